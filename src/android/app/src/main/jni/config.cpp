@@ -131,6 +131,10 @@ void Config::ReadValues() {
     // Core
     ReadSetting("Core", Settings::values.use_cpu_jit);
     ReadSetting("Core", Settings::values.cpu_clock_percentage);
+    ReadSetting("Core", Settings::values.parallel_cpu_cores);
+    ReadSetting("Core", Settings::values.deterministic_cpu_cores);
+    ReadSetting("Core", Settings::values.async_savestates);
+    ReadSetting("Core", Settings::values.delta_savestates);
 
     // Renderer
     Settings::values.use_gles = sdl3_config->GetBoolean("Renderer", "use_gles", true);
@@ -142,6 +146,9 @@ void Config::ReadValues() {
     ReadSetting("Renderer", Settings::values.spirv_shader_gen);
     ReadSetting("Renderer", Settings::values.use_hw_shader);
     ReadSetting("Renderer", Settings::values.use_shader_jit);
+    ReadSetting("Renderer", Settings::values.async_shader_jit);
+    ReadSetting("Renderer", Settings::values.parallel_vertex_shading);
+    ReadSetting("Renderer", Settings::values.async_gpu);
     ReadSetting("Renderer", Settings::values.resolution_factor);
     ReadSetting("Renderer", Settings::values.use_disk_shader_cache);
     ReadSetting("Renderer", Settings::values.use_vsync_new);
@@ -196,6 +203,7 @@ void Config::ReadValues() {
     // Audio
     ReadSetting("Audio", Settings::values.audio_emulation);
     ReadSetting("Audio", Settings::values.enable_audio_stretching);
+    ReadSetting("Audio", Settings::values.parallel_hle_audio);
     ReadSetting("Audio", Settings::values.volume);
     ReadSetting("Audio", Settings::values.output_type);
     ReadSetting("Audio", Settings::values.output_device);
@@ -97,6 +97,26 @@ use_cpu_jit =
 # Range is any positive integer (but we suspect 25 - 400 is a good idea) Default is 100
 cpu_clock_percentage =
 
+# Whether to run each emulated CPU core on its own host thread.
+# The cores synchronize at the end of every timing slice.
+# 0 (default): Off, 1: On
+parallel_cpu_cores =
+
+# Whether parallel cores should fall back to serial execution while a movie is recorded or played.
+# Keeps movie playback reproducible at the cost of speed.
+# 0: Off, 1 (default): On
+deterministic_cpu_cores =
+
+# Whether savestates are compressed and written on a background thread.
+# Emulation only pauses to take the snapshot. Errors while writing are only logged.
+# 0 (default): Off, 1: On
+async_savestates =
+
+# Whether savestates are stored as deltas against the first full savestate saved or loaded.
+# Loading a delta savestate requires the savestate it is based on to remain in its slot.
+# 0 (default): Off, 1: On
+delta_savestates =
+
 [Renderer]
 # Whether to render using OpenGL
 # 1: OpenGL ES (default), 2: Vulkan
@@ -122,6 +142,19 @@ shaders_accurate_mul =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether to compile JIT shaders in the background, running them in the interpreter until ready
+# 0 (default): Off, 1: On
+async_shader_jit =
+
+# Whether to split the vertex shading of large software processed draws across multiple threads
+# 0 (default): Off, 1: On
+parallel_vertex_shading =
+
+# Whether to process GPU command lists, memory fills and transfers on a dedicated thread
+# (Vulkan and software renderers only). Interrupts are delivered at a fixed emulated latency.
+# 0 (default): Off, 1: On
+async_gpu =
+
 # Forces VSync on the display thread. Usually doesn't impact performance, but on some drivers it can
 # so only turn this off if you notice a speed difference.
 # 0: Off, 1 (default): On
@@ -240,6 +273,10 @@ enable_dsp_lle_thread =
 # 0: No, 1 (default): Yes
 enable_audio_stretching =
 
+# Whether to generate the HLE DSP sources on multiple threads
+# 0 (default): No, 1: Yes
+parallel_hle_audio =
+
 # Output volume.
 # 1.0 (default): 100%, 0.0; mute
 volume =
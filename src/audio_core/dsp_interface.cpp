@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include "audio_core/dsp_interface.h"
 #include "audio_core/sink.h"
@@ -13,7 +15,18 @@
 
 namespace AudioCore {
 
-DspInterface::DspInterface(Core::System& system_) : system(system_) {}
+namespace {
+/// Smallest queue depth aimed for, in sink callbacks worth of frames.
+constexpr double MinTargetCallbacks = 1.5;
+/// How many interval deviations of headroom are kept queued, as for TCP retransmit timeouts.
+constexpr double JitterDeviations = 4.0;
+/// Fraction of the underrun headroom kept after each callback without an underrun.
+constexpr double UnderrunHeadroomDecay = 0.999;
+} // Anonymous namespace
+
+DspInterface::DspInterface(Core::System& system_) : system(system_) {
+    stretch_input.resize(fifo.Capacity() * 2);
+}
 
 DspInterface::~DspInterface() = default;
 
@@ -22,9 +35,12 @@ void DspInterface::SetSink(AudioCore::SinkType sink_type, std::string_view audio
     sink.reset();
 
     sink = AudioCore::GetSinkDetails(sink_type).create_sink(audio_device);
+    time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
+    output_sample_rate = static_cast<double>(sink->GetNativeSampleRate());
+    // The callback may start firing as soon as it is set, so the stats must be reset before.
+    ResetOutputStats();
     sink->SetCallback(
         [this](s16* buffer, std::size_t num_frames) { OutputCallback(buffer, num_frames); });
-    time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
 }
 
 Sink& DspInterface::GetSink() {
@@ -36,6 +52,69 @@ void DspInterface::EnableStretching(bool enable) {
     enable_time_stretching = enable;
 }
 
+DspInterface::OutputStats DspInterface::GetOutputStats() const {
+    const std::size_t buffered_frames = fifo.Size();
+    return {
+        .underruns = underruns.load(std::memory_order_relaxed),
+        .frames_dropped = frames_dropped.load(std::memory_order_relaxed),
+        .buffered_frames = buffered_frames,
+        .target_frames = target_frames.load(std::memory_order_relaxed),
+        .latency_ms = output_sample_rate > 0.0
+                          ? static_cast<double>(buffered_frames) * 1000.0 / output_sample_rate
+                          : 0.0,
+        .callback_jitter_ms = jitter_ms.load(std::memory_order_relaxed),
+    };
+}
+
+void DspInterface::ResetOutputStats() {
+    last_callback = {};
+    callback_interval = 0.0;
+    callback_jitter = 0.0;
+    underrun_headroom = 0.0;
+    refilling = true;
+    target_frames = 0;
+    jitter_ms = 0.0;
+    underruns = 0;
+    frames_dropped = 0;
+}
+
+void DspInterface::UpdateTargetLatency(std::size_t num_frames, bool underrun) {
+    const auto now = std::chrono::steady_clock::now();
+    if (last_callback != std::chrono::steady_clock::time_point{}) {
+        const double elapsed = std::chrono::duration<double>(now - last_callback).count();
+        const double interval = elapsed * output_sample_rate;
+        if (callback_interval == 0.0) {
+            callback_interval = interval;
+        } else {
+            // Smoothed mean and mean deviation of the interval, with the gains used by TCP.
+            const double error = interval - callback_interval;
+            callback_interval += error / 8.0;
+            callback_jitter += (std::abs(error) - callback_jitter) / 4.0;
+        }
+    }
+    last_callback = now;
+
+    if (underrun) {
+        underrun_headroom += static_cast<double>(num_frames);
+    } else {
+        underrun_headroom *= UnderrunHeadroomDecay;
+    }
+
+    // The queue must cover the wait until the next callback, however late it comes, on top of
+    // what this callback consumed. Anything beyond that is only added latency.
+    const double frames = static_cast<double>(num_frames);
+    const double wanted = std::max(frames * MinTargetCallbacks,
+                                   std::max(callback_interval, frames) +
+                                       JitterDeviations * callback_jitter) +
+                          underrun_headroom;
+    const double max_target = static_cast<double>(fifo.Capacity() / 2);
+    target_frames.store(static_cast<std::size_t>(std::min(wanted, max_target)),
+                        std::memory_order_relaxed);
+    if (output_sample_rate > 0.0) {
+        jitter_ms.store(callback_jitter * 1000.0 / output_sample_rate, std::memory_order_relaxed);
+    }
+}
+
 void DspInterface::OutputFrame(StereoFrame16 frame) {
     if (!sink) {
         return;
@@ -72,12 +151,33 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
     }
     performing_time_stretching = should_stretch;
 
+    const std::size_t target = target_frames.load(std::memory_order_relaxed);
+    const std::size_t buffered = fifo.Size();
+
     std::size_t frames_written = 0;
+    bool underrun = false;
     if (performing_time_stretching) {
-        const std::vector<s16> in{fifo.Pop()};
-        const std::size_t num_in{in.size() / 2};
-        frames_written = time_stretcher.Process(in.data(), num_in, buffer, num_frames);
+        // The stretcher keeps its own backlog, steer it towards the same target depth.
+        time_stretcher.SetTargetBacklog(target);
+        const std::size_t num_in = fifo.Pop(stretch_input.data(), fifo.Capacity());
+        frames_written = time_stretcher.Process(stretch_input.data(), num_in, buffer, num_frames);
+        if (frames_written < num_frames) {
+            underruns.fetch_add(1, std::memory_order_relaxed);
+            underrun = true;
+        }
+    } else if (refilling && buffered < target) {
+        // After an underrun, let the queue build back up to the target depth before resuming.
+        // Resuming as soon as a single frame is available would only underrun again right away.
     } else {
+        refilling = false;
+
+        // When the emulator produced a burst of audio the queue only adds latency beyond the
+        // target. Trim it back once it is twice as deep as needed.
+        if (target > 0 && buffered > num_frames + 2 * target) {
+            frames_dropped.fetch_add(fifo.Discard(buffered - num_frames - target),
+                                     std::memory_order_relaxed);
+        }
+
         if (flushing_time_stretcher) {
             time_stretcher.Flush();
             frames_written = time_stretcher.Process(nullptr, 0, buffer, num_frames);
@@ -88,7 +188,13 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
             time_stretcher.Clear();
         }
         frames_written += fifo.Pop(buffer, num_frames - frames_written);
+        if (frames_written < num_frames) {
+            underruns.fetch_add(1, std::memory_order_relaxed);
+            underrun = true;
+            refilling = true;
+        }
     }
+    UpdateTargetLatency(num_frames, underrun);
 
     if (frames_written > 0) {
         std::memcpy(&last_frame[0], buffer + 2 * (frames_written - 1), 2 * sizeof(s16));
@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <span>
+#include <vector>
 #include <boost/serialization/access.hpp>
 #include "audio_core/audio_types.h"
 #include "audio_core/time_stretch.h"
@@ -106,6 +109,18 @@ public:
     /// Enable/Disable audio stretching.
     void EnableStretching(bool enable);
 
+    struct OutputStats {
+        u64 underruns;                ///< Sink callbacks that could not be filled completely
+        u64 frames_dropped;           ///< Frames discarded to bring the latency back to target
+        std::size_t buffered_frames;  ///< Frames currently queued for the sink
+        std::size_t target_frames;    ///< Queue depth currently aimed for
+        double latency_ms;            ///< Duration of the frames queued for the sink
+        double callback_jitter_ms;    ///< Smoothed deviation of the sink callback interval
+    };
+
+    /// Returns counters describing the health of the audio output queue.
+    OutputStats GetOutputStats() const;
+
 protected:
     void OutputFrame(StereoFrame16 frame);
     void OutputSample(std::array<s16, 2> sample);
@@ -113,6 +128,8 @@ protected:
 private:
     void FlushResidualStretcherAudio();
     void OutputCallback(s16* buffer, std::size_t num_frames);
+    void UpdateTargetLatency(std::size_t num_frames, bool underrun);
+    void ResetOutputStats();
 
     Core::System& system;
 
@@ -124,6 +141,22 @@ private:
     TimeStretcher time_stretcher;
     std::unique_ptr<Sink> sink;
 
+    /// Scratch space the time stretcher input is drained into, so the sink thread never allocates.
+    std::vector<s16> stretch_input;
+
+    // Adaptive latency state. Only touched by the sink thread, apart from the atomics which are
+    // also read by GetOutputStats.
+    std::chrono::steady_clock::time_point last_callback{};
+    double output_sample_rate = 0.0;
+    double callback_interval = 0.0;  ///< Smoothed callback interval, in frames
+    double callback_jitter = 0.0;    ///< Smoothed callback interval deviation, in frames
+    double underrun_headroom = 0.0;  ///< Extra depth requested after underruns, in frames
+    bool refilling = true;           ///< Holding output until the queue reaches the target
+    std::atomic<std::size_t> target_frames = 0;
+    std::atomic<double> jitter_ms = 0.0;
+    std::atomic<u64> underruns = 0;
+    std::atomic<u64> frames_dropped = 0;
+
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {}
     friend class boost::serialization::access;
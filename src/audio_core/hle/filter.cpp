@@ -5,13 +5,25 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
-#include "audio_core/hle/common.h"
 #include "audio_core/hle/filter.h"
 #include "audio_core/hle/shared_memory.h"
+#include "common/arch.h"
 #include "common/common_types.h"
 
+#if CYTRUS_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CYTRUS_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
 namespace AudioCore::HLE {
 
+namespace {
+/// Sum of the feedforward terms of every sample of a frame, per channel.
+using FeedForward = std::array<std::array<s32, 2>, samples_per_frame>;
+static_assert(samples_per_frame % 4 == 0);
+} // Anonymous namespace
+
 void SourceFilters::Reset() {
     Enable(false, false);
 }
@@ -39,11 +51,11 @@ void SourceFilters::ProcessFrame(StereoFrame16& frame) {
         return;
 
     if (simple_filter_enabled) {
-        FilterFrame(frame, simple_filter);
+        simple_filter.ProcessFrame(frame);
     }
 
     if (biquad_filter_enabled) {
-        FilterFrame(frame, biquad_filter);
+        biquad_filter.ProcessFrame(frame);
     }
 }
 
@@ -63,16 +75,44 @@ void SourceFilters::SimpleFilter::Configure(
     b0 = config.b0;
 }
 
-std::array<s16, 2> SourceFilters::SimpleFilter::ProcessSample(const std::array<s16, 2>& x0) {
-    std::array<s16, 2> y0;
-    for (std::size_t i = 0; i < 2; i++) {
-        const s32 tmp = (b0 * x0[i] + a1 * y1[i]) >> 15;
-        y0[i] = std::clamp(tmp, -32768, 32767);
+void SourceFilters::SimpleFilter::ProcessFrame(StereoFrame16& frame) {
+    // Only the a1 term depends on previous outputs. The b0 term is computed for the whole frame
+    // up front, for both channels and several samples at once.
+    alignas(16) FeedForward feed_forward;
+#if CYTRUS_ARCH(x86_64)
+    // madd multiplies 16-bit values, and b0 is 1 << 15 when passing through. Each sample is
+    // multiplied by two halves of b0 that fit instead, and madd adds the products.
+    const s32 b0_hi = b0 / 2;
+    const __m128i coeffs = _mm_unpacklo_epi16(_mm_set1_epi16(static_cast<s16>(b0 - b0_hi)),
+                                              _mm_set1_epi16(static_cast<s16>(b0_hi)));
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        const __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frame[i].data()));
+        _mm_store_si128(reinterpret_cast<__m128i*>(feed_forward[i].data()),
+                        _mm_madd_epi16(_mm_unpacklo_epi16(x0, x0), coeffs));
+        _mm_store_si128(reinterpret_cast<__m128i*>(feed_forward[i + 2].data()),
+                        _mm_madd_epi16(_mm_unpackhi_epi16(x0, x0), coeffs));
+    }
+#elif CYTRUS_ARCH(arm64)
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        const int16x8_t x0 = vld1q_s16(frame[i].data());
+        vst1q_s32(feed_forward[i].data(), vmulq_n_s32(vmovl_s16(vget_low_s16(x0)), b0));
+        vst1q_s32(feed_forward[i + 2].data(), vmulq_n_s32(vmovl_s16(vget_high_s16(x0)), b0));
+    }
+#else
+    for (std::size_t i = 0; i < samples_per_frame; i++) {
+        for (std::size_t c = 0; c < 2; c++) {
+            feed_forward[i][c] = b0 * frame[i][c];
+        }
+    }
+#endif
+
+    for (std::size_t i = 0; i < samples_per_frame; i++) {
+        for (std::size_t c = 0; c < 2; c++) {
+            const s32 tmp = (feed_forward[i][c] + a1 * y1[c]) >> 15;
+            y1[c] = static_cast<s16>(std::clamp(tmp, -32768, 32767));
+        }
+        frame[i] = y1;
     }
-
-    y1 = y0;
-
-    return y0;
 }
 
 // BiquadFilter
@@ -97,19 +137,71 @@ void SourceFilters::BiquadFilter::Configure(
     b2 = config.b2;
 }
 
-std::array<s16, 2> SourceFilters::BiquadFilter::ProcessSample(const std::array<s16, 2>& x0) {
-    std::array<s16, 2> y0;
-    for (std::size_t i = 0; i < 2; i++) {
-        const s32 tmp = (b0 * x0[i] + b1 * x1[i] + b2 * x2[i] + a1 * y1[i] + a2 * y2[i]) >> 14;
-        y0[i] = std::clamp(tmp, -32768, 32767);
+void SourceFilters::BiquadFilter::ProcessFrame(StereoFrame16& frame) {
+    // Only the a1 and a2 terms depend on previous outputs. The b0, b1 and b2 terms are computed
+    // for the whole frame up front, for both channels and several samples at once.
+    std::array<std::array<s16, 2>, samples_per_frame + 2> input;
+    input[0] = x2;
+    input[1] = x1;
+    std::copy(frame.begin(), frame.end(), input.begin() + 2);
+
+    alignas(16) FeedForward feed_forward;
+#if CYTRUS_ARCH(x86_64)
+    // madd multiplies adjacent 16-bit values and adds the products, so x[n] and x[n-1] are
+    // interleaved to get both of their terms at once.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i b0_b1 = _mm_unpacklo_epi16(_mm_set1_epi16(static_cast<s16>(b0)),
+                                             _mm_set1_epi16(static_cast<s16>(b1)));
+    const __m128i b2_0 = _mm_unpacklo_epi16(_mm_set1_epi16(static_cast<s16>(b2)), zero);
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        const auto load = [&](std::size_t j) {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(input[j].data()));
+        };
+        const __m128i xn0 = load(i + 2);
+        const __m128i xn1 = load(i + 1);
+        const __m128i xn2 = load(i);
+        const __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(xn0, xn1), b0_b1),
+                                         _mm_madd_epi16(_mm_unpacklo_epi16(xn2, zero), b2_0));
+        const __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(xn0, xn1), b0_b1),
+                                         _mm_madd_epi16(_mm_unpackhi_epi16(xn2, zero), b2_0));
+        _mm_store_si128(reinterpret_cast<__m128i*>(feed_forward[i].data()), lo);
+        _mm_store_si128(reinterpret_cast<__m128i*>(feed_forward[i + 2].data()), hi);
     }
-
-    x2 = x1;
-    x1 = x0;
-    y2 = y1;
-    y1 = y0;
-
-    return y0;
+#elif CYTRUS_ARCH(arm64)
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        const int16x8_t xn0 = vld1q_s16(input[i + 2].data());
+        const int16x8_t xn1 = vld1q_s16(input[i + 1].data());
+        const int16x8_t xn2 = vld1q_s16(input[i].data());
+        int32x4_t lo = vmull_n_s16(vget_low_s16(xn0), static_cast<s16>(b0));
+        lo = vmlal_n_s16(lo, vget_low_s16(xn1), static_cast<s16>(b1));
+        lo = vmlal_n_s16(lo, vget_low_s16(xn2), static_cast<s16>(b2));
+        int32x4_t hi = vmull_n_s16(vget_high_s16(xn0), static_cast<s16>(b0));
+        hi = vmlal_n_s16(hi, vget_high_s16(xn1), static_cast<s16>(b1));
+        hi = vmlal_n_s16(hi, vget_high_s16(xn2), static_cast<s16>(b2));
+        vst1q_s32(feed_forward[i].data(), lo);
+        vst1q_s32(feed_forward[i + 2].data(), hi);
+    }
+#else
+    for (std::size_t i = 0; i < samples_per_frame; i++) {
+        for (std::size_t c = 0; c < 2; c++) {
+            feed_forward[i][c] =
+                b0 * input[i + 2][c] + b1 * input[i + 1][c] + b2 * input[i][c];
+        }
+    }
+#endif
+
+    for (std::size_t i = 0; i < samples_per_frame; i++) {
+        std::array<s16, 2> y0;
+        for (std::size_t c = 0; c < 2; c++) {
+            const s32 tmp = (feed_forward[i][c] + a1 * y1[c] + a2 * y2[c]) >> 14;
+            y0[c] = static_cast<s16>(std::clamp(tmp, -32768, 32767));
+        }
+        y2 = y1;
+        y1 = y0;
+        frame[i] = y0;
+    }
+    x2 = input[samples_per_frame];
+    x1 = input[samples_per_frame + 1];
 }
 
 } // namespace AudioCore::HLE
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <thread>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/shared_ptr.hpp>
@@ -21,6 +23,8 @@
 #include "common/common_types.h"
 #include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/settings.h"
+#include "common/thread_worker.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 
@@ -88,6 +92,9 @@ private:
     }};
     HLE::Mixers mixers{};
 
+    /// Workers generating sources in parallel, only created when parallel_hle_audio is set.
+    std::unique_ptr<Common::ThreadWorker> source_workers;
+
     DspHle& parent;
     Core::Timing& core_timing;
     Core::TimingEventType* tick_event{};
@@ -116,6 +123,12 @@ DspHle::Impl::Impl(DspHle& parent_, Memory::MemorySystem& memory, Core::Timing&
         source.SetMemory(memory);
     }
 
+    const u32 num_threads = std::thread::hardware_concurrency();
+    if (Settings::values.parallel_hle_audio.GetValue() && num_threads > 1) {
+        source_workers =
+            std::make_unique<Common::ThreadWorker>(std::min(num_threads, 4U) - 1, "HleAudio");
+    }
+
     aac_decoder = std::make_unique<HLE::AACDecoder>(memory);
     tick_event =
         core_timing.RegisterEvent("AudioCore::DspHle::tick_event", [this](u64, s64 cycles_late) {
@@ -370,12 +383,32 @@ StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
 
     std::array<QuadFrame32, 3> intermediate_mixes = {};
 
+    // Sources only touch their own configuration, status and state, so they can be generated
+    // in parallel. Sources are interleaved between the threads, as games tend to use the
+    // lowest numbered ones.
+    const auto tick_sources = [&](std::size_t first, std::size_t stride) {
+        for (std::size_t i = first; i < HLE::num_sources; i += stride) {
+            write.source_statuses.status[i] = sources[i].Tick(read.source_configurations.config[i],
+                                                              read.adpcm_coefficients.coeff[i]);
+        }
+    };
+    if (source_workers) {
+        const std::size_t num_chunks = source_workers->NumWorkers() + 1;
+        for (std::size_t chunk = 1; chunk < num_chunks; chunk++) {
+            source_workers->QueueWork([&tick_sources, chunk, num_chunks] {
+                tick_sources(chunk, num_chunks);
+            });
+        }
+        tick_sources(0, num_chunks);
+        source_workers->WaitForRequests();
+    } else {
+        tick_sources(0, 1);
+    }
+
     // Generate intermediate mixes
-    for (std::size_t i = 0; i < HLE::num_sources; i++) {
-        write.source_statuses.status[i] =
-            sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
+    for (const auto& source : sources) {
         for (std::size_t mix = 0; mix < 3; mix++) {
-            sources[i].MixInto(intermediate_mixes[mix], mix);
+            source.MixInto(intermediate_mixes[mix], mix);
         }
     }
 
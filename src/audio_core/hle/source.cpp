@@ -4,14 +4,22 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include "audio_core/codec.h"
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
+#include "common/arch.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/memory.h"
 
+#if CYTRUS_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CYTRUS_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
 namespace AudioCore::HLE {
 
 SourceStatus::Status Source::Tick(SourceConfiguration::Configuration& config,
@@ -30,13 +38,44 @@ void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
         return;
 
     const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
+    if (std::all_of(gains.begin(), gains.end(), [](float gain) { return gain == 0.0f; })) {
+        // Most sources only feed some of the intermediate mixes.
+        return;
+    }
+
+    // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
+    // Each sample is widened to {left, right, left, right} and scaled by all four gains at once,
+    // truncating towards zero like the scalar conversion does.
+#if CYTRUS_ARCH(x86_64)
+    const __m128 gain_vector = _mm_loadu_ps(gains.data());
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        s32 stereo_bits;
+        std::memcpy(&stereo_bits, current_frame[samplei].data(), sizeof(stereo_bits));
+        const __m128i stereo = _mm_cvtsi32_si128(stereo_bits);
+        const __m128i widened = _mm_srai_epi32(_mm_unpacklo_epi16(stereo, stereo), 16);
+        const __m128i quad = _mm_shuffle_epi32(widened, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m128i scaled = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(quad), gain_vector));
+        auto* out = reinterpret_cast<__m128i*>(dest[samplei].data());
+        _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), scaled));
+    }
+#elif CYTRUS_ARCH(arm64)
+    const float32x4_t gain_vector = vld1q_f32(gains.data());
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        u32 stereo_bits;
+        std::memcpy(&stereo_bits, current_frame[samplei].data(), sizeof(stereo_bits));
+        const int32x4_t quad = vmovl_s16(vreinterpret_s16_u32(vdup_n_u32(stereo_bits)));
+        const int32x4_t scaled = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(quad), gain_vector));
+        s32* out = dest[samplei].data();
+        vst1q_s32(out, vaddq_s32(vld1q_s32(out), scaled));
+    }
+#else
     for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
-        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
         dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
         dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
         dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
         dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
     }
+#endif
 }
 
 void Source::Reset() {
@@ -349,9 +388,8 @@ void Source::GenerateFrame() {
                                 current_frame, frame_position);
             break;
         case InterpolationMode::Polyphase:
-            // TODO(merry): Implement polyphase interpolation
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier,
-                                current_frame, frame_position);
+            AudioInterp::Polyphase(state.interp_state, state.current_buffer,
+                                   state.rate_multiplier, current_frame, frame_position);
             break;
         default:
             UNIMPLEMENTED();
@@ -3,9 +3,21 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <vector>
 #include "audio_core/interpolate.h"
+#include "common/arch.h"
 #include "common/assert.h"
 
+#if CYTRUS_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CYTRUS_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
 namespace AudioCore::AudioInterp {
 
 // Calculations are done in fixed point with 24 fractional bits.
@@ -57,20 +69,323 @@ void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output
         [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
 }
 
+/**
+ * Computes count linearly interpolated outputs. Output i lies between samples[positions[i]] and
+ * the sample following it, at fractions[i] / scale_factor of the way.
+ */
+static void InterpolateLinear(const std::array<s16, 2>* samples, const u32* positions,
+                              const u32* fractions, std::size_t count,
+                              std::array<s16, 2>* output) {
+    std::size_t i = 0;
+    // The firmware subtracts with saturation and the product with the 24-bit fraction is floored.
+    // The fraction is split into two 12-bit halves so both partial products fit 32-bit lanes:
+    // floor(f * d / 2^24) == floor((fh * d + floor(fl * d / 2^12)) / 2^12).
+#if CYTRUS_ARCH(x86_64)
+    const __m128i fraction_mask = _mm_set1_epi32(0xFFF);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        // Both samples of an output are adjacent, so a single 64-bit load fetches them.
+        const auto load_pair = [&](std::size_t j) {
+            return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(samples + positions[j]));
+        };
+        const __m128i pairs01 = _mm_unpacklo_epi64(load_pair(i), load_pair(i + 1));
+        const __m128i pairs23 = _mm_unpacklo_epi64(load_pair(i + 2), load_pair(i + 3));
+        const __m128i lo = _mm_unpacklo_epi32(pairs01, pairs23);
+        const __m128i hi = _mm_unpackhi_epi32(pairs01, pairs23);
+        const __m128i x0 = _mm_unpacklo_epi32(lo, hi);
+        const __m128i x1 = _mm_unpackhi_epi32(lo, hi);
+        const __m128i delta = _mm_subs_epi16(x1, x0);
+
+        // Each 32-bit lane holds a 16-bit value with a zero upper half, so madd is a plain
+        // signed multiply. Both channels of an output share its fraction.
+        const __m128i fraction = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fractions + i));
+        const __m128i fraction_hi = _mm_srli_epi32(fraction, 12);
+        const __m128i fraction_lo = _mm_and_si128(fraction, fraction_mask);
+        const auto scale = [&](__m128i d, __m128i f_hi, __m128i f_lo) {
+            const __m128i product_lo = _mm_srai_epi32(_mm_madd_epi16(d, f_lo), 12);
+            return _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(d, f_hi), product_lo), 12);
+        };
+        const __m128i offset01 =
+            scale(_mm_unpacklo_epi16(delta, zero), _mm_unpacklo_epi32(fraction_hi, fraction_hi),
+                  _mm_unpacklo_epi32(fraction_lo, fraction_lo));
+        const __m128i offset23 =
+            scale(_mm_unpackhi_epi16(delta, zero), _mm_unpackhi_epi32(fraction_hi, fraction_hi),
+                  _mm_unpackhi_epi32(fraction_lo, fraction_lo));
+
+        // The offsets never exceed the delta, so packing them does not saturate.
+        const __m128i result = _mm_add_epi16(x0, _mm_packs_epi32(offset01, offset23));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), result);
+    }
+#elif CYTRUS_ARCH(arm64)
+    const uint32x4_t fraction_mask = vdupq_n_u32(0xFFF);
+    for (; i + 4 <= count; i += 4) {
+        // Both samples of an output are adjacent, so a single 64-bit load fetches them.
+        const auto load_pair = [&](std::size_t j) {
+            return vreinterpret_u32_s16(vld1_s16(samples[positions[j]].data()));
+        };
+        const uint32x4x2_t pairs = vuzpq_u32(vcombine_u32(load_pair(i), load_pair(i + 1)),
+                                             vcombine_u32(load_pair(i + 2), load_pair(i + 3)));
+        const int16x8_t x0 = vreinterpretq_s16_u32(pairs.val[0]);
+        const int16x8_t x1 = vreinterpretq_s16_u32(pairs.val[1]);
+        const int16x8_t delta = vqsubq_s16(x1, x0);
+
+        // Both channels of an output share its fraction.
+        const uint32x4_t fraction = vld1q_u32(fractions + i);
+        const uint16x4_t fraction_hi = vmovn_u32(vshrq_n_u32(fraction, 12));
+        const uint16x4_t fraction_lo = vmovn_u32(vandq_u32(fraction, fraction_mask));
+        const uint16x4x2_t hi = vzip_u16(fraction_hi, fraction_hi);
+        const uint16x4x2_t lo = vzip_u16(fraction_lo, fraction_lo);
+        const auto scale = [](int16x4_t d, uint16x4_t f_hi, uint16x4_t f_lo) {
+            const int32x4_t product_lo = vshrq_n_s32(vmull_s16(d, vreinterpret_s16_u16(f_lo)), 12);
+            return vshrq_n_s32(vaddq_s32(vmull_s16(d, vreinterpret_s16_u16(f_hi)), product_lo),
+                               12);
+        };
+        const int32x4_t offset01 = scale(vget_low_s16(delta), hi.val[0], lo.val[0]);
+        const int32x4_t offset23 = scale(vget_high_s16(delta), hi.val[1], lo.val[1]);
+
+        // The offsets never exceed the delta, so narrowing them does not saturate.
+        const int16x8_t offset = vcombine_s16(vqmovn_s32(offset01), vqmovn_s32(offset23));
+        vst1q_s16(output[i].data(), vaddq_s16(x0, offset));
+    }
+#endif
+    for (; i < count; i++) {
+        const auto& x0 = samples[positions[i]];
+        const auto& x1 = samples[positions[i] + 1];
+        // This is a saturated subtraction. (Verified by black-box fuzzing.)
+        const s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
+        const s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
+        output[i] = {
+            static_cast<s16>(x0[0] + ((fractions[i] * delta0) >> 24)),
+            static_cast<s16>(x0[1] + ((fractions[i] * delta1) >> 24)),
+        };
+    }
+}
+
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi) {
     // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
-    StepOverSamples(state, input, rate, output, outputi,
-                    [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
-                        // This is a saturated subtraction. (Verified by black-box fuzzing.)
-                        s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
-                        s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
-
-                        return std::array<s16, 2>{
-                            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
-                            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
-                        };
-                    });
+    ASSERT(rate > 0);
+
+    if (input.empty())
+        return;
+
+    // This follows StepOverSamples. The positions of the outputs are worked out first, and the
+    // samples they reach are copied behind the two historical ones, so that the outputs can then
+    // be interpolated several at a time from contiguous memory.
+    const u64 step_size = static_cast<u64>(rate * scale_factor);
+    const std::size_t available = input.size() + 2;
+    u64 fposition = state.fposition;
+    std::size_t inputi = 0;
+
+    std::array<u32, samples_per_frame> positions;
+    std::array<u32, samples_per_frame> fractions;
+    std::size_t count = 0;
+    while (outputi + count < output.size()) {
+        inputi = static_cast<std::size_t>(fposition / scale_factor);
+
+        if (inputi + 2 >= available) {
+            inputi = available - 2;
+            break;
+        }
+
+        positions[count] = static_cast<u32>(inputi);
+        fractions[count] = static_cast<u32>(fposition & scale_mask);
+        count++;
+
+        fposition += step_size;
+    }
+
+    const std::size_t needed = count == 0 ? 0 : positions[count - 1] + 2;
+    thread_local std::vector<std::array<s16, 2>> samples;
+    samples.resize(std::max<std::size_t>(needed, 2));
+    samples[0] = state.xn2;
+    samples[1] = state.xn1;
+    std::copy_n(input.begin(), needed > 2 ? needed - 2 : 0, samples.begin() + 2);
+    InterpolateLinear(samples.data(), positions.data(), fractions.data(), count,
+                      output.data() + outputi);
+    outputi += count;
+
+    // The last two samples the next position may start from become the new history.
+    const auto sample_at = [&](std::size_t position) {
+        return position < 2 ? (position == 0 ? state.xn2 : state.xn1) : input[position - 2];
+    };
+    const auto xn2 = sample_at(inputi);
+    const auto xn1 = sample_at(inputi + 1);
+    state.xn2 = xn2;
+    state.xn1 = xn1;
+    state.fposition = fposition - inputi * scale_factor;
+
+    input.erase(input.begin(), std::next(input.begin(), inputi));
+}
+
+// The polyphase filter has coefficients for polyphase_phases fractional positions, selected by
+// the top bits of the fraction.
+constexpr std::size_t polyphase_phases = 256;
+constexpr u64 polyphase_phase_shift = 16;
+static_assert((scale_factor >> polyphase_phase_shift) == polyphase_phases);
+
+// Decimating rates get a bank with a lower cutoff. The cutoff is quantized to 1/polyphase_banks
+// of the full bandwidth, which bounds the number of banks that can ever be built.
+constexpr u32 polyphase_banks = 64;
+// Passband relative to the Nyquist frequency, leaving room for the transition band.
+constexpr double polyphase_rolloff = 0.9;
+constexpr double kaiser_beta = 6.0;
+
+struct PolyphaseBank {
+    alignas(16) std::array<std::array<float, polyphase_taps>, polyphase_phases> coeffs;
+};
+
+/// Zeroth order modified Bessel function of the first kind, used by the Kaiser window.
+static double BesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+static std::unique_ptr<PolyphaseBank> MakePolyphaseBank(double cutoff) {
+    constexpr double half_length = polyphase_taps / 2;
+    auto bank = std::make_unique<PolyphaseBank>();
+    for (std::size_t phase = 0; phase < polyphase_phases; phase++) {
+        const double fraction = static_cast<double>(phase) / polyphase_phases;
+        std::array<double, polyphase_taps> taps;
+        double sum = 0.0;
+        for (std::size_t k = 0; k < polyphase_taps; k++) {
+            // Distance of the tap from the interpolated position, which lies between the
+            // samples of taps half_length - 1 and half_length.
+            const double t = static_cast<double>(k) - (half_length - 1) - fraction;
+            const double x = t / half_length;
+            const double window =
+                std::abs(x) < 1.0 ? BesselI0(kaiser_beta * std::sqrt(1.0 - x * x)) : 0.0;
+            const double arg = std::numbers::pi * cutoff * t;
+            const double sinc = arg == 0.0 ? 1.0 : std::sin(arg) / arg;
+            taps[k] = cutoff * sinc * window;
+            sum += taps[k];
+        }
+        // Normalize every phase to unity gain, so constant signals pass through unchanged.
+        for (std::size_t k = 0; k < polyphase_taps; k++) {
+            bank->coeffs[phase][k] = static_cast<float>(taps[k] / sum);
+        }
+    }
+    return bank;
+}
+
+static const PolyphaseBank* GetPolyphaseBank(float rate) {
+    const u32 index =
+        rate <= 1.0f ? polyphase_banks
+                     : std::clamp(static_cast<u32>(std::lround(polyphase_banks / rate)), 1U,
+                                  polyphase_banks);
+
+    static std::mutex banks_mutex;
+    static std::array<std::unique_ptr<PolyphaseBank>, polyphase_banks + 1> banks;
+    std::scoped_lock lock{banks_mutex};
+    auto& bank = banks[index];
+    if (!bank) {
+        bank = MakePolyphaseBank(polyphase_rolloff * index / polyphase_banks);
+    }
+    return bank.get();
+}
+
+static float DotProduct(const std::array<float, polyphase_taps>& taps, const float* samples) {
+    static_assert(polyphase_taps % 4 == 0);
+#if CYTRUS_ARCH(x86_64)
+    __m128 sum = _mm_mul_ps(_mm_load_ps(taps.data()), _mm_loadu_ps(samples));
+    for (std::size_t i = 4; i < polyphase_taps; i += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(taps.data() + i), _mm_loadu_ps(samples + i)));
+    }
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(sum);
+#elif CYTRUS_ARCH(arm64)
+    float32x4_t sum = vmulq_f32(vld1q_f32(taps.data()), vld1q_f32(samples));
+    for (std::size_t i = 4; i < polyphase_taps; i += 4) {
+        sum = vfmaq_f32(sum, vld1q_f32(taps.data() + i), vld1q_f32(samples + i));
+    }
+    return vaddvq_f32(sum);
+#else
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < polyphase_taps; i++) {
+        sum += taps[i] * samples[i];
+    }
+    return sum;
+#endif
+}
+
+static s16 ToSample(float value) {
+    return static_cast<s16>(std::clamp(std::lrint(value), -32768L, 32767L));
+}
+
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi) {
+    ASSERT(rate > 0);
+
+    if (input.empty() || outputi >= output.size())
+        return;
+
+    if (!state.polyphase_bank || state.polyphase_rate != rate) {
+        state.polyphase_bank = GetPolyphaseBank(rate);
+        state.polyphase_rate = rate;
+    }
+    const auto& coeffs = state.polyphase_bank->coeffs;
+
+    // This follows StepOverSamples, with a window of polyphase_taps samples instead of three.
+    // The window is read from planar float copies of the history and of the input samples the
+    // remaining output can reach, so the inner loop runs on contiguous memory.
+    constexpr std::size_t history_size = polyphase_taps - 1;
+    const u64 step_size = static_cast<u64>(rate * scale_factor);
+    u64 fposition = state.fposition;
+
+    const u64 last_position = fposition + (output.size() - outputi - 1) * step_size;
+    const std::size_t available = history_size + input.size();
+    const std::size_t needed = static_cast<std::size_t>(
+        std::min<u64>(available, last_position / scale_factor + polyphase_taps));
+
+    thread_local std::vector<float> left;
+    thread_local std::vector<float> right;
+    left.resize(needed);
+    right.resize(needed);
+    for (std::size_t i = 0; i < history_size; i++) {
+        left[i] = state.polyphase_history[i][0];
+        right[i] = state.polyphase_history[i][1];
+    }
+    auto input_it = input.begin();
+    for (std::size_t i = history_size; i < needed; i++, ++input_it) {
+        left[i] = (*input_it)[0];
+        right[i] = (*input_it)[1];
+    }
+
+    std::size_t inputi = 0;
+    while (outputi < output.size()) {
+        inputi = static_cast<std::size_t>(fposition / scale_factor);
+
+        if (inputi + polyphase_taps > needed) {
+            inputi = needed - history_size;
+            break;
+        }
+
+        const auto& taps = coeffs[(fposition & scale_mask) >> polyphase_phase_shift];
+        output[outputi++] = {
+            ToSample(DotProduct(taps, left.data() + inputi)),
+            ToSample(DotProduct(taps, right.data() + inputi)),
+        };
+
+        fposition += step_size;
+    }
+
+    // The window of the next position starts at inputi, keep it as the new history.
+    std::array<std::array<s16, 2>, history_size> history;
+    for (std::size_t i = 0; i < history_size; i++) {
+        const std::size_t position = inputi + i;
+        history[i] = position < history_size ? state.polyphase_history[position]
+                                             : input[position - history_size];
+    }
+    state.polyphase_history = history;
+    state.fposition = fposition - inputi * scale_factor;
+
+    input.erase(input.begin(), std::next(input.begin(), inputi));
 }
 
 } // namespace AudioCore::AudioInterp
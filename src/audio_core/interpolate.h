@@ -14,12 +14,23 @@ namespace AudioCore::AudioInterp {
 /// A variable length buffer of signed PCM16 stereo samples.
 using StereoBuffer16 = std::deque<std::array<s16, 2>>;
 
+/// Number of input samples contributing to every output sample of the polyphase filter.
+constexpr std::size_t polyphase_taps = 16;
+
+struct PolyphaseBank;
+
 struct State {
     /// Two historical samples.
     std::array<s16, 2> xn1 = {}; ///< x[n-1]
     std::array<s16, 2> xn2 = {}; ///< x[n-2]
     /// Current fractional position.
     u64 fposition = 0;
+
+    /// Historical samples of the polyphase filter, oldest first.
+    std::array<std::array<s16, 2>, polyphase_taps - 1> polyphase_history = {};
+    /// Coefficient bank used for polyphase_rate, looked up again when the rate changes.
+    const PolyphaseBank* polyphase_bank = nullptr;
+    float polyphase_rate = 0.0f;
 };
 
 /**
@@ -46,4 +57,17 @@ void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi);
 
+/**
+ * Polyphase interpolation with a windowed-sinc filter of polyphase_taps taps. When decimating, the
+ * cutoff is lowered with the rate to avoid aliasing. There is an eight-sample predelay.
+ * @param state Interpolation state.
+ * @param input Input buffer.
+ * @param rate Stretch factor. Must be a positive non-zero value.
+ *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
+ * @param output The resampled audio buffer.
+ * @param outputi The index of output to start writing to.
+ */
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi);
+
 } // namespace AudioCore::AudioInterp
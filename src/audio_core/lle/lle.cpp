@@ -2,19 +2,25 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <thread>
 #include <teakra/teakra.h>
 #include "audio_core/lle/lle.h"
 #include "common/assert.h"
 #include "common/bit_field.h"
+#include "common/microprofile.h"
 #include "common/swap.h"
 #include "common/thread.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/dsp/dsp_dsp.h"
 
+MICROPROFILE_DEFINE(Audio_DSPLLE, "Audio", "DSP LLE", MP_RGB(100, 200, 100));
+MICROPROFILE_DEFINE(Audio_DSPLLEWait, "Audio", "DSP LLE Wait", MP_RGB(128, 128, 128));
+
 namespace AudioCore {
 
 enum class SegmentType : u8 {
@@ -142,45 +148,140 @@ struct DspLle::Impl final {
 
     const bool multithread;
     std::thread teakra_thread;
-    Common::Barrier teakra_slice_barrier{2};
     std::atomic<bool> stop_signal = false;
-    std::size_t stop_generation;
+
+    // Slice handoff with the Teakra thread. The CPU thread publishes a slice by bumping
+    // slice_requested and the Teakra thread bumps slice_completed once it ran it, so at most one
+    // slice is in flight and neither side takes a lock to pass it on.
+    std::atomic<u32> slice_requested = 0;
+    std::atomic<u32> slice_completed = 0;
+    u32 requested_cycles = 0;
 
     static constexpr u32 DspDataOffset = 0x40000;
+    /// Slice used while the CPU is waiting on the DSP, and after the two communicated.
     static constexpr u32 TeakraSlice = 16384;
+    /// Longest slice scheduled while the DSP is left alone.
+    static constexpr u32 MaxTeakraSlice = TeakraSlice * 8;
+    /// Number of polls of a pending slice before the CPU thread goes to sleep on it.
+    static constexpr u32 HandoffSpinCount = 256;
+
+    u32 scheduled_slice = TeakraSlice;
+    /// Set when pipes, semaphores or data registers were used since the last scheduled slice.
+    std::atomic<bool> interacted = false;
+
+    // Instrumentation, reported once per second.
+    std::atomic<u64> dsp_cycles = 0;
+    u64 last_report_cycles = 0;
+    std::chrono::steady_clock::time_point last_report_time{};
+    std::atomic<double> cycles_per_second = 0.0;
+
+    void NoteInteraction() {
+        if (!interacted.load(std::memory_order_relaxed)) {
+            interacted.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    void RunCycles(u32 cycles) {
+        MICROPROFILE_SCOPE(Audio_DSPLLE);
+        teakra.Run(cycles);
+        dsp_cycles.fetch_add(cycles, std::memory_order_relaxed);
+    }
 
     void TeakraThread() {
+        u32 completed = slice_completed.load(std::memory_order_relaxed);
         while (true) {
-            teakra.Run(TeakraSlice);
-            teakra_slice_barrier.Sync();
-            if (stop_signal) {
-                if (stop_generation == teakra_slice_barrier.Generation())
-                    break;
+            slice_requested.wait(completed, std::memory_order_acquire);
+            const u32 request = slice_requested.load(std::memory_order_acquire);
+            if (stop_signal.load(std::memory_order_relaxed)) {
+                break;
             }
+            RunCycles(requested_cycles);
+            completed = request;
+            slice_completed.store(completed, std::memory_order_release);
+            slice_completed.notify_one();
         }
-        stop_signal = false;
+    }
+
+    /// Blocks until the Teakra thread finished the slice in flight, if any.
+    void WaitForSlice() {
+        const u32 requested = slice_requested.load(std::memory_order_relaxed);
+        u32 completed = slice_completed.load(std::memory_order_acquire);
+        if (completed == requested) {
+            return;
+        }
+        MICROPROFILE_SCOPE(Audio_DSPLLEWait);
+        // Slices are short, so the result is usually close. Poll for a while before sleeping.
+        for (u32 i = 0; i < HandoffSpinCount && completed != requested; ++i) {
+            std::this_thread::yield();
+            completed = slice_completed.load(std::memory_order_acquire);
+        }
+        while (completed != requested) {
+            slice_completed.wait(completed, std::memory_order_acquire);
+            completed = slice_completed.load(std::memory_order_acquire);
+        }
+    }
+
+    void PostSlice(u32 cycles) {
+        requested_cycles = cycles;
+        slice_requested.fetch_add(1, std::memory_order_release);
+        slice_requested.notify_one();
     }
 
     void StopTeakraThread() {
         if (teakra_thread.joinable()) {
-            stop_generation = teakra_slice_barrier.Generation() + 1;
+            WaitForSlice();
             stop_signal = true;
-            teakra_slice_barrier.Sync();
+            PostSlice(0);
             teakra_thread.join();
+            stop_signal = false;
+            slice_completed.store(slice_requested.load());
         }
     }
 
-    void RunTeakraSlice() {
+    /// Waits for the previous slice and lets the DSP run the next `cycles` cycles. In multithread
+    /// mode the new slice runs concurrently with the caller.
+    void RunTeakraSlice(u32 cycles = TeakraSlice) {
         if (multithread) {
-            teakra_slice_barrier.Sync();
+            WaitForSlice();
+            PostSlice(cycles);
         } else {
-            teakra.Run(TeakraSlice);
+            RunCycles(cycles);
+        }
+    }
+
+    void ReportCycleRate() {
+        const auto now = std::chrono::steady_clock::now();
+        if (last_report_time == std::chrono::steady_clock::time_point{}) {
+            last_report_time = now;
+            last_report_cycles = dsp_cycles.load(std::memory_order_relaxed);
+            return;
+        }
+        const std::chrono::duration<double> elapsed = now - last_report_time;
+        if (elapsed < std::chrono::seconds{1}) {
+            return;
         }
+        const u64 cycles = dsp_cycles.load(std::memory_order_relaxed);
+        const double rate = static_cast<double>(cycles - last_report_cycles) / elapsed.count();
+        cycles_per_second.store(rate, std::memory_order_relaxed);
+        LOG_DEBUG(Audio_DSP, "LLE DSP running at {:.2f} Mcycles/s, slice {} cycles", rate / 1e6,
+                  scheduled_slice);
+        last_report_time = now;
+        last_report_cycles = cycles;
     }
 
     void TeakraSliceEvent(u64 late) {
-        RunTeakraSlice();
-        u64 next = TeakraSlice * 2; // DSP runs at clock rate half of the CPU rate
+        // Communication comes in bursts around each audio frame. Keep slices short while it is
+        // going on so replies arrive promptly, and let them grow while the DSP is left alone to
+        // save on handoffs.
+        if (interacted.exchange(false, std::memory_order_relaxed)) {
+            scheduled_slice = TeakraSlice;
+        } else {
+            scheduled_slice = std::min(scheduled_slice * 2, MaxTeakraSlice);
+        }
+        RunTeakraSlice(scheduled_slice);
+        ReportCycleRate();
+
+        u64 next = scheduled_slice * 2; // DSP runs at clock rate half of the CPU rate
         if (next < late)
             next = 0;
         else
@@ -250,6 +351,7 @@ struct DspLle::Impl final {
             need_update = true;
         }
         if (need_update) {
+            NoteInteraction();
             UpdatePipeStatus(pipe_status);
             while (!teakra.SendDataIsEmpty(2))
                 RunTeakraSlice();
@@ -287,6 +389,7 @@ struct DspLle::Impl final {
             need_update = true;
         }
         if (need_update) {
+            NoteInteraction();
             UpdatePipeStatus(pipe_status);
             while (!teakra.SendDataIsEmpty(2))
                 RunTeakraSlice();
@@ -326,10 +429,12 @@ struct DspLle::Impl final {
 
         // TODO: load special segment
 
+        scheduled_slice = TeakraSlice;
         core_timing.ScheduleEvent(TeakraSlice, teakra_slice_event, 0);
 
         if (multithread) {
             teakra_thread = std::thread(&Impl::TeakraThread, this);
+            PostSlice(TeakraSlice);
         }
 
         // Wait for initialization
@@ -377,6 +482,7 @@ struct DspLle::Impl final {
 };
 
 u16 DspLle::RecvData(u32 register_number) {
+    impl->NoteInteraction();
     while (!impl->teakra.RecvDataIsReady(register_number)) {
         impl->RunTeakraSlice();
     }
@@ -388,6 +494,7 @@ bool DspLle::RecvDataIsReady(u32 register_number) const {
 }
 
 void DspLle::SetSemaphore(u16 semaphore_value) {
+    impl->NoteInteraction();
     impl->teakra.SetSemaphore(semaphore_value);
 }
 
@@ -413,12 +520,14 @@ void DspLle::SetInterruptHandler(
         if (!impl->loaded) {
             return;
         }
+        impl->NoteInteraction();
         handler(Service::DSP::InterruptType::Zero, static_cast<DspPipe>(0));
     });
     impl->teakra.SetRecvDataHandler(1, [this, handler]() {
         if (!impl->loaded) {
             return;
         }
+        impl->NoteInteraction();
         handler(Service::DSP::InterruptType::One, static_cast<DspPipe>(0));
     });
 
@@ -426,6 +535,7 @@ void DspLle::SetInterruptHandler(
         if (!impl->loaded)
             return;
 
+        impl->NoteInteraction();
         auto& teakra = impl->teakra;
         if (event_from_data) {
             impl->data_signaled = true;
@@ -464,6 +574,10 @@ void DspLle::UnloadComponent() {
     impl->UnloadComponent();
 }
 
+double DspLle::GetCyclesPerSecond() const {
+    return impl->cycles_per_second.load(std::memory_order_relaxed);
+}
+
 DspLle::DspLle(Core::System& system, bool multithread)
     : DspLle(system, system.Memory(), system.CoreTiming(), multithread) {}
 
@@ -39,6 +39,9 @@ public:
     void LoadComponent(const std::span<const u8> buffer) override;
     void UnloadComponent() override;
 
+    /// Returns the rate at which DSP cycles were emulated over the last second of wall time.
+    double GetCyclesPerSecond() const;
+
 private:
     struct Impl;
     std::unique_ptr<Impl> impl;
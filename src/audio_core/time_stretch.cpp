@@ -31,6 +31,10 @@ void TimeStretcher::SetOutputSampleRate(unsigned int sample_rate) {
     sound_touch->setSampleRate(sample_rate);
 }
 
+void TimeStretcher::SetTargetBacklog(std::size_t num_frames) {
+    target_backlog = num_frames;
+}
+
 std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
                                    std::size_t num_out) {
     const double time_delta = static_cast<double>(num_out) / native_sample_rate; // seconds
@@ -44,11 +48,15 @@ std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
         num_in = 0;
     }
 
-    // We ideally want the backlog to be about 50% full.
+    // We ideally want the backlog to be about 50% full, or at the target set by the caller.
     // This gives some headroom both ways to prevent underflow and overflow.
     // We tweak current_ratio to encourage this.
+    const double target_fullness =
+        target_backlog == 0 ? 0.5
+                            : std::min(static_cast<double>(target_backlog) / max_backlog, 0.5);
     constexpr double tweak_time_scale = 0.050; // seconds
-    const double tweak_correction = (backlog_fullness - 0.5) * (time_delta / tweak_time_scale);
+    const double tweak_correction =
+        (backlog_fullness - target_fullness) * (time_delta / tweak_time_scale);
     current_ratio *= std::pow(1.0 + 2.0 * tweak_correction, tweak_correction < 0 ? 3.0 : 1.0);
 
     // This low-pass filter smoothes out variance in the calculated stretch ratio.
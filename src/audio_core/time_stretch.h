@@ -22,6 +22,9 @@ public:
 
     void SetOutputSampleRate(unsigned int sample_rate);
 
+    /// Sets the number of frames the backlog is steered towards, zero selects the default.
+    void SetTargetBacklog(std::size_t num_frames);
+
     /// @param in       Input sample buffer
     /// @param num_in   Number of input frames in `in`
     /// @param out      Output sample buffer
@@ -36,6 +39,7 @@ public:
 private:
     std::unique_ptr<soundtouch::SoundTouch> sound_touch;
     double stretch_ratio = 1.0;
+    std::size_t target_backlog = 0;
 };
 
 } // namespace AudioCore
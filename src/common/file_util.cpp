@@ -315,6 +315,38 @@ bool Rename(const std::string& srcFilename, const std::string& destFilename) {
     return false;
 }
 
+bool Replace(const std::string& srcFilename, const std::string& destFilename) {
+    LOG_TRACE(Common_Filesystem, "{} --> {}", srcFilename, destFilename);
+#ifdef _WIN32
+    if (MoveFileExW(Common::UTF8ToUTF16W(srcFilename).c_str(),
+                    Common::UTF8ToUTF16W(destFilename).c_str(),
+                    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        return true;
+#elif ANDROID
+    // Storage access framework renames can't overwrite, so keep the old file around until the
+    // new one is in place.
+    if (!Exists(destFilename)) {
+        return Rename(srcFilename, destFilename);
+    }
+    const std::string backup = destFilename + ".bak";
+    Delete(backup);
+    if (Rename(destFilename, backup)) {
+        if (Rename(srcFilename, destFilename)) {
+            Delete(backup);
+            return true;
+        }
+        Rename(backup, destFilename);
+    }
+#else
+    // rename() atomically replaces the destination
+    if (rename(srcFilename.c_str(), destFilename.c_str()) == 0)
+        return true;
+#endif
+    LOG_ERROR(Common_Filesystem, "failed {} --> {}: {}", srcFilename, destFilename,
+              GetLastErrorMsg());
+    return false;
+}
+
 bool Copy(const std::string& srcFilename, const std::string& destFilename) {
     LOG_TRACE(Common_Filesystem, "{} --> {}", srcFilename, destFilename);
 #ifdef _WIN32
@@ -121,6 +121,10 @@ bool DeleteDir(const std::string& filename);
 // renames file srcFilename to destFilename, returns true on success
 bool Rename(const std::string& srcFilename, const std::string& destFilename);
 
+// renames file srcFilename to destFilename, replacing destFilename if it exists. Where the
+// platform allows it, there is no point at which neither file exists. Returns true on success
+bool Replace(const std::string& srcFilename, const std::string& destFilename);
+
 // copies file srcFilename to destFilename, returns true on success
 bool Copy(const std::string& srcFilename, const std::string& destFilename);
 
@@ -0,0 +1,197 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+// windows.h needs to be included before other windows headers
+#include <io.h>
+#include <psapi.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "common/alignment.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/mapped_file.h"
+
+namespace Common {
+
+MappedFile::MappedFile(const FileUtil::IOFile& file) {
+    const int fd = file.GetFd();
+    if (fd == -1) {
+        return;
+    }
+
+#ifdef _WIN32
+    const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    LARGE_INTEGER file_size;
+    if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &file_size) ||
+        file_size.QuadPart == 0) {
+        return;
+    }
+    const HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        LOG_WARNING(Common_Filesystem, "CreateFileMapping failed with error {}", GetLastError());
+        return;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // The view keeps the mapping object alive.
+    CloseHandle(mapping);
+    if (view == nullptr) {
+        LOG_WARNING(Common_Filesystem, "MapViewOfFile failed with error {}", GetLastError());
+        return;
+    }
+    data = static_cast<const u8*>(view);
+    size = static_cast<std::size_t>(file_size.QuadPart);
+#else
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_size == 0) {
+        return;
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(file_stat.st_size), PROT_READ, MAP_SHARED,
+                      fd, 0);
+    if (view == MAP_FAILED) {
+        LOG_WARNING(Common_Filesystem, "mmap failed with errno {}", errno);
+        return;
+    }
+    data = static_cast<const u8*>(view);
+    size = static_cast<std::size_t>(file_stat.st_size);
+#endif
+}
+
+MappedFile::~MappedFile() {
+    Unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data{std::exchange(other.data, nullptr)}, size{std::exchange(other.size, 0)} {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Unmap();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+    }
+    return *this;
+}
+
+std::span<const u8> MappedFile::Subspan(std::size_t offset, std::size_t length) const {
+    if (offset >= size) {
+        return {};
+    }
+    return {data + offset, std::min(length, size - offset)};
+}
+
+bool MappedFile::IsStale(const FileUtil::IOFile& file) const {
+    const int fd = file.GetFd();
+    return fd == -1 || FileUtil::GetSize(fd) != size;
+}
+
+bool MappedFile::IsResident(std::size_t offset, std::size_t length) const {
+    const auto range = Subspan(offset, length);
+    if (range.empty()) {
+        return false;
+    }
+#ifdef _WIN32
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    const std::size_t page_size = system_info.dwPageSize;
+#else
+    static const std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    const auto start = Common::AlignDown<uintptr_t>(reinterpret_cast<uintptr_t>(range.data()),
+                                                    page_size);
+    const auto end = reinterpret_cast<uintptr_t>(range.data()) + range.size();
+
+    // Query the pages in batches, large ranges are not expected here.
+    constexpr std::size_t batch_pages = 64;
+    for (uintptr_t batch = start; batch < end; batch += batch_pages * page_size) {
+        const std::size_t num_pages =
+            std::min<std::size_t>(batch_pages, (end - batch + page_size - 1) / page_size);
+#ifdef _WIN32
+        std::array<PSAPI_WORKING_SET_EX_INFORMATION, batch_pages> pages;
+        for (std::size_t i = 0; i < num_pages; i++) {
+            pages[i].VirtualAddress = reinterpret_cast<void*>(batch + i * page_size);
+        }
+        if (!QueryWorkingSetEx(GetCurrentProcess(), pages.data(),
+                               static_cast<DWORD>(num_pages * sizeof(pages[0])))) {
+            return false;
+        }
+        for (std::size_t i = 0; i < num_pages; i++) {
+            if (!pages[i].VirtualAttributes.Valid) {
+                return false;
+            }
+        }
+#else
+#ifdef __APPLE__
+        std::array<char, batch_pages> pages;
+#else
+        std::array<unsigned char, batch_pages> pages;
+#endif
+        if (mincore(reinterpret_cast<void*>(batch), num_pages * page_size, pages.data()) != 0) {
+            return false;
+        }
+        for (std::size_t i = 0; i < num_pages; i++) {
+            if ((pages[i] & 1) == 0) {
+                return false;
+            }
+        }
+#endif
+    }
+    return true;
+}
+
+void MappedFile::Advise(std::size_t offset, std::size_t length, AccessHint hint) const {
+    const auto range = Subspan(offset, length);
+    if (range.empty()) {
+        return;
+    }
+#ifdef _WIN32
+    if (hint == AccessHint::WillNeed) {
+        WIN32_MEMORY_RANGE_ENTRY entry{const_cast<u8*>(range.data()), range.size()};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+    }
+#else
+    // madvise wants a page aligned start address.
+    static const std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const auto start = reinterpret_cast<uintptr_t>(range.data());
+    const auto aligned_start = Common::AlignDown<uintptr_t>(start, page_size);
+    const std::size_t aligned_length = range.size() + (start - aligned_start);
+    int advice = MADV_NORMAL;
+    switch (hint) {
+    case AccessHint::Normal:
+        advice = MADV_NORMAL;
+        break;
+    case AccessHint::Sequential:
+        advice = MADV_SEQUENTIAL;
+        break;
+    case AccessHint::WillNeed:
+        advice = MADV_WILLNEED;
+        break;
+    }
+    madvise(reinterpret_cast<void*>(aligned_start), aligned_length, advice);
+#endif
+}
+
+void MappedFile::Unmap() {
+    if (data == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<u8*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+} // namespace Common
@@ -0,0 +1,78 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <span>
+#include "common/common_types.h"
+
+namespace FileUtil {
+class IOFile;
+}
+
+namespace Common {
+
+/**
+ * A read only memory mapping of a whole file. Reads become plain memory accesses served
+ * straight from the page cache, without a syscall or an intermediate copy.
+ */
+class MappedFile {
+public:
+    enum class AccessHint {
+        Normal,     ///< No particular access pattern
+        Sequential, ///< Pages are read in ascending order and are unlikely to be read again
+        WillNeed,   ///< Pages are about to be read, start fetching them
+    };
+
+    MappedFile() = default;
+
+    /// Maps the file opened by the provided handle. Check IsOpen for success.
+    explicit MappedFile(const FileUtil::IOFile& file);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] bool IsOpen() const {
+        return data != nullptr;
+    }
+
+    [[nodiscard]] std::span<const u8> Span() const {
+        return {data, size};
+    }
+
+    [[nodiscard]] std::size_t Size() const {
+        return size;
+    }
+
+    /// Returns the bytes in [offset, offset + length), clamped to the end of the file.
+    [[nodiscard]] std::span<const u8> Subspan(std::size_t offset, std::size_t length) const;
+
+    /**
+     * Returns true when the file no longer has the size it had when it was mapped. Touching pages
+     * past the new end of a truncated file raises SIGBUS, so the mapping must not be read then.
+     */
+    [[nodiscard]] bool IsStale(const FileUtil::IOFile& file) const;
+
+    /**
+     * Returns true when every page of [offset, offset + length) is in memory, so reading it does
+     * not wait for the disk. Only a snapshot, the pages may be evicted right after.
+     */
+    [[nodiscard]] bool IsResident(std::size_t offset, std::size_t length) const;
+
+    /// Tells the kernel how a range of the file is going to be accessed. Only a hint.
+    void Advise(std::size_t offset, std::size_t length, AccessHint hint) const;
+
+private:
+    void Unmap();
+
+    const u8* data = nullptr;
+    std::size_t size = 0;
+};
+
+} // namespace Common
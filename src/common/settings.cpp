@@ -83,6 +83,10 @@ void LogSettings() {
     LOG_INFO(Config, "Cytrus Configuration:");
     log_setting("Core_UseCpuJit", values.use_cpu_jit.GetValue());
     log_setting("Core_CPUClockPercentage", values.cpu_clock_percentage.GetValue());
+    log_setting("Core_ParallelCPUCores", values.parallel_cpu_cores.GetValue());
+    log_setting("Core_DeterministicCPUCores", values.deterministic_cpu_cores.GetValue());
+    log_setting("Core_AsyncSaveStates", values.async_savestates.GetValue());
+    log_setting("Core_DeltaSaveStates", values.delta_savestates.GetValue());
     log_setting("Renderer_UseGLES", values.use_gles.GetValue());
     log_setting("Renderer_GraphicsAPI", GetGraphicsAPIName(values.graphics_api.GetValue()));
     log_setting("Renderer_AsyncShaders", values.async_shader_compilation.GetValue());
@@ -92,6 +96,9 @@ void LogSettings() {
     log_setting("Renderer_UseHwShader", values.use_hw_shader.GetValue());
     log_setting("Renderer_ShadersAccurateMul", values.shaders_accurate_mul.GetValue());
     log_setting("Renderer_UseShaderJit", values.use_shader_jit.GetValue());
+    log_setting("Renderer_AsyncShaderJit", values.async_shader_jit.GetValue());
+    log_setting("Renderer_ParallelVertexShading", values.parallel_vertex_shading.GetValue());
+    log_setting("Renderer_AsyncGPU", values.async_gpu.GetValue());
     log_setting("Renderer_UseResolutionFactor", values.resolution_factor.GetValue());
     log_setting("Renderer_FrameLimit", values.frame_limit.GetValue());
     log_setting("Renderer_VSyncNew", values.use_vsync_new.GetValue());
@@ -121,6 +128,7 @@ void LogSettings() {
     log_setting("Audio_InputType", values.input_type.GetValue());
     log_setting("Audio_InputDevice", values.input_device.GetValue());
     log_setting("Audio_EnableAudioStretching", values.enable_audio_stretching.GetValue());
+    log_setting("Audio_ParallelHleAudio", values.parallel_hle_audio.GetValue());
     using namespace Service::CAM;
     log_setting("Camera_OuterRightName", values.camera_name[OuterRightCamera]);
     log_setting("Camera_OuterRightConfig", values.camera_config[OuterRightCamera]);
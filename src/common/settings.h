@@ -431,6 +431,10 @@ struct Values {
     // Core
     Setting<bool> use_cpu_jit{true, "use_cpu_jit"};
     SwitchableSetting<s32, true> cpu_clock_percentage{100, 5, 400, "cpu_clock_percentage"};
+    Setting<bool> parallel_cpu_cores{false, "parallel_cpu_cores"};
+    Setting<bool> deterministic_cpu_cores{true, "deterministic_cpu_cores"};
+    Setting<bool> async_savestates{false, "async_savestates"};
+    Setting<bool> delta_savestates{false, "delta_savestates"};
     SwitchableSetting<bool> is_new_3ds{true, "is_new_3ds"};
     SwitchableSetting<bool> lle_applets{false, "lle_applets"};
 
@@ -473,6 +477,9 @@ struct Values {
     SwitchableSetting<bool> shaders_accurate_mul{true, "shaders_accurate_mul"};
     SwitchableSetting<bool> use_vsync_new{true, "use_vsync_new"};
     Setting<bool> use_shader_jit{true, "use_shader_jit"};
+    Setting<bool> async_shader_jit{false, "async_shader_jit"};
+    Setting<bool> parallel_vertex_shading{false, "parallel_vertex_shading"};
+    Setting<bool> async_gpu{false, "async_gpu"};
     SwitchableSetting<u32, true> resolution_factor{1, 0, 10, "resolution_factor"};
     SwitchableSetting<u16, true> frame_limit{100, 0, 1000, "frame_limit"};
     SwitchableSetting<TextureFilter> texture_filter{TextureFilter::None, "texture_filter"};
@@ -521,6 +528,7 @@ struct Values {
     bool audio_muted;
     SwitchableSetting<AudioEmulation> audio_emulation{AudioEmulation::HLE, "audio_emulation"};
     SwitchableSetting<bool> enable_audio_stretching{true, "enable_audio_stretching"};
+    Setting<bool> parallel_hle_audio{false, "parallel_hle_audio"};
     SwitchableSetting<float, true> volume{1.f, 0.f, 1.f, "volume"};
     Setting<AudioCore::SinkType> output_type{AudioCore::SinkType::Auto, "output_type"};
     Setting<std::string> output_device{"auto", "output_device"};
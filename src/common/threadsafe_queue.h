@@ -186,4 +186,70 @@ private:
     SPSCQueue<T, with_stop_token> spsc_queue;
     std::mutex write_lock;
 };
+
+// a lock-free thread-safe,
+// single reader, multiple writer queue.
+// Writers never block, the reader takes all queued elements at once.
+
+template <typename T>
+class LockFreeMPSCQueue {
+public:
+    LockFreeMPSCQueue() = default;
+    ~LockFreeMPSCQueue() {
+        Clear();
+    }
+
+    LockFreeMPSCQueue(const LockFreeMPSCQueue&) = delete;
+    LockFreeMPSCQueue& operator=(const LockFreeMPSCQueue&) = delete;
+
+    [[nodiscard]] bool Empty() const {
+        return head.load(std::memory_order_acquire) == nullptr;
+    }
+
+    template <typename Arg>
+    void Push(Arg&& t) {
+        Node* node = new Node{std::forward<Arg>(t), head.load(std::memory_order_relaxed)};
+        while (!head.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+        }
+    }
+
+    // Pops every queued element in push order, calling func on each of them.
+    template <typename Func>
+    void PopAll(Func&& func) {
+        Node* node = head.exchange(nullptr, std::memory_order_acquire);
+        // The elements are linked newest first, reverse them to keep the push order.
+        Node* oldest = nullptr;
+        while (node != nullptr) {
+            Node* next = node->next;
+            node->next = oldest;
+            oldest = node;
+            node = next;
+        }
+        while (oldest != nullptr) {
+            Node* next = oldest->next;
+            func(std::move(oldest->value));
+            delete oldest;
+            oldest = next;
+        }
+    }
+
+    // not thread-safe
+    void Clear() {
+        Node* node = head.exchange(nullptr);
+        while (node != nullptr) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head{nullptr};
+};
 } // namespace Common
@@ -0,0 +1,420 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include "common/arch.h"
+#include "common/swap.h"
+#include "common/xxh3.h"
+
+#if CYTRUS_ARCH(x86_64)
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+#elif CYTRUS_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define XXH3_TARGET(isa) __attribute__((target(isa)))
+#else
+#define XXH3_TARGET(isa)
+#endif
+
+namespace Common {
+
+namespace {
+
+constexpr u64 PRIME32_1 = 0x9E3779B1U;
+constexpr u64 PRIME32_2 = 0x85EBCA77U;
+constexpr u64 PRIME32_3 = 0xC2B2AE3DU;
+constexpr u64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr u64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr u64 PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr u64 PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr u64 PRIME64_5 = 0x27D4EB2F165667C5ULL;
+constexpr u64 PRIME_MX1 = 0x165667919E3779F9ULL;
+constexpr u64 PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+constexpr std::size_t STRIPE_LEN = 64;
+constexpr std::size_t SECRET_CONSUME_RATE = 8;
+constexpr std::size_t SECRET_SIZE = 192;
+constexpr std::size_t SECRET_SIZE_MIN = 136;
+constexpr std::size_t SECRET_MERGEACCS_START = 11;
+constexpr std::size_t SECRET_LASTACC_START = 7;
+constexpr std::size_t MIDSIZE_MAX = 240;
+constexpr std::size_t MIDSIZE_STARTOFFSET = 3;
+constexpr std::size_t MIDSIZE_LASTOFFSET = 17;
+constexpr std::size_t STRIPES_PER_BLOCK = (SECRET_SIZE - STRIPE_LEN) / SECRET_CONSUME_RATE;
+constexpr std::size_t BLOCK_LEN = STRIPE_LEN * STRIPES_PER_BLOCK;
+
+alignas(64) constexpr std::array<u8, SECRET_SIZE> DEFAULT_SECRET = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+using Accumulators = std::array<u64, 8>;
+
+/// Accumulates a 64 byte stripe of input keyed with secret into acc.
+using AccumulateFunc = void (*)(Accumulators& acc, const u8* input, const u8* secret);
+
+/// Scrambles the accumulators at the end of each block.
+using ScrambleFunc = void (*)(Accumulators& acc, const u8* secret);
+
+u32 Read32(const u8* ptr) {
+    u32 value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+u64 Read64(const u8* ptr) {
+    u64 value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+u64 Multiply128Fold64(u64 lhs, u64 rhs) {
+#if defined(_MSC_VER) && CYTRUS_ARCH(x86_64)
+    u64 high;
+    const u64 low = _umul128(lhs, rhs, &high);
+    return low ^ high;
+#elif defined(_MSC_VER) && CYTRUS_ARCH(arm64)
+    return (lhs * rhs) ^ __umulh(lhs, rhs);
+#else
+    const unsigned __int128 product = static_cast<unsigned __int128>(lhs) * rhs;
+    return static_cast<u64>(product) ^ static_cast<u64>(product >> 64);
+#endif
+}
+
+u64 XXH64Avalanche(u64 hash) {
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    return hash ^ (hash >> 32);
+}
+
+u64 Avalanche(u64 hash) {
+    hash ^= hash >> 37;
+    hash *= PRIME_MX1;
+    return hash ^ (hash >> 32);
+}
+
+u64 RRMXMX(u64 hash, u64 len) {
+    hash ^= std::rotl(hash, 49) ^ std::rotl(hash, 24);
+    hash *= PRIME_MX2;
+    hash ^= (hash >> 35) + len;
+    hash *= PRIME_MX2;
+    return hash ^ (hash >> 28);
+}
+
+u64 Mix16B(const u8* input, const u8* secret) {
+    return Multiply128Fold64(Read64(input) ^ Read64(secret),
+                             Read64(input + 8) ^ Read64(secret + 8));
+}
+
+u64 Hash1To3(const u8* input, std::size_t len, const u8* secret) {
+    const u32 combined = (u32{input[0]} << 16) | (u32{input[len >> 1]} << 24) |
+                         u32{input[len - 1]} | (static_cast<u32>(len) << 8);
+    const u64 bitflip = Read32(secret) ^ Read32(secret + 4);
+    return XXH64Avalanche(combined ^ bitflip);
+}
+
+u64 Hash4To8(const u8* input, std::size_t len, const u8* secret) {
+    const u64 input_low = Read32(input + len - 4);
+    const u64 input_high = Read32(input);
+    const u64 bitflip = Read64(secret + 8) ^ Read64(secret + 16);
+    return RRMXMX((input_low + (input_high << 32)) ^ bitflip, len);
+}
+
+u64 Hash9To16(const u8* input, std::size_t len, const u8* secret) {
+    const u64 bitflip_low = Read64(secret + 24) ^ Read64(secret + 32);
+    const u64 bitflip_high = Read64(secret + 40) ^ Read64(secret + 48);
+    const u64 input_low = Read64(input) ^ bitflip_low;
+    const u64 input_high = Read64(input + len - 8) ^ bitflip_high;
+    const u64 acc =
+        len + swap64(input_low) + input_high + Multiply128Fold64(input_low, input_high);
+    return Avalanche(acc);
+}
+
+u64 Hash17To128(const u8* input, std::size_t len, const u8* secret) {
+    u64 acc = len * PRIME64_1;
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc += Mix16B(input + 48, secret + 96);
+                acc += Mix16B(input + len - 64, secret + 112);
+            }
+            acc += Mix16B(input + 32, secret + 64);
+            acc += Mix16B(input + len - 48, secret + 80);
+        }
+        acc += Mix16B(input + 16, secret + 32);
+        acc += Mix16B(input + len - 32, secret + 48);
+    }
+    acc += Mix16B(input, secret);
+    acc += Mix16B(input + len - 16, secret + 16);
+    return Avalanche(acc);
+}
+
+u64 Hash129To240(const u8* input, std::size_t len, const u8* secret) {
+    const std::size_t num_rounds = len / 16;
+    u64 acc = len * PRIME64_1;
+    for (std::size_t i = 0; i < 8; i++) {
+        acc += Mix16B(input + 16 * i, secret + 16 * i);
+    }
+    acc = Avalanche(acc);
+    for (std::size_t i = 8; i < num_rounds; i++) {
+        acc += Mix16B(input + 16 * i, secret + 16 * (i - 8) + MIDSIZE_STARTOFFSET);
+    }
+    acc += Mix16B(input + len - 16, secret + SECRET_SIZE_MIN - MIDSIZE_LASTOFFSET);
+    return Avalanche(acc);
+}
+
+void AccumulateScalar(Accumulators& acc, const u8* input, const u8* secret) {
+    for (std::size_t i = 0; i < acc.size(); i++) {
+        const u64 data = Read64(input + 8 * i);
+        const u64 data_key = data ^ Read64(secret + 8 * i);
+        acc[i ^ 1] += data;
+        acc[i] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+    }
+}
+
+void ScrambleScalar(Accumulators& acc, const u8* secret) {
+    for (std::size_t i = 0; i < acc.size(); i++) {
+        u64 value = acc[i];
+        value ^= value >> 47;
+        value ^= Read64(secret + 8 * i);
+        acc[i] = value * PRIME32_1;
+    }
+}
+
+#if CYTRUS_ARCH(x86_64)
+
+void AccumulateSse2(Accumulators& acc, const u8* input, const u8* secret) {
+    auto* const acc_vec = reinterpret_cast<__m128i*>(acc.data());
+    for (std::size_t i = 0; i < 4; i++) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input) + i);
+        const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+        const __m128i data_key = _mm_xor_si128(data, key);
+        const __m128i data_key_high = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+        const __m128i product = _mm_mul_epu32(data_key, data_key_high);
+        const __m128i data_swap = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+        const __m128i sum = _mm_add_epi64(_mm_loadu_si128(acc_vec + i), data_swap);
+        _mm_storeu_si128(acc_vec + i, _mm_add_epi64(product, sum));
+    }
+}
+
+void ScrambleSse2(Accumulators& acc, const u8* secret) {
+    auto* const acc_vec = reinterpret_cast<__m128i*>(acc.data());
+    const __m128i prime = _mm_set1_epi32(static_cast<s32>(PRIME32_1));
+    for (std::size_t i = 0; i < 4; i++) {
+        __m128i value = _mm_loadu_si128(acc_vec + i);
+        value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+        const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+        const __m128i data_key = _mm_xor_si128(value, key);
+        const __m128i data_key_high = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+        const __m128i product_low = _mm_mul_epu32(data_key, prime);
+        const __m128i product_high = _mm_mul_epu32(data_key_high, prime);
+        _mm_storeu_si128(acc_vec + i,
+                         _mm_add_epi64(product_low, _mm_slli_epi64(product_high, 32)));
+    }
+}
+
+XXH3_TARGET("avx2")
+void AccumulateAvx2(Accumulators& acc, const u8* input, const u8* secret) {
+    auto* const acc_vec = reinterpret_cast<__m256i*>(acc.data());
+    for (std::size_t i = 0; i < 2; i++) {
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input) + i);
+        const __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i);
+        const __m256i data_key = _mm256_xor_si256(data, key);
+        const __m256i data_key_high = _mm256_srli_epi64(data_key, 32);
+        const __m256i product = _mm256_mul_epu32(data_key, data_key_high);
+        const __m256i data_swap = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+        const __m256i sum = _mm256_add_epi64(_mm256_loadu_si256(acc_vec + i), data_swap);
+        _mm256_storeu_si256(acc_vec + i, _mm256_add_epi64(product, sum));
+    }
+}
+
+XXH3_TARGET("avx2")
+void ScrambleAvx2(Accumulators& acc, const u8* secret) {
+    auto* const acc_vec = reinterpret_cast<__m256i*>(acc.data());
+    const __m256i prime = _mm256_set1_epi32(static_cast<s32>(PRIME32_1));
+    for (std::size_t i = 0; i < 2; i++) {
+        __m256i value = _mm256_loadu_si256(acc_vec + i);
+        value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 47));
+        const __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i);
+        const __m256i data_key = _mm256_xor_si256(value, key);
+        const __m256i data_key_high = _mm256_srli_epi64(data_key, 32);
+        const __m256i product_low = _mm256_mul_epu32(data_key, prime);
+        const __m256i product_high = _mm256_mul_epu32(data_key_high, prime);
+        _mm256_storeu_si256(acc_vec + i,
+                            _mm256_add_epi64(product_low, _mm256_slli_epi64(product_high, 32)));
+    }
+}
+
+#elif CYTRUS_ARCH(arm64)
+
+void AccumulateNeon(Accumulators& acc, const u8* input, const u8* secret) {
+    for (std::size_t i = 0; i < 4; i++) {
+        const uint64x2_t data = vreinterpretq_u64_u8(vld1q_u8(input + 16 * i));
+        const uint64x2_t key = vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i));
+        const uint64x2_t data_key = veorq_u64(data, key);
+        const uint64x2_t data_swap = vextq_u64(data, data, 1);
+        uint64x2_t sum = vaddq_u64(vld1q_u64(acc.data() + 2 * i), data_swap);
+        sum = vmlal_u32(sum, vmovn_u64(data_key), vshrn_n_u64(data_key, 32));
+        vst1q_u64(acc.data() + 2 * i, sum);
+    }
+}
+
+void ScrambleNeon(Accumulators& acc, const u8* secret) {
+    const uint32x2_t prime = vdup_n_u32(static_cast<u32>(PRIME32_1));
+    for (std::size_t i = 0; i < 4; i++) {
+        uint64x2_t value = vld1q_u64(acc.data() + 2 * i);
+        value = veorq_u64(value, vshrq_n_u64(value, 47));
+        const uint64x2_t key = vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i));
+        const uint64x2_t data_key = veorq_u64(value, key);
+        const uint64x2_t product_high =
+            vshlq_n_u64(vmull_u32(vshrn_n_u64(data_key, 32), prime), 32);
+        vst1q_u64(acc.data() + 2 * i, vmlal_u32(product_high, vmovn_u64(data_key), prime));
+    }
+}
+
+#endif
+
+struct LongKernels {
+    AccumulateFunc accumulate;
+    ScrambleFunc scramble;
+};
+
+LongKernels GetLongKernels(XXH3Kernel kernel) {
+    switch (kernel) {
+#if CYTRUS_ARCH(x86_64)
+    case XXH3Kernel::SSE2:
+        return {AccumulateSse2, ScrambleSse2};
+    case XXH3Kernel::AVX2:
+        return {AccumulateAvx2, ScrambleAvx2};
+#elif CYTRUS_ARCH(arm64)
+    case XXH3Kernel::NEON:
+        return {AccumulateNeon, ScrambleNeon};
+#endif
+    default:
+        return {AccumulateScalar, ScrambleScalar};
+    }
+}
+
+LongKernels SelectLongKernels() {
+#if CYTRUS_ARCH(x86_64)
+    if (GetCPUCaps().avx2) {
+        return GetLongKernels(XXH3Kernel::AVX2);
+    }
+    return GetLongKernels(XXH3Kernel::SSE2);
+#elif CYTRUS_ARCH(arm64)
+    return GetLongKernels(XXH3Kernel::NEON);
+#else
+    return GetLongKernels(XXH3Kernel::Scalar);
+#endif
+}
+
+u64 MergeAccumulators(const Accumulators& acc, const u8* secret, u64 start) {
+    u64 result = start;
+    for (std::size_t i = 0; i < 4; i++) {
+        result += Multiply128Fold64(acc[2 * i] ^ Read64(secret + 16 * i),
+                                    acc[2 * i + 1] ^ Read64(secret + 16 * i + 8));
+    }
+    return Avalanche(result);
+}
+
+template <typename Accumulate, typename Scramble>
+u64 HashLong(const u8* input, std::size_t len, const u8* secret, Accumulate&& accumulate,
+             Scramble&& scramble) {
+    Accumulators acc = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+                        PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+    const auto accumulate_stripes = [&](const u8* block, std::size_t num_stripes) {
+        for (std::size_t n = 0; n < num_stripes; n++) {
+            accumulate(acc, block + n * STRIPE_LEN, secret + n * SECRET_CONSUME_RATE);
+        }
+    };
+
+    const std::size_t num_blocks = (len - 1) / BLOCK_LEN;
+    for (std::size_t n = 0; n < num_blocks; n++) {
+        accumulate_stripes(input + n * BLOCK_LEN, STRIPES_PER_BLOCK);
+        scramble(acc, secret + SECRET_SIZE - STRIPE_LEN);
+    }
+
+    // The last partial block, followed by the final stripe which may overlap with it
+    const std::size_t num_stripes = ((len - 1) - BLOCK_LEN * num_blocks) / STRIPE_LEN;
+    accumulate_stripes(input + num_blocks * BLOCK_LEN, num_stripes);
+    accumulate(acc, input + len - STRIPE_LEN,
+               secret + SECRET_SIZE - STRIPE_LEN - SECRET_LASTACC_START);
+
+    return MergeAccumulators(acc, secret + SECRET_MERGEACCS_START, len * PRIME64_1);
+}
+
+u64 Hash64(const u8* input, std::size_t len, const LongKernels& kernels) {
+    const u8* secret = DEFAULT_SECRET.data();
+    if (len <= 16) {
+        if (len > 8) {
+            return Hash9To16(input, len, secret);
+        }
+        if (len >= 4) {
+            return Hash4To8(input, len, secret);
+        }
+        if (len > 0) {
+            return Hash1To3(input, len, secret);
+        }
+        return XXH64Avalanche(Read64(secret + 56) ^ Read64(secret + 64));
+    }
+    if (len <= 128) {
+        return Hash17To128(input, len, secret);
+    }
+    if (len <= MIDSIZE_MAX) {
+        return Hash129To240(input, len, secret);
+    }
+    return HashLong(input, len, secret, kernels.accumulate, kernels.scramble);
+}
+
+} // Anonymous namespace
+
+u64 XXH3Hash64(const void* data, std::size_t len) noexcept {
+    static const LongKernels kernels = SelectLongKernels();
+    return Hash64(static_cast<const u8*>(data), len, kernels);
+}
+
+bool IsXXH3KernelSupported(XXH3Kernel kernel) noexcept {
+    switch (kernel) {
+    case XXH3Kernel::Scalar:
+        return true;
+#if CYTRUS_ARCH(x86_64)
+    case XXH3Kernel::SSE2:
+        return true;
+    case XXH3Kernel::AVX2:
+        return GetCPUCaps().avx2;
+#elif CYTRUS_ARCH(arm64)
+    case XXH3Kernel::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+u64 XXH3Hash64(const void* data, std::size_t len, XXH3Kernel kernel) noexcept {
+    return Hash64(static_cast<const u8*>(data), len, GetLongKernels(kernel));
+}
+
+} // namespace Common
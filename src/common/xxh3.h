@@ -0,0 +1,39 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Computes the 64-bit XXH3 hash of the specified block of data, using the default secret and a
+ * seed of zero. The result is identical to XXH3_64bits from the reference implementation, inputs
+ * longer than 240 bytes are processed with the widest vector unit supported by the host CPU.
+ * @param data Block of data to compute hash over
+ * @param len Length of data (in bytes) to compute hash over
+ * @returns 64-bit hash value that was computed over the data block
+ */
+[[nodiscard]] u64 XXH3Hash64(const void* data, std::size_t len) noexcept;
+
+/// Implementations of the XXH3 inner loop used for inputs longer than 240 bytes
+enum class XXH3Kernel {
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON,
+};
+
+/// Returns true if the kernel is built for the host architecture and supported by its CPU
+[[nodiscard]] bool IsXXH3KernelSupported(XXH3Kernel kernel) noexcept;
+
+/**
+ * Computes the same hash as XXH3Hash64, processing long inputs with the specified kernel instead
+ * of the widest one available. Meant for testing, the kernel must be supported.
+ */
+[[nodiscard]] u64 XXH3Hash64(const void* data, std::size_t len, XXH3Kernel kernel) noexcept;
+
+} // namespace Common
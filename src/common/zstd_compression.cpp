@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <bit>
+#include <memory>
 #include <zstd.h>
 
 #include "common/logging/log.h"
@@ -38,6 +40,87 @@ std::vector<u8> CompressDataZSTDDefault(std::span<const u8> source) {
     return CompressDataZSTD(source, ZSTD_CLEVEL_DEFAULT);
 }
 
+std::vector<u8> CompressDataZSTDParallel(std::span<const u8> source, s32 compression_level,
+                                         u32 num_workers, std::span<const u8> prefix) {
+    compression_level = std::clamp(compression_level, ZSTD_minCLevel(), ZSTD_maxCLevel());
+
+    const std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx{ZSTD_createCCtx(),
+                                                                    ZSTD_freeCCtx};
+    if (!cctx) {
+        LOG_ERROR(Common, "Could not create ZSTD compression context");
+        return {};
+    }
+    ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_compressionLevel, compression_level);
+    if (num_workers > 1) {
+        const std::size_t result =
+            ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_nbWorkers, static_cast<int>(num_workers));
+        if (ZSTD_isError(result)) {
+            LOG_DEBUG(Common, "ZSTD multithreading unavailable: {}", ZSTD_getErrorName(result));
+        }
+    }
+    if (!prefix.empty()) {
+        // Same as `zstd --patch-from`: the window must reach back over the whole prefix, and long
+        // distance matching is what finds the unchanged regions in it.
+        const ZSTD_bounds bounds = ZSTD_cParam_getBounds(ZSTD_c_windowLog);
+        const int window_log =
+            std::clamp(static_cast<int>(std::bit_width(prefix.size() + source.size())),
+                       bounds.lowerBound, bounds.upperBound);
+        ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_windowLog, window_log);
+        ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_enableLongDistanceMatching, 1);
+        ZSTD_CCtx_refPrefix(cctx.get(), prefix.data(), prefix.size());
+    }
+
+    std::vector<u8> compressed(ZSTD_compressBound(source.size()));
+    const std::size_t compressed_size = ZSTD_compress2(cctx.get(), compressed.data(),
+                                                       compressed.size(), source.data(),
+                                                       source.size());
+    if (ZSTD_isError(compressed_size)) {
+        LOG_ERROR(Common, "Error compressing ZSTD data: {} ({})",
+                  ZSTD_getErrorName(compressed_size), compressed_size);
+        return {};
+    }
+
+    compressed.resize(compressed_size);
+    return compressed;
+}
+
+std::vector<u8> DecompressDataZSTD(std::span<const u8> compressed, std::span<const u8> prefix) {
+    const std::size_t decompressed_size =
+        ZSTD_getFrameContentSize(compressed.data(), compressed.size());
+    if (decompressed_size == ZSTD_CONTENTSIZE_UNKNOWN ||
+        decompressed_size == ZSTD_CONTENTSIZE_ERROR) {
+        LOG_ERROR(Common, "ZSTD decompressed size could not be determined.");
+        return {};
+    }
+
+    const std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx{ZSTD_createDCtx(),
+                                                                    ZSTD_freeDCtx};
+    if (!dctx) {
+        LOG_ERROR(Common, "Could not create ZSTD decompression context");
+        return {};
+    }
+    // Frames compressed against a prefix use windows larger than what is accepted by default.
+    ZSTD_DCtx_setParameter(dctx.get(), ZSTD_d_windowLogMax,
+                           ZSTD_dParam_getBounds(ZSTD_d_windowLogMax).upperBound);
+    ZSTD_DCtx_refPrefix(dctx.get(), prefix.data(), prefix.size());
+
+    std::vector<u8> decompressed(decompressed_size);
+    const std::size_t result = ZSTD_decompressDCtx(
+        dctx.get(), decompressed.data(), decompressed.size(), compressed.data(), compressed.size());
+    if (ZSTD_isError(result)) {
+        LOG_ERROR(Common, "Error decompressing ZSTD data: {} ({})", ZSTD_getErrorName(result),
+                  result);
+        return {};
+    }
+    if (result != decompressed_size) {
+        LOG_ERROR(Common, "ZSTD decompression expected {} bytes, got {}", decompressed_size,
+                  result);
+        return {};
+    }
+
+    return decompressed;
+}
+
 std::vector<u8> DecompressDataZSTD(std::span<const u8> compressed) {
     const std::size_t decompressed_size =
         ZSTD_getFrameContentSize(compressed.data(), compressed.size());
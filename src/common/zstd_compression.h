@@ -31,6 +31,23 @@ namespace Common::Compression {
  */
 [[nodiscard]] std::vector<u8> CompressDataZSTDDefault(std::span<const u8> source);
 
+/**
+ * Compresses a source memory region with Zstandard on several worker threads and returns the
+ * compressed data in a vector. Falls back to a single thread if Zstandard was built without
+ * multithreading support.
+ *
+ * @param source the uncompressed source memory region.
+ * @param compression_level the used compression level. Should be between 1 and 22.
+ * @param num_workers the number of worker threads to compress with.
+ * @param prefix optional data the source is compressed as a delta against. The same prefix must be
+ * provided to decompress the data.
+ *
+ * @return the compressed data.
+ */
+[[nodiscard]] std::vector<u8> CompressDataZSTDParallel(std::span<const u8> source,
+                                                       s32 compression_level, u32 num_workers,
+                                                       std::span<const u8> prefix = {});
+
 /**
  * Decompresses a source memory region with Zstandard and returns the uncompressed data in a vector.
  *
@@ -40,4 +57,16 @@ namespace Common::Compression {
  */
 [[nodiscard]] std::vector<u8> DecompressDataZSTD(std::span<const u8> compressed);
 
+/**
+ * Decompresses a source memory region compressed as a delta against a prefix with Zstandard and
+ * returns the uncompressed data in a vector.
+ *
+ * @param compressed the compressed source memory region.
+ * @param prefix the prefix the data was compressed against.
+ *
+ * @return the decompressed data.
+ */
+[[nodiscard]] std::vector<u8> DecompressDataZSTD(std::span<const u8> compressed,
+                                                 std::span<const u8> prefix);
+
 } // namespace Common::Compression
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include <mutex>
 #include <dynarmic/interface/A32/a32.h>
 #include <dynarmic/interface/optimization_flags.h>
 #include "common/assert.h"
@@ -26,41 +27,53 @@ public:
     ~DynarmicUserCallbacks() = default;
 
     std::uint8_t MemoryRead8(VAddr vaddr) override {
+        const auto lock = LockKernel();
         return memory.Read8(vaddr);
     }
     std::uint16_t MemoryRead16(VAddr vaddr) override {
+        const auto lock = LockKernel();
         return memory.Read16(vaddr);
     }
     std::uint32_t MemoryRead32(VAddr vaddr) override {
+        const auto lock = LockKernel();
         return memory.Read32(vaddr);
     }
     std::uint64_t MemoryRead64(VAddr vaddr) override {
+        const auto lock = LockKernel();
         return memory.Read64(vaddr);
     }
 
     void MemoryWrite8(VAddr vaddr, std::uint8_t value) override {
+        const auto lock = LockKernel();
         memory.Write8(vaddr, value);
     }
     void MemoryWrite16(VAddr vaddr, std::uint16_t value) override {
+        const auto lock = LockKernel();
         memory.Write16(vaddr, value);
     }
     void MemoryWrite32(VAddr vaddr, std::uint32_t value) override {
+        const auto lock = LockKernel();
         memory.Write32(vaddr, value);
     }
     void MemoryWrite64(VAddr vaddr, std::uint64_t value) override {
+        const auto lock = LockKernel();
         memory.Write64(vaddr, value);
     }
 
     bool MemoryWriteExclusive8(u32 vaddr, u8 value, u8 expected) override {
+        const auto lock = LockKernel();
         return memory.WriteExclusive8(vaddr, value, expected);
     }
     bool MemoryWriteExclusive16(u32 vaddr, u16 value, u16 expected) override {
+        const auto lock = LockKernel();
         return memory.WriteExclusive16(vaddr, value, expected);
     }
     bool MemoryWriteExclusive32(u32 vaddr, u32 value, u32 expected) override {
+        const auto lock = LockKernel();
         return memory.WriteExclusive32(vaddr, value, expected);
     }
     bool MemoryWriteExclusive64(u32 vaddr, u64 value, u64 expected) override {
+        const auto lock = LockKernel();
         return memory.WriteExclusive64(vaddr, value, expected);
     }
 
@@ -71,6 +84,7 @@ public:
     }
 
     void CallSVC(std::uint32_t swi) override {
+        const auto lock = LockKernel();
         svc_context.CallSVC(swi);
     }
 
@@ -104,6 +118,8 @@ public:
     }
 
     void AddTicks(std::uint64_t ticks) override {
+        // Timers are per core and their events only fire from Advance, between slices, so this
+        // does not take the kernel lock.
         parent.GetTimer().AddTicks(ticks);
     }
     std::uint64_t GetTicksRemaining() override {
@@ -114,6 +130,15 @@ public:
         return Core::TicksForInstruction(is_thumb, instruction);
     }
 
+    /// Cores executing in parallel share the kernel, HLE and MMIO state, so every callback that
+    /// leaves the JIT is serialized while they do.
+    [[nodiscard]] std::unique_lock<std::recursive_mutex> LockKernel() {
+        if (!parent.system.IsRunningCoresInParallel()) {
+            return {};
+        }
+        return parent.system.LockKernel(parent);
+    }
+
     ARM_Dynarmic& parent;
     Kernel::SVCContext svc_context;
     Memory::MemorySystem& memory;
@@ -133,7 +158,10 @@ ARM_Dynarmic::~ARM_Dynarmic() = default;
 MICROPROFILE_DEFINE(ARM_Jit, "ARM JIT", "ARM JIT", MP_RGB(255, 64, 64));
 
 void ARM_Dynarmic::Run() {
-    ASSERT(memory.GetCurrentPageTable() == current_page_table);
+    // The memory system page table only follows the core that last entered the kernel while the
+    // cores execute in parallel.
+    ASSERT(system.IsRunningCoresInParallel() ||
+           memory.GetCurrentPageTable() == current_page_table);
     MICROPROFILE_SCOPE(ARM_Jit);
 
     jit->Run();
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include <stdexcept>
 #include <utility>
 #include <boost/serialization/array.hpp>
@@ -11,6 +12,7 @@
 #include "common/arch.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
+#include "common/thread_worker.h"
 #include "core/arm/arm_interface.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/hle/service/cam/cam.h"
@@ -44,6 +46,7 @@
 #include "core/hw/aes/key.h"
 #include "core/loader/loader.h"
 #include "core/movie.h"
+#include "core/savestate.h"
 #ifdef ENABLE_SCRIPTING
 #include "core/rpc/server.h"
 #endif
@@ -51,6 +54,7 @@
 #include "network/network.h"
 #include "video_core/custom_textures/custom_tex_manager.h"
 #include "video_core/gpu.h"
+#include "video_core/pica/pica_core.h"
 #include "video_core/renderer_base.h"
 
 namespace Core {
@@ -100,6 +104,12 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         }
     }
 
+    if (savestate_failed.exchange(false)) {
+        std::scoped_lock lock{savestate_error_mutex};
+        status_details = std::move(savestate_error);
+        return ResultStatus::ErrorSavestate;
+    }
+
     Signal signal{Signal::None};
     u32 param{};
     {
@@ -148,6 +158,9 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         break;
     }
 
+    // Page table updates made by the GPU thread since the last slice
+    memory->ApplyRasterizerCacheMarks();
+
     // All cores should have executed the same amount of ticks. If this is not the case an event was
     // scheduled with a cycles_into_future smaller then the current downcount.
     // So we have to get those cores to the same global time first
@@ -206,27 +219,31 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
             kernel->GetThreadManager(cpu_core->GetID()).Reschedule();
             max_slice = std::min(max_slice, cpu_core->GetTimer().GetMaxSliceLength());
         }
-        for (auto& cpu_core : cpu_cores) {
-            cpu_core->GetTimer().SetNextSlice(max_slice);
-            auto start_ticks = cpu_core->GetTimer().GetTicks();
-            LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
-                      cpu_core->GetTimer().GetDowncount());
-            running_core = cpu_core.get();
-            kernel->SetRunningCPU(running_core);
-            // If we don't have a currently active thread then don't execute instructions,
-            // instead advance to the next event and try to yield to the next thread
-            if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
-                LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
-                cpu_core->GetTimer().Idle();
-                PrepareReschedule();
-            } else {
-                if (tight_loop) {
-                    cpu_core->Run();
+        if (tight_loop && CanRunCoresInParallel()) {
+            RunCoresInParallel(max_slice);
+        } else {
+            for (auto& cpu_core : cpu_cores) {
+                cpu_core->GetTimer().SetNextSlice(max_slice);
+                auto start_ticks = cpu_core->GetTimer().GetTicks();
+                LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
+                          cpu_core->GetTimer().GetDowncount());
+                running_core = cpu_core.get();
+                kernel->SetRunningCPU(running_core);
+                // If we don't have a currently active thread then don't execute instructions,
+                // instead advance to the next event and try to yield to the next thread
+                if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+                    LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+                    cpu_core->GetTimer().Idle();
+                    PrepareReschedule();
                 } else {
-                    cpu_core->Step();
+                    if (tight_loop) {
+                        cpu_core->Run();
+                    } else {
+                        cpu_core->Step();
+                    }
                 }
+                max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
             }
-            max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
         }
     }
 
@@ -239,6 +256,58 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
     return status;
 }
 
+bool System::CanRunCoresInParallel() const {
+    if (!core_workers || GDBStub::IsServerEnabled()) {
+        return false;
+    }
+    // Host thread interleaving decides the order in which the cores enter the kernel, so keep the
+    // serial schedule while a movie is being recorded or played back.
+    return !Settings::values.deterministic_cpu_cores ||
+           movie.GetPlayMode() == Movie::PlayMode::None;
+}
+
+void System::RunCoresInParallel(s64 max_slice) {
+    std::array<ARM_Interface*, 4> active_cores{};
+    std::size_t num_active_cores = 0;
+    for (auto& cpu_core : cpu_cores) {
+        cpu_core->GetTimer().SetNextSlice(max_slice);
+        running_core = cpu_core.get();
+        kernel->SetRunningCPU(running_core);
+        if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+            LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+            cpu_core->GetTimer().Idle();
+            PrepareReschedule();
+        } else {
+            active_cores[num_active_cores++] = cpu_core.get();
+        }
+    }
+
+    // The first active core runs on the emulation thread, the others on the worker threads.
+    // Cores that halt early for a reschedule are brought up to the global time by the next
+    // RunLoop iteration, the same way delayed cores are in serial mode.
+    cores_running_in_parallel = true;
+    for (std::size_t i = 1; i < num_active_cores; i++) {
+        core_workers->QueueWork([core = active_cores[i]] { core->Run(); });
+    }
+    if (num_active_cores != 0) {
+        active_cores[0]->Run();
+    }
+    core_workers->WaitForRequests();
+    cores_running_in_parallel = false;
+
+    running_core = cpu_cores.back().get();
+    kernel->SetRunningCPU(running_core);
+}
+
+std::unique_lock<std::recursive_mutex> System::LockKernel(ARM_Interface& core) {
+    std::unique_lock lock{kernel_mutex};
+    if (running_core != &core) {
+        running_core = &core;
+        kernel->SetRunningCPUForCallback(running_core);
+    }
+    return lock;
+}
+
 bool System::SendSignal(System::Signal signal, u32 param) {
     std::scoped_lock lock{signal_mutex};
     if (current_signal != signal && current_signal != Signal::None) {
@@ -338,6 +407,8 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
     cheat_engine.LoadCheatFile(title_id);
     cheat_engine.Connect();
 
+    gpu->PicaCore().LoadShaderDiskCache(title_id);
+
     perf_stats = std::make_unique<PerfStats>(title_id);
 
     if (Settings::values.dump_textures) {
@@ -423,6 +494,13 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
     }
     running_core = cpu_cores[0].get();
 
+#if CYTRUS_ARCH(x86_64) || CYTRUS_ARCH(arm64)
+    if (Settings::values.use_cpu_jit && Settings::values.parallel_cpu_cores && num_cores > 1) {
+        core_workers =
+            std::make_unique<Common::StatefulThreadWorker<void>>(num_cores - 1, "CPUCore");
+    }
+#endif
+
     kernel->SetCPUs(cpu_cores);
     kernel->SetRunningCPU(cpu_cores[0].get());
 
@@ -585,6 +663,11 @@ void System::Shutdown(bool is_deserializing) {
         GDBStub::Shutdown();
         perf_stats.reset();
         app_loader.reset();
+        if (savestate_worker) {
+            savestate_worker->WaitForRequests();
+            savestate_worker.reset();
+        }
+        savestate_base.reset();
     }
     custom_tex_manager.reset();
     telemetry_session.reset();
@@ -595,6 +678,7 @@ void System::Shutdown(bool is_deserializing) {
     service_manager.reset();
     dsp_core.reset();
     kernel.reset();
+    core_workers.reset();
     cpu_cores.clear();
     exclusive_monitor.reset();
     timing.reset();
@@ -713,6 +797,7 @@ void System::serialize(Archive& ar, const unsigned int file_version) {
         auto n3ds_hw_caps = this->app_loader->LoadNew3dsHwCapabilities();
         [[maybe_unused]] const System::ResultStatus result = Init(
             *m_emu_window, m_secondary_window, *memory_mode.first, *n3ds_hw_caps.first, num_cores);
+        gpu->PicaCore().LoadShaderDiskCache(title_id);
     }
 
     // Flush on save, don't flush on load
@@ -18,6 +18,11 @@
 #include "core/movie.h"
 #include "core/perf_stats.h"
 
+namespace Common {
+template <class StateType>
+class StatefulThreadWorker;
+}
+
 namespace Frontend {
 class EmuWindow;
 class ImageInterface;
@@ -75,6 +80,7 @@ class ARM_Interface;
 class TelemetrySession;
 class ExclusiveMonitor;
 class Timing;
+struct SaveStateBase;
 
 class System {
 public:
@@ -189,6 +195,20 @@ public:
         return *running_core;
     };
 
+    /// Returns true while the emulated cores are executing a slice on separate host threads.
+    [[nodiscard]] bool IsRunningCoresInParallel() const {
+        return cores_running_in_parallel;
+    }
+
+    /**
+     * Acquires the kernel lock and makes the provided core the running core, without touching the
+     * page tables of the JITs. While the cores execute in parallel this lock must be held whenever
+     * a core calls into the kernel, HLE services, Core::Timing or the slow memory path.
+     * @param core The core entering the kernel.
+     * @returns The held kernel lock.
+     */
+    [[nodiscard]] std::unique_lock<std::recursive_mutex> LockKernel(ARM_Interface& core);
+
     /**
      * Gets a reference to the emulated CPU.
      * @param core_id The id of the core requested.
@@ -339,7 +359,7 @@ public:
                (mic_permission_granted = mic_permission_func());
     }
 
-    void SaveState(u32 slot) const;
+    void SaveState(u32 slot);
 
     void LoadState(u32 slot);
 
@@ -372,6 +392,12 @@ private:
     /// Reschedule the core emulation
     void Reschedule();
 
+    /// Returns true if the next slice can be executed with one host thread per core.
+    [[nodiscard]] bool CanRunCoresInParallel() const;
+
+    /// Runs every core for max_slice ticks on its own host thread and waits for all of them.
+    void RunCoresInParallel(s64 max_slice);
+
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
@@ -379,6 +405,24 @@ private:
     std::vector<std::shared_ptr<ARM_Interface>> cpu_cores;
     ARM_Interface* running_core = nullptr;
 
+    /// Host threads executing the secondary cores when parallel core execution is enabled
+    std::unique_ptr<Common::StatefulThreadWorker<void>> core_workers;
+    /// Compresses and writes savestates when asynchronous savestates are enabled
+    std::unique_ptr<Common::StatefulThreadWorker<void>> savestate_worker;
+    std::atomic<u32> pending_savestates{};
+    /// Error of the last savestate that failed to be written asynchronously, reported by RunLoop
+    std::mutex savestate_error_mutex;
+    std::string savestate_error;
+    std::atomic<bool> savestate_failed{};
+    /// Full savestate that delta savestates are made against, when they are enabled
+    std::shared_ptr<SaveStateBase> savestate_base;
+    /// Size of the last serialized state, used to size the buffer of the next one
+    std::size_t last_savestate_size{};
+
+    /// Serializes kernel and HLE access between cores executing in parallel
+    std::recursive_mutex kernel_mutex;
+    bool cores_running_in_parallel{};
+
     /// DSP core
     std::unique_ptr<AudioCore::DspInterface> dsp_core;
 
@@ -12,6 +12,14 @@
 
 namespace Core {
 
+struct PendingEvent {
+    Timing::Event event;
+    Timing::Timer* timer;
+    std::size_t heap_index;
+    PendingEvent* prev_of_type;
+    PendingEvent* next_of_type;
+};
+
 // Sort by time, unless the times are the same, in which case sort by the order added to the queue
 bool Timing::Event::operator>(const Timing::Event& right) const {
     return std::tie(time, fifo_order) > std::tie(right.time, right.fifo_order);
@@ -34,6 +42,13 @@ Timing::Timing(std::size_t num_cores, u32 cpu_clock_percentage, s64 override_bas
     current_timer = timers[0].get();
 }
 
+Timing::~Timing() {
+    // Timers can outlive the event types they reference through the cores holding them.
+    for (auto& timer : timers) {
+        timer->ClearEvents();
+    }
+}
+
 s64 Timing::GenerateBaseTicks() {
     if (Settings::values.init_ticks_type.GetValue() == Settings::InitTicks::Fixed) {
         return Settings::values.init_ticks_override.GetValue();
@@ -92,9 +107,7 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
             if (!timer->is_timer_sane)
                 timer->ForceExceptionCheck(cycles_into_future);
 
-            timer->event_queue.emplace_back(
-                Event{timeout, timer->event_fifo_id++, user_data, event_type});
-            std::push_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
+            timer->InsertEvent(Event{timeout, timer->event_fifo_id++, user_data, event_type});
         } else {
             timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
                                        user_data, event_type});
@@ -106,16 +119,12 @@ void Timing::UnscheduleEvent(const TimingEventType* event_type, std::uintptr_t u
     if (event_queue_locked) {
         return;
     }
-    for (auto timer : timers) {
-        auto itr = std::remove_if(
-            timer->event_queue.begin(), timer->event_queue.end(),
-            [&](const Event& e) { return e.type == event_type && e.user_data == user_data; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
+    for (PendingEvent* event = event_type->pending_events; event != nullptr;) {
+        PendingEvent* next = event->next_of_type;
+        if (event->event.user_data == user_data) {
+            event->timer->RemoveEvent(event);
         }
+        event = next;
     }
     // TODO:remove events from ts_queue
 }
@@ -124,17 +133,9 @@ void Timing::RemoveEvent(const TimingEventType* event_type) {
     if (event_queue_locked) {
         return;
     }
-    for (auto timer : timers) {
-        auto itr = std::remove_if(timer->event_queue.begin(), timer->event_queue.end(),
-                                  [&](const Event& e) { return e.type == event_type; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+    while (event_type->pending_events != nullptr) {
+        event_type->pending_events->timer->RemoveEvent(event_type->pending_events);
     }
-    // TODO:remove events from ts_queue
 }
 
 void Timing::SetCurrentTimer(std::size_t core_id) {
@@ -164,19 +165,24 @@ std::shared_ptr<Timing::Timer> Timing::GetTimer(std::size_t cpu_id) {
 Timing::Timer::Timer(s64 base_ticks) : executed_ticks(base_ticks) {}
 
 Timing::Timer::~Timer() {
-    MoveEvents();
+    ClearEvents();
 }
 
 u64 Timing::Timer::GetTicks() const {
     u64 ticks = static_cast<u64>(executed_ticks);
     if (!is_timer_sane) {
-        ticks += slice_length - downcount;
+        ticks += slice_length.load(std::memory_order_relaxed) -
+                 downcount.load(std::memory_order_relaxed);
     }
     return ticks;
 }
 
 void Timing::Timer::AddTicks(u64 ticks) {
-    downcount -= static_cast<u64>(ticks * cpu_clock_scale);
+    // Only the owning core writes its downcount, so this needs no lock while the cores run in
+    // parallel. The atomic accesses only keep the reads of the other cores well defined.
+    const s64 current = downcount.load(std::memory_order_relaxed);
+    downcount.store(current - static_cast<s64>(ticks * cpu_clock_scale),
+                    std::memory_order_relaxed);
 }
 
 u64 Timing::Timer::GetIdleTicks() const {
@@ -185,25 +191,123 @@ u64 Timing::Timer::GetIdleTicks() const {
 
 void Timing::Timer::ForceExceptionCheck(s64 cycles) {
     cycles = std::max<s64>(0, cycles);
-    if (downcount > cycles) {
-        slice_length -= downcount - cycles;
-        downcount = cycles;
+    const s64 current = downcount.load(std::memory_order_relaxed);
+    if (current > cycles) {
+        slice_length.store(slice_length.load(std::memory_order_relaxed) - (current - cycles),
+                           std::memory_order_relaxed);
+        downcount.store(cycles, std::memory_order_relaxed);
     }
 }
 
 void Timing::Timer::MoveEvents() {
-    for (Event ev; ts_queue.Pop(ev);) {
+    ts_queue.PopAll([this](Event&& ev) {
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        InsertEvent(ev);
+    });
+}
+
+void Timing::Timer::InsertEvent(const Event& event) {
+    PendingEvent* node;
+    if (free_events.empty()) {
+        node = event_pool.emplace_back(std::make_unique<PendingEvent>()).get();
+    } else {
+        node = free_events.back();
+        free_events.pop_back();
+    }
+
+    const TimingEventType* type = event.type;
+    *node = PendingEvent{event, this, event_queue.size(), nullptr, type->pending_events};
+    if (type->pending_events != nullptr) {
+        type->pending_events->prev_of_type = node;
+    }
+    type->pending_events = node;
+
+    event_queue.push_back(node);
+    SiftUp(node->heap_index);
+}
+
+void Timing::Timer::RemoveEvent(PendingEvent* event) {
+    if (event->prev_of_type != nullptr) {
+        event->prev_of_type->next_of_type = event->next_of_type;
+    } else {
+        event->event.type->pending_events = event->next_of_type;
+    }
+    if (event->next_of_type != nullptr) {
+        event->next_of_type->prev_of_type = event->prev_of_type;
     }
+
+    // Move the last node into the hole and restore the heap property around it.
+    const std::size_t index = event->heap_index;
+    PendingEvent* last = event_queue.back();
+    event_queue.pop_back();
+    if (last != event) {
+        event_queue[index] = last;
+        last->heap_index = index;
+        SiftUp(index);
+        SiftDown(last->heap_index);
+    }
+    free_events.push_back(event);
+}
+
+void Timing::Timer::ClearEvents() {
+    while (!event_queue.empty()) {
+        RemoveEvent(event_queue.back());
+    }
+    ts_queue.Clear();
+}
+
+std::vector<Timing::Event> Timing::Timer::GetSortedEvents() const {
+    std::vector<Event> events;
+    events.reserve(event_queue.size());
+    for (const PendingEvent* event : event_queue) {
+        events.push_back(event->event);
+    }
+    std::sort(events.begin(), events.end());
+    return events;
+}
+
+void Timing::Timer::SiftUp(std::size_t index) {
+    PendingEvent* event = event_queue[index];
+    while (index > 0) {
+        const std::size_t parent = (index - 1) / 2;
+        if (!(event->event < event_queue[parent]->event)) {
+            break;
+        }
+        event_queue[index] = event_queue[parent];
+        event_queue[index]->heap_index = index;
+        index = parent;
+    }
+    event_queue[index] = event;
+    event->heap_index = index;
+}
+
+void Timing::Timer::SiftDown(std::size_t index) {
+    PendingEvent* event = event_queue[index];
+    const std::size_t size = event_queue.size();
+    while (true) {
+        std::size_t child = index * 2 + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && event_queue[child + 1]->event < event_queue[child]->event) {
+            child++;
+        }
+        if (!(event_queue[child]->event < event->event)) {
+            break;
+        }
+        event_queue[index] = event_queue[child];
+        event_queue[index]->heap_index = index;
+        index = child;
+    }
+    event_queue[index] = event;
+    event->heap_index = index;
 }
 
 s64 Timing::Timer::GetMaxSliceLength() const {
-    const auto& next_event = event_queue.begin();
-    if (next_event != event_queue.end()) {
-        ASSERT(next_event->time - executed_ticks > 0);
-        return next_event->time - executed_ticks;
+    if (!event_queue.empty()) {
+        const s64 next_event_time = event_queue.front()->event.time;
+        ASSERT(next_event_time - executed_ticks > 0);
+        return next_event_time - executed_ticks;
     }
     return MAX_SLICE_LENGTH;
 }
@@ -211,18 +315,18 @@ s64 Timing::Timer::GetMaxSliceLength() const {
 void Timing::Timer::Advance() {
     MoveEvents();
 
-    s64 cycles_executed = slice_length - downcount;
+    s64 cycles_executed = slice_length.load(std::memory_order_relaxed) -
+                          downcount.load(std::memory_order_relaxed);
     idled_cycles = 0;
     executed_ticks += cycles_executed;
-    slice_length = 0;
-    downcount = 0;
+    slice_length.store(0, std::memory_order_relaxed);
+    downcount.store(0, std::memory_order_relaxed);
 
     is_timer_sane = true;
 
-    while (!event_queue.empty() && event_queue.front().time <= executed_ticks) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+    while (!event_queue.empty() && event_queue.front()->event.time <= executed_ticks) {
+        const Event evt = event_queue.front()->event;
+        RemoveEvent(event_queue.front());
         if (evt.type->callback != nullptr) {
             evt.type->callback(evt.user_data, static_cast<int>(executed_ticks - evt.time));
         } else {
@@ -234,24 +338,25 @@ void Timing::Timer::Advance() {
 }
 
 void Timing::Timer::SetNextSlice(s64 max_slice_length) {
-    slice_length = max_slice_length;
+    s64 length = max_slice_length;
 
     // Still events left (scheduled in the future)
     if (!event_queue.empty()) {
-        slice_length = static_cast<int>(
-            std::min<s64>(event_queue.front().time - executed_ticks, max_slice_length));
+        length = static_cast<int>(
+            std::min<s64>(event_queue.front()->event.time - executed_ticks, max_slice_length));
     }
 
-    downcount = slice_length;
+    slice_length.store(length, std::memory_order_relaxed);
+    downcount.store(length, std::memory_order_relaxed);
 }
 
 void Timing::Timer::Idle() {
-    idled_cycles += downcount;
-    downcount = 0;
+    idled_cycles += downcount.load(std::memory_order_relaxed);
+    downcount.store(0, std::memory_order_relaxed);
 }
 
 s64 Timing::Timer::GetDowncount() const {
-    return downcount;
+    return downcount.load(std::memory_order_relaxed);
 }
 
 } // namespace Core
@@ -17,9 +17,11 @@
  *   ScheduleEvent(periodInCycles - cyclesLate, callback, "whatever")
  */
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -134,9 +136,14 @@ namespace Core {
 
 using TimedCallback = std::function<void(std::uintptr_t user_data, int cycles_late)>;
 
+struct PendingEvent;
+
 struct TimingEventType {
     TimedCallback callback;
     const std::string* name;
+    // Intrusive list of the scheduled events of this type, in any timer. Lets UnscheduleEvent and
+    // RemoveEvent find their events without searching the event queues.
+    mutable PendingEvent* pending_events = nullptr;
 };
 
 class Timing {
@@ -209,15 +216,30 @@ public:
 
     private:
         friend class Timing;
-        // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-        // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-        // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-        // accommodated by the standard adaptor class.
-        std::vector<Event> event_queue;
+
+        /// Inserts an event into the queue and links it into the list of its type.
+        void InsertEvent(const Event& event);
+        /// Removes an event from the queue and its type list, recycling the node.
+        void RemoveEvent(PendingEvent* event);
+        /// Removes every event from the queue.
+        void ClearEvents();
+        /// Returns the events in the order they will fire.
+        std::vector<Event> GetSortedEvents() const;
+
+        void SiftUp(std::size_t index);
+        void SiftDown(std::size_t index);
+
+        // The queue is a binary min-heap of nodes that record their own heap position, so any
+        // event can be erased in O(log n) from the handle kept in its type's pending list instead
+        // of filtering the whole queue and rebuilding the heap.
+        std::vector<PendingEvent*> event_queue;
+        // Every node allocated by this timer, and the ones currently unused.
+        std::vector<std::unique_ptr<PendingEvent>> event_pool;
+        std::vector<PendingEvent*> free_events;
         u64 event_fifo_id = 0;
         // the queue for storing the events from other threads threadsafe until they will be added
         // to the event_queue by the emu thread
-        Common::MPSCQueue<Event> ts_queue;
+        Common::LockFreeMPSCQueue<Event> ts_queue;
         // Are we in a function that has been called from Advance()
         // If events are sheduled from a function that gets called from Advance(),
         // don't change slice_length and downcount.
@@ -227,8 +249,9 @@ public:
         // downcount for that slice.
         bool is_timer_sane = true;
 
-        s64 slice_length = MAX_SLICE_LENGTH;
-        s64 downcount = MAX_SLICE_LENGTH;
+        // Read by the other cores through GetTicks while this one runs in parallel with them.
+        std::atomic<s64> slice_length = MAX_SLICE_LENGTH;
+        std::atomic<s64> downcount = MAX_SLICE_LENGTH;
         s64 executed_ticks = 0;
         u64 idled_cycles = 0;
 
@@ -239,10 +262,25 @@ public:
         template <class Archive>
         void serialize(Archive& ar, const unsigned int) {
             MoveEvents();
-            ar & event_queue;
+            // Stored as a sorted vector, which is also a valid heap for older versions.
+            std::vector<Event> events;
+            if (Archive::is_saving::value) {
+                events = GetSortedEvents();
+            }
+            ar & events;
+            if (Archive::is_loading::value) {
+                ClearEvents();
+                for (const Event& event : events) {
+                    InsertEvent(event);
+                }
+            }
             ar & event_fifo_id;
-            ar & slice_length;
-            ar & downcount;
+            s64 slice_length_value = slice_length.load(std::memory_order_relaxed);
+            s64 downcount_value = downcount.load(std::memory_order_relaxed);
+            ar & slice_length_value;
+            ar & downcount_value;
+            slice_length.store(slice_length_value, std::memory_order_relaxed);
+            downcount.store(downcount_value, std::memory_order_relaxed);
             ar & executed_ticks;
             ar & idled_cycles;
         }
@@ -251,7 +289,7 @@ public:
 
     explicit Timing(std::size_t num_cores, u32 cpu_clock_percentage, s64 override_base_ticks = -1);
 
-    ~Timing() {};
+    ~Timing();
 
     /**
      * Returns the event_type identifier. if name is not unique, it will assert.
@@ -523,6 +523,29 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
 
             s64 section_offset =
                 (section.offset + exefs_offset + sizeof(ExeFs_Header) + ncch_offset);
+
+            // Decrypted sections are used as they are, so read them straight from a mapping.
+            if (!is_encrypted) {
+                if (!exefs_mapping.IsOpen()) {
+                    exefs_mapping = Common::MappedFile(exefs_file);
+                }
+                const auto mapped_section = exefs_mapping.Subspan(section_offset, section.size);
+                if (section.size != 0 && mapped_section.size() == section.size &&
+                    !exefs_mapping.IsStale(exefs_file)) {
+                    exefs_mapping.Advise(section_offset, section.size,
+                                         Common::MappedFile::AccessHint::Sequential);
+                    if (strcmp(section.name, ".code") == 0 && is_compressed) {
+                        buffer.resize(LZSS_GetDecompressedSize(mapped_section));
+                        if (!LZSS_Decompress(mapped_section, buffer)) {
+                            return Loader::ResultStatus::ErrorInvalidFormat;
+                        }
+                    } else {
+                        buffer.assign(mapped_section.begin(), mapped_section.end());
+                    }
+                    return Loader::ResultStatus::Success;
+                }
+            }
+
             exefs_file.Seek(section_offset, SEEK_SET);
 
             std::array<u8, 16> key;
@@ -683,8 +706,7 @@ Loader::ResultStatus NCCHContainer::ReadRomFS(std::shared_ptr<RomFSReader>& romf
             std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner), romfs_offset,
                                                 romfs_size, secondary_key, romfs_ctr, 0x1000);
     } else {
-        direct_romfs = std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner),
-                                                           romfs_offset, romfs_size);
+        direct_romfs = OpenDecryptedRomFS(std::move(romfs_file_inner), romfs_offset, romfs_size);
     }
 
     const auto path =
@@ -725,8 +747,8 @@ Loader::ResultStatus NCCHContainer::ReadOverrideRomFS(std::shared_ptr<RomFSReade
         if (romfs_file_inner.IsOpen()) {
             LOG_WARNING(Service_FS, "File {} overriding built-in RomFS; LayeredFS not enabled",
                         split_filepath);
-            romfs_file = std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner), 0,
-                                                             romfs_file_inner.GetSize());
+            const std::size_t romfs_size = romfs_file_inner.GetSize();
+            romfs_file = OpenDecryptedRomFS(std::move(romfs_file_inner), 0, romfs_size);
             return Loader::ResultStatus::Success;
         }
     }
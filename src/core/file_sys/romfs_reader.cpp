@@ -1,15 +1,144 @@
 #include <algorithm>
+#include <chrono>
+#include <limits>
 #include <vector>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include "common/archives.h"
+#include "common/literals.h"
 #include "common/logging/log.h"
+#include "common/memory_detect.h"
 #include "core/file_sys/romfs_reader.h"
 
 SERIALIZE_EXPORT_IMPL(FileSys::DirectRomFSReader)
+SERIALIZE_EXPORT_IMPL(FileSys::MappedRomFSReader)
 
 namespace FileSys {
 
+namespace {
+using namespace Common::Literals;
+
+/// Cache size bounds per reader. Within them, the cache gets 1/256 of the host memory.
+constexpr std::size_t MinCacheSize = 2_MiB;
+constexpr std::size_t MaxCacheSize = 64_MiB;
+
+std::size_t CacheLinesPerShard(std::size_t line_size, std::size_t shard_count) {
+    const u64 total_memory = Common::GetMemInfo().total_physical_memory;
+    const std::size_t cache_size =
+        std::clamp<std::size_t>(static_cast<std::size_t>(total_memory / 256), MinCacheSize,
+                                MaxCacheSize);
+    return std::max<std::size_t>(cache_size / line_size / shard_count, 1);
+}
+} // Anonymous namespace
+
+struct DirectRomFSReader::Cipher {
+    CryptoPP::AES::Encryption aes;
+};
+
+DirectRomFSReader::DirectRomFSReader()
+    : cache_lines_per_shard(CacheLinesPerShard(cache_line_size, cache_shard_count)) {}
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size)
+    : is_encrypted(false), file(std::move(file)), file_offset(file_offset), data_size(data_size),
+      cache_lines_per_shard(CacheLinesPerShard(cache_line_size, cache_shard_count)) {}
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size, const std::array<u8, 16>& key,
+                                     const std::array<u8, 16>& ctr, std::size_t crypto_offset)
+    : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
+      crypto_offset(crypto_offset), data_size(data_size),
+      cache_lines_per_shard(CacheLinesPerShard(cache_line_size, cache_shard_count)) {
+    InitializeCipher();
+}
+
+DirectRomFSReader::~DirectRomFSReader() = default;
+
+void DirectRomFSReader::InitializeCipher() {
+    if (!is_encrypted) {
+        cipher.reset();
+        return;
+    }
+    cipher = std::make_unique<Cipher>();
+    cipher->aes.SetKey(key.data(), key.size());
+}
+
+void DirectRomFSReader::Decrypt(u8* data, std::size_t length, std::size_t offset) {
+    // The external cipher mode only holds the counter, so this does not expand the key again.
+    // Crypto++ picks AES-NI or the ARMv8 crypto extensions for the block cipher when available.
+    CryptoPP::CTR_Mode_ExternalCipher::Decryption d(cipher->aes, ctr.data());
+    d.Seek(crypto_offset + offset);
+    d.ProcessData(data, data, length);
+}
+
+DirectRomFSReader::CacheLine DirectRomFSReader::LookupLine(std::size_t page) {
+    auto& shard = ShardForPage(page);
+    std::scoped_lock lock{shard.mutex};
+    const auto it = shard.lines.find(page);
+    if (it == shard.lines.end()) {
+        return nullptr;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    return it->second->second;
+}
+
+void DirectRomFSReader::InsertLine(std::size_t page, CacheLine line) {
+    auto& shard = ShardForPage(page);
+    std::scoped_lock lock{shard.mutex};
+    if (const auto it = shard.lines.find(page); it != shard.lines.end()) {
+        // Another thread fetched the same page in the meantime.
+        it->second->second = std::move(line);
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+    if (shard.lru.size() >= cache_lines_per_shard) {
+        shard.lines.erase(shard.lru.back().first);
+        shard.lru.pop_back();
+    }
+    shard.lru.emplace_front(page, std::move(line));
+    shard.lines.emplace(page, shard.lru.begin());
+}
+
+DirectRomFSReader::CacheLine DirectRomFSReader::FetchLine(std::size_t page) {
+    // Grow the read-ahead window while misses continue where the previous access ended, and
+    // fall back to single lines on random access.
+    std::size_t lines = 1;
+    if (page == next_sequential_page.load(std::memory_order_relaxed)) {
+        lines = std::min(readahead_lines.load(std::memory_order_relaxed) * 2, max_readahead_lines);
+    }
+    readahead_lines.store(lines, std::memory_order_relaxed);
+
+    const std::size_t end =
+        std::min<std::size_t>(page + lines * cache_line_size, static_cast<std::size_t>(data_size));
+    std::vector<u8> data(end - page);
+    std::size_t read_size = file.ReadAtBytes(data.data(), data.size(), file_offset + page);
+    if (read_size == std::numeric_limits<std::size_t>::max()) {
+        read_size = 0;
+    }
+    data.resize(std::min(read_size, data.size()));
+    if (is_encrypted && !data.empty()) {
+        Decrypt(data.data(), data.size(), page);
+    }
+    LOG_TRACE(Service_FS, "RomFS Cache MISS: page={}, lines={}, read={}", page, lines,
+              data.size());
+    if (data.empty()) {
+        // Do not cache failed reads, the next access should retry them.
+        return std::make_shared<const std::vector<u8>>();
+    }
+
+    CacheLine requested;
+    for (std::size_t line_offset = 0; line_offset < data.size(); line_offset += cache_line_size) {
+        const auto first = data.begin() + line_offset;
+        const auto last = data.begin() + std::min(line_offset + cache_line_size, data.size());
+        auto line = std::make_shared<const std::vector<u8>>(first, last);
+        if (line_offset == 0) {
+            requested = line;
+        }
+        InsertLine(page + line_offset, std::move(line));
+    }
+    return requested;
+}
+
 std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
     length = std::min(length, static_cast<std::size_t>(data_size) - offset);
     if (length == 0)
@@ -22,41 +151,28 @@ std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length,
     if (segments.size() == 1 && segments[0].second > cache_line_size) {
         length = file.ReadAtBytes(buffer, length, file_offset + offset);
         if (is_encrypted) {
-            CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-            d.Seek(crypto_offset + offset);
-            d.ProcessData(buffer, buffer, length);
+            Decrypt(buffer, length, offset);
         }
+        next_sequential_page.store(OffsetToPage(offset + length), std::memory_order_relaxed);
         LOG_TRACE(Service_FS, "RomFS Cache SKIP: offset={}, length={}", offset, length);
         return length;
     }
 
-    // TODO(PabloMK7): Make cache thread safe, read the comment in CacheReady function.
-    // std::unique_lock<std::shared_mutex> read_guard(cache_mutex);
     for (const auto& seg : segments) {
-        std::size_t read_size = cache_line_size;
-        std::size_t page = OffsetToPage(seg.first);
-        // Check if segment is in cache
-        auto cache_entry = cache.request(page);
-        if (!cache_entry.first) {
-            // If not found, read from disk and cache the data
-            read_size = file.ReadAtBytes(cache_entry.second.data(), read_size, file_offset + page);
-            if (is_encrypted && read_size) {
-                CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-                d.Seek(crypto_offset + page);
-                d.ProcessData(cache_entry.second.data(), cache_entry.second.data(), read_size);
-            }
-            LOG_TRACE(Service_FS, "RomFS Cache MISS: page={}, length={}, into={}", page, seg.second,
-                      (seg.first - page));
+        const std::size_t page = OffsetToPage(seg.first);
+        CacheLine line = LookupLine(page);
+        if (!line) {
+            line = FetchLine(page);
         } else {
             LOG_TRACE(Service_FS, "RomFS Cache HIT: page={}, length={}, into={}", page, seg.second,
                       (seg.first - page));
         }
-        std::size_t copy_amount =
-            (read_size > (seg.first - page))
-                ? std::min((seg.first - page) + seg.second, read_size) - (seg.first - page)
-                : 0;
-        std::memcpy(buffer + read_progress, cache_entry.second.data() + (seg.first - page),
-                    copy_amount);
+        next_sequential_page.store(page + cache_line_size, std::memory_order_relaxed);
+
+        const std::size_t into = seg.first - page;
+        const std::size_t copy_amount =
+            (line->size() > into) ? std::min(into + seg.second, line->size()) - into : 0;
+        std::memcpy(buffer + read_progress, line->data() + into, copy_amount);
         read_progress += copy_amount;
     }
     return read_progress;
@@ -70,21 +186,18 @@ bool DirectRomFSReader::CacheReady(std::size_t file_offset, std::size_t length)
     auto segments = BreakupRead(file_offset, length);
     if (segments.size() == 1 && segments[0].second > cache_line_size) {
         return false;
-    } else {
-        // TODO(PabloMK7): Since the LRU cache is not thread safe, a lock must be used.
-        // However, this completely breaks the point of using a cache, because
-        // smaller reads may be blocked by bigger reads. For now, always return
-        // data being in cache to prevent the need of a lock, and only read data
-        // asynchronously if it is too big to use the cache.
-        /*
-        std::shared_lock<std::shared_mutex> read_guard(cache_mutex);
-        for (auto it = segments.begin(); it != segments.end(); it++) {
-            if (!cache.contains(OffsetToPage(it->first)))
-                return false;
+    }
+    // The cache is safe to query from any thread, so report misses and let the caller read
+    // them asynchronously instead of stalling on the disk.
+    for (const auto& seg : segments) {
+        const std::size_t page = OffsetToPage(seg.first);
+        auto& shard = ShardForPage(page);
+        std::scoped_lock lock{shard.mutex};
+        if (!shard.lines.contains(page)) {
+            return false;
         }
-        */
-        return true;
     }
+    return true;
 }
 
 std::vector<std::pair<std::size_t, std::size_t>> DirectRomFSReader::BreakupRead(
@@ -109,4 +222,90 @@ std::vector<std::pair<std::size_t, std::size_t>> DirectRomFSReader::BreakupRead(
     return ret;
 }
 
+MappedRomFSReader::MappedRomFSReader(FileUtil::IOFile&& file_, Common::MappedFile&& mapping_,
+                                     std::size_t file_offset_, std::size_t data_size_)
+    : file(std::move(file_)), mapping(std::move(mapping_)), file_offset(file_offset_),
+      data_size(data_size_), use_mapping(true) {}
+
+bool MappedRomFSReader::CheckMapping() {
+    if (!use_mapping.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    const s64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+    s64 next_check = next_stale_check.load(std::memory_order_relaxed);
+    if (now < next_check) {
+        return true;
+    }
+    // Only one of the racing readers performs the check, the others keep using the mapping.
+    const s64 interval = std::chrono::nanoseconds{stale_check_interval}.count();
+    if (!next_stale_check.compare_exchange_strong(next_check, now + interval,
+                                                  std::memory_order_relaxed)) {
+        return use_mapping.load(std::memory_order_relaxed);
+    }
+    if (mapping.IsOpen() && mapping.Size() >= file_offset + data_size && !mapping.IsStale(file)) {
+        return true;
+    }
+    if (use_mapping.exchange(false, std::memory_order_relaxed)) {
+        LOG_WARNING(Service_FS, "RomFS mapping is unusable, falling back to file reads");
+    }
+    return false;
+}
+
+std::span<const u8> MappedRomFSReader::GetSpan(std::size_t offset, std::size_t length) {
+    if (offset >= data_size || !CheckMapping()) {
+        return {};
+    }
+    length = std::min(length, static_cast<std::size_t>(data_size) - offset);
+    return mapping.Subspan(file_offset + offset, length);
+}
+
+std::size_t MappedRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
+    if (offset >= data_size) {
+        return 0;
+    }
+    length = std::min(length, static_cast<std::size_t>(data_size) - offset);
+    const auto data = GetSpan(offset, length);
+    if (data.empty()) {
+        const std::size_t read_size = file.ReadAtBytes(buffer, length, file_offset + offset);
+        return read_size == std::numeric_limits<std::size_t>::max() ? 0 : read_size;
+    }
+
+    // Have the kernel fetch what follows while reads stream through the RomFS.
+    const std::size_t end = offset + data.size();
+    if (next_sequential_offset.exchange(end, std::memory_order_relaxed) == offset) {
+        mapping.Advise(file_offset + end, readahead_size,
+                       Common::MappedFile::AccessHint::WillNeed);
+    }
+
+    std::memcpy(buffer, data.data(), data.size());
+    return data.size();
+}
+
+bool MappedRomFSReader::AllowsCachedReads() const {
+    return true;
+}
+
+bool MappedRomFSReader::CacheReady(std::size_t offset, std::size_t length) {
+    // Only serve small reads synchronously, as the direct reader does for reads that fit its
+    // cache, and only when they will not fault in pages from the disk.
+    if (length >= async_read_size || offset >= data_size || !CheckMapping()) {
+        return false;
+    }
+    length = std::min(length, static_cast<std::size_t>(data_size) - offset);
+    return length == 0 || mapping.IsResident(file_offset + offset, length);
+}
+
+std::shared_ptr<RomFSReader> OpenDecryptedRomFS(FileUtil::IOFile&& file, std::size_t file_offset,
+                                                std::size_t data_size) {
+    Common::MappedFile mapping(file);
+    if (mapping.IsOpen() && mapping.Size() >= file_offset + data_size) {
+        return std::make_shared<MappedRomFSReader>(std::move(file), std::move(mapping),
+                                                   file_offset, data_size);
+    }
+    LOG_DEBUG(Service_FS, "Could not map RomFS, falling back to file reads");
+    return std::make_shared<DirectRomFSReader>(std::move(file), file_offset, data_size);
+}
+
 } // namespace FileSys
@@ -1,14 +1,20 @@
 #pragma once
 
 #include <array>
-#include <shared_mutex>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
 #include "common/alignment.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
-#include "common/static_lru_cache.h"
+#include "common/mapped_file.h"
 
 namespace FileSys {
 
@@ -35,17 +41,13 @@ private:
  */
 class DirectRomFSReader : public RomFSReader {
 public:
-    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size);
 
     DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                       const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
-                      std::size_t crypto_offset)
-        : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+                      std::size_t crypto_offset);
 
-    ~DirectRomFSReader() override = default;
+    ~DirectRomFSReader() override;
 
     std::size_t GetSize() const override {
         return data_size;
@@ -66,15 +68,49 @@ private:
     u64 crypto_offset;
     u64 data_size;
 
-    // Total cache size: 128KB
+    /// AES key schedule, expanded once and shared by every read.
+    struct Cipher;
+    std::unique_ptr<Cipher> cipher;
+
     static constexpr std::size_t cache_line_size = (1 << 13); // About 8KB
-    static constexpr std::size_t cache_line_count = 16;
+    /// The cache is split by page so that concurrent reads rarely contend on the same lock.
+    static constexpr std::size_t cache_shard_count = 16;
+    /// Upper bound of lines fetched with a single read once accesses turn out to be sequential.
+    static constexpr std::size_t max_readahead_lines = 32;
+
+    /// Decrypted page contents. May be shorter than a line at the end of the RomFS.
+    using CacheLine = std::shared_ptr<const std::vector<u8>>;
+
+    struct CacheShard {
+        std::mutex mutex;
+        std::list<std::pair<std::size_t, CacheLine>> lru; ///< Most recently used first
+        std::unordered_map<std::size_t, decltype(lru)::iterator> lines;
+    };
+
+    std::array<CacheShard, cache_shard_count> cache;
+    std::size_t cache_lines_per_shard;
 
-    Common::StaticLRUCache<std::size_t, std::array<u8, cache_line_size>, cache_line_count> cache;
-    // TODO(PabloMK7): Make cache thread safe, read the comment in CacheReady function.
-    // std::shared_mutex cache_mutex;
+    // Sequential access detection for read-ahead. Only a heuristic, so races are harmless.
+    std::atomic<std::size_t> next_sequential_page = 0;
+    std::atomic<std::size_t> readahead_lines = 1;
 
-    DirectRomFSReader() = default;
+    DirectRomFSReader();
+
+    void InitializeCipher();
+
+    void Decrypt(u8* data, std::size_t length, std::size_t offset);
+
+    CacheShard& ShardForPage(std::size_t page) {
+        return cache[(page / cache_line_size) % cache_shard_count];
+    }
+
+    /// Returns the cached line for the page, or nullptr when it is not cached.
+    CacheLine LookupLine(std::size_t page);
+
+    void InsertLine(std::size_t page, CacheLine line);
+
+    /// Reads the page, and the pages following it if reads are sequential, into the cache.
+    CacheLine FetchLine(std::size_t page);
 
     std::size_t OffsetToPage(std::size_t offset) {
         return Common::AlignDown<std::size_t>(offset, cache_line_size);
@@ -93,10 +129,91 @@ private:
         ar& file_offset;
         ar& crypto_offset;
         ar& data_size;
+        if (Archive::is_loading::value) {
+            InitializeCipher();
+        }
+    }
+    friend class boost::serialization::access;
+};
+
+/**
+ * A RomFS reader for decrypted images that memory maps the file. Reads are copies out of the
+ * page cache, without going through a syscall or an intermediate buffer.
+ */
+class MappedRomFSReader : public RomFSReader {
+public:
+    MappedRomFSReader(FileUtil::IOFile&& file, Common::MappedFile&& mapping,
+                      std::size_t file_offset, std::size_t data_size);
+
+    ~MappedRomFSReader() override = default;
+
+    std::size_t GetSize() const override {
+        return data_size;
+    }
+
+    std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer) override;
+
+    bool AllowsCachedReads() const override;
+
+    bool CacheReady(std::size_t file_offset, std::size_t length) override;
+
+    /// Returns the RomFS bytes in [offset, offset + length) without copying them. Empty when
+    /// the reader has fallen back to file reads.
+    std::span<const u8> GetSpan(std::size_t offset, std::size_t length);
+
+    /// How often reads check that the file still has the size it had when it was mapped.
+    static constexpr std::chrono::milliseconds stale_check_interval{500};
+
+private:
+    /// Size of the window prefetched ahead of sequential reads.
+    static constexpr std::size_t readahead_size = 256 * 1024;
+    /// Reads of at least this size are served asynchronously, as they may need to hit the disk.
+    static constexpr std::size_t async_read_size = 8 * 1024;
+
+    FileUtil::IOFile file;
+    Common::MappedFile mapping;
+    u64 file_offset;
+    u64 data_size;
+
+    /// Where the previous read ended. Only a heuristic, so races are harmless.
+    std::atomic<std::size_t> next_sequential_offset = 0;
+
+    /// Cleared once the mapping can no longer be trusted, reads then go through the file. The
+    /// mapping itself stays alive as other threads may still be copying from it.
+    std::atomic<bool> use_mapping = false;
+
+    /// Steady clock time, in nanoseconds, after which the next read checks the file again.
+    std::atomic<s64> next_stale_check = 0;
+
+    MappedRomFSReader() = default;
+
+    /// Returns whether reads may be served from the mapping, falling back to file reads when the
+    /// mapping is missing or the file changed size since it was mapped. The size is only checked
+    /// every stale_check_interval to keep the syscall off most reads.
+    bool CheckMapping();
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& boost::serialization::base_object<RomFSReader>(*this);
+        ar& file;
+        ar& file_offset;
+        ar& data_size;
+        if (Archive::is_loading::value) {
+            mapping = Common::MappedFile(file);
+            use_mapping = true;
+        }
     }
     friend class boost::serialization::access;
 };
 
+/**
+ * Opens a reader for an unencrypted RomFS. The file is memory mapped when possible, and read
+ * through DirectRomFSReader otherwise.
+ */
+std::shared_ptr<RomFSReader> OpenDecryptedRomFS(FileUtil::IOFile&& file, std::size_t file_offset,
+                                                std::size_t data_size);
+
 } // namespace FileSys
 
 BOOST_CLASS_EXPORT_KEY(FileSys::DirectRomFSReader)
+BOOST_CLASS_EXPORT_KEY(FileSys::MappedRomFSReader)
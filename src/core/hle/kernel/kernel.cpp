@@ -77,8 +77,9 @@ void KernelSystem::SetCurrentProcessForCPU(std::shared_ptr<Process> process, u32
         current_process = process;
         SetCurrentMemoryPageTable(process->vm_manager.page_table);
     } else {
+        // The page table of the other core is switched by SetRunningCPU before it runs again, so
+        // its JIT is never touched from this thread while the cores run in parallel.
         stored_processes[core_id] = process;
-        thread_managers[core_id]->cpu->SetPageTable(process->vm_manager.page_table);
     }
 }
 
@@ -107,6 +108,18 @@ void KernelSystem::SetRunningCPU(Core::ARM_Interface* cpu) {
     }
 }
 
+void KernelSystem::SetRunningCPUForCallback(Core::ARM_Interface* cpu) {
+    if (current_process) {
+        stored_processes[current_cpu->GetID()] = current_process;
+    }
+    current_cpu = cpu;
+    timing.SetCurrentTimer(cpu->GetID());
+    if (const auto& process = stored_processes[current_cpu->GetID()]) {
+        current_process = process;
+        memory.SetCurrentPageTable(process->vm_manager.page_table);
+    }
+}
+
 ThreadManager& KernelSystem::GetThreadManager(u32 core_id) {
     return *thread_managers[core_id];
 }
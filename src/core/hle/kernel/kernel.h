@@ -280,6 +280,13 @@ public:
 
     void SetRunningCPU(Core::ARM_Interface* cpu);
 
+    /**
+     * Makes cpu the running CPU for a call into the kernel from its JIT while the cores execute
+     * in parallel. Unlike SetRunningCPU, this only switches the kernel bookkeeping and the memory
+     * view of the current process, the page tables of the running JITs are left alone.
+     */
+    void SetRunningCPUForCallback(Core::ARM_Interface* cpu);
+
     ThreadManager& GetThreadManager(u32 core_id);
     const ThreadManager& GetThreadManager(u32 core_id) const;
 
@@ -3,10 +3,13 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <atomic>
 #include <cstring>
+#include <mutex>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/binary_object.hpp>
 #include "audio_core/dsp_interface.h"
+#include "common/alignment.h"
 #include "common/archives.h"
 #include "common/assert.h"
 #include "common/atomic_ops.h"
@@ -21,7 +24,6 @@
 #include "core/hle/service/plgldr/plgldr.h"
 #include "core/memory.h"
 #include "video_core/gpu.h"
-#include "video_core/renderer_base.h"
 
 SERIALIZE_EXPORT_IMPL(Memory::MemorySystem::BackingMemImpl<Memory::Region::FCRAM>)
 SERIALIZE_EXPORT_IMPL(Memory::MemorySystem::BackingMemImpl<Memory::Region::VRAM>)
@@ -84,6 +86,83 @@ private:
     }
 };
 
+/**
+ * Tracks, per physical page of FCRAM and VRAM, the rasterizer work a CPU access to a
+ * RasterizerCachedMemory page can skip because it was already done since the rasterizer cache
+ * last touched the page. The CPU thread promotes pages while the GPU thread may demote them, so
+ * each state is atomic and the CPU promotes a page before doing the work, letting a concurrent
+ * demotion win.
+ */
+class RasterizerAccessTracker {
+public:
+    enum class State : u8 {
+        /// The GPU may hold newer data, CPU accesses have to go through the rasterizer.
+        Unsynced,
+        /// GPU data has been written back, the CPU can read the page directly.
+        Flushed,
+        /// GPU data has been written back and invalidated, the CPU can also write directly.
+        Invalidated,
+    };
+
+    State Get(VAddr addr) const {
+        const std::atomic<State>* state = At(addr);
+        return state ? state->load() : State::Unsynced;
+    }
+
+    void Set(VAddr addr, State new_state) {
+        if (std::atomic<State>* state = At(addr)) {
+            state->store(new_state);
+        }
+    }
+
+    /// Lowers the state of every page in the physical region to at most max_state.
+    void Demote(PAddr start, u32 size, State max_state) {
+        if (size == 0) {
+            return;
+        }
+        const PAddr end = start + size;
+        const auto demote_range = [&](auto& pages, PAddr region_start) {
+            const PAddr region_end = region_start + pages.size() * CYTRUS_PAGE_SIZE;
+            if (start >= region_end || end <= region_start) {
+                return;
+            }
+            const std::size_t first = (std::max(start, region_start) - region_start) >>
+                                      CYTRUS_PAGE_BITS;
+            const std::size_t last =
+                (std::min(end, region_end) - region_start - 1) >> CYTRUS_PAGE_BITS;
+            for (std::size_t i = first; i <= last; i++) {
+                State state = pages[i].load();
+                while (state > max_state && !pages[i].compare_exchange_weak(state, max_state)) {
+                }
+            }
+        };
+        demote_range(fcram, FCRAM_PADDR);
+        demote_range(vram, VRAM_PADDR);
+    }
+
+private:
+    const std::atomic<State>* At(VAddr addr) const {
+        return const_cast<RasterizerAccessTracker*>(this)->At(addr);
+    }
+
+    // Plugin framebuffer pages are left untracked, they always go through the rasterizer.
+    std::atomic<State>* At(VAddr addr) {
+        if (addr >= VRAM_VADDR && addr < VRAM_VADDR_END) {
+            return &vram[(addr - VRAM_VADDR) >> CYTRUS_PAGE_BITS];
+        }
+        if (addr >= LINEAR_HEAP_VADDR && addr < LINEAR_HEAP_VADDR_END) {
+            return &fcram[(addr - LINEAR_HEAP_VADDR) >> CYTRUS_PAGE_BITS];
+        }
+        if (addr >= NEW_LINEAR_HEAP_VADDR && addr < NEW_LINEAR_HEAP_VADDR_END) {
+            return &fcram[(addr - NEW_LINEAR_HEAP_VADDR) >> CYTRUS_PAGE_BITS];
+        }
+        return nullptr;
+    }
+
+    std::array<std::atomic<State>, FCRAM_N3DS_SIZE / CYTRUS_PAGE_SIZE> fcram{};
+    std::array<std::atomic<State>, VRAM_SIZE / CYTRUS_PAGE_SIZE> vram{};
+};
+
 class MemorySystem::Impl {
 public:
     // Visual Studio would try to allocate these on compile time
@@ -95,8 +174,19 @@ public:
     Core::System& system;
     std::shared_ptr<PageTable> current_page_table = nullptr;
     RasterizerCacheMarker cache_marker;
+    RasterizerAccessTracker access_tracker;
     std::vector<std::shared_ptr<PageTable>> page_table_list;
 
+    struct CacheMark {
+        PAddr start;
+        u32 size;
+        bool cached;
+    };
+    bool defer_cache_marks = false;
+    std::atomic<bool> has_cache_marks{};
+    std::mutex cache_marks_mutex;
+    std::vector<CacheMark> cache_marks;
+
     AudioCore::DspInterface* dsp = nullptr;
 
     std::shared_ptr<BackingMem> fcram_mem;
@@ -189,8 +279,7 @@ public:
             }
             case PageType::RasterizerCachedMemory: {
                 if constexpr (!UNSAFE) {
-                    RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                                 FlushMode::Flush);
+                    RasterizerPrepareCpuRead(current_vaddr, static_cast<u32>(copy_amount));
                 }
                 std::memcpy(dest_buffer, GetPointerForRasterizerCache(current_vaddr), copy_amount);
                 break;
@@ -238,8 +327,7 @@ public:
             }
             case PageType::RasterizerCachedMemory: {
                 if constexpr (!UNSAFE) {
-                    RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                                 FlushMode::Invalidate);
+                    RasterizerPrepareCpuWrite(current_vaddr, static_cast<u32>(copy_amount));
                 }
                 std::memcpy(GetPointerForRasterizerCache(current_vaddr), src_buffer, copy_amount);
                 break;
@@ -277,6 +365,38 @@ public:
         return MemoryRef{};
     }
 
+    /// Flushes GPU data before a CPU read of a RasterizerCachedMemory page, unless the page
+    /// has already been flushed since the rasterizer cache last modified it. The whole page is
+    /// flushed, so that further reads anywhere in it can skip the rasterizer.
+    void RasterizerPrepareCpuRead(VAddr vaddr, u32 size) {
+        using State = RasterizerAccessTracker::State;
+        system.GPU().WaitForIdle();
+        if (access_tracker.Get(vaddr) != State::Unsynced) {
+            return;
+        }
+        access_tracker.Set(vaddr, State::Flushed);
+        const VAddr page_start = vaddr & ~CYTRUS_PAGE_MASK;
+        const VAddr page_end = Common::AlignUp(vaddr + size, CYTRUS_PAGE_SIZE);
+        RasterizerFlushVirtualRegion(page_start, page_end - page_start, FlushMode::Flush);
+    }
+
+    /// Invalidates GPU data before a CPU write to a RasterizerCachedMemory page. The whole page
+    /// is invalidated on the first write, so that further writes can skip the rasterizer until
+    /// the cache uses the page again and the surfaces reload all of them at draw time.
+    void RasterizerPrepareCpuWrite(VAddr vaddr, u32 size) {
+        using State = RasterizerAccessTracker::State;
+        system.GPU().WaitForIdle();
+        if (access_tracker.Get(vaddr) == State::Invalidated) {
+            return;
+        }
+        access_tracker.Set(vaddr, State::Invalidated);
+        RasterizerFlushVirtualRegion(vaddr, size, FlushMode::Invalidate);
+        if (size < CYTRUS_PAGE_SIZE) {
+            RasterizerFlushVirtualRegion(vaddr & ~CYTRUS_PAGE_MASK, CYTRUS_PAGE_SIZE,
+                                         FlushMode::FlushAndInvalidate);
+        }
+    }
+
     void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
         const VAddr end = start + size;
 
@@ -286,22 +406,21 @@ public:
                 return;
             }
 
-            auto& renderer = system.GPU().Renderer();
+            auto& gpu = system.GPU();
             VAddr overlap_start = std::max(start, region_start);
             VAddr overlap_end = std::min(end, region_end);
             PAddr physical_start = paddr_region_start + (overlap_start - region_start);
             u32 overlap_size = overlap_end - overlap_start;
 
-            auto* rasterizer = renderer.Rasterizer();
             switch (mode) {
             case FlushMode::Flush:
-                rasterizer->FlushRegion(physical_start, overlap_size);
+                gpu.FlushRegion(physical_start, overlap_size);
                 break;
             case FlushMode::Invalidate:
-                rasterizer->InvalidateRegion(physical_start, overlap_size);
+                gpu.InvalidateRegion(physical_start, overlap_size);
                 break;
             case FlushMode::FlushAndInvalidate:
-                rasterizer->FlushAndInvalidateRegion(physical_start, overlap_size);
+                gpu.FlushAndInvalidateRegion(physical_start, overlap_size);
                 break;
             }
         };
@@ -485,7 +604,7 @@ T MemorySystem::Read(const VAddr vaddr) {
         ASSERT_MSG(false, "Mapped memory page without a pointer @ {:08X}", vaddr);
         break;
     case PageType::RasterizerCachedMemory: {
-        RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Flush);
+        impl->RasterizerPrepareCpuRead(vaddr, sizeof(T));
 
         T value;
         std::memcpy(&value, GetPointerForRasterizerCache(vaddr), sizeof(T));
@@ -534,7 +653,7 @@ void MemorySystem::Write(const VAddr vaddr, const T data) {
         ASSERT_MSG(false, "Mapped memory page without a pointer @ {:08X}", vaddr);
         break;
     case PageType::RasterizerCachedMemory: {
-        RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Invalidate);
+        impl->RasterizerPrepareCpuWrite(vaddr, sizeof(T));
         std::memcpy(GetPointerForRasterizerCache(vaddr), &data, sizeof(T));
         break;
     }
@@ -563,7 +682,7 @@ bool MemorySystem::WriteExclusive(const VAddr vaddr, const T data, const T expec
         ASSERT_MSG(false, "Mapped memory page without a pointer @ {:08X}", vaddr);
         return true;
     case PageType::RasterizerCachedMemory: {
-        RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Invalidate);
+        impl->RasterizerPrepareCpuWrite(vaddr, sizeof(T));
         const auto volatile_pointer =
             reinterpret_cast<volatile T*>(GetPointerForRasterizerCache(vaddr).GetPtr());
         return Common::AtomicCompareAndSwap(volatile_pointer, data, expected);
@@ -722,6 +841,37 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
     if (start == 0) {
         return;
     }
+    if (impl->defer_cache_marks) {
+        std::scoped_lock lock{impl->cache_marks_mutex};
+        impl->cache_marks.push_back({start, size, cached});
+        impl->has_cache_marks.store(true, std::memory_order_release);
+        return;
+    }
+    MarkRegionCached(start, size, cached);
+}
+
+void MemorySystem::SetDeferRasterizerCacheMarks(bool defer) {
+    impl->defer_cache_marks = defer;
+}
+
+void MemorySystem::ApplyRasterizerCacheMarks() {
+    if (!impl->has_cache_marks.load(std::memory_order_acquire) ||
+        impl->system.IsRunningCoresInParallel()) {
+        return;
+    }
+
+    std::vector<Impl::CacheMark> marks;
+    {
+        std::scoped_lock lock{impl->cache_marks_mutex};
+        marks.swap(impl->cache_marks);
+        impl->has_cache_marks.store(false, std::memory_order_relaxed);
+    }
+    for (const auto& mark : marks) {
+        MarkRegionCached(mark.start, mark.size, mark.cached);
+    }
+}
+
+void MemorySystem::MarkRegionCached(PAddr start, u32 size, bool cached) {
 
     u32 num_pages = ((start + size - 1) >> CYTRUS_PAGE_BITS) - (start >> CYTRUS_PAGE_BITS) + 1;
     PAddr paddr = start;
@@ -729,6 +879,7 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
     for (unsigned i = 0; i < num_pages; ++i, paddr += CYTRUS_PAGE_SIZE) {
         for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
             impl->cache_marker.Mark(vaddr, cached);
+            impl->access_tracker.Set(vaddr, RasterizerAccessTracker::State::Unsynced);
             for (auto& page_table : impl->page_table_list) {
                 PageType& page_type = page_table->attributes[vaddr >> CYTRUS_PAGE_BITS];
 
@@ -768,6 +919,11 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
     }
 }
 
+void MemorySystem::RasterizerNotifyGpuAccess(PAddr start, u32 size, bool modified) {
+    using State = RasterizerAccessTracker::State;
+    impl->access_tracker.Demote(start, size, modified ? State::Unsynced : State::Flushed);
+}
+
 u8 MemorySystem::Read8(const VAddr addr) {
     return Read<u8>(addr);
 }
@@ -865,8 +1021,7 @@ void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_ad
             break;
         }
         case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Invalidate);
+            impl->RasterizerPrepareCpuWrite(current_vaddr, static_cast<u32>(copy_amount));
             std::memset(GetPointerForRasterizerCache(current_vaddr), 0, copy_amount);
             break;
         }
@@ -914,8 +1069,7 @@ void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
             break;
         }
         case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Flush);
+            impl->RasterizerPrepareCpuRead(current_vaddr, static_cast<u32>(copy_amount));
             WriteBlock(dest_process, dest_addr, GetPointerForRasterizerCache(current_vaddr),
                        copy_amount);
             break;
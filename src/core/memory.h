@@ -516,6 +516,28 @@ public:
      */
     void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
+    /**
+     * Makes RasterizerMarkRegionCached queue its page table updates instead of applying them.
+     * Used when the rasterizer runs on its own thread, so the page tables only ever change on the
+     * emulation thread while no core is executing.
+     */
+    void SetDeferRasterizerCacheMarks(bool defer);
+
+    /// Applies the page table updates queued by RasterizerMarkRegionCached, in order. This does
+    /// nothing while the cores are running in parallel.
+    void ApplyRasterizerCacheMarks();
+
+    /**
+     * Notifies that the rasterizer cache mirrored or modified the specified region, so the next
+     * CPU access to those pages has to synchronize with the rasterizer again.
+     *
+     * @param start    The physical address indicating the start of the address range.
+     * @param size     The size of the address range in bytes.
+     * @param modified True if the GPU holds data for the region that memory does not have yet,
+     *                 false if it only loaded a copy of the region.
+     */
+    void RasterizerNotifyGpuAccess(PAddr start, u32 size, bool modified);
+
     /// For a rasterizer-accessible PAddr, gets a list of all possible VAddr
     std::vector<VAddr> PhysicalToVirtualAddressForRasterizer(PAddr addr);
 
@@ -573,6 +595,8 @@ private:
 
     void MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef memory, PageType type);
 
+    void MarkRegionCached(PAddr start, u32 size, bool cached);
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl;
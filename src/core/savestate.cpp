@@ -2,15 +2,23 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
-#include <sstream>
+#include <optional>
+#include <thread>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/stream.hpp>
 #include <cryptopp/hex.h>
 #include <fmt/format.h>
 #include "common/archives.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/scm_rev.h"
+#include "common/settings.h"
 #include "common/swap.h"
+#include "common/thread_worker.h"
 #include "common/zstd_compression.h"
 #include "core/core.h"
 #include "core/movie.h"
@@ -28,14 +36,32 @@ struct CSTHeader {
     u64_le time;                   /// The time when this save state was created
     std::array<u8, 20> build_name; /// The build name (Canary/Nightly) with the version number
     u32_le zero = 0;               /// Should be zero, just in case.
+    u32_le flags = 0;              /// CSTFlags describing how the data is stored
+    u32_le base_slot = 0;          /// Slot of the full savestate a delta savestate is based on
+    u64_le base_hash = 0;          /// Hash of the uncompressed base, or own data when full
 
-    std::array<u8, 192> reserved{}; /// Make heading 256 bytes so it has consistent size
+    std::array<u8, 176> reserved{}; /// Make heading 256 bytes so it has consistent size
 };
 static_assert(sizeof(CSTHeader) == 256, "CSTHeader should be 256 bytes");
 #pragma pack(pop)
 
+enum CSTFlags : u32 {
+    /// The data is compressed against the data of the savestate in base_slot
+    CSTFlag_Delta = 1 << 0,
+};
+
 constexpr std::array<u8, 4> header_magic_bytes{{'C', 'S', 'T', 0x1B}};
 
+/// Same as ZSTD_CLEVEL_DEFAULT, which CompressDataZSTDDefault used to be called with.
+constexpr s32 SaveStateCompressionLevel = 3;
+
+/// Savestates queued for compression at once before saving blocks, bounding memory usage.
+constexpr u32 MaxPendingSaveStates = 2;
+
+static u32 SaveStateCompressionWorkers() {
+    return std::clamp(std::thread::hardware_concurrency() / 2, 1U, 8U);
+}
+
 static std::string GetSaveStatePath(u64 program_id, u64 movie_id, u32 slot) {
     if (movie_id) {
         return fmt::format("{}{:016X}.movie{:016X}.{:02d}.cst",
@@ -86,65 +112,73 @@ static bool ValidateSaveState(const CSTHeader& header, SaveStateInfo& info, u64
     return true;
 }
 
+/// Reads the header of the savestate in slot, returning nothing when there is no readable one.
+static std::optional<CSTHeader> ReadSaveStateHeader(u64 program_id, u64 movie_id, u32 slot) {
+    const auto path = GetSaveStatePath(program_id, movie_id, slot);
+    if (!FileUtil::Exists(path)) {
+        return std::nullopt;
+    }
+
+    FileUtil::IOFile file(path, "rb");
+    if (!file) {
+        LOG_ERROR(Core, "Could not open file {}", path);
+        return std::nullopt;
+    }
+    CSTHeader header;
+    if (file.GetSize() < sizeof(header)) {
+        LOG_ERROR(Core, "File too small {}", path);
+        return std::nullopt;
+    }
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        LOG_ERROR(Core, "Could not read from file {}", path);
+        return std::nullopt;
+    }
+    return header;
+}
+
 std::vector<SaveStateInfo> ListSaveStates(u64 program_id, u64 movie_id) {
+    std::array<std::optional<CSTHeader>, SaveStateSlotCount + 1> headers;
+    for (u32 slot = 1; slot <= SaveStateSlotCount; ++slot) {
+        headers[slot] = ReadSaveStateHeader(program_id, movie_id, slot);
+    }
+
     std::vector<SaveStateInfo> result;
     result.reserve(SaveStateSlotCount);
     for (u32 slot = 1; slot <= SaveStateSlotCount; ++slot) {
-        const auto path = GetSaveStatePath(program_id, movie_id, slot);
-        if (!FileUtil::Exists(path)) {
+        if (!headers[slot]) {
             continue;
         }
+        const CSTHeader& header = *headers[slot];
 
         SaveStateInfo info;
         info.slot = slot;
-
-        FileUtil::IOFile file(path, "rb");
-        if (!file) {
-            LOG_ERROR(Core, "Could not open file {}", path);
-            continue;
-        }
-        CSTHeader header;
-        if (file.GetSize() < sizeof(header)) {
-            LOG_ERROR(Core, "File too small {}", path);
-            continue;
-        }
-        if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
-            LOG_ERROR(Core, "Could not read from file {}", path);
-            continue;
-        }
         if (!ValidateSaveState(header, info, program_id, movie_id)) {
             continue;
         }
 
+        // Hide delta savestates that can no longer be loaded because their base was replaced.
+        if (header.flags & CSTFlag_Delta) {
+            const u32 base_slot = header.base_slot;
+            const bool has_base = base_slot >= 1 && base_slot <= SaveStateSlotCount &&
+                                  headers[base_slot] &&
+                                  !(headers[base_slot]->flags & CSTFlag_Delta) &&
+                                  headers[base_slot]->base_hash == header.base_hash;
+            if (!has_base) {
+                LOG_WARNING(Core, "Savestate in slot {} lost its base savestate in slot {}", slot,
+                            base_slot);
+                continue;
+            }
+        }
+
         result.emplace_back(std::move(info));
     }
     return result;
 }
 
-void System::SaveState(u32 slot) const {
-    std::ostringstream sstream{std::ios_base::binary};
-    // Serialize
-    oarchive oa{sstream};
-    oa&* this;
-
-    const std::string& str{sstream.str()};
-    const auto data = std::span<const u8>{reinterpret_cast<const u8*>(str.data()), str.size()};
-    auto buffer = Common::Compression::CompressDataZSTDDefault(data);
-
-    const u64 movie_id = movie.GetCurrentMovieID();
-    const auto path = GetSaveStatePath(title_id, movie_id, slot);
-    if (!FileUtil::CreateFullPath(path)) {
-        throw std::runtime_error("Could not create path " + path);
-    }
-
-    FileUtil::IOFile file(path, "wb");
-    if (!file) {
-        throw std::runtime_error("Could not open file " + path);
-    }
-
+static CSTHeader MakeSaveStateHeader(u64 program_id) {
     CSTHeader header{};
     header.filetype = header_magic_bytes;
-    header.program_id = title_id;
+    header.program_id = program_id;
     std::string rev_bytes;
     CryptoPP::StringSource ss(Common::g_scm_rev, true,
                               new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
@@ -156,52 +190,298 @@ void System::SaveState(u32 slot) const {
     std::memset(header.build_name.data(), 0, sizeof(header.build_name));
     std::memcpy(header.build_name.data(), build_fullname.c_str(),
                 std::min(build_fullname.length(), sizeof(header.build_name) - 1));
+    return header;
+}
 
-    if (file.WriteBytes(&header, sizeof(header)) != sizeof(header) ||
-        file.WriteBytes(buffer.data(), buffer.size()) != buffer.size()) {
-        throw std::runtime_error("Could not write to file " + path);
-    }
+static std::span<const u8> AsBytes(const std::string& data) {
+    return {reinterpret_cast<const u8*>(data.data()), data.size()};
 }
 
-void System::LoadState(u32 slot) {
-    if (Network::GetRoomMember().lock()->IsConnected()) {
-        throw std::runtime_error("Unable to load while connected to multiplayer");
+/// Reads, validates and decompresses a savestate. Delta savestates are resolved against base.
+static std::vector<u8> ReadSaveState(u32 slot, u64 program_id, u64 movie_id,
+                                     const SaveStateBase* base, CSTHeader& header) {
+    const auto path = GetSaveStatePath(program_id, movie_id, slot);
+    if (!FileUtil::Exists(path)) {
+        throw std::runtime_error("No savestate at " + path);
     }
 
-    const u64 movie_id = movie.GetCurrentMovieID();
-    const auto path = GetSaveStatePath(title_id, movie_id, slot);
+    std::vector<u8> buffer(FileUtil::GetSize(path) - sizeof(CSTHeader));
+
+    FileUtil::IOFile file(path, "rb");
+
+    // load header
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        throw std::runtime_error("Could not read from file at " + path);
+    }
+
+    // validate header
+    SaveStateInfo info;
+    info.slot = slot;
+    if (!ValidateSaveState(header, info, program_id, movie_id)) {
+        throw std::runtime_error("Invalid savestate");
+    }
+
+    if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size()) {
+        throw std::runtime_error("Could not read from file at " + path);
+    }
 
     std::vector<u8> decompressed;
+    if (header.flags & CSTFlag_Delta) {
+        std::vector<u8> base_from_file;
+        std::span<const u8> base_data;
+        if (base && base->slot == header.base_slot && base->hash == header.base_hash) {
+            base_data = AsBytes(*base->data);
+        } else {
+            CSTHeader base_header;
+            base_from_file = ReadSaveState(header.base_slot, program_id, movie_id, nullptr,
+                                           base_header);
+            if (base_header.flags & CSTFlag_Delta ||
+                Common::ComputeHash64(base_from_file.data(), base_from_file.size()) !=
+                    header.base_hash) {
+                throw std::runtime_error(fmt::format(
+                    "Savestate in slot {} was replaced, the delta savestate in slot {} can no "
+                    "longer be loaded",
+                    header.base_slot, slot));
+            }
+            base_data = base_from_file;
+        }
+        decompressed = Common::Compression::DecompressDataZSTD(buffer, base_data);
+    } else {
+        decompressed = Common::Compression::DecompressDataZSTD(buffer);
+    }
+    if (decompressed.empty()) {
+        throw std::runtime_error("Could not decompress savestate at " + path);
+    }
+    return decompressed;
+}
+
+/**
+ * Compresses and writes a serialized state. When base is set, the state is stored as a delta
+ * against it. When data is the base itself, the hash of the base is computed along the way.
+ */
+static void WriteSaveState(const std::string& path, CSTHeader header, const std::string& data,
+                           SaveStateBase* base) {
+    std::vector<u8> buffer;
+    if (base && base->data.get() != &data) {
+        header.flags = header.flags | CSTFlag_Delta;
+        header.base_slot = base->slot;
+        header.base_hash = base->hash;
+        buffer = Common::Compression::CompressDataZSTDParallel(
+            AsBytes(data), SaveStateCompressionLevel, SaveStateCompressionWorkers(),
+            AsBytes(*base->data));
+    } else {
+        header.flags = header.flags & ~CSTFlag_Delta;
+        header.base_slot = 0;
+        header.base_hash = Common::ComputeHash64(data.data(), data.size());
+        if (base) {
+            base->hash = header.base_hash;
+        }
+        buffer = Common::Compression::CompressDataZSTDParallel(
+            AsBytes(data), SaveStateCompressionLevel, SaveStateCompressionWorkers());
+    }
+    if (buffer.empty()) {
+        throw std::runtime_error("Could not compress savestate");
+    }
+
+    if (!FileUtil::CreateFullPath(path)) {
+        throw std::runtime_error("Could not create path " + path);
+    }
+
+    // Write to a temporary file first, so that listing savestates never sees a partial one.
+    const std::string temp_path = path + ".tmp";
     {
-        std::vector<u8> buffer(FileUtil::GetSize(path) - sizeof(CSTHeader));
+        FileUtil::IOFile file(temp_path, "wb");
+        if (!file) {
+            throw std::runtime_error("Could not open file " + temp_path);
+        }
+        if (file.WriteBytes(&header, sizeof(header)) != sizeof(header) ||
+            file.WriteBytes(buffer.data(), buffer.size()) != buffer.size()) {
+            throw std::runtime_error("Could not write to file " + temp_path);
+        }
+    }
+    // Replace the previous savestate in one step, so that a crash never loses both of them.
+    if (!FileUtil::Replace(temp_path, path)) {
+        throw std::runtime_error("Could not rename " + temp_path + " to " + path);
+    }
+}
+
+/**
+ * Rewrites the delta savestates based on the savestate in slot as full savestates, so that they
+ * can still be loaded after it is overwritten. base is used instead of the file when it matches.
+ */
+static void RebaseDependentSaveStates(u64 program_id, u64 movie_id, u32 slot,
+                                      const SaveStateBase* base) {
+    const auto base_header = ReadSaveStateHeader(program_id, movie_id, slot);
+    if (!base_header || base_header->flags & CSTFlag_Delta) {
+        return;
+    }
+    for (u32 other = 1; other <= SaveStateSlotCount; ++other) {
+        if (other == slot) {
+            continue;
+        }
+        const auto header = ReadSaveStateHeader(program_id, movie_id, other);
+        if (!header || !(header->flags & CSTFlag_Delta) ||
+            header->base_slot != slot || header->base_hash != base_header->base_hash) {
+            continue;
+        }
 
-        FileUtil::IOFile file(path, "rb");
+        CSTHeader full_header;
+        const std::vector<u8> data = ReadSaveState(other, program_id, movie_id, base, full_header);
+        WriteSaveState(GetSaveStatePath(program_id, movie_id, other), full_header,
+                       std::string(reinterpret_cast<const char*>(data.data()), data.size()),
+                       nullptr);
+        LOG_INFO(Core, "Rebased savestate in slot {} before overwriting slot {}", other, slot);
+    }
+}
 
-        // load header
-        CSTHeader header;
-        if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
-            throw std::runtime_error("Could not read from file at " + path);
+/**
+ * Writes a serialized state to slot, first rebasing the savestates that depend on the one it
+ * replaces. Delta savestates against a base that failed to be written are stored in full.
+ */
+static void StoreSaveState(u64 program_id, u64 movie_id, u32 slot, const CSTHeader& header,
+                           const std::string& data, SaveStateBase* base,
+                           const SaveStateBase* replaced_base) {
+    const bool is_base = base && base->data.get() == &data;
+    if (base && !is_base && base->failed) {
+        base = nullptr;
+    }
+    try {
+        RebaseDependentSaveStates(program_id, movie_id, slot, replaced_base);
+        WriteSaveState(GetSaveStatePath(program_id, movie_id, slot), header, data, base);
+    } catch (...) {
+        if (is_base) {
+            base->failed = true;
         }
+        throw;
+    }
+}
 
-        // validate header
-        SaveStateInfo info;
-        info.slot = slot;
-        if (!ValidateSaveState(header, info, title_id, movie_id)) {
-            throw std::runtime_error("Invalid savestate");
+void StoreSaveStateData(u64 program_id, u64 movie_id, u32 slot, const std::string& data,
+                        SaveStateBase* base, const SaveStateBase* replaced_base) {
+    StoreSaveState(program_id, movie_id, slot, MakeSaveStateHeader(program_id), data, base,
+                   replaced_base);
+}
+
+std::vector<u8> LoadSaveStateData(u64 program_id, u64 movie_id, u32 slot,
+                                  std::shared_ptr<SaveStateBase>& base, bool update_base) {
+    CSTHeader header;
+    std::vector<u8> decompressed = ReadSaveState(slot, program_id, movie_id, base.get(), header);
+    if (!update_base || header.flags & CSTFlag_Delta) {
+        return decompressed;
+    }
+
+    auto loaded_base = std::make_shared<SaveStateBase>();
+    loaded_base->slot = slot;
+    loaded_base->movie_id = movie_id;
+    loaded_base->data = std::make_shared<const std::string>(
+        reinterpret_cast<const char*>(decompressed.data()), decompressed.size());
+    loaded_base->hash =
+        Common::ComputeHash64(loaded_base->data->data(), loaded_base->data->size());
+
+    // Full states from older builds have no hash in their header, which delta savestates and
+    // ListSaveStates check their base against. Store the hash before relying on it.
+    if (header.base_hash != loaded_base->hash) {
+        try {
+            WriteSaveState(GetSaveStatePath(program_id, movie_id, slot), header,
+                           *loaded_base->data, loaded_base.get());
+        } catch (const std::exception& e) {
+            LOG_WARNING(Core, "Could not update savestate in slot {}: {}", slot, e.what());
+            loaded_base.reset();
         }
+    }
+    base = std::move(loaded_base);
+    return decompressed;
+}
 
-        if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size()) {
-            throw std::runtime_error("Could not read from file at " + path);
+void System::SaveState(u32 slot) {
+    // Serialize straight into the buffer that is handed to compression, sized after the last
+    // state so that it does not have to grow while serializing.
+    auto data = std::make_shared<std::string>();
+    data->reserve(last_savestate_size);
+    {
+        boost::iostreams::stream<boost::iostreams::back_insert_device<std::string>> stream{*data};
+        {
+            oarchive oa{stream};
+            oa&* this;
         }
-        decompressed = Common::Compression::DecompressDataZSTD(buffer);
+        stream.flush();
+    }
+    last_savestate_size = data->size();
+
+    const u64 movie_id = movie.GetCurrentMovieID();
+    const CSTHeader header = MakeSaveStateHeader(title_id);
+
+    // The base in memory speeds up rebasing the savestates that depend on the one overwritten.
+    std::shared_ptr<SaveStateBase> replaced_base;
+    if (savestate_base && savestate_base->slot == slot && savestate_base->movie_id == movie_id) {
+        replaced_base = savestate_base;
+    }
+
+    std::shared_ptr<SaveStateBase> base;
+    if (Settings::values.delta_savestates) {
+        // Overwriting the base slot, switching movies or failing to write the base starts over
+        // from a new full state.
+        if (!savestate_base || savestate_base->slot == slot ||
+            savestate_base->movie_id != movie_id || savestate_base->failed) {
+            savestate_base = std::make_shared<SaveStateBase>();
+            savestate_base->slot = slot;
+            savestate_base->movie_id = movie_id;
+            savestate_base->data = data;
+        }
+        base = savestate_base;
+    } else {
+        savestate_base.reset();
+    }
+
+    if (!Settings::values.async_savestates) {
+        StoreSaveState(title_id, movie_id, slot, header, *data, base.get(), replaced_base.get());
+        return;
     }
-    std::istringstream sstream{
-        std::string{reinterpret_cast<char*>(decompressed.data()), decompressed.size()},
-        std::ios_base::binary};
-    decompressed.clear();
+
+    if (!savestate_worker) {
+        savestate_worker = std::make_unique<Common::ThreadWorker>(1, "SaveState");
+    }
+    if (pending_savestates >= MaxPendingSaveStates) {
+        savestate_worker->WaitForRequests();
+    }
+    ++pending_savestates;
+    savestate_worker->QueueWork([this, program_id = title_id, movie_id, slot, header,
+                                 data = std::shared_ptr<const std::string>{std::move(data)},
+                                 base = std::move(base),
+                                 replaced_base = std::move(replaced_base)] {
+        try {
+            StoreSaveState(program_id, movie_id, slot, header, *data, base.get(),
+                           replaced_base.get());
+            LOG_INFO(Core, "Savestate written to slot {}", slot);
+        } catch (const std::exception& e) {
+            LOG_ERROR(Core, "Error writing savestate: {}", e.what());
+            std::scoped_lock lock{savestate_error_mutex};
+            savestate_error = fmt::format("Could not write savestate to slot {}: {}", slot,
+                                          e.what());
+            savestate_failed = true;
+        }
+        --pending_savestates;
+    });
+}
+
+void System::LoadState(u32 slot) {
+    if (Network::GetRoomMember().lock()->IsConnected()) {
+        throw std::runtime_error("Unable to load while connected to multiplayer");
+    }
+
+    // Make sure the savestate, and the base it may depend on, are completely written.
+    if (savestate_worker) {
+        savestate_worker->WaitForRequests();
+    }
+
+    const u64 movie_id = movie.GetCurrentMovieID();
+    const std::vector<u8> decompressed = LoadSaveStateData(
+        title_id, movie_id, slot, savestate_base, Settings::values.delta_savestates.GetValue());
 
     // Deserialize
-    iarchive ia{sstream};
+    boost::iostreams::stream<boost::iostreams::array_source> stream{
+        reinterpret_cast<const char*>(decompressed.data()), decompressed.size()};
+    iarchive ia{stream};
     ia&* this;
 }
 
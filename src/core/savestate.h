@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 #include "common/common_types.h"
@@ -22,6 +24,30 @@ struct SaveStateInfo {
 
 constexpr u32 SaveStateSlotCount = 10; // Maximum count of savestate slots
 
+/// A full savestate kept in memory, which delta savestates are stored against.
+struct SaveStateBase {
+    u32 slot;
+    u64 movie_id;
+    std::shared_ptr<const std::string> data; ///< Uncompressed serialized state
+    u64 hash = 0; ///< Hash of data. Set by whoever writes or reads the base savestate
+    std::atomic<bool> failed{}; ///< Set when writing the base savestate failed
+};
+
 std::vector<SaveStateInfo> ListSaveStates(u64 program_id, u64 movie_id);
 
+/**
+ * Writes a serialized state to slot, after rebasing the delta savestates that depend on
+ * replaced_base, the state currently in slot. The state is stored as a delta against base,
+ * unless base holds data itself.
+ */
+void StoreSaveStateData(u64 program_id, u64 movie_id, u32 slot, const std::string& data,
+                        SaveStateBase* base, const SaveStateBase* replaced_base);
+
+/**
+ * Reads a serialized state from slot, resolving delta savestates against base when it matches.
+ * If update_base is set and slot holds a full state, base is replaced by it.
+ */
+std::vector<u8> LoadSaveStateData(u64 program_id, u64 movie_id, u32 slot,
+                                  std::shared_ptr<SaveStateBase>& base, bool update_base);
+
 } // namespace Core
@@ -130,6 +130,10 @@ void Config::ReadValues() {
     // Core
     ReadSetting("Core", Settings::values.use_cpu_jit);
     ReadSetting("Core", Settings::values.cpu_clock_percentage);
+    ReadSetting("Core", Settings::values.parallel_cpu_cores);
+    ReadSetting("Core", Settings::values.deterministic_cpu_cores);
+    ReadSetting("Core", Settings::values.async_savestates);
+    ReadSetting("Core", Settings::values.delta_savestates);
 
     // Renderer
     ReadSetting("Renderer", Settings::values.graphics_api);
@@ -141,6 +145,9 @@ void Config::ReadValues() {
     ReadSetting("Renderer", Settings::values.use_hw_shader);
     ReadSetting("Renderer", Settings::values.shaders_accurate_mul);
     ReadSetting("Renderer", Settings::values.use_shader_jit);
+    ReadSetting("Renderer", Settings::values.async_shader_jit);
+    ReadSetting("Renderer", Settings::values.parallel_vertex_shading);
+    ReadSetting("Renderer", Settings::values.async_gpu);
     ReadSetting("Renderer", Settings::values.resolution_factor);
     ReadSetting("Renderer", Settings::values.use_disk_shader_cache);
     ReadSetting("Renderer", Settings::values.frame_limit);
@@ -184,6 +191,7 @@ void Config::ReadValues() {
     // Audio
     ReadSetting("Audio", Settings::values.audio_emulation);
     ReadSetting("Audio", Settings::values.enable_audio_stretching);
+    ReadSetting("Audio", Settings::values.parallel_hle_audio);
     ReadSetting("Audio", Settings::values.volume);
     ReadSetting("Audio", Settings::values.output_type);
     ReadSetting("Audio", Settings::values.output_device);
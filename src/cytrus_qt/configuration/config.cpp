@@ -281,6 +281,7 @@ void Config::ReadAudioValues() {
     ReadGlobalSetting(Settings::values.volume);
 
     if (global) {
+        ReadBasicSetting(Settings::values.parallel_hle_audio);
         ReadBasicSetting(Settings::values.output_type);
         ReadBasicSetting(Settings::values.output_device);
         ReadBasicSetting(Settings::values.input_type);
@@ -457,6 +458,10 @@ void Config::ReadCoreValues() {
 
     if (global) {
         ReadBasicSetting(Settings::values.use_cpu_jit);
+        ReadBasicSetting(Settings::values.parallel_cpu_cores);
+        ReadBasicSetting(Settings::values.deterministic_cpu_cores);
+        ReadBasicSetting(Settings::values.async_savestates);
+        ReadBasicSetting(Settings::values.delta_savestates);
         ReadBasicSetting(Settings::values.delay_start_for_lle_modules);
     }
 
@@ -666,6 +671,9 @@ void Config::ReadRendererValues() {
 
     if (global) {
         ReadBasicSetting(Settings::values.use_shader_jit);
+        ReadBasicSetting(Settings::values.async_shader_jit);
+        ReadBasicSetting(Settings::values.parallel_vertex_shading);
+        ReadBasicSetting(Settings::values.async_gpu);
     }
 
     qt_config->endGroup();
@@ -879,6 +887,7 @@ void Config::SaveAudioValues() {
     WriteGlobalSetting(Settings::values.volume);
 
     if (global) {
+        WriteBasicSetting(Settings::values.parallel_hle_audio);
         WriteBasicSetting(Settings::values.output_type);
         WriteBasicSetting(Settings::values.output_device);
         WriteBasicSetting(Settings::values.input_type);
@@ -995,6 +1004,10 @@ void Config::SaveCoreValues() {
 
     if (global) {
         WriteBasicSetting(Settings::values.use_cpu_jit);
+        WriteBasicSetting(Settings::values.parallel_cpu_cores);
+        WriteBasicSetting(Settings::values.deterministic_cpu_cores);
+        WriteBasicSetting(Settings::values.async_savestates);
+        WriteBasicSetting(Settings::values.delta_savestates);
         WriteBasicSetting(Settings::values.delay_start_for_lle_modules);
     }
 
@@ -1167,6 +1180,9 @@ void Config::SaveRendererValues() {
     if (global) {
         WriteSetting(QStringLiteral("use_shader_jit"), Settings::values.use_shader_jit.GetValue(),
                      true);
+        WriteBasicSetting(Settings::values.async_shader_jit);
+        WriteBasicSetting(Settings::values.parallel_vertex_shading);
+        WriteBasicSetting(Settings::values.async_gpu);
     }
 
     qt_config->endGroup();
@@ -28,6 +28,7 @@
 #include <QtDBus/QtDBus>
 #include "common/linux/gamemode.h"
 #endif
+#include "audio_core/dsp_interface.h"
 #include "common/arch.h"
 #include "common/common_paths.h"
 #include "common/detached_tasks.h"
@@ -416,8 +417,13 @@ void GMainWindow::InitializeWidgets() {
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
            "full-speed emulation this should be at most 16.67 ms."));
+    audio_latency_label = new QLabel();
+    audio_latency_label->setToolTip(
+        tr("Audio queued for output, and how often the output ran out of audio. Underruns cause "
+           "crackling and raise the latency until the output keeps up."));
 
-    for (auto& label : {emu_speed_label, game_fps_label, emu_frametime_label}) {
+    for (auto& label :
+         {emu_speed_label, game_fps_label, emu_frametime_label, audio_latency_label}) {
         label->setVisible(false);
         label->setFrameStyle(QFrame::NoFrame);
         label->setContentsMargins(4, 0, 4, 0);
@@ -1449,6 +1455,7 @@ void GMainWindow::ShutdownGame() {
     emu_speed_label->setVisible(false);
     game_fps_label->setVisible(false);
     emu_frametime_label->setVisible(false);
+    audio_latency_label->setVisible(false);
 
     UpdateSaveStates();
 
@@ -2610,10 +2617,15 @@ void GMainWindow::UpdateStatusBar() {
     }
     game_fps_label->setText(tr("Game: %1 FPS").arg(results.game_fps, 0, 'f', 0));
     emu_frametime_label->setText(tr("Frame: %1 ms").arg(results.frametime * 1000.0, 0, 'f', 2));
+    const auto audio_stats = system.DSP().GetOutputStats();
+    audio_latency_label->setText(tr("Audio: %1 ms, %n underrun(s)", "",
+                                    static_cast<int>(audio_stats.underruns))
+                                     .arg(audio_stats.latency_ms, 0, 'f', 0));
 
     emu_speed_label->setVisible(true);
     game_fps_label->setVisible(true);
     emu_frametime_label->setVisible(true);
+    audio_latency_label->setVisible(true);
 }
 
 void GMainWindow::UpdateBootHomeMenuState() {
@@ -3112,6 +3124,9 @@ void GMainWindow::RetranslateStatusBar() {
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
            "full-speed emulation this should be at most 16.67 ms."));
+    audio_latency_label->setToolTip(
+        tr("Audio queued for output, and how often the output ran out of audio. Underruns cause "
+           "crackling and raise the latency until the output keeps up."));
 
     multiplayer_state->retranslateUi();
 }
@@ -2,13 +2,19 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 #include <cryptopp/base64.h>
+#include <fmt/format.h>
+#include <httplib.h>
 
 #ifdef _WIN32
 // windows.h needs to be included before shellapi.h
@@ -29,6 +35,7 @@
 #include "network/network.h"
 #include "network/network_settings.h"
 #include "network/room.h"
+#include "network/room_shard.h"
 #include "network/verify_user.h"
 
 #ifdef ENABLE_WEB_SERVICE
@@ -57,6 +64,9 @@ static void PrintHelp(const char* argv0) {
                  "--ban-list-file     The file for storing the room ban list\n"
                  "--log-file          The file for storing the room log\n"
                  "--enable-cytrus-mods Allow Cytrus Community Moderators to moderate on your room\n"
+                 "--rooms             The number of rooms to host, on consecutive ports\n"
+                 "--shards            The number of I/O threads servicing the rooms\n"
+                 "--stats-port        The port of the HTTP endpoint reporting traffic per shard\n"
                  "-h, --help          Display this help and exit\n"
                  "-v, --version       Output version information and exit\n";
 }
@@ -149,6 +159,116 @@ static void SaveBanList(const Network::Room::BanList& ban_list, const std::strin
     file.flush();
 }
 
+/**
+ * Samples the traffic counters of the hosted rooms once per second and serves the resulting
+ * rates of every shard as JSON on /stats.
+ */
+class StatsServer {
+public:
+    StatsServer(std::vector<std::shared_ptr<Network::Room>> rooms_, std::vector<u32> room_shards_,
+                u32 num_shards_, u16 port)
+        : rooms{std::move(rooms_)}, room_shards{std::move(room_shards_)}, num_shards{num_shards_},
+          previous(num_shards_) {
+        Sample();
+        server.Get("/stats", [this](const httplib::Request&, httplib::Response& response) {
+            std::scoped_lock lock{report_mutex};
+            response.set_content(report, "application/json");
+        });
+        sample_thread = std::thread([this] { SampleLoop(); });
+        listen_thread = std::thread([this, port] {
+            if (!server.listen("0.0.0.0", port)) {
+                LOG_ERROR(Network, "Could not serve room statistics on port {}", port);
+            }
+        });
+    }
+
+    ~StatsServer() {
+        server.stop();
+        listen_thread.join();
+        {
+            std::scoped_lock lock{report_mutex};
+            stop_requested = true;
+        }
+        stop_cv.notify_all();
+        sample_thread.join();
+    }
+
+private:
+    struct ShardSample {
+        Network::Room::Statistics statistics{};
+        std::size_t num_members = 0;
+    };
+
+    void SampleLoop() {
+        std::unique_lock lock{report_mutex};
+        while (!stop_requested) {
+            stop_cv.wait_for(lock, std::chrono::seconds(1), [this] { return stop_requested; });
+            lock.unlock();
+            Sample();
+            lock.lock();
+        }
+    }
+
+    void Sample() {
+        std::vector<ShardSample> current(num_shards);
+        for (std::size_t i = 0; i < rooms.size(); i++) {
+            const Network::Room::Statistics statistics = rooms[i]->GetStatistics();
+            ShardSample& shard = current[room_shards[i]];
+            shard.statistics.packets_received += statistics.packets_received;
+            shard.statistics.bytes_received += statistics.bytes_received;
+            shard.statistics.packets_relayed += statistics.packets_relayed;
+            shard.statistics.bytes_relayed += statistics.bytes_relayed;
+            shard.num_members += rooms[i]->GetRoomMemberList().size();
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(now - previous_time).count();
+        const auto rate = [seconds](u64 current_value, u64 previous_value) {
+            return seconds > 0.0 ? static_cast<double>(current_value - previous_value) / seconds
+                                 : 0.0;
+        };
+
+        std::string new_report = "{\"shards\":[";
+        for (u32 shard = 0; shard < num_shards; shard++) {
+            const auto& now_stats = current[shard].statistics;
+            const auto& prev_stats = previous[shard].statistics;
+            new_report += fmt::format(
+                "{}{{\"id\":{},\"rooms\":{},\"members\":{},\"packets_received_per_sec\":{:.1f},"
+                "\"bytes_received_per_sec\":{:.1f},\"packets_relayed_per_sec\":{:.1f},"
+                "\"bytes_relayed_per_sec\":{:.1f}}}",
+                shard == 0 ? "" : ",", shard,
+                std::count(room_shards.begin(), room_shards.end(), shard),
+                current[shard].num_members,
+                rate(now_stats.packets_received, prev_stats.packets_received),
+                rate(now_stats.bytes_received, prev_stats.bytes_received),
+                rate(now_stats.packets_relayed, prev_stats.packets_relayed),
+                rate(now_stats.bytes_relayed, prev_stats.bytes_relayed));
+        }
+        new_report += "]}";
+
+        previous = std::move(current);
+        previous_time = now;
+        std::scoped_lock lock{report_mutex};
+        report = std::move(new_report);
+    }
+
+    std::vector<std::shared_ptr<Network::Room>> rooms;
+    std::vector<u32> room_shards; ///< Shard of every room
+    u32 num_shards;
+
+    std::vector<ShardSample> previous; ///< Counters at the previous sample
+    std::chrono::steady_clock::time_point previous_time{};
+
+    std::mutex report_mutex; ///< Mutex for report and stop_requested
+    std::condition_variable stop_cv;
+    std::string report;
+    bool stop_requested = false;
+
+    httplib::Server server;
+    std::thread listen_thread;
+    std::thread sample_thread;
+};
+
 static void InitializeLogging(const std::string& log_file) {
     Common::Log::Initialize(log_file);
     Common::Log::SetColorConsoleBackendEnabled(true);
@@ -174,6 +294,9 @@ int main(int argc, char** argv) {
     u16 port = Network::DefaultRoomPort;
     u32 max_members = 16;
     bool enable_cytrus_mods = false;
+    u32 num_rooms = 1;
+    u32 num_shards = 0;
+    u16 stats_port = 0;
 
     static struct option long_options[] = {
         {"room-name", required_argument, 0, 'n'},
@@ -189,6 +312,9 @@ int main(int argc, char** argv) {
         {"ban-list-file", required_argument, 0, 'b'},
         {"log-file", required_argument, 0, 'l'},
         {"enable-cytrus-mods", no_argument, 0, 'e'},
+        {"rooms", required_argument, 0, 'r'},
+        {"shards", required_argument, 0, 's'},
+        {"stats-port", required_argument, 0, 'S'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
@@ -237,6 +363,15 @@ int main(int argc, char** argv) {
             case 'e':
                 enable_cytrus_mods = true;
                 break;
+            case 'r':
+                num_rooms = static_cast<u32>(strtoul(optarg, &endarg, 0));
+                break;
+            case 's':
+                num_shards = static_cast<u32>(strtoul(optarg, &endarg, 0));
+                break;
+            case 'S':
+                stats_port = static_cast<u16>(strtoul(optarg, &endarg, 0));
+                break;
             case 'h':
                 PrintHelp(argv[0]);
                 return 0;
@@ -272,6 +407,17 @@ int main(int argc, char** argv) {
         PrintHelp(argv[0]);
         return -1;
     }
+    if (num_rooms == 0 || num_rooms > 65536U - port) {
+        std::cout << "rooms needs to be at least 1 and the ports of all rooms need to be in the "
+                     "range 0 - 65535!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
+    if (num_shards == 0 && num_rooms > 1) {
+        // By default every core gets a shard, and a room hosted alone keeps its own thread.
+        num_shards = std::min(num_rooms, std::max(std::thread::hardware_concurrency(), 1U));
+    }
+    num_shards = std::min(num_shards, num_rooms);
     if (ban_list_file.empty()) {
         std::cout << "Ban list file not set!\nThis should get set to load and save room ban "
                      "list.\nSet with --ban-list-file <file>\n\n";
@@ -306,40 +452,81 @@ int main(int argc, char** argv) {
 
     InitializeLogging(log_file);
 
-    // Load the ban list
-    Network::Room::BanList ban_list;
+    // Load the ban list, which is shared by all rooms
+    auto ban_list = std::make_shared<Network::Room::SharedBanList>();
     if (!ban_list_file.empty()) {
-        ban_list = LoadBanList(ban_list_file);
+        auto [username_ban_list, ip_ban_list] = LoadBanList(ban_list_file);
+        ban_list->username_ban_list = std::move(username_ban_list);
+        ban_list->ip_ban_list = std::move(ip_ban_list);
     }
 
-    std::unique_ptr<Network::VerifyUser::Backend> verify_backend;
+    std::shared_ptr<Network::VerifyUser::Backend> verify_backend;
     if (announce) {
 #ifdef ENABLE_WEB_SERVICE
         verify_backend =
-            std::make_unique<WebService::VerifyUserJWT>(NetSettings::values.web_api_url);
+            std::make_shared<WebService::VerifyUserJWT>(NetSettings::values.web_api_url);
 #else
         std::cout
             << "Cytrus Web Services is not available with this build: validation is disabled.\n\n";
-        verify_backend = std::make_unique<Network::VerifyUser::NullBackend>();
+        verify_backend = std::make_shared<Network::VerifyUser::NullBackend>();
 #endif
     } else {
-        verify_backend = std::make_unique<Network::VerifyUser::NullBackend>();
+        verify_backend = std::make_shared<Network::VerifyUser::NullBackend>();
     }
 
     Network::Init();
-    if (std::shared_ptr<Network::Room> room = Network::GetRoom().lock()) {
-        if (!room->Create(room_name, room_description, "", port, password, max_members, username,
-                          preferred_game, preferred_game_id, std::move(verify_backend), ban_list,
-                          enable_cytrus_mods)) {
-            std::cout << "Failed to create room: \n\n";
-            return -1;
+    std::vector<std::unique_ptr<Network::RoomShard>> shards;
+    for (u32 i = 0; i < num_shards; i++) {
+        shards.push_back(std::make_unique<Network::RoomShard>(i));
+    }
+
+    std::vector<std::shared_ptr<Network::Room>> rooms;
+    std::vector<u32> room_shards;
+    for (u32 i = 0; i < num_rooms; i++) {
+        // A single room is the global room, so it behaves exactly like before sharding existed.
+        std::shared_ptr<Network::Room> room =
+            num_rooms == 1 ? Network::GetRoom().lock() : std::make_shared<Network::Room>();
+        if (!room) {
+            break;
         }
-        std::cout << "Room is open. Close with Q+Enter...\n\n";
-        auto announce_session = std::make_unique<Network::AnnounceMultiplayerSession>();
-        if (announce) {
-            announce_session->Start();
+        const std::string name =
+            num_rooms == 1 ? room_name : fmt::format("{} {}", room_name, i + 1);
+        const u16 room_port = static_cast<u16>(port + i);
+        const u32 shard = shards.empty() ? 0 : i % num_shards;
+        if (!room->Create(name, room_description, "", room_port, password, max_members, username,
+                          preferred_game, preferred_game_id,
+                          std::make_unique<Network::VerifyUser::SharedBackend>(verify_backend), {},
+                          enable_cytrus_mods, ban_list,
+                          shards.empty() ? nullptr : shards[shard].get())) {
+            std::cout << "Failed to create room on port " << room_port << ": \n\n";
+            break;
+        }
+        rooms.push_back(std::move(room));
+        room_shards.push_back(shard);
+    }
+
+    if (rooms.size() == num_rooms) {
+        if (num_rooms == 1) {
+            std::cout << "Room is open. Close with Q+Enter...\n\n";
+        } else {
+            std::cout << num_rooms << " rooms are open on ports " << port << " - "
+                      << port + num_rooms - 1 << ", serviced by " << num_shards
+                      << " threads. Close with Q+Enter...\n\n";
         }
-        while (room->GetState() == Network::Room::State::Open) {
+        std::unique_ptr<StatsServer> stats_server;
+        if (stats_port != 0) {
+            stats_server = std::make_unique<StatsServer>(rooms, room_shards,
+                                                         std::max(num_shards, 1U), stats_port);
+        }
+        std::vector<std::unique_ptr<Network::AnnounceMultiplayerSession>> announce_sessions;
+        for (const auto& room : rooms) {
+            announce_sessions.push_back(
+                std::make_unique<Network::AnnounceMultiplayerSession>(room));
+            if (announce) {
+                announce_sessions.back()->Start();
+            }
+        }
+        while (rooms.front()->GetState() == Network::Room::State::Open) {
             std::string in;
             std::cin >> in;
             if (in.size() > 0) {
@@ -348,16 +535,24 @@ int main(int argc, char** argv) {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
         if (announce) {
-            announce_session->Stop();
+            for (auto& announce_session : announce_sessions) {
+                announce_session->Stop();
+            }
         }
-        announce_session.reset();
+        announce_sessions.clear();
+        stats_server.reset();
         // Save the ban list
         if (!ban_list_file.empty()) {
-            SaveBanList(room->GetBanList(), ban_list_file);
+            SaveBanList(rooms.front()->GetBanList(), ban_list_file);
         }
+    }
+    const bool all_rooms_created = rooms.size() == num_rooms;
+    for (auto& room : rooms) {
         room->Destroy();
     }
+    rooms.clear();
+    shards.clear();
     Network::Shutdown();
     detached_tasks.WaitForAllTasks();
-    return 0;
+    return all_rooms_created ? 0 : -1;
 }
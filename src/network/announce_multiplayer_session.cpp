@@ -30,8 +30,20 @@ AnnounceMultiplayerSession::AnnounceMultiplayerSession() {
 #endif
 }
 
+AnnounceMultiplayerSession::AnnounceMultiplayerSession(std::weak_ptr<Room> room)
+    : AnnounceMultiplayerSession() {
+    announced_room = std::move(room);
+}
+
+std::shared_ptr<Network::Room> AnnounceMultiplayerSession::GetAnnouncedRoom() const {
+    if (announced_room) {
+        return announced_room->lock();
+    }
+    return Network::GetRoom().lock();
+}
+
 Common::WebResult AnnounceMultiplayerSession::Register() {
-    std::shared_ptr<Network::Room> room = Network::GetRoom().lock();
+    std::shared_ptr<Network::Room> room = GetAnnouncedRoom();
     if (!room) {
         return Common::WebResult{Common::WebResult::Code::LibError, "Network is not initialized"};
     }
@@ -120,7 +132,7 @@ void AnnounceMultiplayerSession::AnnounceMultiplayerLoop() {
     std::future<Common::WebResult> future;
     while (!shutdown_event.WaitUntil(update_time)) {
         update_time += announce_time_interval;
-        std::shared_ptr<Network::Room> room = Network::GetRoom().lock();
+        std::shared_ptr<Network::Room> room = GetAnnouncedRoom();
         if (!room) {
             break;
         }
@@ -8,6 +8,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <thread>
 #include "common/announce_multiplayer_room.h"
@@ -27,6 +28,8 @@ class AnnounceMultiplayerSession : NonCopyable {
 public:
     using CallbackHandle = std::shared_ptr<std::function<void(const Common::WebResult&)>>;
     AnnounceMultiplayerSession();
+    /// Creates a session announcing the given room instead of the global one.
+    explicit AnnounceMultiplayerSession(std::weak_ptr<Room> room);
     ~AnnounceMultiplayerSession();
 
     /**
@@ -85,8 +88,12 @@ private:
     /// Backend interface that logs fields
     std::unique_ptr<AnnounceMultiplayerRoom::Backend> backend;
 
+    /// The room that is announced, the global room if not set
+    std::optional<std::weak_ptr<Room>> announced_room;
+
     std::atomic_bool registered = false; ///< Whether the room has been registered
 
+    std::shared_ptr<Network::Room> GetAnnouncedRoom() const;
     void UpdateBackendData(std::shared_ptr<Network::Room> room);
     void AnnounceMultiplayerLoop();
 };
@@ -2,21 +2,41 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <mutex>
 #include <random>
 #include <regex>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
 #include "common/logging/log.h"
 #include "enet/enet.h"
 #include "network/packet.h"
 #include "network/room.h"
+#include "network/room_shard.h"
 #include "network/verify_user.h"
 
 namespace Network {
 
+namespace {
+
+struct MacAddressHash {
+    std::size_t operator()(const MacAddress& mac) const noexcept {
+        u64 value = 0;
+        std::memcpy(&value, mac.data(), mac.size());
+        return std::hash<u64>{}(value);
+    }
+};
+
+} // Anonymous namespace
+
 class Room::RoomImpl {
 public:
     // This MAC address is used to generate a 'Nintendo' like Mac address.
@@ -43,13 +63,19 @@ public:
         ENetPeer* peer; ///< The remote peer.
     };
     using MemberList = std::vector<Member>;
-    MemberList members;              ///< Information about the members of this room
-    mutable std::mutex member_mutex; ///< Mutex for locking the members list
+    MemberList members; ///< Information about the members of this room
     /// This should be a std::shared_mutex as soon as C++17 is supported
+    mutable std::mutex member_mutex; ///< Mutex for locking the members list and member_peers
+    /// Peers of the members indexed by their MAC address, used to route wifi packets. Guarded by
+    /// member_mutex.
+    std::unordered_map<MacAddress, ENetPeer*, MacAddressHash> member_peers;
 
-    UsernameBanList username_ban_list; ///< List of banned usernames
-    IPBanList ip_ban_list;             ///< List of banned IP addresses
-    mutable std::mutex ban_list_mutex; ///< Mutex for the ban lists
+    std::shared_ptr<SharedBanList> ban_list; ///< Ban lists, possibly shared with other rooms
+
+    std::atomic<u64> packets_received{0}; ///< Packets received from members
+    std::atomic<u64> bytes_received{0};   ///< Bytes received from members
+    std::atomic<u64> packets_relayed{0};  ///< Wifi packets forwarded, once per recipient
+    std::atomic<u64> bytes_relayed{0};    ///< Bytes of the forwarded wifi packets
 
     RoomImpl()
         : NintendoOUI{0x00, 0x1F, 0x32, 0x00, 0x00, 0x00}, random_gen(std::random_device()()) {}
@@ -57,6 +83,9 @@ public:
     /// Thread that receives and dispatches network packets
     std::unique_ptr<std::thread> room_thread;
 
+    /// Shard servicing the room instead of room_thread, if any
+    RoomShard* shard = nullptr;
+
     /// Verification backend of the room
     std::unique_ptr<VerifyUser::Backend> verify_backend;
 
@@ -64,6 +93,18 @@ public:
     void ServerLoop();
     void StartLoop();
 
+    /// Waits up to timeout_ms for an event, then dispatches it and everything already queued.
+    void ServiceEvents(u32 timeout_ms);
+
+    /**
+     * Dispatches a single event received by the server.
+     * @return Whether ownership of the received packet was passed on to ENet.
+     */
+    bool HandleEvent(const ENetEvent& event);
+
+    /// Removes a member from the member list, member_mutex must be held.
+    void RemoveMember(MemberList::iterator member);
+
     /**
      * Parses and answers a room join request from a client.
      * Validates the uniqueness of the username and assigns the MAC address
@@ -222,10 +263,12 @@ public:
     MacAddress GenerateMacAddress();
 
     /**
-     * Broadcasts this packet to all members except the sender.
+     * Forwards this packet to its destination, or to all members except the sender for
+     * broadcasts. The received ENet packet is sent as is instead of being copied.
      * @param event The ENet event containing the data
+     * @return Whether the packet was passed on to ENet, in which case it must not be destroyed.
      */
-    void HandleWifiPacket(const ENetEvent* event);
+    bool HandleWifiPacket(const ENetEvent* event);
 
     /**
      * Extracts a chat entry from a received ENet packet and adds it to the chat queue.
@@ -249,52 +292,78 @@ public:
 // RoomImpl
 void Room::RoomImpl::ServerLoop() {
     while (state != State::Closed) {
-        ENetEvent event;
-        if (enet_host_service(server, &event, 16) > 0) {
-            switch (event.type) {
-            case ENET_EVENT_TYPE_RECEIVE:
-                switch (event.packet->data[0]) {
-                case IdJoinRequest:
-                    HandleJoinRequest(&event);
-                    break;
-                case IdSetGameInfo:
-                    HandleGameNamePacket(&event);
-                    break;
-                case IdWifiPacket:
-                    HandleWifiPacket(&event);
-                    break;
-                case IdChatMessage:
-                    HandleChatPacket(&event);
-                    break;
-                // Moderation
-                case IdModKick:
-                    HandleModKickPacket(&event);
-                    break;
-                case IdModBan:
-                    HandleModBanPacket(&event);
-                    break;
-                case IdModUnban:
-                    HandleModUnbanPacket(&event);
-                    break;
-                case IdModGetBanList:
-                    HandleModGetBanListPacket(&event);
-                    break;
-                }
-                enet_packet_destroy(event.packet);
-                break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                HandleClientDisconnection(event.peer);
-                break;
-            case ENET_EVENT_TYPE_NONE:
-            case ENET_EVENT_TYPE_CONNECT:
-                break;
-            }
-        }
+        ServiceEvents(16);
     }
     // Close the connection to all members:
     SendCloseMessage();
 }
 
+void Room::RoomImpl::ServiceEvents(u32 timeout_ms) {
+    ENetEvent event;
+    if (enet_host_service(server, &event, timeout_ms) <= 0) {
+        return;
+    }
+
+    // Dispatch everything that is already queued, so the packets relayed for these events
+    // go out with a single flush.
+    do {
+        if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+            packets_received.fetch_add(1, std::memory_order_relaxed);
+            bytes_received.fetch_add(event.packet->dataLength, std::memory_order_relaxed);
+        }
+        const bool packet_forwarded = HandleEvent(event);
+        if (event.type == ENET_EVENT_TYPE_RECEIVE && !packet_forwarded) {
+            enet_packet_destroy(event.packet);
+        }
+    } while (enet_host_check_events(server, &event) > 0);
+    enet_host_flush(server);
+}
+
+bool Room::RoomImpl::HandleEvent(const ENetEvent& event) {
+    switch (event.type) {
+    case ENET_EVENT_TYPE_RECEIVE:
+        switch (event.packet->data[0]) {
+        case IdJoinRequest:
+            HandleJoinRequest(&event);
+            break;
+        case IdSetGameInfo:
+            HandleGameNamePacket(&event);
+            break;
+        case IdWifiPacket:
+            return HandleWifiPacket(&event);
+        case IdChatMessage:
+            HandleChatPacket(&event);
+            break;
+        // Moderation
+        case IdModKick:
+            HandleModKickPacket(&event);
+            break;
+        case IdModBan:
+            HandleModBanPacket(&event);
+            break;
+        case IdModUnban:
+            HandleModUnbanPacket(&event);
+            break;
+        case IdModGetBanList:
+            HandleModGetBanListPacket(&event);
+            break;
+        }
+        break;
+    case ENET_EVENT_TYPE_DISCONNECT:
+        HandleClientDisconnection(event.peer);
+        break;
+    case ENET_EVENT_TYPE_NONE:
+    case ENET_EVENT_TYPE_CONNECT:
+        break;
+    }
+    return false;
+}
+
+void Room::RoomImpl::RemoveMember(MemberList::iterator member) {
+    member_peers.erase(member->mac_address);
+    members.erase(member);
+}
+
 void Room::RoomImpl::StartLoop() {
     room_thread = std::make_unique<std::thread>(&Room::RoomImpl::ServerLoop, this);
 }
@@ -375,7 +444,9 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
 
     std::string ip;
     {
-        std::lock_guard lock(ban_list_mutex);
+        std::lock_guard lock(ban_list->mutex);
+        const auto& username_ban_list = ban_list->username_ban_list;
+        const auto& ip_ban_list = ban_list->ip_ban_list;
 
         // Check username ban
         if (!member.user_data.username.empty() &&
@@ -402,6 +473,7 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
 
     {
         std::lock_guard lock(member_mutex);
+        member_peers.insert_or_assign(member.mac_address, member.peer);
         members.push_back(std::move(member));
     }
 
@@ -448,7 +520,7 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
         ip = ip_raw;
 
         enet_peer_disconnect(target_member->peer, 0);
-        members.erase(target_member);
+        RemoveMember(target_member);
     }
 
     // Announce the change to all clients.
@@ -491,11 +563,13 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
         ip = ip_raw;
 
         enet_peer_disconnect(target_member->peer, 0);
-        members.erase(target_member);
+        RemoveMember(target_member);
     }
 
     {
-        std::lock_guard lock(ban_list_mutex);
+        std::lock_guard lock(ban_list->mutex);
+        auto& username_ban_list = ban_list->username_ban_list;
+        auto& ip_ban_list = ban_list->ip_ban_list;
 
         if (!username.empty()) {
             // Ban the forum username
@@ -532,7 +606,9 @@ void Room::RoomImpl::HandleModUnbanPacket(const ENetEvent* event) {
 
     bool unbanned = false;
     {
-        std::lock_guard lock(ban_list_mutex);
+        std::lock_guard lock(ban_list->mutex);
+        auto& username_ban_list = ban_list->username_ban_list;
+        auto& ip_ban_list = ban_list->ip_ban_list;
 
         auto it = std::find(username_ban_list.begin(), username_ban_list.end(), address);
         if (it != username_ban_list.end()) {
@@ -736,9 +812,9 @@ void Room::RoomImpl::SendModBanListResponse(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdModBanListResponse);
     {
-        std::lock_guard lock(ban_list_mutex);
-        packet << username_ban_list;
-        packet << ip_ban_list;
+        std::lock_guard lock(ban_list->mutex);
+        packet << ban_list->username_ban_list;
+        packet << ban_list->ip_ban_list;
     }
 
     ENetPacket* enet_packet =
@@ -845,52 +921,52 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
     return result_mac;
 }
 
-void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
-    in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
+bool Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
+    // Message type, WifiPacket type and channel, followed by the transmitter address
+    constexpr std::size_t DestinationOffset = 3 * sizeof(u8) + sizeof(MacAddress);
+
+    ENetPacket* enet_packet = event->packet;
+    if (enet_packet->dataLength < DestinationOffset + sizeof(MacAddress)) {
+        LOG_ERROR(Network, "Received truncated wifi packet of {} bytes", enet_packet->dataLength);
+        return false;
+    }
     MacAddress destination_address;
-    in_packet >> destination_address;
+    std::memcpy(destination_address.data(), enet_packet->data + DestinationOffset,
+                destination_address.size());
 
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    // The payload is relayed unchanged, so the received packet is sent on directly. ENet frees
+    // it once every peer it was queued for is done with it.
+    enet_packet->flags |= ENET_PACKET_FLAG_RELIABLE;
 
+    std::lock_guard lock(member_mutex);
     if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
-        std::lock_guard lock(member_mutex);
-        bool sent_packet = false;
+        u64 recipients = 0;
         for (const auto& member : members) {
-            if (member.peer != event->peer) {
-                sent_packet = true;
-                enet_peer_send(member.peer, 0, enet_packet);
+            if (member.peer != event->peer && enet_peer_send(member.peer, 0, enet_packet) == 0) {
+                recipients++;
             }
         }
+        packets_relayed.fetch_add(recipients, std::memory_order_relaxed);
+        bytes_relayed.fetch_add(recipients * enet_packet->dataLength, std::memory_order_relaxed);
+        return recipients != 0;
+    }
 
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
-        }
-    } else { // Send the data only to the destination client
-        std::lock_guard lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(),
-                                   [destination_address](const Member& member) -> bool {
-                                       return member.mac_address == destination_address;
-                                   });
-        if (member != members.end()) {
-            enet_peer_send(member->peer, 0, enet_packet);
-        } else {
-            LOG_ERROR(Network,
-                      "Attempting to send to unknown MAC address: "
-                      "{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}",
-                      destination_address[0], destination_address[1], destination_address[2],
-                      destination_address[3], destination_address[4], destination_address[5]);
-            enet_packet_destroy(enet_packet);
-        }
+    // Send the data only to the destination client
+    const auto member = member_peers.find(destination_address);
+    if (member == member_peers.end()) {
+        LOG_ERROR(Network,
+                  "Attempting to send to unknown MAC address: "
+                  "{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}",
+                  destination_address[0], destination_address[1], destination_address[2],
+                  destination_address[3], destination_address[4], destination_address[5]);
+        return false;
     }
-    enet_host_flush(server);
+    if (enet_peer_send(member->second, 0, enet_packet) != 0) {
+        return false;
+    }
+    packets_relayed.fetch_add(1, std::memory_order_relaxed);
+    bytes_relayed.fetch_add(enet_packet->dataLength, std::memory_order_relaxed);
+    return true;
 }
 
 void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
@@ -992,7 +1068,7 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
             enet_address_get_host_ip(&member->peer->address, ip_raw, sizeof(ip_raw) - 1);
             ip = ip_raw;
 
-            members.erase(member);
+            RemoveMember(member);
         }
     }
 
@@ -1013,7 +1089,8 @@ bool Room::Create(const std::string& name, const std::string& description,
                   const u32 max_connections, const std::string& host_username,
                   const std::string& preferred_game, u64 preferred_game_id,
                   std::unique_ptr<VerifyUser::Backend> verify_backend,
-                  const Room::BanList& ban_list, bool enable_cytrus_mods) {
+                  const Room::BanList& ban_list, bool enable_cytrus_mods,
+                  std::shared_ptr<SharedBanList> shared_ban_list, RoomShard* shard) {
     ENetAddress address;
     address.host = ENET_HOST_ANY;
     if (!server_address.empty()) {
@@ -1039,10 +1116,24 @@ bool Room::Create(const std::string& name, const std::string& description,
     room_impl->room_information.enable_cytrus_mods = enable_cytrus_mods;
     room_impl->password = password;
     room_impl->verify_backend = std::move(verify_backend);
-    room_impl->username_ban_list = ban_list.first;
-    room_impl->ip_ban_list = ban_list.second;
-
-    room_impl->StartLoop();
+    if (shared_ban_list) {
+        room_impl->ban_list = std::move(shared_ban_list);
+    } else {
+        room_impl->ban_list = std::make_shared<SharedBanList>();
+        room_impl->ban_list->username_ban_list = ban_list.first;
+        room_impl->ban_list->ip_ban_list = ban_list.second;
+    }
+    room_impl->packets_received = 0;
+    room_impl->bytes_received = 0;
+    room_impl->packets_relayed = 0;
+    room_impl->bytes_relayed = 0;
+
+    room_impl->shard = shard;
+    if (shard) {
+        shard->AddRoom(this);
+    } else {
+        room_impl->StartLoop();
+    }
     return true;
 }
 
@@ -1060,8 +1151,17 @@ std::string Room::GetVerifyUID() const {
 }
 
 Room::BanList Room::GetBanList() const {
-    std::lock_guard lock(room_impl->ban_list_mutex);
-    return {room_impl->username_ban_list, room_impl->ip_ban_list};
+    std::lock_guard lock(room_impl->ban_list->mutex);
+    return {room_impl->ban_list->username_ban_list, room_impl->ban_list->ip_ban_list};
+}
+
+Room::Statistics Room::GetStatistics() const {
+    return {
+        .packets_received = room_impl->packets_received.load(std::memory_order_relaxed),
+        .bytes_received = room_impl->bytes_received.load(std::memory_order_relaxed),
+        .packets_relayed = room_impl->packets_relayed.load(std::memory_order_relaxed),
+        .bytes_relayed = room_impl->bytes_relayed.load(std::memory_order_relaxed),
+    };
 }
 
 std::vector<Room::Member> Room::GetRoomMemberList() const {
@@ -1089,10 +1189,39 @@ void Room::SetVerifyUID(const std::string& uid) {
     room_impl->verify_UID = uid;
 }
 
+void Room::ServiceRooms(std::span<Room* const> rooms, u32 timeout_ms, bool service_idle_rooms) {
+    // select() is undefined for sockets at or above FD_SETSIZE, which a server hosting many rooms
+    // reaches quickly, so the sockets are polled instead.
+    thread_local std::vector<pollfd> poll_fds;
+    poll_fds.clear();
+    for (const Room* room : rooms) {
+        poll_fds.push_back({.fd = room->room_impl->server->socket, .events = POLLIN, .revents = 0});
+    }
+    // ENet can only wait on a single host, so wait on all sockets at once and then service the
+    // rooms that received data without blocking.
+#ifdef _WIN32
+    WSAPoll(poll_fds.data(), static_cast<ULONG>(poll_fds.size()), static_cast<INT>(timeout_ms));
+#else
+    poll(poll_fds.data(), static_cast<nfds_t>(poll_fds.size()), static_cast<int>(timeout_ms));
+#endif
+    for (std::size_t i = 0; i < rooms.size(); i++) {
+        if (service_idle_rooms || poll_fds[i].revents != 0) {
+            rooms[i]->room_impl->ServiceEvents(0);
+        }
+    }
+}
+
 void Room::Destroy() {
     room_impl->state = State::Closed;
-    room_impl->room_thread->join();
-    room_impl->room_thread.reset();
+    if (room_impl->shard) {
+        room_impl->shard->RemoveRoom(this);
+        room_impl->shard = nullptr;
+        // The shard no longer services the room, so close the connections from here.
+        room_impl->SendCloseMessage();
+    } else {
+        room_impl->room_thread->join();
+        room_impl->room_thread.reset();
+    }
 
     if (room_impl->server) {
         enet_host_destroy(room_impl->server);
@@ -1102,6 +1231,7 @@ void Room::Destroy() {
     {
         std::lock_guard lock(room_impl->member_mutex);
         room_impl->members.clear();
+        room_impl->member_peers.clear();
     }
     room_impl->room_information.member_slots = 0;
     room_impl->room_information.name.clear();
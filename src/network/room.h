@@ -6,6 +6,8 @@
 
 #include <array>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <string>
 #include <vector>
 #include "common/common_types.h"
@@ -87,6 +89,8 @@ enum StatusMessageTypes : u8 {
     IdAddressUnbanned, ///< A username / ip address is unbanned from the room
 };
 
+class RoomShard;
+
 /// This is what a server [person creating a server] would use.
 class Room final {
 public:
@@ -137,9 +141,26 @@ public:
 
     using BanList = std::pair<UsernameBanList, IPBanList>;
 
+    /// Ban lists that can be shared by several rooms, so that a ban in one applies to all.
+    struct SharedBanList {
+        UsernameBanList username_ban_list; ///< List of banned usernames
+        IPBanList ip_ban_list;             ///< List of banned IP addresses
+        std::mutex mutex;                  ///< Mutex for the ban lists
+    };
+
+    /// Traffic counters of a room, accumulated since the room was created.
+    struct Statistics {
+        u64 packets_received = 0; ///< Packets received from members.
+        u64 bytes_received = 0;   ///< Bytes received from members.
+        u64 packets_relayed = 0;  ///< Wifi packets forwarded to members, once per recipient.
+        u64 bytes_relayed = 0;    ///< Bytes of the forwarded wifi packets, once per recipient.
+    };
+
     /**
      * Creates the socket for this room. Will bind to default address if
      * server is empty string.
+     * @param shared_ban_list Ban lists shared with other rooms. When set, ban_list is ignored.
+     * @param shard Shard whose thread services the room. When null, the room starts its own thread.
      */
     bool Create(const std::string& name, const std::string& description = "",
                 const std::string& server = "", u16 server_port = DefaultRoomPort,
@@ -148,7 +169,9 @@ public:
                 const std::string& host_username = "", const std::string& preferred_game = "",
                 u64 preferred_game_id = 0,
                 std::unique_ptr<VerifyUser::Backend> verify_backend = nullptr,
-                const BanList& ban_list = {}, bool enable_cytrus_mods = false);
+                const BanList& ban_list = {}, bool enable_cytrus_mods = false,
+                std::shared_ptr<SharedBanList> shared_ban_list = nullptr,
+                RoomShard* shard = nullptr);
 
     /**
      * Sets the verification GUID of the room.
@@ -160,12 +183,28 @@ public:
      */
     BanList GetBanList() const;
 
+    /**
+     * Gets the traffic counters of the room.
+     */
+    Statistics GetStatistics() const;
+
     /**
      * Destroys the socket
      */
     void Destroy();
 
 private:
+    friend class RoomShard;
+
+    /**
+     * Waits up to timeout_ms for any of the rooms to receive data, then dispatches the pending
+     * events of the rooms that did. Used by RoomShard to service several rooms from one thread.
+     * @param service_idle_rooms Also service the rooms without data, for ENet's timeouts and
+     *                           resends.
+     */
+    static void ServiceRooms(std::span<Room* const> rooms, u32 timeout_ms,
+                             bool service_idle_rooms);
+
     class RoomImpl;
     std::unique_ptr<RoomImpl> room_impl;
 };
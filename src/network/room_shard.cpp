@@ -0,0 +1,81 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
+#include "common/thread.h"
+#include "network/room_shard.h"
+
+namespace Network {
+
+/// Interval at which the rooms without incoming data are serviced
+constexpr auto FullPassInterval = std::chrono::milliseconds{16};
+
+RoomShard::RoomShard(u32 id_) : id{id_}, service_thread{&RoomShard::ServiceLoop, this} {}
+
+RoomShard::~RoomShard() {
+    {
+        std::scoped_lock lock{rooms_mutex};
+        running = false;
+    }
+    rooms_cv.notify_all();
+    service_thread.join();
+}
+
+u32 RoomShard::GetId() const {
+    return id;
+}
+
+void RoomShard::AddRoom(Room* room) {
+    {
+        std::scoped_lock lock{rooms_mutex};
+        rooms.push_back(room);
+    }
+    rooms_cv.notify_all();
+}
+
+void RoomShard::RemoveRoom(Room* room) {
+    std::unique_lock lock{rooms_mutex};
+    if (std::erase(rooms, room) == 0) {
+        return;
+    }
+    // The service thread may still be using a snapshot that contains the room. The next snapshot
+    // is only taken after it is done with it.
+    const u64 next_iteration = iteration + 1;
+    rooms_cv.wait(lock, [this, next_iteration] { return iteration >= next_iteration; });
+}
+
+void RoomShard::ServiceLoop() {
+    const std::string name = fmt::format("RoomShard{}", id);
+    Common::SetCurrentThreadName(name.c_str());
+
+    // Rooms are serviced from a snapshot, so adding or removing a room never has to wait for the
+    // lock while the thread is blocked on the sockets.
+    std::vector<Room*> serviced_rooms;
+    auto next_full_pass = std::chrono::steady_clock::now();
+    while (true) {
+        {
+            std::unique_lock lock{rooms_mutex};
+            iteration++;
+            rooms_cv.notify_all();
+            rooms_cv.wait(lock, [this] { return !running || !rooms.empty(); });
+            if (!running) {
+                break;
+            }
+            serviced_rooms = rooms;
+        }
+
+        // A busy room wakes the thread up constantly. The idle rooms only need servicing for
+        // ENet's timeouts and resends, as often as a room with its own thread does.
+        const auto now = std::chrono::steady_clock::now();
+        const bool full_pass = now >= next_full_pass;
+        if (full_pass) {
+            next_full_pass = now + FullPassInterval;
+        }
+        Room::ServiceRooms(serviced_rooms, 16, full_pass);
+    }
+}
+
+} // namespace Network
@@ -0,0 +1,54 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+#include "network/room.h"
+
+namespace Network {
+
+/**
+ * An I/O thread servicing several rooms, each with its own ENet host.
+ * Rooms are pinned to a shard by passing it to Room::Create and leave it in Room::Destroy.
+ */
+class RoomShard final {
+public:
+    explicit RoomShard(u32 id);
+    ~RoomShard();
+
+    RoomShard(const RoomShard&) = delete;
+    RoomShard& operator=(const RoomShard&) = delete;
+
+    /**
+     * Gets the index of this shard.
+     */
+    u32 GetId() const;
+
+private:
+    friend class Room;
+
+    /// Starts servicing a room. The room must already have created its host.
+    void AddRoom(Room* room);
+
+    /// Stops servicing a room. Once this returns the room is not touched by the shard anymore.
+    void RemoveRoom(Room* room);
+
+    /// Thread function that services the rooms until the shard is destroyed.
+    void ServiceLoop();
+
+    u32 id;
+    std::vector<Room*> rooms;         ///< Rooms pinned to this shard
+    std::mutex rooms_mutex;           ///< Mutex for rooms, iteration and running
+    std::condition_variable rooms_cv; ///< Signalled when rooms, iteration or running changes
+    u64 iteration = 0;                ///< Number of times the service thread took a snapshot
+    bool running = true;              ///< Whether the service thread should keep running
+    std::thread service_thread;       ///< Thread that receives and dispatches network packets
+};
+
+} // namespace Network
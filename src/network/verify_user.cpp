@@ -15,4 +15,12 @@ UserData NullBackend::LoadUserData([[maybe_unused]] const std::string& verify_UI
     return {};
 }
 
+SharedBackend::SharedBackend(std::shared_ptr<Backend> backend_) : backend(std::move(backend_)) {}
+
+SharedBackend::~SharedBackend() = default;
+
+UserData SharedBackend::LoadUserData(const std::string& verify_UID, const std::string& token) {
+    return backend->LoadUserData(verify_UID, token);
+}
+
 } // namespace Network::VerifyUser
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include "common/logging/log.h"
 
@@ -43,4 +44,19 @@ public:
     UserData LoadUserData(const std::string& verify_UID, const std::string& token) override;
 };
 
+/**
+ * A backend that forwards to a backend shared by several rooms.
+ * The shared backend is called from the threads of all those rooms, so it must be thread-safe.
+ */
+class SharedBackend final : public Backend {
+public:
+    explicit SharedBackend(std::shared_ptr<Backend> backend);
+    ~SharedBackend();
+
+    UserData LoadUserData(const std::string& verify_UID, const std::string& token) override;
+
+private:
+    std::shared_ptr<Backend> backend;
+};
+
 } // namespace Network::VerifyUser
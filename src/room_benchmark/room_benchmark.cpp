@@ -0,0 +1,377 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "common/common_types.h"
+#include "common/logging/backend.h"
+#include "common/scm_rev.h"
+#include "network/network.h"
+#include "network/room.h"
+#include "network/room_member.h"
+#include "network/room_shard.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options]\n"
+                 "--clients           The number of synthetic room members (2 - 254)\n"
+                 "--broadcast-rate    Broadcast wifi packets sent per second by every member\n"
+                 "--unicast-rate      Unicast wifi packets sent per second by every member\n"
+                 "--payload-size      The size of the wifi packet payloads in bytes\n"
+                 "--duration          The length of the measurement in seconds\n"
+                 "--warmup            The time to run before measuring, in seconds\n"
+                 "--port              The port used for the room\n"
+                 "--shard             Service the room from a RoomShard instead of its own thread\n"
+                 "--log-file          The file for storing the benchmark log\n"
+                 "-h, --help          Display this help and exit\n"
+                 "-v, --version       Output version information and exit\n"
+                 "\n"
+                 "The room and all members run in this process on localhost. Latency is measured\n"
+                 "from SendWifiPacket to the receive callback of the destination member, so it\n"
+                 "includes the time the member loop takes to pick up queued packets.\n";
+}
+
+static void PrintVersion() {
+    std::cout << "Cytrus room benchmark " << Common::g_scm_branch << " " << Common::g_scm_desc
+              << " Libnetwork: " << Network::network_version << std::endl;
+}
+
+/// Header written at the start of every payload, used to measure the relay latency.
+struct PayloadHeader {
+    s64 send_time_ns; ///< Clock time at which the packet was queued by the sender.
+    u32 sender;       ///< Index of the sending member.
+    u32 sequence;     ///< Per sender sequence number.
+};
+
+struct BenchmarkMember {
+    Network::RoomMember member;
+    Network::RoomMember::CallbackHandle<Network::WifiPacket> wifi_handle;
+    std::vector<s64> latencies_ns; ///< Written by the member thread only while it is connected
+    u64 packets_received = 0;
+    u32 sequence = 0;
+    double broadcast_credit = 0.0;
+    double unicast_credit = 0.0;
+};
+
+/// Returns the current time of the latency clock, in nanoseconds.
+static s64 GetTimeNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch())
+        .count();
+}
+
+/// Returns the CPU time used by the whole process, in nanoseconds.
+static s64 GetProcessCpuTimeNs() {
+#ifdef _WIN32
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time,
+                         &user_time)) {
+        return 0;
+    }
+    const auto to_ns = [](const FILETIME& time) {
+        return ((static_cast<s64>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 100;
+    };
+    return to_ns(kernel_time) + to_ns(user_time);
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    const auto to_ns = [](const timeval& time) {
+        return static_cast<s64>(time.tv_sec) * 1000000000 + static_cast<s64>(time.tv_usec) * 1000;
+    };
+    return to_ns(usage.ru_utime) + to_ns(usage.ru_stime);
+#endif
+}
+
+static s64 Percentile(const std::vector<s64>& sorted, double percentile) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    const auto index = static_cast<std::size_t>(percentile * static_cast<double>(sorted.size()));
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+/// Application entry point
+int main(int argc, char** argv) {
+    int option_index = 0;
+    char* endarg;
+
+    u32 num_clients = 64;
+    double broadcast_rate = 10.0;
+    double unicast_rate = 50.0;
+    u32 payload_size = 512;
+    double duration = 10.0;
+    double warmup = 2.0;
+    u16 port = Network::DefaultRoomPort;
+    bool use_shard = false;
+    std::string log_file = "cytrus-room-benchmark.log";
+
+    static struct option long_options[] = {
+        {"clients", required_argument, 0, 'c'},
+        {"broadcast-rate", required_argument, 0, 'b'},
+        {"unicast-rate", required_argument, 0, 'u'},
+        {"payload-size", required_argument, 0, 's'},
+        {"duration", required_argument, 0, 'd'},
+        {"warmup", required_argument, 0, 'w'},
+        {"port", required_argument, 0, 'p'},
+        {"shard", no_argument, 0, 'S'},
+        {"log-file", required_argument, 0, 'l'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "c:b:u:s:d:w:p:Sl:hv", long_options, &option_index);
+        if (arg != -1) {
+            switch (static_cast<char>(arg)) {
+            case 'c':
+                num_clients = static_cast<u32>(strtoul(optarg, &endarg, 0));
+                break;
+            case 'b':
+                broadcast_rate = strtod(optarg, &endarg);
+                break;
+            case 'u':
+                unicast_rate = strtod(optarg, &endarg);
+                break;
+            case 's':
+                payload_size = static_cast<u32>(strtoul(optarg, &endarg, 0));
+                break;
+            case 'd':
+                duration = strtod(optarg, &endarg);
+                break;
+            case 'w':
+                warmup = strtod(optarg, &endarg);
+                break;
+            case 'p':
+                port = static_cast<u16>(strtoul(optarg, &endarg, 0));
+                break;
+            case 'S':
+                use_shard = true;
+                break;
+            case 'l':
+                log_file.assign(optarg);
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            }
+        }
+    }
+
+    if (num_clients > Network::MaxConcurrentConnections || num_clients < 2) {
+        std::cout << "clients needs to be in the range 2 - " << Network::MaxConcurrentConnections
+                  << "!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
+    if (payload_size < sizeof(PayloadHeader)) {
+        std::cout << "payload-size needs to be at least " << sizeof(PayloadHeader) << "!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
+    if (broadcast_rate < 0.0 || unicast_rate < 0.0 || duration <= 0.0 || warmup < 0.0) {
+        std::cout << "rates, duration and warmup need to be positive!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
+
+    Common::Log::Initialize(log_file);
+    Common::Log::Start();
+
+    Network::Init();
+    std::shared_ptr<Network::Room> room = Network::GetRoom().lock();
+    std::unique_ptr<Network::RoomShard> shard;
+    if (use_shard) {
+        shard = std::make_unique<Network::RoomShard>(0);
+    }
+    if (!room->Create("Benchmark", "", "127.0.0.1", port, "", num_clients, "", "", 0, nullptr, {},
+                      false, nullptr, shard.get())) {
+        std::cout << "Failed to create room on port " << port << "\n\n";
+        Network::Shutdown();
+        return -1;
+    }
+
+    std::atomic<bool> measuring{false};
+    std::vector<std::unique_ptr<BenchmarkMember>> members;
+    for (u32 i = 0; i < num_clients; i++) {
+        auto& client = members.emplace_back(std::make_unique<BenchmarkMember>());
+        client->wifi_handle = client->member.BindOnWifiPacketReceived(
+            [&measuring, client = client.get()](const Network::WifiPacket& packet) {
+                const s64 now = GetTimeNs();
+                if (!measuring.load(std::memory_order_relaxed) ||
+                    packet.data.size() < sizeof(PayloadHeader)) {
+                    return;
+                }
+                PayloadHeader header;
+                std::memcpy(&header, packet.data.data(), sizeof(header));
+                client->latencies_ns.push_back(now - header.send_time_ns);
+                client->packets_received++;
+            });
+        client->member.Join(fmt::format("bench{}", i), fmt::format("{:016X}", i), "127.0.0.1",
+                            port);
+    }
+
+    // Wait for every member to be assigned its MAC address
+    const auto join_deadline = Clock::now() + std::chrono::seconds(10);
+    const auto all_joined = [&members] {
+        return std::all_of(members.begin(), members.end(), [](const auto& client) {
+            return client->member.GetState() == Network::RoomMember::State::Joined;
+        });
+    };
+    while (!all_joined() && Clock::now() < join_deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!all_joined()) {
+        std::cout << "Not all members could join the room\n\n";
+        for (auto& client : members) {
+            if (client->member.IsConnected()) {
+                client->member.Leave();
+            }
+        }
+        room->Destroy();
+        shard.reset();
+        Network::Shutdown();
+        return -1;
+    }
+    std::vector<Network::MacAddress> mac_addresses;
+    for (const auto& client : members) {
+        mac_addresses.push_back(client->member.GetMacAddress());
+    }
+
+    std::cout << fmt::format("{} members joined, sending {} broadcasts/s and {} unicasts/s each "
+                             "with {} byte payloads\n",
+                             num_clients, broadcast_rate, unicast_rate, payload_size);
+
+    // Drive all members from this thread, crediting every member with packets on each tick so
+    // the configured rates are kept on average.
+    std::mt19937 random_gen(std::random_device{}());
+    std::uniform_int_distribution<u32> other_member(1, num_clients - 1);
+    Network::WifiPacket packet{};
+    packet.type = Network::WifiPacket::PacketType::Data;
+    packet.channel = 1;
+    packet.data.resize(payload_size);
+
+    u64 packets_sent = 0;
+    Network::Room::Statistics start_statistics{};
+    s64 start_cpu_ns = 0;
+    Clock::time_point measure_start{};
+
+    const auto run_start = Clock::now();
+    const auto measure_begin = run_start + std::chrono::duration_cast<Clock::duration>(
+                                               std::chrono::duration<double>(warmup));
+    const auto run_end = measure_begin + std::chrono::duration_cast<Clock::duration>(
+                                             std::chrono::duration<double>(duration));
+    auto last_tick = run_start;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const auto now = Clock::now();
+        if (now >= run_end) {
+            break;
+        }
+        if (!measuring && now >= measure_begin) {
+            start_statistics = room->GetStatistics();
+            start_cpu_ns = GetProcessCpuTimeNs();
+            measure_start = now;
+            measuring = true;
+        }
+
+        const double elapsed = std::chrono::duration<double>(now - last_tick).count();
+        last_tick = now;
+        for (u32 i = 0; i < num_clients; i++) {
+            BenchmarkMember& client = *members[i];
+            client.broadcast_credit += broadcast_rate * elapsed;
+            client.unicast_credit += unicast_rate * elapsed;
+            while (client.broadcast_credit >= 1.0 || client.unicast_credit >= 1.0) {
+                const bool broadcast = client.broadcast_credit >= 1.0;
+                if (broadcast) {
+                    client.broadcast_credit -= 1.0;
+                    packet.destination_address = Network::BroadcastMac;
+                } else {
+                    client.unicast_credit -= 1.0;
+                    packet.destination_address =
+                        mac_addresses[(i + other_member(random_gen)) % num_clients];
+                }
+                packet.transmitter_address = mac_addresses[i];
+                const PayloadHeader header{
+                    .send_time_ns = GetTimeNs(),
+                    .sender = i,
+                    .sequence = client.sequence++,
+                };
+                std::memcpy(packet.data.data(), &header, sizeof(header));
+                client.member.SendWifiPacket(packet);
+                if (measuring) {
+                    packets_sent++;
+                }
+            }
+        }
+    }
+    measuring = false;
+    const auto measure_end = Clock::now();
+    const s64 cpu_ns = GetProcessCpuTimeNs() - start_cpu_ns;
+    const Network::Room::Statistics end_statistics = room->GetStatistics();
+
+    for (auto& client : members) {
+        client->member.Unbind(client->wifi_handle);
+        client->member.Leave();
+    }
+    room->Destroy();
+    shard.reset();
+    Network::Shutdown();
+
+    std::vector<s64> latencies;
+    u64 packets_received = 0;
+    for (const auto& client : members) {
+        latencies.insert(latencies.end(), client->latencies_ns.begin(),
+                         client->latencies_ns.end());
+        packets_received += client->packets_received;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    const double seconds = std::chrono::duration<double>(measure_end - measure_start).count();
+    const u64 packets_relayed = end_statistics.packets_relayed - start_statistics.packets_relayed;
+    const u64 bytes_relayed = end_statistics.bytes_relayed - start_statistics.bytes_relayed;
+    const auto to_us = [](s64 ns) { return static_cast<double>(ns) / 1000.0; };
+
+    std::cout << fmt::format("Measured {:.2f} s\n", seconds);
+    std::cout << fmt::format("  sent       {:>12} packets  {:>12.1f} packets/s\n", packets_sent,
+                             packets_sent / seconds);
+    std::cout << fmt::format(
+        "  relayed    {:>12} packets  {:>12.1f} packets/s  {:>14.1f} bytes/s\n", packets_relayed,
+        packets_relayed / seconds, bytes_relayed / seconds);
+    std::cout << fmt::format("  received   {:>12} packets  {:>12.1f} packets/s\n", packets_received,
+                             packets_received / seconds);
+    std::cout << fmt::format("  latency    p50 {:.1f} us  p99 {:.1f} us  p999 {:.1f} us\n",
+                             to_us(Percentile(latencies, 0.5)), to_us(Percentile(latencies, 0.99)),
+                             to_us(Percentile(latencies, 0.999)));
+    std::cout << fmt::format("  cpu        {:.2f} us per relayed packet (whole process, including "
+                             "the members)\n",
+                             packets_relayed ? to_us(cpu_ns) / packets_relayed : 0.0);
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/interpolate.h"
+
+namespace AudioInterp = AudioCore::AudioInterp;
+
+TEST_CASE("Polyphase preserves constant signals", "[audio_core][interpolate]") {
+    for (const float rate : {0.5f, 1.0f, 1.3f, 4.0f}) {
+        AudioInterp::State state{};
+        AudioCore::StereoBuffer16 input(1000, {1234, -1234});
+        AudioCore::StereoFrame16 output{};
+        std::size_t outputi = 0;
+        AudioInterp::Polyphase(state, input, rate, output, outputi);
+
+        REQUIRE(outputi == output.size());
+        // Skip the outputs whose window still includes the zeroed history
+        const auto first = static_cast<std::size_t>(
+            std::ceil(static_cast<float>(AudioInterp::polyphase_taps - 1) / rate));
+        for (std::size_t i = first; i < output.size(); i++) {
+            REQUIRE(output[i][0] == 1234);
+            REQUIRE(output[i][1] == -1234);
+        }
+    }
+}
+
+TEST_CASE("Polyphase resamples a sine wave", "[audio_core][interpolate]") {
+    constexpr double frequency = 0.01; // Cycles per input sample
+    constexpr double amplitude = 10000.0;
+    constexpr double predelay = 8.0;
+
+    for (const float rate : {0.5f, 1.0f, 2.0f}) {
+        AudioInterp::State state{};
+        AudioCore::StereoBuffer16 input;
+        std::vector<s16> result;
+        std::size_t samples_generated = 0;
+        for (int frame = 0; frame < 50; frame++) {
+            AudioCore::StereoFrame16 output{};
+            std::size_t outputi = 0;
+            while (outputi < output.size()) {
+                // Feed the input in small buffers, like a source dequeuing its buffers
+                if (input.empty()) {
+                    for (int i = 0; i < 100; i++, samples_generated++) {
+                        const auto sample = static_cast<s16>(std::lround(
+                            amplitude * std::sin(2.0 * std::numbers::pi * frequency *
+                                                 static_cast<double>(samples_generated))));
+                        input.push_back({sample, sample});
+                    }
+                }
+                AudioInterp::Polyphase(state, input, rate, output, outputi);
+            }
+            for (const auto& sample : output) {
+                result.push_back(sample[0]);
+            }
+        }
+
+        for (std::size_t i = 100; i < result.size(); i++) {
+            const double position = static_cast<double>(i) * rate - predelay;
+            const double expected =
+                amplitude * std::sin(2.0 * std::numbers::pi * frequency * position);
+            REQUIRE(std::abs(expected - result[i]) < 8.0);
+        }
+    }
+}
+
+TEST_CASE("Linear interpolates between adjacent samples", "[audio_core][interpolate]") {
+    // Full scale steps exercise the saturated subtraction of the firmware.
+    AudioCore::StereoBuffer16 input;
+    for (int i = 0; i < 1000; i++) {
+        const auto sample = static_cast<s16>(i % 3 == 0 ? 32767 : (i % 3 == 1 ? -32768 : i * 37));
+        input.push_back({sample, static_cast<s16>(-i * 29)});
+    }
+    const AudioCore::StereoBuffer16 samples = input;
+
+    for (const float rate : {0.3f, 1.0f, 1.7f}) {
+        AudioInterp::State state{};
+        AudioCore::StereoBuffer16 remaining = samples;
+        AudioCore::StereoFrame16 output{};
+        std::size_t outputi = 0;
+        AudioInterp::Linear(state, remaining, rate, output, outputi);
+        REQUIRE(outputi == output.size());
+
+        // There is a two-sample predelay, the history starts out zeroed.
+        const u64 step = static_cast<u64>(rate * (1 << 24));
+        for (std::size_t i = 0; i < output.size(); i++) {
+            const u64 position = i * step;
+            const std::size_t index = static_cast<std::size_t>(position >> 24);
+            const s64 fraction = static_cast<s64>(position & 0xFFFFFF);
+            for (std::size_t c = 0; c < 2; c++) {
+                const s64 x0 = index < 2 ? 0 : samples[index - 2][c];
+                const s64 x1 = index + 1 < 2 ? 0 : samples[index - 1][c];
+                const s64 delta = std::clamp<s64>(x1 - x0, -32768, 32767);
+                REQUIRE(output[i][c] == static_cast<s16>(x0 + ((fraction * delta) >> 24)));
+            }
+        }
+    }
+}
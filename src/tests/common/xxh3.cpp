@@ -0,0 +1,62 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <utility>
+#include <catch2/catch_test_macros.hpp>
+#include "common/xxh3.h"
+
+namespace {
+
+std::array<u8, 2048> MakeData() {
+    std::array<u8, 2048> data;
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<u8>(i * 31 + 7);
+    }
+    return data;
+}
+
+// Covers every length class, including inputs long enough for the vectorized path
+constexpr std::array<std::pair<std::size_t, u64>, 15> EXPECTED = {{
+    {0, 0x2D06800538D394C2ULL},
+    {1, 0x4C5CCA45D0F4811FULL},
+    {3, 0x15F7093B173D005CULL},
+    {4, 0xDCA012F95811B6B9ULL},
+    {8, 0xDEC6A9A43575982EULL},
+    {9, 0xCBE393399F17FFBDULL},
+    {16, 0x7E484C18D74895D0ULL},
+    {17, 0x208BDE5EE2BED407ULL},
+    {128, 0xF92B70EAA21A6288ULL},
+    {129, 0xF8F76713F2BB60FAULL},
+    {240, 0xCCC7375172C41F03ULL},
+    {241, 0x0B3B630948CE4A00ULL},
+    {1024, 0x23BC880EBF0D29C6ULL},
+    {1025, 0xC09FDFBC398C7D82ULL},
+    {2048, 0x19F6F9C987331373ULL},
+}};
+
+} // Anonymous namespace
+
+TEST_CASE("XXH3Hash64 matches the reference implementation", "[common]") {
+    const auto data = MakeData();
+    for (const auto& [len, hash] : EXPECTED) {
+        INFO("len = " << len);
+        REQUIRE(Common::XXH3Hash64(data.data(), len) == hash);
+    }
+}
+
+TEST_CASE("XXH3Hash64 kernels match the reference implementation", "[common]") {
+    using Common::XXH3Kernel;
+    const auto data = MakeData();
+    for (const auto kernel :
+         {XXH3Kernel::Scalar, XXH3Kernel::SSE2, XXH3Kernel::AVX2, XXH3Kernel::NEON}) {
+        if (!Common::IsXXH3KernelSupported(kernel)) {
+            continue;
+        }
+        for (const auto& [len, hash] : EXPECTED) {
+            INFO("kernel = " << static_cast<int>(kernel) << ", len = " << len);
+            REQUIRE(Common::XXH3Hash64(data.data(), len, kernel) == hash);
+        }
+    }
+}
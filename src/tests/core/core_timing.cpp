@@ -6,7 +6,12 @@
 
 #include <array>
 #include <bitset>
+#include <chrono>
+#include <random>
 #include <string>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -196,4 +201,138 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(MAX_SLICE_LENGTH == timing.GetTimer(0)->GetDowncount());
 }
 
-// TODO: Add tests for multiple timers
+namespace UnscheduleTest {
+static std::vector<std::uintptr_t> fired;
+
+static void RecordCallback(std::uintptr_t user_data, s64 cycles_late) {
+    fired.push_back(user_data);
+}
+} // namespace UnscheduleTest
+
+TEST_CASE("CoreTiming[Unschedule]", "[core]") {
+    using namespace UnscheduleTest;
+
+    Core::Timing timing(2, 100);
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", RecordCallback);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", RecordCallback);
+
+    // Enter slice 0
+    for (std::size_t i = 0; i < 2; i++) {
+        timing.GetTimer(i)->Advance();
+        timing.GetTimer(i)->SetNextSlice();
+    }
+
+    timing.ScheduleEvent(100, cb_a, 1, 0);
+    timing.ScheduleEvent(200, cb_a, 2, 0);
+    timing.ScheduleEvent(300, cb_a, 1, 1);
+    timing.ScheduleEvent(400, cb_b, 3, 0);
+    timing.ScheduleEvent(500, cb_b, 4, 0);
+    timing.GetTimer(1)->MoveEvents();
+
+    // Removes the matching events from every timer, including the one at the front of the queue.
+    timing.UnscheduleEvent(cb_a, 1);
+    REQUIRE(200 == timing.GetTimer(0)->GetMaxSliceLength());
+    REQUIRE(MAX_SLICE_LENGTH == timing.GetTimer(1)->GetMaxSliceLength());
+
+    timing.RemoveEvent(cb_b);
+
+    fired.clear();
+    timing.GetTimer(0)->AddTicks(1000);
+    timing.GetTimer(0)->Advance();
+    REQUIRE(std::vector<std::uintptr_t>{2} == fired);
+}
+
+TEST_CASE("CoreTiming[ThreadSafeScheduling]", "[core]") {
+    using namespace UnscheduleTest;
+
+    static constexpr std::size_t NUM_THREADS = 4;
+    static constexpr std::size_t EVENTS_PER_THREAD = 256;
+
+    Core::Timing timing(1, 100);
+
+    Core::TimingEventType* cb = timing.RegisterEvent("callback", RecordCallback);
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < NUM_THREADS; i++) {
+        threads.emplace_back([&timing, cb, i] {
+            for (std::size_t j = 0; j < EVENTS_PER_THREAD; j++) {
+                timing.ScheduleEvent(0, cb, i * EVENTS_PER_THREAD + j, 0, true);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    fired.clear();
+    timing.GetTimer(0)->AddTicks(MAX_SLICE_LENGTH * 3);
+    timing.GetTimer(0)->Advance();
+    REQUIRE(NUM_THREADS * EVENTS_PER_THREAD == fired.size());
+
+    // Events pushed by a single thread keep their order.
+    std::array<std::uintptr_t, NUM_THREADS> last_seen{};
+    for (const std::uintptr_t user_data : fired) {
+        const std::size_t thread = user_data / EVENTS_PER_THREAD;
+        REQUIRE(last_seen[thread] <= user_data);
+        last_seen[thread] = user_data;
+    }
+}
+
+namespace ThroughputBenchmark {
+static u64 events_fired = 0;
+
+static void CountCallback(std::uintptr_t user_data, s64 cycles_late) {
+    ++events_fired;
+}
+} // namespace ThroughputBenchmark
+
+// Not run by default, use the [benchmark] tag to run it.
+TEST_CASE("CoreTiming[Throughput]", "[.][core][benchmark]") {
+    using namespace ThroughputBenchmark;
+
+    static constexpr std::size_t NUM_TYPES = 64;
+    static constexpr std::size_t EVENTS_PER_ROUND = 1024;
+    static constexpr std::size_t NUM_ROUNDS = 1024;
+
+    Core::Timing timing(1, 100);
+
+    std::array<Core::TimingEventType*, NUM_TYPES> types;
+    for (std::size_t i = 0; i < NUM_TYPES; i++) {
+        types[i] = timing.RegisterEvent(fmt::format("callback{}", i), CountCallback);
+    }
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    std::mt19937 rng{1234};
+    std::uniform_int_distribution<s64> delay{1, MAX_SLICE_LENGTH};
+
+    events_fired = 0;
+    u64 events_scheduled = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < NUM_ROUNDS; round++) {
+        for (std::size_t i = 0; i < EVENTS_PER_ROUND; i++) {
+            timing.ScheduleEvent(delay(rng), types[i % NUM_TYPES], i, 0);
+        }
+        // Cancel a quarter of the events, like thread wakeups being cancelled by a signal.
+        for (std::size_t i = 0; i < EVENTS_PER_ROUND; i += 4) {
+            timing.UnscheduleEvent(types[i % NUM_TYPES], i);
+        }
+        events_scheduled += EVENTS_PER_ROUND;
+
+        timing.GetTimer(0)->AddTicks(MAX_SLICE_LENGTH);
+        timing.GetTimer(0)->Advance();
+        timing.GetTimer(0)->SetNextSlice();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    REQUIRE(events_fired == events_scheduled - events_scheduled / 4);
+    WARN(fmt::format("{} events in {:.3f}s, {:.0f} events/sec", events_scheduled, elapsed.count(),
+                     events_scheduled / elapsed.count()));
+}
@@ -0,0 +1,62 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "common/scope_exit.h"
+#include "core/file_sys/romfs_reader.h"
+
+namespace FileSys {
+
+TEST_CASE("MappedRomFSReader falls back to file reads", "[core][file_sys]") {
+    const auto path =
+        (std::filesystem::temp_directory_path() / "cytrus_romfs_reader_test.bin").string();
+    SCOPE_EXIT({ std::filesystem::remove(path); });
+
+    constexpr std::size_t romfs_offset = 0x1000;
+    std::vector<u8> data(0x10000);
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<u8>(i * 7);
+    }
+    {
+        FileUtil::IOFile out(path, "wb");
+        REQUIRE(out.WriteBytes(data.data(), data.size()) == data.size());
+    }
+
+    auto reader = std::dynamic_pointer_cast<MappedRomFSReader>(OpenDecryptedRomFS(
+        FileUtil::IOFile(path, "rb"), romfs_offset, data.size() - romfs_offset));
+    REQUIRE(reader);
+
+    const auto read_matches = [&](std::size_t offset, std::size_t length) {
+        std::vector<u8> buffer(length);
+        return reader->ReadFile(offset, length, buffer.data()) == length &&
+               std::equal(buffer.begin(), buffer.end(), data.begin() + romfs_offset + offset);
+    };
+    REQUIRE(read_matches(100, 256));
+    REQUIRE(!reader->GetSpan(0, 16).empty());
+
+    // Rewrite part of the file in place and grow it, so that its size no longer matches the
+    // mapping. Once the next check is due, reads go through ReadAtBytes instead.
+    {
+        FileUtil::IOFile out(path, "r+b");
+        std::fill_n(data.begin() + romfs_offset + 100, 256, u8{0xA5});
+        REQUIRE(out.Seek(romfs_offset + 100, SEEK_SET));
+        REQUIRE(out.WriteBytes(data.data() + romfs_offset + 100, 256) == 256);
+        const std::vector<u8> tail(0x1000, 0x5A);
+        REQUIRE(out.Seek(0, SEEK_END));
+        REQUIRE(out.WriteBytes(tail.data(), tail.size()) == tail.size());
+    }
+    std::this_thread::sleep_for(MappedRomFSReader::stale_check_interval);
+
+    REQUIRE(read_matches(100, 256));
+    REQUIRE(reader->GetSpan(0, 16).empty());
+    REQUIRE_FALSE(reader->CacheReady(100, 256));
+    REQUIRE(read_matches(0, data.size() - romfs_offset));
+}
+
+} // namespace FileSys
@@ -0,0 +1,59 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/arm/skyeye_common/armstate.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory.h"
+
+namespace Kernel {
+
+TEST_CASE("KernelSystem::SetCurrentProcessForCPU", "[core][kernel]") {
+    Core::Timing timing(2, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    KernelSystem kernel(memory, timing, [] {}, MemoryMode::Prod, 2,
+                        New3dsHwCapabilities{false, false, New3dsMemoryMode::Legacy});
+
+    std::vector<std::shared_ptr<Core::ARM_Interface>> cpus;
+    for (u32 core_id = 0; core_id < 2; core_id++) {
+        cpus.push_back(std::make_shared<Core::ARM_DynCom>(system, memory, USER32MODE, core_id,
+                                                          timing.GetTimer(core_id)));
+    }
+    kernel.SetCPUs(cpus);
+
+    auto process_a = kernel.CreateProcess(kernel.CreateCodeSet("a", 0));
+    auto process_b = kernel.CreateProcess(kernel.CreateCodeSet("b", 1));
+    kernel.SetRunningCPU(cpus[0].get());
+    kernel.SetCurrentProcess(process_a);
+
+    // Switching the process of another core leaves the running core untouched.
+    kernel.SetCurrentProcessForCPU(process_b, 1);
+    REQUIRE(kernel.GetCurrentProcess() == process_a);
+    REQUIRE(memory.GetCurrentPageTable() == process_a->vm_manager.page_table);
+
+    SECTION("kernel lock switches to the core taking it") {
+        kernel.SetRunningCPUForCallback(cpus[1].get());
+        REQUIRE(kernel.GetCurrentProcess() == process_b);
+        REQUIRE(memory.GetCurrentPageTable() == process_b->vm_manager.page_table);
+
+        kernel.SetRunningCPUForCallback(cpus[0].get());
+        REQUIRE(kernel.GetCurrentProcess() == process_a);
+        REQUIRE(memory.GetCurrentPageTable() == process_a->vm_manager.page_table);
+    }
+
+    SECTION("running the other core applies its process") {
+        kernel.SetRunningCPU(cpus[1].get());
+        REQUIRE(kernel.GetCurrentProcess() == process_b);
+        REQUIRE(memory.GetCurrentPageTable() == process_b->vm_manager.page_table);
+
+        kernel.SetRunningCPU(cpus[0].get());
+        REQUIRE(kernel.GetCurrentProcess() == process_a);
+    }
+}
+
+} // namespace Kernel
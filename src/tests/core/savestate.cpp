@@ -0,0 +1,111 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/scope_exit.h"
+#include "common/zstd_compression.h"
+#include "core/savestate.h"
+
+namespace {
+
+constexpr u64 PROGRAM_ID = 0x0004000000123400;
+
+std::string MakeState(u32 seed) {
+    std::string data(0x20000, '\0');
+    u32 value = seed;
+    for (std::size_t i = 0; i < data.size(); i += 16) {
+        value = value * 1664525 + 1013904223;
+        data[i] = static_cast<char>(value >> 24);
+    }
+    return data;
+}
+
+std::string SlotPath(u32 slot) {
+    return fmt::format("{}{:016X}.{:02d}.cst",
+                       FileUtil::GetUserPath(FileUtil::UserPath::StatesDir), PROGRAM_ID, slot);
+}
+
+/// Writes a full savestate the way builds without delta savestates did, with a header that
+/// ends in reserved zeroes instead of the base slot and hash.
+void WriteLegacySaveState(u32 slot, const std::string& data) {
+    std::array<u8, 256> header{};
+    const std::array<u8, 4> magic{'C', 'S', 'T', 0x1B};
+    std::memcpy(header.data(), magic.data(), magic.size());
+    std::memcpy(header.data() + 4, &PROGRAM_ID, sizeof(PROGRAM_ID));
+    const auto compressed = Common::Compression::CompressDataZSTD(
+        {reinterpret_cast<const u8*>(data.data()), data.size()}, 3);
+
+    FileUtil::IOFile file(SlotPath(slot), "wb");
+    REQUIRE(file.WriteBytes(header.data(), header.size()) == header.size());
+    REQUIRE(file.WriteBytes(compressed.data(), compressed.size()) == compressed.size());
+}
+
+std::vector<u32> ListedSlots() {
+    std::vector<u32> slots;
+    for (const auto& info : Core::ListSaveStates(PROGRAM_ID, 0)) {
+        slots.push_back(info.slot);
+    }
+    return slots;
+}
+
+bool Equals(const std::vector<u8>& lhs, const std::string& rhs) {
+    return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), rhs.size()) == 0;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Delta savestates against a legacy full savestate", "[core][savestate]") {
+    const std::string states_dir = FileUtil::GetUserPath(FileUtil::UserPath::StatesDir);
+    const auto temp_dir = std::filesystem::temp_directory_path() / "cytrus_savestate_test";
+    std::filesystem::remove_all(temp_dir);
+    std::filesystem::create_directories(temp_dir);
+    FileUtil::UpdateUserPath(FileUtil::UserPath::StatesDir, temp_dir.string());
+    SCOPE_EXIT({
+        FileUtil::UpdateUserPath(FileUtil::UserPath::StatesDir, states_dir);
+        std::filesystem::remove_all(temp_dir);
+    });
+
+    const std::string legacy = MakeState(1);
+    std::string delta = legacy;
+    delta.replace(0x1000, 0x100, MakeState(2).substr(0, 0x100));
+    WriteLegacySaveState(1, legacy);
+
+    // Loading the legacy state makes it the base, which stores its hash in the header
+    std::shared_ptr<Core::SaveStateBase> base;
+    REQUIRE(Equals(Core::LoadSaveStateData(PROGRAM_ID, 0, 1, base, true), legacy));
+    REQUIRE(base);
+    REQUIRE(base->slot == 1);
+
+    Core::StoreSaveStateData(PROGRAM_ID, 0, 2, delta, base.get(), nullptr);
+    REQUIRE(ListedSlots() == std::vector<u32>{1, 2});
+
+    SECTION("with the base in memory") {
+        std::shared_ptr<Core::SaveStateBase> no_update = base;
+        REQUIRE(Equals(Core::LoadSaveStateData(PROGRAM_ID, 0, 2, no_update, true), delta));
+        REQUIRE(no_update == base);
+    }
+
+    SECTION("with the base read back from its file") {
+        std::shared_ptr<Core::SaveStateBase> no_base;
+        REQUIRE(Equals(Core::LoadSaveStateData(PROGRAM_ID, 0, 2, no_base, true), delta));
+    }
+
+    SECTION("after overwriting the base") {
+        const std::string replacement = MakeState(3);
+        Core::StoreSaveStateData(PROGRAM_ID, 0, 1, replacement, nullptr, base.get());
+        REQUIRE(ListedSlots() == std::vector<u32>{1, 2});
+
+        std::shared_ptr<Core::SaveStateBase> no_base;
+        REQUIRE(Equals(Core::LoadSaveStateData(PROGRAM_ID, 0, 2, no_base, false), delta));
+        REQUIRE(Equals(Core::LoadSaveStateData(PROGRAM_ID, 0, 1, no_base, false), replacement));
+    }
+}
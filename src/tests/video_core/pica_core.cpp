@@ -0,0 +1,169 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <nihstro/inline_assembly.h>
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "core/core.h"
+#include "core/memory.h"
+#include "video_core/pica/output_vertex.h"
+#include "video_core/pica/pica_core.h"
+#include "video_core/rasterizer_interface.h"
+
+namespace {
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+constexpr PAddr COMMAND_LIST_ADDR = Memory::FCRAM_PADDR;
+constexpr PAddr VERTEX_BASE_ADDR = Memory::FCRAM_PADDR + 0x1000;
+constexpr u32 INDEX_ARRAY_OFFSET = 0x10000;
+constexpr u32 NUM_VERTEX_DATA = 0x800;
+
+/// Records the position of every vertex submitted to the rasterizer
+class CaptureRasterizer final : public VideoCore::RasterizerInterface {
+public:
+    void AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
+                     const Pica::OutputVertex& v2) override {
+        for (const auto* vertex : {&v0, &v1, &v2}) {
+            positions.push_back({vertex->pos.x.ToFloat32(), vertex->pos.y.ToFloat32(),
+                                 vertex->pos.z.ToFloat32(), vertex->pos.w.ToFloat32()});
+        }
+    }
+    void DrawTriangles() override {}
+    void NotifyPicaRegisterChanged(u32 id) override {}
+    void FlushAll() override {}
+    void FlushRegion(PAddr addr, u32 size) override {}
+    void InvalidateRegion(PAddr addr, u32 size) override {}
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
+    void ClearAll(bool flush) override {}
+
+    std::vector<std::array<f32, 4>> positions;
+};
+
+/// Writes the vertex data, the index buffer and a command list triggering the draw to FCRAM
+void SetupMemory(Memory::MemorySystem& memory, bool is_indexed) {
+    u8* vertex_data = memory.GetFCRAMPointer(VERTEX_BASE_ADDR - Memory::FCRAM_PADDR);
+    for (u32 i = 0; i < NUM_VERTEX_DATA; ++i) {
+        const std::array<f32, 4> position{static_cast<f32>(i), static_cast<f32>(2 * i),
+                                          -static_cast<f32>(i), 1.0f};
+        std::memcpy(vertex_data + i * sizeof(position), position.data(), sizeof(position));
+    }
+
+    // Indices revisit vertices out of order, like meshes sharing vertices between triangles
+    u8* index_data = vertex_data + INDEX_ARRAY_OFFSET;
+    for (u32 i = 0; i < 0x1000; ++i) {
+        const u16 index = static_cast<u16>((i * 7) % 613);
+        std::memcpy(index_data + i * sizeof(u16), &index, sizeof(u16));
+    }
+
+    const u32 trigger_id = is_indexed ? PICA_REG_INDEX(pipeline.trigger_draw_indexed)
+                                      : PICA_REG_INDEX(pipeline.trigger_draw);
+    const std::array<u32, 2> command_list{1, trigger_id | (0xF << 16)};
+    std::memcpy(memory.GetFCRAMPointer(COMMAND_LIST_ADDR - Memory::FCRAM_PADDR),
+                command_list.data(), sizeof(command_list));
+}
+
+/// Configures pica to pass the float4 vertex attribute through a MOV vertex shader
+void SetupPica(Pica::PicaCore& pica, bool is_indexed, u32 num_vertices) {
+    auto& pipeline = pica.regs.internal.pipeline;
+    auto& attributes = pipeline.vertex_attributes;
+    attributes.base_address.Assign(VERTEX_BASE_ADDR / 16);
+    attributes.format0.Assign(Pica::PipelineRegs::VertexAttributeFormat::FLOAT);
+    attributes.size0.Assign(3);
+    attributes.max_attribute_index.Assign(0);
+    attributes.attribute_loaders[0].data_offset.Assign(0);
+    attributes.attribute_loaders[0].comp0.Assign(0);
+    attributes.attribute_loaders[0].byte_count.Assign(16);
+    attributes.attribute_loaders[0].component_count.Assign(1);
+    auto& index_array = pipeline.index_array;
+    index_array.offset.Assign(INDEX_ARRAY_OFFSET);
+    index_array.format.Assign(std::remove_reference_t<decltype(index_array)>::SHORT);
+    pipeline.num_vertices = num_vertices;
+    pipeline.vertex_offset = is_indexed ? 0 : 5;
+    pipeline.max_input_attrib_index.Assign(0);
+
+    auto& vs = pica.regs.internal.vs;
+    vs.max_input_attribute_index.Assign(0);
+    vs.main_offset.Assign(0);
+    vs.output_mask.Assign(1);
+
+    auto& rasterizer = pica.regs.internal.rasterizer;
+    using Semantic = Pica::RasterizerRegs::VSOutputAttributes::Semantic;
+    rasterizer.vs_output_total.Assign(1);
+    rasterizer.vs_output_attributes[0].map_x.Assign(Semantic::POSITION_X);
+    rasterizer.vs_output_attributes[0].map_y.Assign(Semantic::POSITION_Y);
+    rasterizer.vs_output_attributes[0].map_z.Assign(Semantic::POSITION_Z);
+    rasterizer.vs_output_attributes[0].map_w.Assign(Semantic::POSITION_W);
+
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary({
+        {OpCode::Id::MOV, DestRegister::MakeOutput(0), SourceRegister::MakeInput(0)},
+        {OpCode::Id::END},
+    });
+    std::transform(shbin.program.begin(), shbin.program.end(),
+                   pica.vs_setup.program_code.begin(), [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   pica.vs_setup.swizzle_data.begin(), [](const auto& x) { return x.hex; });
+    pica.vs_setup.MarkProgramCodeDirty();
+    pica.vs_setup.MarkSwizzleDataDirty();
+}
+
+/// Issues the draws one after another on the same pica and returns the vertices they produced
+std::vector<std::array<f32, 4>> Draw(bool parallel, bool is_indexed,
+                                     std::initializer_list<u32> draws) {
+    Settings::values.use_shader_jit.SetValue(false);
+    Settings::values.use_hw_shader.SetValue(false);
+    Settings::values.parallel_vertex_shading.SetValue(parallel);
+
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    CaptureRasterizer rasterizer;
+    auto pica = std::make_unique<Pica::PicaCore>(memory, nullptr);
+    pica->BindRasterizer(&rasterizer);
+
+    SetupMemory(memory, is_indexed);
+    for (const u32 num_vertices : draws) {
+        SetupPica(*pica, is_indexed, num_vertices);
+        pica->ProcessCmdList(COMMAND_LIST_ADDR, 8);
+    }
+    return std::move(rasterizer.positions);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Parallel vertex shading matches serial shading", "[video_core][pica]") {
+    const bool use_shader_jit = Settings::values.use_shader_jit.GetValue();
+    const bool use_hw_shader = Settings::values.use_hw_shader.GetValue();
+    const bool parallel_vertex_shading = Settings::values.parallel_vertex_shading.GetValue();
+    SCOPE_EXIT({
+        Settings::values.use_shader_jit.SetValue(use_shader_jit);
+        Settings::values.use_hw_shader.SetValue(use_hw_shader);
+        Settings::values.parallel_vertex_shading.SetValue(parallel_vertex_shading);
+    });
+
+    SECTION("non-indexed") {
+        // Large enough to go wide, and not a multiple of the vertex batch size
+        const auto serial = Draw(false, false, {1203});
+        const auto parallel = Draw(true, false, {1203});
+        REQUIRE(serial.size() == 1203);
+        REQUIRE(parallel == serial);
+    }
+
+    SECTION("indexed") {
+        // The second draw reuses the slot table left behind by the first one
+        const auto serial = Draw(false, true, {0xFFF, 0x600});
+        const auto parallel = Draw(true, true, {0xFFF, 0x600});
+        REQUIRE(serial.size() == 0xFFF + 0x600);
+        REQUIRE(parallel == serial);
+    }
+}
@@ -6,6 +6,7 @@
 #if CYTRUS_ARCH(x86_64) || CYTRUS_ARCH(arm64)
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
 #include <memory>
 #include <span>
@@ -13,9 +14,12 @@
 #include <catch2/catch_test_macros.hpp>
 #include <fmt/format.h>
 #include <nihstro/inline_assembly.h>
+#include "common/scope_exit.h"
+#include "common/settings.h"
 #include "video_core/pica/shader_setup.h"
 #include "video_core/pica/shader_unit.h"
 #include "video_core/shader/shader_interpreter.h"
+#include "video_core/shader/shader_jit.h"
 #if CYTRUS_ARCH(x86_64)
 #include "video_core/shader/shader_jit_x64_compiler.h"
 #elif CYTRUS_ARCH(arm64)
@@ -357,6 +361,14 @@ TEST_CASE("FLR", "[video_core][shader][shader_jit]") {
     REQUIRE(shader.Run({-1.5}).x == -2.0f);
     REQUIRE(std::isnan(shader.Run({NAN}).x));
     REQUIRE(std::isinf(shader.Run({INFINITY}).x));
+
+    // The interpreter uses std::floor, so the JIT must match it bit for bit on every host,
+    // including negative non-integers, negative zero and values that do not fit an int32.
+    for (const float input : {-0.25f, -0.75f, -1.0f, -2.5f, -0.0f, -100.125f, -3e9f, 5e9f,
+                              -1e20f, -INFINITY}) {
+        const float expected = std::floor(Pica::f24::FromFloat32(input).ToFloat32());
+        REQUIRE(std::bit_cast<u32>(shader.Run({input}).x) == std::bit_cast<u32>(expected));
+    }
 }
 
 TEST_CASE("MAX", "[video_core][shader][shader_jit]") {
@@ -702,4 +714,70 @@ TEST_CASE("Source Swizzle", "[video_core][shader][shader_jit]") {
             Common::Vec4f(iota_vec.y, iota_vec.y, iota_vec.y, iota_vec.y));
 }
 
+#if CYTRUS_ARCH(x86_64)
+TEST_CASE("Serialize", "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        {OpCode::Id::EX2, sh_output, sh_input},
+        {OpCode::Id::END},
+    });
+
+    // Loading into another shader places the code at a different address
+    const std::vector<u8> blob = shader.shader_jit.Serialize();
+    JitShader loaded_jit;
+    REQUIRE(loaded_jit.Deserialize(blob));
+    REQUIRE(loaded_jit.Serialize() == blob);
+    REQUIRE_FALSE(loaded_jit.Deserialize(std::span{blob}.first(blob.size() - 1)));
+
+    for (const float input : {-2.0f, 0.0f, 0.5f, 3.0f}) {
+        Pica::ShaderUnit shader_unit;
+        shader_unit.input[0] = Common::Vec4<Pica::f24>::AssignToAll(Pica::f24::FromFloat32(input));
+        loaded_jit.Run(*shader.shader_setup, shader_unit, 0);
+        REQUIRE(shader_unit.output[0].x.ToFloat32() == shader.Run(input).x);
+    }
+}
+#endif
+
+TEST_CASE("Interpreter Fallback", "[video_core][shader][shader_jit]") {
+    const bool async_shader_jit = Settings::values.async_shader_jit.GetValue();
+    Settings::values.async_shader_jit.SetValue(true);
+    SCOPE_EXIT({ Settings::values.async_shader_jit.SetValue(async_shader_jit); });
+
+    // Without a compiled shader, the engine runs the batch through its interpreter fallback
+    Pica::Shader::JitEngine engine;
+
+    const auto sh_input1 = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    const std::array inputs{
+        Common::Vec4f(0.1f, -2.7f, 3.3f, 0.9f),    Common::Vec4f(1.7f, 0.3f, -0.45f, 12.5f),
+        Common::Vec4f(-7.25f, 1e-3f, 5e3f, -0.0f), Common::Vec4f(0.0f, -0.0f, 0.0f, 1.0f),
+        Common::Vec4f(INFINITY, 2.0f, NAN, -1.0f), Common::Vec4f(123.456f, 0.5f, 0.3f, 0.7f),
+    };
+    for (const auto opcode : {OpCode::Id::DP3, OpCode::Id::DP4, OpCode::Id::DPH, OpCode::Id::EX2,
+                              OpCode::Id::LG2, OpCode::Id::RCP, OpCode::Id::RSQ}) {
+        auto shader = ShaderTest({
+            {opcode, sh_output, sh_input1, sh_input2},
+            {OpCode::Id::END},
+        });
+        for (const auto& input1 : inputs) {
+            for (const auto& input2 : inputs) {
+                const std::array shader_inputs{input1, input2};
+                Pica::ShaderUnit jit_unit;
+                shader.RunJit(jit_unit, shader_inputs);
+                Pica::ShaderUnit fallback_unit;
+                fallback_unit.input = jit_unit.input;
+                engine.Run(*shader.shader_setup, fallback_unit);
+                for (std::size_t i = 0; i < 4; ++i) {
+                    REQUIRE(std::bit_cast<u32>(fallback_unit.output[0][i].ToFloat32()) ==
+                            std::bit_cast<u32>(jit_unit.output[0][i].ToFloat32()));
+                }
+            }
+        }
+    }
+}
+
 #endif // CYTRUS_ARCH(x86_64) || CYTRUS_ARCH(arm64)
@@ -0,0 +1,84 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <boost/icl/interval_map.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/rasterizer_cache/surface_region_map.h"
+
+using namespace VideoCore;
+
+namespace {
+
+using ReferenceMap = boost::icl::interval_map<PAddr, SurfaceId, boost::icl::partial_absorber,
+                                              std::less, boost::icl::inplace_plus,
+                                              boost::icl::inter_section, SurfaceInterval>;
+
+std::vector<std::pair<SurfaceInterval, SurfaceId>> Collect(const SurfaceRegionMap& map,
+                                                           SurfaceInterval interval) {
+    std::vector<std::pair<SurfaceInterval, SurfaceId>> regions;
+    map.ForEachInRange(interval, [&](SurfaceInterval region, SurfaceId surface_id) {
+        regions.emplace_back(region, surface_id);
+    });
+    return regions;
+}
+
+std::vector<std::pair<SurfaceInterval, SurfaceId>> Collect(const ReferenceMap& map,
+                                                           SurfaceInterval interval) {
+    std::vector<std::pair<SurfaceInterval, SurfaceId>> regions;
+    const auto [begin, end] = map.equal_range(interval);
+    for (auto it = begin; it != end; ++it) {
+        regions.emplace_back(it->first, it->second);
+    }
+    return regions;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SurfaceRegionMap joins and splits regions", "[video_core][rasterizer_cache]") {
+    SurfaceRegionMap map;
+    map.Set({0x100, 0x200}, SurfaceId{1});
+    map.Set({0x200, 0x300}, SurfaceId{1});
+    REQUIRE(Collect(map, {0x0, 0x1000}).size() == 1);
+    REQUIRE(map.Contains({0x100, 0x300}));
+
+    map.Set({0x180, 0x280}, SurfaceId{2});
+    REQUIRE(Collect(map, {0x0, 0x1000}).size() == 3);
+
+    map.Erase(SurfaceInterval{0x1C0, 0x1D0});
+    REQUIRE(!map.Contains({0x100, 0x300}));
+    REQUIRE(map.Contains({0x100, 0x1C0}));
+    REQUIRE(Collect(map, {0x1C0, 0x1D0}).empty());
+
+    map.Clear();
+    REQUIRE(Collect(map, {0x0, 0x1000}).empty());
+}
+
+TEST_CASE("SurfaceRegionMap matches an interval map", "[video_core][rasterizer_cache]") {
+    std::mt19937 rng(0x5EED);
+    std::uniform_int_distribution<u32> addr_dist(0, 0x400);
+    std::uniform_int_distribution<u32> size_dist(1, 0x80);
+    std::uniform_int_distribution<u32> id_dist(1, 3);
+
+    SurfaceRegionMap map;
+    ReferenceMap reference;
+    for (u32 i = 0; i < 4096; i++) {
+        const u32 addr = addr_dist(rng);
+        const SurfaceInterval interval{addr, addr + size_dist(rng)};
+        if (id_dist(rng) == 1) {
+            map.Erase(interval);
+            reference.erase(interval);
+        } else {
+            const SurfaceId surface_id{id_dist(rng)};
+            map.Set(interval, surface_id);
+            reference.set({interval, surface_id});
+        }
+
+        const u32 query_addr = addr_dist(rng);
+        const SurfaceInterval query{query_addr, query_addr + size_dist(rng)};
+        REQUIRE(Collect(map, query) == Collect(reference, query));
+        REQUIRE(map.Contains(query) == boost::icl::contains(reference, query));
+    }
+}
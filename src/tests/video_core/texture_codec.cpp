@@ -0,0 +1,227 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/rasterizer_cache/surface_params.h"
+#include "video_core/rasterizer_cache/texture_codec.h"
+#include "video_core/rasterizer_cache/utils.h"
+
+using namespace VideoCore;
+
+namespace {
+
+std::vector<const CodecKernels*> AvailableKernels() {
+    std::vector<const CodecKernels*> kernels;
+    for (const CodecIsa isa : {CodecIsa::Scalar, CodecIsa::SSSE3, CodecIsa::AVX2, CodecIsa::NEON}) {
+        if (const CodecKernels* isa_kernels = GetCodecKernels(isa)) {
+            kernels.push_back(isa_kernels);
+        }
+    }
+    return kernels;
+}
+
+std::vector<u8> RandomBytes(std::size_t size) {
+    std::mt19937 rng(size);
+    std::uniform_int_distribution<u32> dist(0, 255);
+    std::vector<u8> bytes(size);
+    for (u8& byte : bytes) {
+        byte = static_cast<u8>(dist(rng));
+    }
+    return bytes;
+}
+
+template <PixelFormat format>
+void CheckConversion(const CodecKernels& kernels) {
+    constexpr u32 bytes_per_pixel = GetFormatBpp(format) / 8;
+    constexpr auto index = static_cast<std::size_t>(format);
+    // An odd count that exercises both the vector loops and the scalar tails.
+    constexpr std::size_t count = 131;
+
+    if (const ConvertPixelsFunc decode = kernels.decode[index]) {
+        const auto source = RandomBytes(count * bytes_per_pixel);
+        std::vector<u8> expected(count * 4);
+        std::vector<u8> result(count * 4);
+        for (std::size_t i = 0; i < count; i++) {
+            DecodePixel<format, true>(&source[i * bytes_per_pixel], &expected[i * 4]);
+        }
+        decode(source.data(), result.data(), count);
+        REQUIRE(result == expected);
+    }
+
+    if (const ConvertPixelsFunc encode = kernels.encode[index]) {
+        const auto source = RandomBytes(count * 4);
+        std::vector<u8> expected(count * bytes_per_pixel);
+        std::vector<u8> result(count * bytes_per_pixel);
+        for (std::size_t i = 0; i < count; i++) {
+            EncodePixel<format, true>(&source[i * 4], &expected[i * bytes_per_pixel]);
+        }
+        encode(source.data(), result.data(), count);
+        REQUIRE(result == expected);
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Codec kernels match the per-pixel conversions", "[video_core][texture_codec]") {
+    for (const CodecKernels* kernels : AvailableKernels()) {
+        INFO("isa = " << static_cast<u32>(kernels->isa));
+        CheckConversion<PixelFormat::RGBA8>(*kernels);
+        CheckConversion<PixelFormat::RGB8>(*kernels);
+        CheckConversion<PixelFormat::RGB5A1>(*kernels);
+        CheckConversion<PixelFormat::RGB565>(*kernels);
+        CheckConversion<PixelFormat::RGBA4>(*kernels);
+        CheckConversion<PixelFormat::IA8>(*kernels);
+        CheckConversion<PixelFormat::I8>(*kernels);
+        CheckConversion<PixelFormat::A8>(*kernels);
+        CheckConversion<PixelFormat::D24S8>(*kernels);
+    }
+}
+
+TEST_CASE("Codec kernels follow the morton layout", "[video_core][texture_codec]") {
+    // Bottom up rows with a pitch wider than the tile, as used by MortonCopy.
+    constexpr std::ptrdiff_t pixels_per_row = 24;
+
+    for (const CodecKernels* kernels : AvailableKernels()) {
+        for (u32 bytes_per_pixel = 1; bytes_per_pixel <= 4; bytes_per_pixel++) {
+            INFO("isa = " << static_cast<u32>(kernels->isa) << ", bpp = " << bytes_per_pixel);
+            const std::ptrdiff_t row_pitch = pixels_per_row * bytes_per_pixel;
+            const auto tile = RandomBytes(64 * bytes_per_pixel);
+            std::vector<u8> linear(8 * row_pitch);
+            u8* linear_top = linear.data() + 7 * row_pitch;
+
+            kernels->unswizzle_tile[bytes_per_pixel](tile.data(), linear_top, -row_pitch);
+            for (u32 y = 0; y < 8; y++) {
+                for (u32 x = 0; x < 8; x++) {
+                    const u8* tiled_pixel = &tile[MortonInterleave(x, y) * bytes_per_pixel];
+                    const u8* linear_pixel = linear_top - y * row_pitch + x * bytes_per_pixel;
+                    REQUIRE(std::memcmp(tiled_pixel, linear_pixel, bytes_per_pixel) == 0);
+                }
+            }
+
+            std::vector<u8> swizzled(tile.size());
+            kernels->swizzle_tile[bytes_per_pixel](linear_top, -row_pitch, swizzled.data());
+            REQUIRE(swizzled == tile);
+        }
+    }
+}
+
+TEST_CASE("DecodeETC1Subtile matches SampleETC1Subtile", "[video_core][texture_codec]") {
+    std::mt19937_64 rng(0xE7C1);
+    for (u32 i = 0; i < 1024; i++) {
+        const u64 value = rng();
+        const auto texels = Pica::Texture::DecodeETC1Subtile(value);
+        for (u32 y = 0; y < 4; y++) {
+            for (u32 x = 0; x < 4; x++) {
+                REQUIRE(texels[y * 4 + x] == Pica::Texture::SampleETC1Subtile(value, x, y));
+            }
+        }
+    }
+}
+
+TEST_CASE("Chunked texture copies match the unchunked copy", "[video_core][texture_codec]") {
+    struct CopyCase {
+        PixelFormat format;
+        bool is_tiled;
+        bool convert;
+    };
+    // Unconverted D24 keeps 3 bytes per pixel in linear copies but 4 in tiled ones.
+    constexpr std::array cases = {
+        CopyCase{PixelFormat::RGBA8, true, true},  CopyCase{PixelFormat::RGB8, true, false},
+        CopyCase{PixelFormat::D24, true, false},   CopyCase{PixelFormat::RGB565, false, true},
+        CopyCase{PixelFormat::D24, false, false},  CopyCase{PixelFormat::D24, false, true},
+        CopyCase{PixelFormat::D24S8, false, false},
+    };
+
+    for (const CopyCase& copy : cases) {
+        INFO("format = " << static_cast<u32>(copy.format) << ", tiled = " << copy.is_tiled
+                         << ", convert = " << copy.convert);
+        SurfaceParams params{};
+        params.addr = 0x18000000;
+        params.width = 64;
+        params.height = 40;
+        params.is_tiled = copy.is_tiled;
+        params.pixel_format = copy.format;
+        params.UpdateParams();
+
+        // Staging buffers use the internal pixel size, which can be larger than the copy needs.
+        const std::size_t linear_size = params.width * params.height * 4;
+        const u32 tile_size = params.BytesInPixels(64);
+        const u32 pixel_size = params.BytesInPixels(1);
+        // Decoding tiled data needs tile aligned bounds, encoding it does not.
+        const std::array<std::pair<u32, u32>, 3> bounds = {
+            std::pair{0U, params.size},
+            std::pair{3 * tile_size, params.size - 2 * tile_size},
+            std::pair{7 * pixel_size, params.size - 5 * pixel_size},
+        };
+
+        for (const auto& [start_offset, end_offset] : bounds) {
+            const PAddr start_addr = params.addr + start_offset;
+            const PAddr end_addr = params.addr + end_offset;
+            const bool can_decode = !copy.is_tiled || start_offset % tile_size == 0;
+
+            auto encoded = RandomBytes(end_offset - start_offset);
+            auto linear = RandomBytes(linear_size);
+            std::vector<u8> decoded(linear_size);
+            std::vector<u8> reencoded(encoded.size());
+            if (can_decode) {
+                DecodeTexture(params, start_addr, end_addr, encoded, decoded, copy.convert);
+            }
+            EncodeTexture(params, start_addr, end_addr, linear, reencoded, copy.convert);
+
+            for (u32 num_chunks = 2; num_chunks <= 5; num_chunks++) {
+                std::vector<u8> chunk_decoded(linear_size);
+                std::vector<u8> chunk_encoded(encoded.size());
+                for (u32 chunk = 0; chunk < num_chunks; chunk++) {
+                    if (can_decode) {
+                        DecodeTexture(params, start_addr, end_addr, encoded, chunk_decoded,
+                                      copy.convert, chunk, num_chunks);
+                    }
+                    EncodeTexture(params, start_addr, end_addr, linear, chunk_encoded,
+                                  copy.convert, chunk, num_chunks);
+                }
+                REQUIRE(chunk_decoded == decoded);
+                REQUIRE(chunk_encoded == reencoded);
+            }
+        }
+    }
+}
+
+TEST_CASE("Texture codec throughput", "[.][benchmark][video_core][texture_codec]") {
+    constexpr u32 width = 512;
+    constexpr u32 height = 512;
+    auto rgba8_tiled = RandomBytes(width * height * 4);
+    auto rgb565_tiled = RandomBytes(width * height * 2);
+    auto etc1_tiled = RandomBytes(width * height / 2);
+    std::vector<u8> linear(width * height * 4);
+
+    BENCHMARK("Unswizzle RGBA8") {
+        UNSWIZZLE_TABLE[0](width, height, 0, static_cast<u32>(rgba8_tiled.size()), linear,
+                           rgba8_tiled);
+        return linear[0];
+    };
+    BENCHMARK("Unswizzle and convert RGBA8") {
+        UNSWIZZLE_TABLE_CONVERTED[0](width, height, 0, static_cast<u32>(rgba8_tiled.size()),
+                                     linear, rgba8_tiled);
+        return linear[0];
+    };
+    BENCHMARK("Unswizzle and convert RGB565") {
+        UNSWIZZLE_TABLE_CONVERTED[3](width, height, 0, static_cast<u32>(rgb565_tiled.size()),
+                                     linear, rgb565_tiled);
+        return linear[0];
+    };
+    BENCHMARK("Unswizzle ETC1") {
+        UNSWIZZLE_TABLE[12](width, height, 0, static_cast<u32>(etc1_tiled.size()), linear,
+                            etc1_tiled);
+        return linear[0];
+    };
+    BENCHMARK("Swizzle and convert RGBA8") {
+        SWIZZLE_TABLE_CONVERTED[0](width, height, 0, static_cast<u32>(rgba8_tiled.size()), linear,
+                                   rgba8_tiled);
+        return rgba8_tiled[0];
+    };
+}
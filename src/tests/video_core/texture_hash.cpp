@@ -0,0 +1,123 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/xxh3.h"
+#include "video_core/rasterizer_cache/surface_base.h"
+#include "video_core/rasterizer_cache/utils.h"
+
+using namespace VideoCore;
+
+namespace {
+
+std::vector<u8> RandomBytes(std::size_t size) {
+    std::mt19937 rng(size);
+    std::uniform_int_distribution<u32> dist(0, 255);
+    std::vector<u8> bytes(size);
+    for (u8& byte : bytes) {
+        byte = static_cast<u8>(dist(rng));
+    }
+    return bytes;
+}
+
+std::vector<u64> MakeChunkHashes(std::size_t size) {
+    return std::vector<u64>((size + TEXTURE_HASH_CHUNK_SIZE - 1) / TEXTURE_HASH_CHUNK_SIZE);
+}
+
+/// Hashes data from scratch, without HashTextureChunks
+u64 ReferenceHash(const std::vector<u8>& data) {
+    std::vector<u64> hashes;
+    for (std::size_t offset = 0; offset < data.size(); offset += TEXTURE_HASH_CHUNK_SIZE) {
+        const std::size_t size = std::min<std::size_t>(data.size() - offset,
+                                                       TEXTURE_HASH_CHUNK_SIZE);
+        hashes.push_back(Common::XXH3Hash64(data.data() + offset, size));
+    }
+    return Common::XXH3Hash64(hashes.data(), hashes.size() * sizeof(u64));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("HashTextureChunks", "[video_core][rasterizer_cache]") {
+    // Three full chunks and a partial one
+    auto data = RandomBytes(3 * TEXTURE_HASH_CHUNK_SIZE + 100);
+    auto chunk_hashes = MakeChunkHashes(data.size());
+    REQUIRE(chunk_hashes.size() == 4);
+
+    const u64 hash = HashTextureChunks(data, chunk_hashes);
+    REQUIRE(hash == ReferenceHash(data));
+    REQUIRE(std::ranges::none_of(chunk_hashes, [](u64 chunk_hash) { return chunk_hash == 0; }));
+
+    SECTION("cached chunks are reused") {
+        data[TEXTURE_HASH_CHUNK_SIZE + 1] ^= 0xFF;
+        REQUIRE(HashTextureChunks(data, chunk_hashes) == hash);
+    }
+
+    SECTION("cleared chunks are hashed again") {
+        data[TEXTURE_HASH_CHUNK_SIZE + 1] ^= 0xFF;
+        data[3 * TEXTURE_HASH_CHUNK_SIZE + 99] ^= 0xFF;
+        chunk_hashes[1] = 0;
+        chunk_hashes[3] = 0;
+        const u64 new_hash = HashTextureChunks(data, chunk_hashes);
+        REQUIRE(new_hash != hash);
+        REQUIRE(new_hash == ReferenceHash(data));
+    }
+}
+
+TEST_CASE("SurfaceBase::InvalidateChunkHashes", "[video_core][rasterizer_cache]") {
+    SurfaceParams params{};
+    params.addr = 0x18000000;
+    params.width = 128;
+    params.height = 128;
+    params.levels = 2;
+    params.is_tiled = true;
+    params.pixel_format = PixelFormat::RGBA8;
+    params.UpdateParams();
+
+    SurfaceBase surface{params};
+    const PAddr level0 = surface.LevelInterval(0).lower();
+    const PAddr level1 = surface.LevelInterval(1).lower();
+    REQUIRE(level1 - level0 == 16 * TEXTURE_HASH_CHUNK_SIZE);
+    REQUIRE(surface.LevelInterval(1).upper() - level1 == 4 * TEXTURE_HASH_CHUNK_SIZE);
+
+    surface.chunk_hashes[0].assign(16, 1);
+    surface.chunk_hashes[1].assign(4, 1);
+    const auto cleared = [&](u32 level) {
+        std::vector<std::size_t> chunks;
+        for (std::size_t i = 0; i < surface.chunk_hashes[level].size(); i++) {
+            if (surface.chunk_hashes[level][i] == 0) {
+                chunks.push_back(i);
+            }
+        }
+        return chunks;
+    };
+
+    SECTION("partial chunks are cleared") {
+        surface.InvalidateChunkHashes(SurfaceInterval{level0 + TEXTURE_HASH_CHUNK_SIZE + 10,
+                                                      level0 + 3 * TEXTURE_HASH_CHUNK_SIZE});
+        REQUIRE(cleared(0) == std::vector<std::size_t>{1, 2});
+        REQUIRE(cleared(1).empty());
+    }
+
+    SECTION("intervals spanning levels clear both") {
+        surface.InvalidateChunkHashes(SurfaceInterval{level1 - 1, level1 + 1});
+        REQUIRE(cleared(0) == std::vector<std::size_t>{15});
+        REQUIRE(cleared(1) == std::vector<std::size_t>{0});
+    }
+
+    SECTION("intervals outside the surface are ignored") {
+        surface.InvalidateChunkHashes(SurfaceInterval{surface.end, surface.end + 0x1000});
+        REQUIRE(cleared(0).empty());
+        REQUIRE(cleared(1).empty());
+    }
+
+    SECTION("levels without hashes stay empty") {
+        surface.chunk_hashes[1].clear();
+        surface.InvalidateChunkHashes(surface.GetInterval());
+        REQUIRE(cleared(0).size() == 16);
+        REQUIRE(surface.chunk_hashes[1].empty());
+    }
+}
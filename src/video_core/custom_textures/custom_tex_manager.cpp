@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <optional>
+#include <string_view>
 #include <json.hpp>
 #include "common/file_util.h"
 #include "common/literals.h"
@@ -52,6 +54,52 @@ MapType MakeMapType(std::string_view ext) {
     return MapType::Color;
 }
 
+std::optional<HashMethod> MakeHashMethod(std::string_view name) {
+    if (name == "legacy") {
+        return HashMethod::Legacy;
+    } else if (name == "cityhash") {
+        return HashMethod::CityHash;
+    } else if (name == "xxh3") {
+        return HashMethod::XXH3;
+    }
+    LOG_ERROR(Render, "Unknown hash method {}", name);
+    return std::nullopt;
+}
+
+/**
+ * Reads the hashing methods of a pack. "hash_method" is either a single method or a list of them,
+ * older packs only have "use_new_hash" to choose between the two CityHash based methods.
+ */
+std::vector<HashMethod> ParseHashMethods(const nlohmann::json& options) {
+    if (!options.contains("hash_method")) {
+        const bool use_new_hash = options.value("use_new_hash", true);
+        return {use_new_hash ? HashMethod::CityHash : HashMethod::Legacy};
+    }
+    std::vector<HashMethod> methods;
+    const auto add_method = [&](const nlohmann::json& name) {
+        if (!name.is_string()) {
+            LOG_ERROR(Render, "Hash method {} is invalid", name.dump());
+            return;
+        }
+        if (const auto method = MakeHashMethod(name.get<std::string>())) {
+            methods.push_back(*method);
+        }
+    };
+    const auto& hash_method = options["hash_method"];
+    if (hash_method.is_array()) {
+        for (const auto& name : hash_method) {
+            add_method(name);
+        }
+    } else {
+        add_method(hash_method);
+    }
+    if (methods.empty()) {
+        LOG_ERROR(Render, "Pack has no valid hash method, using xxh3");
+        methods.push_back(HashMethod::XXH3);
+    }
+    return methods;
+}
+
 } // Anonymous namespace
 
 CustomTexManager::CustomTexManager(Core::System& system_)
@@ -96,7 +144,7 @@ void CustomTexManager::FindCustomTextures() {
     const u64 title_id = system.Kernel().GetCurrentProcess()->codeset->program_id;
     const auto textures = GetTextures(title_id);
     if (!ReadConfig(title_id)) {
-        use_new_hash = false;
+        hash_methods = {HashMethod::Legacy};
         skip_mipmap = true;
     }
 
@@ -173,12 +221,12 @@ bool CustomTexManager::ParseFilename(const FileUtil::FSTEntry& file, CustomTextu
 }
 
 void CustomTexManager::PrepareDumping(u64 title_id) {
-    // If a pack exists in the load folder that uses the old hash, dump textures using the old hash.
-    // This occurs either if a configuration file doesn't exist or that file sets the old hash.
+    // If a pack exists in the load folder, dump textures with its hash method so they can be added
+    // to it. Packs without a configuration file use the legacy hash.
     const std::string load_path =
         fmt::format("{}textures/{:016X}/", GetUserPath(FileUtil::UserPath::LoadDir), title_id);
     if (FileUtil::Exists(load_path) && !ReadConfig(title_id, true)) {
-        use_new_hash = false;
+        hash_methods = {HashMethod::Legacy};
     }
 
     // Write template config file
@@ -197,7 +245,7 @@ void CustomTexManager::PrepareDumping(u64 title_id) {
     auto& options = json["options"];
     options["skip_mipmap"] = false;
     options["flip_png_files"] = true;
-    options["use_new_hash"] = true;
+    options["hash_method"] = "xxh3";
 
     FileUtil::IOFile file{pack_config, "w"};
     const std::string output = json.dump(4);
@@ -335,7 +383,7 @@ bool CustomTexManager::ReadConfig(u64 title_id, bool options_only) {
     const auto& options = json["options"];
     skip_mipmap = options["skip_mipmap"].get<bool>();
     flip_png_files = options["flip_png_files"].get<bool>();
-    use_new_hash = options["use_new_hash"].get<bool>();
+    hash_methods = ParseHashMethods(options);
 
     if (options_only) {
         return true;
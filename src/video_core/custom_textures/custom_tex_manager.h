@@ -24,6 +24,12 @@ namespace VideoCore {
 
 class SurfaceParams;
 
+enum class HashMethod : u32 {
+    Legacy,   ///< CityHash64 of the decoded texture data, used by packs without a config file.
+    CityHash, ///< CityHash64 of the guest texture data.
+    XXH3,     ///< XXH3 of the guest level data, hashed in chunks with HashTextureChunks.
+};
+
 struct AsyncUpload {
     const Material* material;
     std::function<bool()> func;
@@ -64,9 +70,9 @@ public:
         return skip_mipmap;
     }
 
-    /// Returns true if the pack uses the new hashing method.
-    bool UseNewHash() const noexcept {
-        return use_new_hash;
+    /// Returns the hashing methods used by the pack, the first one is also used for dumping.
+    std::span<const HashMethod> GetHashMethods() const noexcept {
+        return hash_methods;
     }
 
 private:
@@ -92,7 +98,7 @@ private:
     bool async_custom_loading{true};
     bool skip_mipmap{false};
     bool flip_png_files{true};
-    bool use_new_hash{true};
+    std::vector<HashMethod> hash_methods{HashMethod::XXH3};
 };
 
 } // namespace VideoCore
@@ -2,8 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <boost/serialization/vector.hpp>
 #include "common/archives.h"
 #include "common/microprofile.h"
+#include "common/ring_buffer.h"
+#include "common/settings.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/gsp/gsp_gpu.h"
@@ -24,6 +32,38 @@ constexpr VAddr VADDR_GPU = 0x1EF00000;
 
 MICROPROFILE_DEFINE(GPU_DisplayTransfer, "GPU", "DisplayTransfer", MP_RGB(100, 100, 255));
 MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
+MICROPROFILE_DEFINE(GPU_WaitForIdle, "GPU", "Wait for GPU thread", MP_RGB(255, 100, 100));
+
+/// Number of register writes that can be in flight to the GPU thread.
+constexpr std::size_t GPU_QUEUE_SIZE = 4096;
+
+/// Emulated time between queueing a triggering register write to the GPU thread and signalling
+/// the interrupts it raised. Fixed so that guest-visible fences do not depend on host timing.
+constexpr s64 ASYNC_GPU_FENCE_TICKS = 65536;
+
+/// Register index used to stop the GPU thread.
+constexpr u32 GPU_THREAD_STOP = ~0U;
+
+/// Register index used to present the rendered frame once the work queued before it is done.
+constexpr u32 GPU_PRESENT_FRAME = ~0U - 1;
+
+struct GpuRegWrite {
+    u32 index;
+    u32 value;
+};
+
+static bool IsTriggerRegister(u32 index) {
+    switch (index) {
+    case GPU_REG_INDEX(memory_fill_config[0].trigger):
+    case GPU_REG_INDEX(memory_fill_config[1].trigger):
+    case GPU_REG_INDEX(display_transfer_config.trigger):
+    case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[0]):
+    case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[1]):
+        return true;
+    default:
+        return false;
+    }
+}
 
 struct GPU::Impl {
     Core::Timing& timing;
@@ -36,7 +76,21 @@ struct GPU::Impl {
     RasterizerInterface* rasterizer;
     std::unique_ptr<SwRenderer::SwBlitter> sw_blitter;
     Core::TimingEventType* vblank_event;
+    Core::TimingEventType* fence_event;
     Service::GSP::InterruptHandler signal_interrupt;
+    Service::GSP::InterruptHandler gpu_interrupt;
+
+    // Asynchronous mode. Register writes are applied by the GPU thread in submission order, and
+    // the interrupts raised by each write are signalled on the emulation thread once the fence
+    // event scheduled for it fires.
+    bool async_gpu;
+    Common::RingBuffer<GpuRegWrite, GPU_QUEUE_SIZE> write_queue;
+    std::array<std::vector<Service::GSP::InterruptId>, GPU_QUEUE_SIZE> raised_interrupts;
+    std::vector<Service::GSP::InterruptId>* current_interrupts{};
+    std::atomic<u64> submitted_seq{};
+    std::atomic<u64> completed_seq{};
+    u64 delivered_seq{};
+    std::thread gpu_thread;
 
     explicit Impl(Core::System& system, Frontend::EmuWindow& emu_window,
                   Frontend::EmuWindow* secondary_window)
@@ -44,8 +98,38 @@ struct GPU::Impl {
           debug_context{Pica::g_debug_context}, pica{memory, debug_context},
           renderer{VideoCore::CreateRenderer(emu_window, secondary_window, pica, system)},
           rasterizer{renderer->Rasterizer()},
-          sw_blitter{std::make_unique<SwRenderer::SwBlitter>(memory, rasterizer)} {}
+          sw_blitter{std::make_unique<SwRenderer::SwBlitter>(memory, rasterizer)},
+          async_gpu{Settings::values.async_gpu.GetValue()} {
+        // OpenGL objects are bound to the context of the emulation thread.
+        const auto graphics_api = Settings::values.graphics_api.GetValue();
+        if (async_gpu && graphics_api == Settings::GraphicsAPI::OpenGL) {
+            LOG_WARNING(HW_GPU, "Asynchronous GPU is not supported by OpenGL, disabling");
+            async_gpu = false;
+        }
+    }
     ~Impl() = default;
+
+    u64 PushWrite(u32 index, u32 value) {
+        const u64 seq = submitted_seq.load(std::memory_order_relaxed) + 1;
+        const GpuRegWrite write{index, value};
+        const std::size_t pushed = write_queue.Push(&write, 1);
+        ASSERT(pushed == 1);
+        submitted_seq.store(seq, std::memory_order_release);
+        submitted_seq.notify_one();
+        return seq;
+    }
+
+    void WaitForFence(u64 seq) {
+        u64 completed = completed_seq.load(std::memory_order_acquire);
+        if (completed >= seq) {
+            return;
+        }
+        MICROPROFILE_SCOPE(GPU_WaitForIdle);
+        while (completed < seq) {
+            completed_seq.wait(completed, std::memory_order_acquire);
+            completed = completed_seq.load(std::memory_order_acquire);
+        }
+    }
 };
 
 GPU::GPU(Core::System& system, Frontend::EmuWindow& emu_window,
@@ -55,12 +139,29 @@ GPU::GPU(Core::System& system, Frontend::EmuWindow& emu_window,
         "GPU::VBlankCallback",
         [this](uintptr_t user_data, s64 cycles_late) { VBlankCallback(user_data, cycles_late); });
     impl->timing.ScheduleEvent(FRAME_TICKS, impl->vblank_event);
+    impl->fence_event = impl->timing.RegisterEvent(
+        "GPU::FenceCallback",
+        [this](uintptr_t user_data, s64 cycles_late) { FenceCallback(user_data, cycles_late); });
 
     // Bind the rasterizer to the PICA GPU
     impl->pica.BindRasterizer(impl->rasterizer);
+
+    if (impl->async_gpu) {
+        // The JIT and the other cores read the page tables without synchronization, so the
+        // rasterizer cache marks made by the GPU thread are applied on the emulation thread.
+        impl->memory.SetDeferRasterizerCacheMarks(true);
+        impl->gpu_thread = std::thread([this] { GpuThreadLoop(); });
+    }
 }
 
-GPU::~GPU() = default;
+GPU::~GPU() {
+    if (impl->gpu_thread.joinable()) {
+        WaitForIdle();
+        impl->PushWrite(GPU_THREAD_STOP, 0);
+        impl->gpu_thread.join();
+        impl->memory.SetDeferRasterizerCacheMarks(false);
+    }
+}
 
 PAddr GPU::VirtualToPhysicalAddress(VAddr addr) {
     if (addr == 0) {
@@ -89,18 +190,34 @@ PAddr GPU::VirtualToPhysicalAddress(VAddr addr) {
 
 void GPU::SetInterruptHandler(Service::GSP::InterruptHandler handler) {
     impl->signal_interrupt = handler;
-    impl->pica.SetInterruptHandler(handler);
+    if (impl->async_gpu) {
+        // Interrupts raised on the GPU thread are recorded against the write being processed.
+        impl->gpu_interrupt = [this](Service::GSP::InterruptId interrupt_id) {
+            impl->current_interrupts->push_back(interrupt_id);
+        };
+    } else {
+        impl->gpu_interrupt = handler;
+    }
+    impl->pica.SetInterruptHandler(impl->gpu_interrupt);
 }
 
 void GPU::FlushRegion(PAddr addr, u32 size) {
+    WaitForIdle();
     impl->rasterizer->FlushRegion(addr, size);
 }
 
 void GPU::InvalidateRegion(PAddr addr, u32 size) {
+    WaitForIdle();
     impl->rasterizer->InvalidateRegion(addr, size);
 }
 
+void GPU::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    WaitForIdle();
+    impl->rasterizer->FlushAndInvalidateRegion(addr, size);
+}
+
 void GPU::ClearAll(bool flush) {
+    WaitForIdle();
     impl->rasterizer->ClearAll(flush);
 }
 
@@ -110,6 +227,8 @@ void GPU::Execute(const Service::GSP::Command& command) {
 
     switch (command.id) {
     case CommandId::RequestDma: {
+        // DMA is ordered after the GPU work queued before it.
+        WaitForIdle();
         impl->system.Memory().RasterizerFlushVirtualRegion(
             command.dma_request.source_address, command.dma_request.size, Memory::FlushMode::Flush);
         impl->system.Memory().RasterizerFlushVirtualRegion(command.dma_request.dest_address,
@@ -127,68 +246,74 @@ void GPU::Execute(const Service::GSP::Command& command) {
     case CommandId::SubmitCmdList: {
         auto& params = command.submit_gpu_cmdlist;
         auto& cmdbuffer = regs.internal.pipeline.command_buffer;
+        using AddrField = std::remove_reference_t<decltype(cmdbuffer.addr[0])>;
+        using SizeField = std::remove_reference_t<decltype(cmdbuffer.size[0])>;
 
         // Write to the command buffer GPU registers
-        cmdbuffer.addr[0].Assign(VirtualToPhysicalAddress(params.address) >> 3);
-        cmdbuffer.size[0].Assign(params.size >> 3);
-        cmdbuffer.trigger[0] = 1;
+        WriteGpuReg(GPU_REG_INDEX(internal.pipeline.command_buffer.addr[0]),
+                    AddrField::FormatValue(VirtualToPhysicalAddress(params.address) >> 3));
+        WriteGpuReg(GPU_REG_INDEX(internal.pipeline.command_buffer.size[0]),
+                    SizeField::FormatValue(params.size >> 3));
 
         // Trigger processing of the command list
-        SubmitCmdList(0);
+        WriteGpuReg(GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[0]), 1);
         break;
     }
     case CommandId::MemoryFill: {
         auto& params = command.memory_fill;
-        auto& memfill = regs.memory_fill_config;
 
-        // Write to the memory fill GPU registers.
+        // Write to the memory fill GPU registers. Writing the control register triggers the fill.
         if (params.start1 != 0) {
-            memfill[0].address_start = VirtualToPhysicalAddress(params.start1) >> 3;
-            memfill[0].address_end = VirtualToPhysicalAddress(params.end1) >> 3;
-            memfill[0].value_32bit = params.value1;
-            memfill[0].control = params.control1;
-            MemoryFill(0);
+            WriteGpuReg(GPU_REG_INDEX(memory_fill_config[0].address_start),
+                        VirtualToPhysicalAddress(params.start1) >> 3);
+            WriteGpuReg(GPU_REG_INDEX(memory_fill_config[0].address_end),
+                        VirtualToPhysicalAddress(params.end1) >> 3);
+            WriteGpuReg(GPU_REG_INDEX(memory_fill_config[0].value_32bit), params.value1);
+            WriteGpuReg(GPU_REG_INDEX(memory_fill_config[0].control), params.control1);
         }
         if (params.start2 != 0) {
-            memfill[1].address_start = VirtualToPhysicalAddress(params.start2) >> 3;
-            memfill[1].address_end = VirtualToPhysicalAddress(params.end2) >> 3;
-            memfill[1].value_32bit = params.value2;
-            memfill[1].control = params.control2;
-            MemoryFill(1);
+            WriteGpuReg(GPU_REG_INDEX(memory_fill_config[1].address_start),
+                        VirtualToPhysicalAddress(params.start2) >> 3);
+            WriteGpuReg(GPU_REG_INDEX(memory_fill_config[1].address_end),
+                        VirtualToPhysicalAddress(params.end2) >> 3);
+            WriteGpuReg(GPU_REG_INDEX(memory_fill_config[1].value_32bit), params.value2);
+            WriteGpuReg(GPU_REG_INDEX(memory_fill_config[1].control), params.control2);
         }
         break;
     }
     case CommandId::DisplayTransfer: {
         auto& params = command.display_transfer;
-        auto& display_transfer = regs.display_transfer_config;
 
         // Write to the transfer engine GPU registers.
-        display_transfer.input_address = VirtualToPhysicalAddress(params.in_buffer_address) >> 3;
-        display_transfer.output_address = VirtualToPhysicalAddress(params.out_buffer_address) >> 3;
-        display_transfer.input_size = params.in_buffer_size;
-        display_transfer.output_size = params.out_buffer_size;
-        display_transfer.flags = params.flags;
-        display_transfer.trigger.Assign(1);
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.input_address),
+                    VirtualToPhysicalAddress(params.in_buffer_address) >> 3);
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.output_address),
+                    VirtualToPhysicalAddress(params.out_buffer_address) >> 3);
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.input_size), params.in_buffer_size);
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.output_size), params.out_buffer_size);
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.flags), params.flags);
 
         // Trigger the display transfer.
-        MemoryTransfer();
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.trigger), 1);
         break;
     }
     case CommandId::TextureCopy: {
         auto& params = command.texture_copy;
-        auto& texture_copy = regs.display_transfer_config;
 
         // Write to the transfer engine GPU registers.
-        texture_copy.input_address = VirtualToPhysicalAddress(params.in_buffer_address) >> 3;
-        texture_copy.output_address = VirtualToPhysicalAddress(params.out_buffer_address) >> 3;
-        texture_copy.texture_copy.size = params.size;
-        texture_copy.texture_copy.input_size = params.in_width_gap;
-        texture_copy.texture_copy.output_size = params.out_width_gap;
-        texture_copy.flags = params.flags;
-        texture_copy.trigger.Assign(1);
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.input_address),
+                    VirtualToPhysicalAddress(params.in_buffer_address) >> 3);
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.output_address),
+                    VirtualToPhysicalAddress(params.out_buffer_address) >> 3);
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.texture_copy.size), params.size);
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.texture_copy.input_size),
+                    params.in_width_gap);
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.texture_copy.output_size),
+                    params.out_width_gap);
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.flags), params.flags);
 
         // Trigger the texture copy.
-        MemoryTransfer();
+        WriteGpuReg(GPU_REG_INDEX(display_transfer_config.trigger), 1);
         break;
     }
     case CommandId::CacheFlush: {
@@ -210,19 +335,26 @@ void GPU::SetBufferSwap(u32 screen_id, const Service::GSP::FrameBufferInfo& info
     const PAddr phys_address_left = VirtualToPhysicalAddress(info.address_left);
     const PAddr phys_address_right = VirtualToPhysicalAddress(info.address_right);
 
-    // Update framebuffer properties.
-    auto& framebuffer = impl->pica.regs.framebuffer_config[screen_id];
+    // Update framebuffer properties. These go through the register queue so that they stay
+    // ordered with the rendering queued before them without waiting for the GPU thread.
+    constexpr std::size_t config_words = sizeof(Pica::FramebufferConfig) / sizeof(u32);
+    const u32 base_index =
+        static_cast<u32>(GPU_REG_INDEX(framebuffer_config) + screen_id * config_words);
+    const auto write_field = [&](std::size_t field_offset, u32 value) {
+        WriteGpuReg(base_index + static_cast<u32>(field_offset / sizeof(u32)), value);
+    };
+    using Pica::FramebufferConfig;
     if (info.active_fb == 0) {
-        framebuffer.address_left1 = phys_address_left;
-        framebuffer.address_right1 = phys_address_right;
+        write_field(offsetof(FramebufferConfig, address_left1), phys_address_left);
+        write_field(offsetof(FramebufferConfig, address_right1), phys_address_right);
     } else {
-        framebuffer.address_left2 = phys_address_left;
-        framebuffer.address_right2 = phys_address_right;
+        write_field(offsetof(FramebufferConfig, address_left2), phys_address_left);
+        write_field(offsetof(FramebufferConfig, address_right2), phys_address_right);
     }
 
-    framebuffer.stride = info.stride;
-    framebuffer.format = info.format;
-    framebuffer.active_fb = info.shown_fb;
+    write_field(offsetof(FramebufferConfig, stride), info.stride);
+    write_field(offsetof(FramebufferConfig, format), info.format);
+    write_field(offsetof(FramebufferConfig, active_fb), info.shown_fb);
 
     // Notify debugger about the buffer swap.
     if (impl->debug_context) {
@@ -255,6 +387,7 @@ u32 GPU::ReadReg(VAddr addr) {
         const u32 index = offset / sizeof(u32);
         ASSERT(addr % sizeof(u32) == 0);
         ASSERT(index < Pica::PicaCore::Regs::NUM_REGS);
+        WaitForIdle();
         return impl->pica.regs.reg_array[index];
     }
     default:
@@ -279,28 +412,7 @@ void GPU::WriteReg(VAddr addr, u32 data) {
 
         ASSERT(addr % sizeof(u32) == 0);
         ASSERT(index < Pica::PicaCore::Regs::NUM_REGS);
-        impl->pica.regs.reg_array[index] = data;
-
-        // Handle registers that trigger GPU actions
-        switch (index) {
-        case GPU_REG_INDEX(memory_fill_config[0].trigger):
-            MemoryFill(0);
-            break;
-        case GPU_REG_INDEX(memory_fill_config[1].trigger):
-            MemoryFill(1);
-            break;
-        case GPU_REG_INDEX(display_transfer_config.trigger):
-            MemoryTransfer();
-            break;
-        case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[0]):
-            SubmitCmdList(0);
-            break;
-        case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[1]):
-            SubmitCmdList(1);
-            break;
-        default:
-            break;
-        }
+        WriteGpuReg(index, data);
         break;
     }
     default:
@@ -309,9 +421,18 @@ void GPU::WriteReg(VAddr addr, u32 data) {
 }
 
 void GPU::Sync() {
+    WaitForIdle();
     impl->renderer->Sync();
 }
 
+void GPU::WaitForIdle() {
+    if (!impl->async_gpu || std::this_thread::get_id() == impl->gpu_thread.get_id()) {
+        return;
+    }
+    impl->WaitForFence(impl->submitted_seq.load(std::memory_order_relaxed));
+    impl->memory.ApplyRasterizerCacheMarks();
+}
+
 VideoCore::RendererBase& GPU::Renderer() {
     return *impl->renderer;
 }
@@ -332,6 +453,93 @@ GraphicsDebugger& GPU::Debugger() {
     return impl->gpu_debugger;
 }
 
+void GPU::WriteGpuReg(u32 index, u32 value) {
+    if (!impl->async_gpu) {
+        ApplyGpuReg(index, value);
+        return;
+    }
+
+    // The interrupt slot of this write is still owned by the write GPU_QUEUE_SIZE before it until
+    // the interrupts of the latter are delivered. This only depends on guest behaviour.
+    const u64 seq = impl->submitted_seq.load(std::memory_order_relaxed) + 1;
+    if (seq - impl->delivered_seq > GPU_QUEUE_SIZE) {
+        DeliverInterrupts(seq - GPU_QUEUE_SIZE);
+    }
+
+    impl->PushWrite(index, value);
+    if (IsTriggerRegister(index)) {
+        impl->timing.ScheduleEvent(ASYNC_GPU_FENCE_TICKS, impl->fence_event, seq);
+    }
+}
+
+void GPU::ApplyGpuReg(u32 index, u32 value) {
+    if (index == GPU_PRESENT_FRAME) {
+        impl->renderer->SwapBuffers();
+        return;
+    }
+
+    impl->pica.regs.reg_array[index] = value;
+
+    // Handle registers that trigger GPU actions
+    switch (index) {
+    case GPU_REG_INDEX(memory_fill_config[0].trigger):
+        MemoryFill(0);
+        break;
+    case GPU_REG_INDEX(memory_fill_config[1].trigger):
+        MemoryFill(1);
+        break;
+    case GPU_REG_INDEX(display_transfer_config.trigger):
+        MemoryTransfer();
+        break;
+    case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[0]):
+        SubmitCmdList(0);
+        break;
+    case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[1]):
+        SubmitCmdList(1);
+        break;
+    default:
+        break;
+    }
+}
+
+void GPU::DeliverInterrupts(u64 fence) {
+    if (fence <= impl->delivered_seq) {
+        return;
+    }
+
+    impl->WaitForFence(fence);
+    impl->memory.ApplyRasterizerCacheMarks();
+    for (u64 seq = impl->delivered_seq + 1; seq <= fence; seq++) {
+        for (const auto interrupt_id : impl->raised_interrupts[seq % GPU_QUEUE_SIZE]) {
+            impl->signal_interrupt(interrupt_id);
+        }
+    }
+    impl->delivered_seq = fence;
+}
+
+void GPU::GpuThreadLoop() {
+    Common::SetCurrentThreadName("GPU");
+
+    GpuRegWrite write;
+    while (true) {
+        const u64 seq = impl->completed_seq.load(std::memory_order_relaxed) + 1;
+        impl->submitted_seq.wait(seq - 1, std::memory_order_acquire);
+        if (impl->write_queue.Pop(&write, 1) == 0) {
+            continue;
+        }
+        if (write.index == GPU_THREAD_STOP) {
+            break;
+        }
+
+        impl->current_interrupts = &impl->raised_interrupts[seq % GPU_QUEUE_SIZE];
+        impl->current_interrupts->clear();
+        ApplyGpuReg(write.index, write.value);
+
+        impl->completed_seq.store(seq, std::memory_order_release);
+        impl->completed_seq.notify_all();
+    }
+}
+
 void GPU::SubmitCmdList(u32 index) {
     // Check if a command list was triggered.
     auto& config = impl->pica.regs.internal.pipeline.command_buffer;
@@ -364,9 +572,9 @@ void GPU::MemoryFill(u32 index) {
     // TODO: hwtest this
     if (config.GetStartAddress() != 0) {
         if (!index) {
-            impl->signal_interrupt(Service::GSP::InterruptId::PSC0);
+            impl->gpu_interrupt(Service::GSP::InterruptId::PSC0);
         } else {
-            impl->signal_interrupt(Service::GSP::InterruptId::PSC1);
+            impl->gpu_interrupt(Service::GSP::InterruptId::PSC1);
         }
     }
 
@@ -403,12 +611,15 @@ void GPU::MemoryTransfer() {
 
     // Complete transfer.
     config.trigger.Assign(0);
-    impl->signal_interrupt(Service::GSP::InterruptId::PPF);
+    impl->gpu_interrupt(Service::GSP::InterruptId::PPF);
 }
 
 void GPU::VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
-    // Present renderered frame.
-    impl->renderer->SwapBuffers();
+    // Present renderered frame. In asynchronous mode this is done by the GPU thread after the
+    // work queued before it, so the emulation thread does not wait for it. Frame limiting and
+    // event polling stay on the emulation thread.
+    WriteGpuReg(GPU_PRESENT_FRAME, 0);
+    impl->renderer->EndFrame();
 
     // Signal to GSP that GPU interrupt has occurred
     impl->signal_interrupt(Service::GSP::InterruptId::PDC0);
@@ -418,9 +629,31 @@ void GPU::VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
     impl->timing.ScheduleEvent(FRAME_TICKS - cycles_late, impl->vblank_event);
 }
 
+void GPU::FenceCallback(std::uintptr_t user_data, s64 cycles_late) {
+    DeliverInterrupts(static_cast<u64>(user_data));
+}
+
 template <class Archive>
 void GPU::serialize(Archive& ar, const u32 file_version) {
+    WaitForIdle();
     ar & impl->pica;
+
+    // Interrupts raised by queued work whose fence events have not fired yet.
+    u64 submitted_seq = impl->submitted_seq.load(std::memory_order_relaxed);
+    if (file_version >= 1) {
+        ar & submitted_seq;
+        ar & impl->delivered_seq;
+        for (u64 seq = impl->delivered_seq + 1; seq <= submitted_seq; seq++) {
+            ar & impl->raised_interrupts[seq % GPU_QUEUE_SIZE];
+        }
+    } else if (Archive::is_loading::value) {
+        // Older states were saved with every write applied and its interrupts signalled.
+        impl->delivered_seq = submitted_seq;
+    }
+    if (Archive::is_loading::value) {
+        impl->completed_seq.store(submitted_seq, std::memory_order_relaxed);
+        impl->submitted_seq.store(submitted_seq, std::memory_order_relaxed);
+    }
 }
 
 SERIALIZE_IMPL(GPU)
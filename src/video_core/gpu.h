@@ -7,6 +7,7 @@
 #include <functional>
 #include <memory>
 #include <boost/serialization/access.hpp>
+#include <boost/serialization/version.hpp>
 
 #include "core/hle/service/gsp/gsp_interrupt.h"
 
@@ -56,6 +57,9 @@ public:
     /// Notify rasterizer that any caches of the specified region should be invalidated
     void InvalidateRegion(PAddr addr, u32 size);
 
+    /// Notify rasterizer that any caches of the specified region should be flushed and invalidated
+    void FlushAndInvalidateRegion(PAddr addr, u32 size);
+
     /// Flushes and invalidates all memory in the rasterizer cache and removes any leftover state.
     void ClearAll(bool flush);
 
@@ -77,6 +81,9 @@ public:
     /// Synchronizes fixed function renderer state with PICA registers.
     void Sync();
 
+    /// Blocks until the GPU thread has processed all queued work. No-op in synchronous mode.
+    void WaitForIdle();
+
     /// Returns a mutable reference to the renderer.
     [[nodiscard]] VideoCore::RendererBase& Renderer();
 
@@ -93,6 +100,17 @@ public:
     [[nodiscard]] GraphicsDebugger& Debugger();
 
 private:
+    /// Writes a GPU register, queueing it to the GPU thread in asynchronous mode.
+    void WriteGpuReg(u32 index, u32 value);
+
+    /// Stores a GPU register and performs the action it triggers, if any.
+    void ApplyGpuReg(u32 index, u32 value);
+
+    /// Signals the interrupts raised by queued work up to and including the provided fence.
+    void DeliverInterrupts(u64 fence);
+
+    void GpuThreadLoop();
+
     void SubmitCmdList(u32 index);
 
     void MemoryFill(u32 index);
@@ -101,6 +119,8 @@ private:
 
     void VBlankCallback(uintptr_t user_data, s64 cycles_late);
 
+    void FenceCallback(uintptr_t user_data, s64 cycles_late);
+
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const u32 file_version);
@@ -113,3 +133,5 @@ private:
 };
 
 } // namespace VideoCore
+
+BOOST_CLASS_VERSION(VideoCore::GPU, 1)
@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <numeric>
+#include <thread>
 #include "common/arch.h"
 #include "common/archives.h"
 #include "common/microprofile.h"
@@ -30,12 +33,24 @@ union CommandHeader {
 };
 static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect size!");
 
+/// Number of vertices fetched from the loader arrays at once
+constexpr u32 VERTEX_BATCH_SIZE = 32;
+
+/// Draws with fewer vertices are not worth distributing to the vertex workers
+constexpr u32 PARALLEL_VERTEX_THRESHOLD = 512;
+
 PicaCore::PicaCore(Memory::MemorySystem& memory_, std::shared_ptr<DebugContext> debug_context_)
     : memory{memory_}, debug_context{std::move(debug_context_)},
       geometry_pipeline{regs.internal, gs_unit, gs_setup},
       shader_engine{CreateEngine(Settings::values.use_shader_jit.GetValue())} {
     InitializeRegs();
 
+    const u32 num_threads = std::thread::hardware_concurrency();
+    if (Settings::values.parallel_vertex_shading.GetValue() && num_threads > 1) {
+        vertex_workers =
+            std::make_unique<Common::ThreadWorker>(std::min(num_threads, 8U) - 1, "VertexShader");
+    }
+
     const auto submit_vertex = [this](const AttributeBuffer& buffer) {
         const auto add_triangle = [this](const OutputVertex& v0, const OutputVertex& v1,
                                          const OutputVertex& v2) {
@@ -87,6 +102,10 @@ void PicaCore::BindRasterizer(VideoCore::RasterizerInterface* rasterizer) {
     this->rasterizer = rasterizer;
 }
 
+void PicaCore::LoadShaderDiskCache(u64 program_id) {
+    shader_engine->LoadDiskCache(program_id);
+}
+
 void PicaCore::SetInterruptHandler(Service::GSP::InterruptHandler& signal_interrupt) {
     this->signal_interrupt = signal_interrupt;
 }
@@ -532,7 +551,9 @@ void PicaCore::LoadVertices(bool is_indexed) {
     // Read and validate vertex information from the loaders
     const auto& pipeline = regs.internal.pipeline;
     const PAddr base_address = pipeline.vertex_attributes.GetPhysicalBaseAddress();
-    const auto loader = VertexLoader(memory, pipeline);
+    if (!vertex_loader || !vertex_loader->MatchesLayout(pipeline)) {
+        vertex_loader = std::make_unique<VertexLoader>(memory, pipeline);
+    }
     regs.internal.rasterizer.ValidateSemantics();
 
     // Locate index buffer.
@@ -558,55 +579,153 @@ void PicaCore::LoadVertices(bool is_indexed) {
     geometry_pipeline.Setup(shader_engine.get());
     ASSERT(!geometry_pipeline.NeedIndexInput() || is_indexed);
 
-    for (u32 index = 0; index < pipeline.num_vertices; ++index) {
-        // Indexed rendering doesn't use the start offset
-        const u32 vertex = is_indexed
-                               ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                               : (index + pipeline.vertex_offset);
-
-        bool vertex_cache_hit = false;
-        if (is_indexed) {
-            if (geometry_pipeline.NeedIndexInput()) {
-                geometry_pipeline.SubmitIndex(vertex);
-                continue;
+    // Large draws are shaded on the vertex workers, the debugger expects invocations in order
+    const bool submit_indices = is_indexed && geometry_pipeline.NeedIndexInput();
+    if (vertex_workers && !submit_indices && !debug_context &&
+        pipeline.num_vertices >= PARALLEL_VERTEX_THRESHOLD) {
+        LoadVerticesParallel(is_indexed, base_address, index_address_8, index_u16);
+        return;
+    }
+
+    // Vertices are fetched in batches, so each attribute is decoded for many vertices at once
+    std::array<u32, VERTEX_BATCH_SIZE> batch_vertices;
+    std::array<AttributeBuffer, VERTEX_BATCH_SIZE> batch_inputs;
+
+    for (u32 batch_start = 0; batch_start < pipeline.num_vertices;
+         batch_start += VERTEX_BATCH_SIZE) {
+        const u32 batch_size =
+            std::min<u32>(VERTEX_BATCH_SIZE, pipeline.num_vertices - batch_start);
+        for (u32 i = 0; i < batch_size; ++i) {
+            const u32 index = batch_start + i;
+
+            // Indexed rendering doesn't use the start offset
+            batch_vertices[i] = is_indexed
+                                    ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                                    : (index + pipeline.vertex_offset);
+        }
+
+        if (submit_indices) {
+            for (u32 i = 0; i < batch_size; ++i) {
+                geometry_pipeline.SubmitIndex(batch_vertices[i]);
             }
+            continue;
+        }
+
+        vertex_loader->LoadVertices(base_address, std::span{batch_vertices}.first(batch_size),
+                                    batch_inputs, input_default_attributes);
 
-            for (u32 i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                    vs_output = vertex_cache[i];
-                    vertex_cache_hit = true;
-                    break;
+        for (u32 i = 0; i < batch_size; ++i) {
+            const u32 vertex = batch_vertices[i];
+
+            bool vertex_cache_hit = false;
+            if (is_indexed) {
+                for (u32 j = 0; j < VERTEX_CACHE_SIZE; ++j) {
+                    if (vertex_cache_valid[j] && vertex == vertex_cache_ids[j]) {
+                        vs_output = vertex_cache[j];
+                        vertex_cache_hit = true;
+                        break;
+                    }
                 }
             }
-        }
 
-        if (!vertex_cache_hit) {
-            // Initialize data for the current vertex
-            AttributeBuffer input;
-            loader.LoadVertex(base_address, index, vertex, input, input_default_attributes);
+            if (!vertex_cache_hit) {
+                AttributeBuffer& input = batch_inputs[i];
 
-            // Record vertex processing to the debugger.
-            if (debug_context) {
-                debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
-                                       std::addressof(input));
+                // Record vertex processing to the debugger.
+                if (debug_context) {
+                    debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
+                                           std::addressof(input));
+                }
+
+                // Invoke the vertex shader for this vertex.
+                shader_unit.LoadInput(regs.internal.vs, input);
+                shader_engine->Run(vs_setup, shader_unit);
+                shader_unit.WriteOutput(regs.internal.vs, vs_output);
+
+                // Cache the vertex when doing indexed rendering.
+                if (is_indexed) {
+                    vertex_cache[vertex_cache_pos] = vs_output;
+                    vertex_cache_valid[vertex_cache_pos] = true;
+                    vertex_cache_ids[vertex_cache_pos] = vertex;
+                    vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+                }
             }
 
-            // Invoke the vertex shader for this vertex.
-            shader_unit.LoadInput(regs.internal.vs, input);
-            shader_engine->Run(vs_setup, shader_unit);
-            shader_unit.WriteOutput(regs.internal.vs, vs_output);
+            // Send to geometry pipeline
+            geometry_pipeline.SubmitVertex(vs_output);
+        }
+    }
+}
 
-            // Cache the vertex when doing indexed rendering.
-            if (is_indexed) {
-                vertex_cache[vertex_cache_pos] = vs_output;
-                vertex_cache_valid[vertex_cache_pos] = true;
-                vertex_cache_ids[vertex_cache_pos] = vertex;
-                vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+void PicaCore::LoadVerticesParallel(bool is_indexed, PAddr base_address, const u8* index_address,
+                                    bool index_u16) {
+    const auto& pipeline = regs.internal.pipeline;
+    const u32 num_vertices = pipeline.num_vertices;
+    const u16* index_address_16 = reinterpret_cast<const u16*>(index_address);
+
+    // Post-transform cache: every distinct index is assigned a slot and only shaded once
+    unique_vertices.clear();
+    if (is_indexed) {
+        if (slot_of_vertex.empty()) {
+            slot_of_vertex.resize(0x10000, UINT32_MAX);
+        }
+        vertex_slots.resize(num_vertices);
+        for (u32 index = 0; index < num_vertices; ++index) {
+            const u32 vertex = index_u16 ? index_address_16[index] : index_address[index];
+            u32& slot = slot_of_vertex[vertex];
+            if (slot == UINT32_MAX) {
+                slot = static_cast<u32>(unique_vertices.size());
+                unique_vertices.push_back(vertex);
             }
+            vertex_slots[index] = slot;
+        }
+        // Only the used entries are reset, so the table is ready for the next draw
+        for (const u32 vertex : unique_vertices) {
+            slot_of_vertex[vertex] = UINT32_MAX;
         }
+    } else {
+        // Non-indexed draws don't repeat vertices, the slot is the index itself
+        unique_vertices.resize(num_vertices);
+        std::iota(unique_vertices.begin(), unique_vertices.end(), pipeline.vertex_offset);
+    }
+
+    if (vs_outputs.size() < unique_vertices.size()) {
+        vs_outputs.resize(unique_vertices.size());
+    }
+    const auto shade_vertices = [&](std::size_t begin, std::size_t end) {
+        // Each chunk has its own shader unit, reused for its vertices like the serial path reuses
+        // one for the whole draw. Registers left over from the previous vertex therefore differ
+        // at chunk boundaries, which hardware with its four parallel vertex units doesn't define.
+        ShaderUnit shader_unit;
+        std::array<AttributeBuffer, VERTEX_BATCH_SIZE> inputs;
+        for (std::size_t batch_start = begin; batch_start < end; batch_start += VERTEX_BATCH_SIZE) {
+            const std::size_t batch_size =
+                std::min<std::size_t>(VERTEX_BATCH_SIZE, end - batch_start);
+            vertex_loader->LoadVertices(
+                base_address, std::span{unique_vertices}.subspan(batch_start, batch_size), inputs,
+                input_default_attributes);
+
+            for (std::size_t i = 0; i < batch_size; ++i) {
+                shader_unit.LoadInput(regs.internal.vs, inputs[i]);
+                shader_engine->Run(vs_setup, shader_unit);
+                shader_unit.WriteOutput(regs.internal.vs, vs_outputs[batch_start + i]);
+            }
+        }
+    };
+
+    // Split the vertices evenly, the calling thread shades the first chunk itself
+    const std::size_t num_chunks = vertex_workers->NumWorkers() + 1;
+    const std::size_t chunk_size = (unique_vertices.size() + num_chunks - 1) / num_chunks;
+    for (std::size_t begin = chunk_size; begin < unique_vertices.size(); begin += chunk_size) {
+        const std::size_t end = std::min(begin + chunk_size, unique_vertices.size());
+        vertex_workers->QueueWork([&shade_vertices, begin, end] { shade_vertices(begin, end); });
+    }
+    shade_vertices(0, std::min(chunk_size, unique_vertices.size()));
+    vertex_workers->WaitForRequests();
 
-        // Send to geometry pipeline
-        geometry_pipeline.SubmitVertex(vs_output);
+    // Primitive assembly consumes the vertices in draw order
+    for (u32 index = 0; index < num_vertices; ++index) {
+        geometry_pipeline.SubmitVertex(vs_outputs[is_indexed ? vertex_slots[index] : index]);
     }
 }
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "common/thread_worker.h"
 #include "core/hle/service/gsp/gsp_interrupt.h"
 #include "video_core/pica/geometry_pipeline.h"
 #include "video_core/pica/packed_attribute.h"
@@ -26,6 +27,7 @@ namespace Pica {
 
 class DebugContext;
 class ShaderEngine;
+class VertexLoader;
 
 class PicaCore {
 public:
@@ -38,6 +40,9 @@ public:
 
     void ProcessCmdList(PAddr list, u32 size);
 
+    /// Starts loading the shaders of the title that were cached on disk by the shader engine.
+    void LoadShaderDiskCache(u64 program_id);
+
 private:
     void InitializeRegs();
 
@@ -51,6 +56,10 @@ private:
 
     void LoadVertices(bool is_indexed);
 
+    /// Shades the vertices of a draw on the vertex workers and submits them in draw order.
+    void LoadVerticesParallel(bool is_indexed, PAddr base_address, const u8* index_address,
+                              bool index_u16);
+
 public:
     union Regs {
         static constexpr std::size_t NUM_REGS = 0x732;
@@ -280,6 +289,14 @@ private:
     PrimitiveAssembler primitive_assembler;
     CommandList cmd_list;
     std::unique_ptr<ShaderEngine> shader_engine;
+    std::unique_ptr<VertexLoader> vertex_loader;
+    std::unique_ptr<Common::ThreadWorker> vertex_workers;
+
+    // Scratch buffers of LoadVerticesParallel, kept to avoid allocating them on every draw
+    std::vector<u32> slot_of_vertex;
+    std::vector<u32> unique_vertices;
+    std::vector<u32> vertex_slots;
+    std::vector<AttributeBuffer> vs_outputs;
 };
 
 #define GPU_REG_INDEX(field_name) (offsetof(Pica::PicaCore::Regs, field_name) / sizeof(u32))
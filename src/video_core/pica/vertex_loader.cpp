@@ -2,23 +2,128 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include "common/alignment.h"
+#include "common/arch.h"
 #include "common/logging/log.h"
 #include "video_core/pica/vertex_loader.h"
 
+#if CYTRUS_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CYTRUS_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
 namespace Pica {
 
+namespace {
+
+static_assert(sizeof(Common::Vec4<f24>) == 4 * sizeof(f32));
+
+/**
+ * Decodes an attribute with the given component type and count. Attributes with less than four
+ * components get the missing ones set to (0, 0, 0, 1). This is *not* carried over from the
+ * default attribute settings even if they're enabled for this attribute.
+ */
+template <typename T, u32 Elements>
+void DecodeAttribute(const u8* data, Common::Vec4<f24>& out) {
+    // Only the bytes of the attribute are read, the remaining components stay zero
+    std::array<T, 4> components{};
+    std::memcpy(components.data(), data, Elements * sizeof(T));
+
+#if CYTRUS_ARCH(x86_64)
+    __m128 result;
+    if constexpr (std::is_same_v<T, f32>) {
+        result = _mm_loadu_ps(components.data());
+    } else if constexpr (sizeof(T) == 1) {
+        u32 packed;
+        std::memcpy(&packed, components.data(), sizeof(packed));
+        __m128i values = _mm_cvtsi32_si128(static_cast<s32>(packed));
+        if constexpr (std::is_signed_v<T>) {
+            values = _mm_unpacklo_epi8(values, values);
+            values = _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 24);
+        } else {
+            values = _mm_unpacklo_epi8(values, _mm_setzero_si128());
+            values = _mm_unpacklo_epi16(values, _mm_setzero_si128());
+        }
+        result = _mm_cvtepi32_ps(values);
+    } else {
+        __m128i values = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(components.data()));
+        values = _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16);
+        result = _mm_cvtepi32_ps(values);
+    }
+    if constexpr (Elements < 4) {
+        // The w component is +0.0 at this point, so or-ing in the bits of 1.0 sets it to one
+        result = _mm_or_ps(result, _mm_setr_ps(0.f, 0.f, 0.f, 1.f));
+    }
+    std::array<f32, 4> floats;
+    _mm_storeu_ps(floats.data(), result);
+#elif CYTRUS_ARCH(arm64)
+    float32x4_t result;
+    if constexpr (std::is_same_v<T, f32>) {
+        result = vld1q_f32(components.data());
+    } else if constexpr (std::is_same_v<T, u8>) {
+        u32 packed;
+        std::memcpy(&packed, components.data(), sizeof(packed));
+        const uint16x8_t values = vmovl_u8(vcreate_u8(packed));
+        result = vcvtq_f32_u32(vmovl_u16(vget_low_u16(values)));
+    } else if constexpr (std::is_same_v<T, s8>) {
+        u32 packed;
+        std::memcpy(&packed, components.data(), sizeof(packed));
+        const int16x8_t values = vmovl_s8(vcreate_s8(packed));
+        result = vcvtq_f32_s32(vmovl_s16(vget_low_s16(values)));
+    } else {
+        result = vcvtq_f32_s32(vmovl_s16(vld1_s16(components.data())));
+    }
+    if constexpr (Elements < 4) {
+        // The w component is +0.0 at this point, so or-ing in the bits of 1.0 sets it to one
+        const float32x4_t one_w = {0.f, 0.f, 0.f, 1.f};
+        result = vreinterpretq_f32_u32(
+            vorrq_u32(vreinterpretq_u32_f32(result), vreinterpretq_u32_f32(one_w)));
+    }
+    std::array<f32, 4> floats;
+    vst1q_f32(floats.data(), result);
+#else
+    std::array<f32, 4> floats;
+    for (u32 comp = 0; comp < 4; ++comp) {
+        floats[comp] = static_cast<f32>(components[comp]);
+    }
+    if constexpr (Elements < 4) {
+        floats[3] = 1.f;
+    }
+#endif
+
+    for (u32 comp = 0; comp < 4; ++comp) {
+        out[comp] = f24::FromFloat32(floats[comp]);
+    }
+}
+
+template <typename T>
+constexpr std::array<void (*)(const u8*, Common::Vec4<f24>&), 4> MakeDecoders() {
+    return {&DecodeAttribute<T, 1>, &DecodeAttribute<T, 2>, &DecodeAttribute<T, 3>,
+            &DecodeAttribute<T, 4>};
+}
+
+/// Decoders indexed by the attribute format and element count minus one
+constexpr std::array decoders = {MakeDecoders<s8>(), MakeDecoders<u8>(), MakeDecoders<s16>(),
+                                 MakeDecoders<f32>()};
+
+} // Anonymous namespace
+
 VertexLoader::VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& regs)
     : memory{memory_} {
     const auto& attribute_config = regs.vertex_attributes;
     num_total_attributes = attribute_config.GetNumTotalAttributes();
+    const u8* regs_layout = reinterpret_cast<const u8*>(&attribute_config) + sizeof(u32);
+    std::memcpy(layout.data(), regs_layout, sizeof(layout));
 
+    std::array<u32, 16> vertex_attribute_sources;
+    std::array<u32, 16> vertex_attribute_strides{};
+    std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
+    std::array<u32, 16> vertex_attribute_elements{};
     vertex_attribute_sources.fill(0xdeadbeef);
 
-    for (u32 i = 0; i < 16; i++) {
-        vertex_attribute_is_default[i] = attribute_config.IsDefaultAttribute(i);
-    }
-
     // Setup attribute data from loaders
     for (u32 loader = 0; loader < 12; ++loader) {
         const auto& loader_config = attribute_config.attribute_loaders[loader];
@@ -57,51 +162,80 @@ VertexLoader::VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& re
             }
         }
     }
-}
 
-VertexLoader::~VertexLoader() = default;
-
-void VertexLoader::LoadVertex(PAddr base_address, u32 index, u32 vertex, AttributeBuffer& input,
-                              AttributeBuffer& input_default_attributes) const {
-    for (s32 i = 0; i < num_total_attributes; ++i) {
-        // Load the default attribute if we're configured to do so
-        if (vertex_attribute_is_default[i]) {
-            input[i] = input_default_attributes[i];
+    // Compile the decode plan of every attribute read from the loader arrays
+    for (u32 i = 0; i < static_cast<u32>(num_total_attributes); ++i) {
+        if (attribute_config.IsDefaultAttribute(i)) {
+            default_attributes[num_default_attributes++] = i;
             continue;
         }
 
-        // TODO(yuriks): In this case, no data gets loaded and the vertex
-        // remains with the last value it had. This isn't currently maintained
-        // as global state, however, and so won't work in Cytrus yet.
-        if (vertex_attribute_elements[i] == 0) {
-            LOG_ERROR(HW_GPU, "Vertex retension unimplemented");
+        const u32 elements = vertex_attribute_elements[i];
+        if (elements == 0) {
+            has_retained_attributes = true;
             continue;
         }
 
-        // Load per-vertex data from the loader arrays
-        const PAddr source_addr =
-            base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
-
-        switch (vertex_attribute_formats[i]) {
-        case PipelineRegs::VertexAttributeFormat::BYTE:
-            LoadAttribute<s8>(source_addr, i, input);
-            break;
-        case PipelineRegs::VertexAttributeFormat::UBYTE:
-            LoadAttribute<u8>(source_addr, i, input);
-            break;
-        case PipelineRegs::VertexAttributeFormat::SHORT:
-            LoadAttribute<s16>(source_addr, i, input);
-            break;
-        case PipelineRegs::VertexAttributeFormat::FLOAT:
-            LoadAttribute<f32>(source_addr, i, input);
-            break;
+        const auto format = vertex_attribute_formats[i];
+        attribute_plans[num_attribute_plans++] = {
+            .attribute = i,
+            .source_offset = vertex_attribute_sources[i],
+            .stride = vertex_attribute_strides[i],
+            .size = elements * PipelineRegs::GetFormatBytes(format),
+            .decode = decoders[static_cast<u32>(format)][elements - 1],
+        };
+    }
+}
+
+VertexLoader::~VertexLoader() = default;
+
+bool VertexLoader::MatchesLayout(const PipelineRegs& regs) const {
+    const u8* regs_layout = reinterpret_cast<const u8*>(&regs.vertex_attributes) + sizeof(u32);
+    return std::memcmp(layout.data(), regs_layout, sizeof(layout)) == 0;
+}
+
+void VertexLoader::LoadVertices(PAddr base_address, std::span<const u32> vertices,
+                                std::span<AttributeBuffer> inputs,
+                                const AttributeBuffer& input_default_attributes) const {
+    ASSERT(inputs.size() >= vertices.size());
+    if (vertices.empty()) {
+        return;
+    }
+
+    // Load the default attributes if we're configured to do so
+    for (u32 i = 0; i < num_default_attributes; ++i) {
+        const u32 attrib = default_attributes[i];
+        for (std::size_t v = 0; v < vertices.size(); ++v) {
+            inputs[v][attrib] = input_default_attributes[attrib];
+        }
+    }
+
+    // TODO(yuriks): In this case, no data gets loaded and the vertex
+    // remains with the last value it had. This isn't currently maintained
+    // as global state, however, and so won't work in Cytrus yet.
+    if (has_retained_attributes) {
+        LOG_ERROR(HW_GPU, "Vertex retension unimplemented");
+    }
+
+    const u32 max_vertex = *std::max_element(vertices.begin(), vertices.end());
+    for (u32 i = 0; i < num_attribute_plans; ++i) {
+        const AttributePlan& plan = attribute_plans[i];
+        const PAddr source_addr = base_address + plan.source_offset;
+
+        // Resolve the attribute array once when the whole batch lies in contiguous memory
+        const u32 array_size = plan.stride * max_vertex + plan.size;
+        const u8* data = memory.GetPhysicalPointer(source_addr);
+        if (data && memory.GetPhysicalPointer(source_addr + array_size - 1) ==
+                        data + array_size - 1) {
+            for (std::size_t v = 0; v < vertices.size(); ++v) {
+                plan.decode(data + plan.stride * vertices[v], inputs[v][plan.attribute]);
+            }
+            continue;
         }
 
-        // Default attribute values set if array elements have < 4 components. This
-        // is *not* carried over from the default attribute settings even if they're
-        // enabled for this attribute.
-        for (u32 comp = vertex_attribute_elements[i]; comp < 4; comp++) {
-            input[i][comp] = comp == 3 ? f24::One() : f24::Zero();
+        for (std::size_t v = 0; v < vertices.size(); ++v) {
+            const PAddr vertex_addr = source_addr + plan.stride * vertices[v];
+            plan.decode(memory.GetPhysicalPointer(vertex_addr), inputs[v][plan.attribute]);
         }
     }
 }
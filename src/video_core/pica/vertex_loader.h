@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <span>
 #include "core/memory.h"
 #include "video_core/pica/output_vertex.h"
 #include "video_core/pica/regs_pipeline.h"
@@ -19,28 +20,45 @@ public:
     explicit VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& regs);
     ~VertexLoader();
 
-    void LoadVertex(PAddr base_address, u32 index, u32 vertex, AttributeBuffer& input,
-                    AttributeBuffer& input_default_attributes) const;
+    /// Returns true if the loader was built for the attribute layout of the provided registers.
+    bool MatchesLayout(const PipelineRegs& regs) const;
 
-    template <typename T>
-    void LoadAttribute(PAddr source_addr, u32 attrib, AttributeBuffer& out) const {
-        const T* data = reinterpret_cast<const T*>(memory.GetPhysicalPointer(source_addr));
-        for (u32 comp = 0; comp < vertex_attribute_elements[attrib]; ++comp) {
-            out[attrib][comp] = f24::FromFloat32(data[comp]);
-        }
-    }
+    /**
+     * Loads a batch of vertices, writing the attributes of vertices[i] to inputs[i]. Each
+     * attribute is decoded for the entire batch before moving on to the next one.
+     */
+    void LoadVertices(PAddr base_address, std::span<const u32> vertices,
+                      std::span<AttributeBuffer> inputs,
+                      const AttributeBuffer& input_default_attributes) const;
 
     int GetNumTotalAttributes() const {
         return num_total_attributes;
     }
 
 private:
+    /// Converts the components of one attribute to f24, filling in the missing ones.
+    using DecodeFunc = void (*)(const u8* data, Common::Vec4<f24>& out);
+
+    /// Precomputed description of how a single attribute is fetched from the loader arrays.
+    struct AttributePlan {
+        u32 attribute;
+        u32 source_offset;
+        u32 stride;
+        u32 size;
+        DecodeFunc decode;
+    };
+
+    /// Words of the attribute configuration following the base address
+    static constexpr std::size_t LAYOUT_WORDS =
+        (sizeof(PipelineRegs::vertex_attributes) - sizeof(u32)) / sizeof(u32);
+
     Memory::MemorySystem& memory;
-    std::array<u32, 16> vertex_attribute_sources;
-    std::array<u32, 16> vertex_attribute_strides{};
-    std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
-    std::array<u32, 16> vertex_attribute_elements{};
-    std::array<bool, 16> vertex_attribute_is_default;
+    std::array<u32, LAYOUT_WORDS> layout;
+    std::array<AttributePlan, 16> attribute_plans;
+    std::array<u32, 16> default_attributes;
+    u32 num_attribute_plans = 0;
+    u32 num_default_attributes = 0;
+    bool has_retained_attributes = false;
     int num_total_attributes = 0;
 };
 
@@ -0,0 +1,945 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <bit>
+#include <cstring>
+#include "common/arch.h"
+#include "common/color.h"
+#include "common/swap.h"
+#include "video_core/rasterizer_cache/codec_kernels.h"
+#include "video_core/utils.h"
+
+#if CYTRUS_ARCH(x86_64)
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+#elif CYTRUS_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CODEC_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CODEC_TARGET(isa)
+#endif
+
+namespace VideoCore {
+
+namespace {
+
+constexpr std::size_t Index(PixelFormat format) {
+    return static_cast<std::size_t>(format);
+}
+
+/**
+ * Rows of a morton tile are made of four pairs of horizontally adjacent pixels, so the
+ * portable kernels move whole pairs instead of single pixels.
+ */
+template <u32 bytes_per_pixel>
+void UnswizzleTilePairs(const u8* tile, u8* linear, std::ptrdiff_t stride) {
+    for (u32 y = 0; y < 8; y++) {
+        u8* row = linear + y * stride;
+        for (u32 x = 0; x < 8; x += 2) {
+            std::memcpy(row + x * bytes_per_pixel, tile + MortonInterleave(x, y) * bytes_per_pixel,
+                        2 * bytes_per_pixel);
+        }
+    }
+}
+
+template <u32 bytes_per_pixel>
+void SwizzleTilePairs(const u8* linear, std::ptrdiff_t stride, u8* tile) {
+    for (u32 y = 0; y < 8; y++) {
+        const u8* row = linear + y * stride;
+        for (u32 x = 0; x < 8; x += 2) {
+            std::memcpy(tile + MortonInterleave(x, y) * bytes_per_pixel, row + x * bytes_per_pixel,
+                        2 * bytes_per_pixel);
+        }
+    }
+}
+
+/// Converts the pixels left over by a vector loop one at a time.
+template <auto decode_pixel, u32 bytes_per_pixel>
+void DecodeTail(const u8* source, u8* dest, std::size_t count) {
+    for (std::size_t i = 0; i < count; i++) {
+        const auto rgba = decode_pixel(source + i * bytes_per_pixel);
+        std::memcpy(dest + i * 4, rgba.AsArray(), 4);
+    }
+}
+
+template <auto encode_pixel, u32 bytes_per_pixel>
+void EncodeTail(const u8* source, u8* dest, std::size_t count) {
+    for (std::size_t i = 0; i < count; i++) {
+        Common::Vec4<u8> rgba;
+        std::memcpy(rgba.AsArray(), source + i * 4, 4);
+        encode_pixel(rgba, dest + i * bytes_per_pixel);
+    }
+}
+
+template <bool decode>
+void RotateD24S8Tail(const u8* source, u8* dest, std::size_t count) {
+    for (std::size_t i = 0; i < count; i++) {
+        u32 value;
+        std::memcpy(&value, source + i * 4, sizeof(u32));
+        value = decode ? std::rotl(value, 8) : std::rotr(value, 8);
+        std::memcpy(dest + i * 4, &value, sizeof(u32));
+    }
+}
+
+constexpr CodecKernels MakeScalarKernels() {
+    CodecKernels kernels{};
+    kernels.isa = CodecIsa::Scalar;
+    kernels.unswizzle_tile = {nullptr, UnswizzleTilePairs<1>, UnswizzleTilePairs<2>,
+                              UnswizzleTilePairs<3>, UnswizzleTilePairs<4>};
+    kernels.swizzle_tile = {nullptr, SwizzleTilePairs<1>, SwizzleTilePairs<2>,
+                            SwizzleTilePairs<3>, SwizzleTilePairs<4>};
+    return kernels;
+}
+
+constexpr CodecKernels scalar_kernels = MakeScalarKernels();
+
+/// Position of the 4x2 block stored at bytes [block * 8 * bpp, (block + 1) * 8 * bpp) of a tile.
+constexpr u32 BlockX(u32 block) {
+    return ((block >> 1) & 1) * 4;
+}
+
+constexpr u32 BlockY(u32 block) {
+    return (block & 1) * 2 + (block >> 2) * 4;
+}
+
+#if CYTRUS_ARCH(x86_64)
+
+/**
+ * SSE2 is part of the x86_64 baseline and covers every kernel that only needs lane-wise
+ * arithmetic. Byte shuffles use SSSE3 and the widest kernels AVX2, both checked at runtime.
+ */
+__m128i Load128(const u8* source) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+}
+
+void Store128(u8* dest, __m128i value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), value);
+}
+
+void Unswizzle1Sse2(const u8* tile, u8* linear, std::ptrdiff_t stride) {
+    // Each 16 byte quadrant holds a 4x4 block, whose rows are words 0/2, 1/3, 4/6 and 5/7.
+    for (u32 quadrant = 0; quadrant < 4; quadrant++) {
+        __m128i block = Load128(tile + quadrant * 16);
+        block = _mm_shufflelo_epi16(block, _MM_SHUFFLE(3, 1, 2, 0));
+        block = _mm_shufflehi_epi16(block, _MM_SHUFFLE(3, 1, 2, 0));
+        u8* dest = linear + (quadrant >> 1) * 4 * stride + (quadrant & 1) * 4;
+        for (u32 y = 0; y < 4; y++) {
+            const u32 row = static_cast<u32>(_mm_cvtsi128_si32(block));
+            std::memcpy(dest + y * stride, &row, sizeof(u32));
+            block = _mm_srli_si128(block, 4);
+        }
+    }
+}
+
+void Swizzle1Sse2(const u8* linear, std::ptrdiff_t stride, u8* tile) {
+    for (u32 quadrant = 0; quadrant < 4; quadrant++) {
+        const u8* source = linear + (quadrant >> 1) * 4 * stride + (quadrant & 1) * 4;
+        std::array<u32, 4> rows;
+        for (u32 y = 0; y < 4; y++) {
+            std::memcpy(&rows[y], source + y * stride, sizeof(u32));
+        }
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows.data()));
+        block = _mm_shufflelo_epi16(block, _MM_SHUFFLE(3, 1, 2, 0));
+        block = _mm_shufflehi_epi16(block, _MM_SHUFFLE(3, 1, 2, 0));
+        Store128(tile + quadrant * 16, block);
+    }
+}
+
+void Unswizzle2Sse2(const u8* tile, u8* linear, std::ptrdiff_t stride) {
+    for (u32 block = 0; block < 8; block++) {
+        // The pixel pairs of the two rows alternate, so gather the even and odd dwords.
+        const __m128i pixels =
+            _mm_shuffle_epi32(Load128(tile + block * 16), _MM_SHUFFLE(3, 1, 2, 0));
+        u8* dest = linear + BlockY(block) * stride + BlockX(block) * 2;
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), pixels);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + stride), _mm_srli_si128(pixels, 8));
+    }
+}
+
+void Swizzle2Sse2(const u8* linear, std::ptrdiff_t stride, u8* tile) {
+    for (u32 block = 0; block < 8; block++) {
+        const u8* source = linear + BlockY(block) * stride + BlockX(block) * 2;
+        const __m128i row0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+        const __m128i row1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + stride));
+        Store128(tile + block * 16, _mm_unpacklo_epi32(row0, row1));
+    }
+}
+
+void Unswizzle4Sse2(const u8* tile, u8* linear, std::ptrdiff_t stride) {
+    for (u32 block = 0; block < 8; block++) {
+        const __m128i left = Load128(tile + block * 32);
+        const __m128i right = Load128(tile + block * 32 + 16);
+        u8* dest = linear + BlockY(block) * stride + BlockX(block) * 4;
+        Store128(dest, _mm_unpacklo_epi64(left, right));
+        Store128(dest + stride, _mm_unpackhi_epi64(left, right));
+    }
+}
+
+void Swizzle4Sse2(const u8* linear, std::ptrdiff_t stride, u8* tile) {
+    for (u32 block = 0; block < 8; block++) {
+        const u8* source = linear + BlockY(block) * stride + BlockX(block) * 4;
+        const __m128i row0 = Load128(source);
+        const __m128i row1 = Load128(source + stride);
+        Store128(tile + block * 32, _mm_unpacklo_epi64(row0, row1));
+        Store128(tile + block * 32 + 16, _mm_unpackhi_epi64(row0, row1));
+    }
+}
+
+/// Interleaves eight pixels worth of 16-bit channels, each at most 255, into RGBA8.
+void StoreRGBA16(u8* dest, __m128i r, __m128i g, __m128i b, __m128i a) {
+    const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+    const __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+    Store128(dest, _mm_unpacklo_epi16(rg, ba));
+    Store128(dest + 16, _mm_unpackhi_epi16(rg, ba));
+}
+
+/// Splits eight RGBA8 pixels into 16-bit channels.
+void LoadRGBA16(const u8* source, __m128i& r, __m128i& g, __m128i& b, __m128i& a) {
+    const __m128i low = Load128(source);
+    const __m128i high = Load128(source + 16);
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const auto channel = [&](int shift) {
+        return _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(low, shift), mask),
+                               _mm_and_si128(_mm_srli_epi32(high, shift), mask));
+    };
+    r = channel(0);
+    g = channel(8);
+    b = channel(16);
+    a = channel(24);
+}
+
+__m128i Expand5To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 3), _mm_srli_epi16(value, 2));
+}
+
+__m128i Expand4To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 4), value);
+}
+
+void DecodeRGB565Sse2(const u8* source, u8* dest, std::size_t count) {
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask6 = _mm_set1_epi16(0x3F);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i pixels = Load128(source + i * 2);
+        const __m128i r = _mm_srli_epi16(pixels, 11);
+        const __m128i g = _mm_and_si128(_mm_srli_epi16(pixels, 5), mask6);
+        const __m128i b = _mm_and_si128(pixels, mask5);
+        StoreRGBA16(dest + i * 4, Expand5To8(r),
+                    _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4)), Expand5To8(b),
+                    _mm_set1_epi16(0xFF));
+    }
+    DecodeTail<Common::Color::DecodeRGB565, 2>(source + i * 2, dest + i * 4, count - i);
+}
+
+void DecodeRGB5A1Sse2(const u8* source, u8* dest, std::size_t count) {
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask1 = _mm_set1_epi16(0x1);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i pixels = Load128(source + i * 2);
+        const __m128i r = _mm_srli_epi16(pixels, 11);
+        const __m128i g = _mm_and_si128(_mm_srli_epi16(pixels, 6), mask5);
+        const __m128i b = _mm_and_si128(_mm_srli_epi16(pixels, 1), mask5);
+        const __m128i a = _mm_mullo_epi16(_mm_and_si128(pixels, mask1), _mm_set1_epi16(0xFF));
+        StoreRGBA16(dest + i * 4, Expand5To8(r), Expand5To8(g), Expand5To8(b), a);
+    }
+    DecodeTail<Common::Color::DecodeRGB5A1, 2>(source + i * 2, dest + i * 4, count - i);
+}
+
+void DecodeRGBA4Sse2(const u8* source, u8* dest, std::size_t count) {
+    const __m128i mask4 = _mm_set1_epi16(0xF);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i pixels = Load128(source + i * 2);
+        const __m128i r = _mm_srli_epi16(pixels, 12);
+        const __m128i g = _mm_and_si128(_mm_srli_epi16(pixels, 8), mask4);
+        const __m128i b = _mm_and_si128(_mm_srli_epi16(pixels, 4), mask4);
+        const __m128i a = _mm_and_si128(pixels, mask4);
+        StoreRGBA16(dest + i * 4, Expand4To8(r), Expand4To8(g), Expand4To8(b), Expand4To8(a));
+    }
+    DecodeTail<Common::Color::DecodeRGBA4, 2>(source + i * 2, dest + i * 4, count - i);
+}
+
+void DecodeIA8Sse2(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i pixels = Load128(source + i * 2);
+        const __m128i intensity = _mm_srli_epi16(pixels, 8);
+        const __m128i alpha = _mm_and_si128(pixels, _mm_set1_epi16(0xFF));
+        StoreRGBA16(dest + i * 4, intensity, intensity, intensity, alpha);
+    }
+    DecodeTail<Common::Color::DecodeIA8, 2>(source + i * 2, dest + i * 4, count - i);
+}
+
+void DecodeI8Sse2(const u8* source, u8* dest, std::size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i opaque = _mm_set1_epi16(0xFF);
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i pixels = Load128(source + i);
+        const __m128i low = _mm_unpacklo_epi8(pixels, zero);
+        const __m128i high = _mm_unpackhi_epi8(pixels, zero);
+        StoreRGBA16(dest + i * 4, low, low, low, opaque);
+        StoreRGBA16(dest + i * 4 + 32, high, high, high, opaque);
+    }
+    DecodeTail<Common::Color::DecodeI8, 1>(source + i, dest + i * 4, count - i);
+}
+
+void DecodeA8Sse2(const u8* source, u8* dest, std::size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i pixels = Load128(source + i);
+        StoreRGBA16(dest + i * 4, zero, zero, zero, _mm_unpacklo_epi8(pixels, zero));
+        StoreRGBA16(dest + i * 4 + 32, zero, zero, zero, _mm_unpackhi_epi8(pixels, zero));
+    }
+    DecodeTail<Common::Color::DecodeA8, 1>(source + i, dest + i * 4, count - i);
+}
+
+template <bool decode>
+void RotateD24S8Sse2(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i pixels = Load128(source + i * 4);
+        if constexpr (decode) {
+            Store128(dest + i * 4,
+                     _mm_or_si128(_mm_slli_epi32(pixels, 8), _mm_srli_epi32(pixels, 24)));
+        } else {
+            Store128(dest + i * 4,
+                     _mm_or_si128(_mm_srli_epi32(pixels, 8), _mm_slli_epi32(pixels, 24)));
+        }
+    }
+    RotateD24S8Tail<decode>(source + i * 4, dest + i * 4, count - i);
+}
+
+void EncodeRGB565Sse2(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i r, g, b, a;
+        LoadRGBA16(source + i * 4, r, g, b, a);
+        const __m128i pixels = _mm_or_si128(
+            _mm_or_si128(_mm_slli_epi16(_mm_srli_epi16(r, 3), 11),
+                         _mm_slli_epi16(_mm_srli_epi16(g, 2), 5)),
+            _mm_srli_epi16(b, 3));
+        Store128(dest + i * 2, pixels);
+    }
+    EncodeTail<Common::Color::EncodeRGB565, 2>(source + i * 4, dest + i * 2, count - i);
+}
+
+void EncodeRGB5A1Sse2(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i r, g, b, a;
+        LoadRGBA16(source + i * 4, r, g, b, a);
+        const __m128i rg = _mm_or_si128(_mm_slli_epi16(_mm_srli_epi16(r, 3), 11),
+                                        _mm_slli_epi16(_mm_srli_epi16(g, 3), 6));
+        const __m128i ba =
+            _mm_or_si128(_mm_slli_epi16(_mm_srli_epi16(b, 3), 1), _mm_srli_epi16(a, 7));
+        Store128(dest + i * 2, _mm_or_si128(rg, ba));
+    }
+    EncodeTail<Common::Color::EncodeRGB5A1, 2>(source + i * 4, dest + i * 2, count - i);
+}
+
+void EncodeRGBA4Sse2(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i r, g, b, a;
+        LoadRGBA16(source + i * 4, r, g, b, a);
+        const __m128i rg = _mm_or_si128(_mm_slli_epi16(_mm_srli_epi16(r, 4), 12),
+                                        _mm_slli_epi16(_mm_srli_epi16(g, 4), 8));
+        const __m128i ba = _mm_or_si128(_mm_slli_epi16(_mm_srli_epi16(b, 4), 4),
+                                        _mm_srli_epi16(a, 4));
+        Store128(dest + i * 2, _mm_or_si128(rg, ba));
+    }
+    EncodeTail<Common::Color::EncodeRGBA4, 2>(source + i * 4, dest + i * 2, count - i);
+}
+
+/// Computes (r + g + b) / 3 exactly, the sum never exceeds 765.
+__m128i AverageRgb(__m128i r, __m128i g, __m128i b) {
+    const __m128i sum = _mm_add_epi16(_mm_add_epi16(r, g), b);
+    return _mm_srli_epi16(_mm_mulhi_epu16(sum, _mm_set1_epi16(static_cast<s16>(0xAAAB))), 1);
+}
+
+void EncodeIA8Sse2(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i r, g, b, a;
+        LoadRGBA16(source + i * 4, r, g, b, a);
+        Store128(dest + i * 2, _mm_or_si128(a, _mm_slli_epi16(AverageRgb(r, g, b), 8)));
+    }
+    EncodeTail<Common::Color::EncodeIA8, 2>(source + i * 4, dest + i * 2, count - i);
+}
+
+void EncodeI8Sse2(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i r, g, b, a;
+        LoadRGBA16(source + i * 4, r, g, b, a);
+        const __m128i intensity = _mm_packus_epi16(AverageRgb(r, g, b), _mm_setzero_si128());
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + i), intensity);
+    }
+    EncodeTail<Common::Color::EncodeI8, 1>(source + i * 4, dest + i, count - i);
+}
+
+void EncodeA8Sse2(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i r, g, b, a;
+        LoadRGBA16(source + i * 4, r, g, b, a);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + i),
+                         _mm_packus_epi16(a, _mm_setzero_si128()));
+    }
+    EncodeTail<Common::Color::EncodeA8, 1>(source + i * 4, dest + i, count - i);
+}
+
+CODEC_TARGET("ssse3")
+void SwapRGBA8Ssse3(const u8* source, u8* dest, std::size_t count) {
+    const __m128i shuffle = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        Store128(dest + i * 4, _mm_shuffle_epi8(Load128(source + i * 4), shuffle));
+    }
+    for (; i < count; i++) {
+        u32 value;
+        std::memcpy(&value, source + i * 4, sizeof(u32));
+        value = Common::swap32(value);
+        std::memcpy(dest + i * 4, &value, sizeof(u32));
+    }
+}
+
+CODEC_TARGET("ssse3")
+void DecodeRGB8Ssse3(const u8* source, u8* dest, std::size_t count) {
+    const __m128i shuffle =
+        _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    const __m128i opaque = _mm_set1_epi32(static_cast<s32>(0xFF000000));
+    std::size_t i = 0;
+    // Every load reads 16 of the 12 bytes used, so stop early enough to stay in bounds.
+    for (; i + 6 <= count; i += 4) {
+        const __m128i pixels = _mm_shuffle_epi8(Load128(source + i * 3), shuffle);
+        Store128(dest + i * 4, _mm_or_si128(pixels, opaque));
+    }
+    DecodeTail<Common::Color::DecodeRGB8, 3>(source + i * 3, dest + i * 4, count - i);
+}
+
+CODEC_TARGET("ssse3")
+void EncodeRGB8Ssse3(const u8* source, u8* dest, std::size_t count) {
+    const __m128i shuffle =
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i pixels = _mm_shuffle_epi8(Load128(source + i * 4), shuffle);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + i * 3), pixels);
+        const u32 last = static_cast<u32>(_mm_cvtsi128_si32(_mm_srli_si128(pixels, 8)));
+        std::memcpy(dest + i * 3 + 8, &last, sizeof(u32));
+    }
+    EncodeTail<Common::Color::EncodeRGB8, 3>(source + i * 4, dest + i * 3, count - i);
+}
+
+CODEC_TARGET("avx2")
+void Unswizzle4Avx2(const u8* tile, u8* linear, std::ptrdiff_t stride) {
+    for (u32 block = 0; block < 8; block++) {
+        const __m256i pixels = _mm256_permute4x64_epi64(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tile + block * 32)),
+            _MM_SHUFFLE(3, 1, 2, 0));
+        u8* dest = linear + BlockY(block) * stride + BlockX(block) * 4;
+        Store128(dest, _mm256_castsi256_si128(pixels));
+        Store128(dest + stride, _mm256_extracti128_si256(pixels, 1));
+    }
+}
+
+CODEC_TARGET("avx2")
+void Swizzle4Avx2(const u8* linear, std::ptrdiff_t stride, u8* tile) {
+    for (u32 block = 0; block < 8; block++) {
+        const u8* source = linear + BlockY(block) * stride + BlockX(block) * 4;
+        const __m256i rows =
+            _mm256_inserti128_si256(_mm256_castsi128_si256(Load128(source)),
+                                    Load128(source + stride), 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile + block * 32),
+                            _mm256_permute4x64_epi64(rows, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+}
+
+CODEC_TARGET("avx2")
+void SwapRGBA8Avx2(const u8* source, u8* dest, std::size_t count) {
+    const __m256i shuffle =
+        _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6,
+                         5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 4),
+                            _mm256_shuffle_epi8(pixels, shuffle));
+    }
+    SwapRGBA8Ssse3(source + i * 4, dest + i * 4, count - i);
+}
+
+/// Interleaves sixteen pixels worth of 16-bit channels into RGBA8, keeping them in order
+/// across the two 128-bit lanes.
+CODEC_TARGET("avx2")
+void StoreRGBA16Avx2(u8* dest, __m256i r, __m256i g, __m256i b, __m256i a) {
+    const __m256i rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+    const __m256i ba = _mm256_or_si256(b, _mm256_slli_epi16(a, 8));
+    const __m256i low = _mm256_unpacklo_epi16(rg, ba);
+    const __m256i high = _mm256_unpackhi_epi16(rg, ba);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest),
+                        _mm256_permute2x128_si256(low, high, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 32),
+                        _mm256_permute2x128_si256(low, high, 0x31));
+}
+
+CODEC_TARGET("avx2")
+__m256i Expand5To8Avx2(__m256i value) {
+    return _mm256_or_si256(_mm256_slli_epi16(value, 3), _mm256_srli_epi16(value, 2));
+}
+
+CODEC_TARGET("avx2")
+__m256i Expand4To8Avx2(__m256i value) {
+    return _mm256_or_si256(_mm256_slli_epi16(value, 4), value);
+}
+
+CODEC_TARGET("avx2")
+void DecodeRGB565Avx2(const u8* source, u8* dest, std::size_t count) {
+    const __m256i mask5 = _mm256_set1_epi16(0x1F);
+    const __m256i mask6 = _mm256_set1_epi16(0x3F);
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i pixels =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i * 2));
+        const __m256i r = _mm256_srli_epi16(pixels, 11);
+        const __m256i g = _mm256_and_si256(_mm256_srli_epi16(pixels, 5), mask6);
+        const __m256i b = _mm256_and_si256(pixels, mask5);
+        StoreRGBA16Avx2(dest + i * 4, Expand5To8Avx2(r),
+                        _mm256_or_si256(_mm256_slli_epi16(g, 2), _mm256_srli_epi16(g, 4)),
+                        Expand5To8Avx2(b), _mm256_set1_epi16(0xFF));
+    }
+    DecodeRGB565Sse2(source + i * 2, dest + i * 4, count - i);
+}
+
+CODEC_TARGET("avx2")
+void DecodeRGBA4Avx2(const u8* source, u8* dest, std::size_t count) {
+    const __m256i mask4 = _mm256_set1_epi16(0xF);
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i pixels =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i * 2));
+        const __m256i r = _mm256_srli_epi16(pixels, 12);
+        const __m256i g = _mm256_and_si256(_mm256_srli_epi16(pixels, 8), mask4);
+        const __m256i b = _mm256_and_si256(_mm256_srli_epi16(pixels, 4), mask4);
+        const __m256i a = _mm256_and_si256(pixels, mask4);
+        StoreRGBA16Avx2(dest + i * 4, Expand4To8Avx2(r), Expand4To8Avx2(g), Expand4To8Avx2(b),
+                        Expand4To8Avx2(a));
+    }
+    DecodeRGBA4Sse2(source + i * 2, dest + i * 4, count - i);
+}
+
+constexpr void SetSse2Kernels(CodecKernels& kernels) {
+    kernels.unswizzle_tile[1] = Unswizzle1Sse2;
+    kernels.unswizzle_tile[2] = Unswizzle2Sse2;
+    kernels.unswizzle_tile[4] = Unswizzle4Sse2;
+    kernels.swizzle_tile[1] = Swizzle1Sse2;
+    kernels.swizzle_tile[2] = Swizzle2Sse2;
+    kernels.swizzle_tile[4] = Swizzle4Sse2;
+
+    kernels.decode[Index(PixelFormat::RGB5A1)] = DecodeRGB5A1Sse2;
+    kernels.decode[Index(PixelFormat::RGB565)] = DecodeRGB565Sse2;
+    kernels.decode[Index(PixelFormat::RGBA4)] = DecodeRGBA4Sse2;
+    kernels.decode[Index(PixelFormat::IA8)] = DecodeIA8Sse2;
+    kernels.decode[Index(PixelFormat::I8)] = DecodeI8Sse2;
+    kernels.decode[Index(PixelFormat::A8)] = DecodeA8Sse2;
+    kernels.decode[Index(PixelFormat::D24S8)] = RotateD24S8Sse2<true>;
+
+    kernels.encode[Index(PixelFormat::RGB5A1)] = EncodeRGB5A1Sse2;
+    kernels.encode[Index(PixelFormat::RGB565)] = EncodeRGB565Sse2;
+    kernels.encode[Index(PixelFormat::RGBA4)] = EncodeRGBA4Sse2;
+    kernels.encode[Index(PixelFormat::IA8)] = EncodeIA8Sse2;
+    kernels.encode[Index(PixelFormat::I8)] = EncodeI8Sse2;
+    kernels.encode[Index(PixelFormat::A8)] = EncodeA8Sse2;
+    kernels.encode[Index(PixelFormat::D24S8)] = RotateD24S8Sse2<false>;
+}
+
+constexpr CodecKernels MakeSsse3Kernels() {
+    CodecKernels kernels = MakeScalarKernels();
+    kernels.isa = CodecIsa::SSSE3;
+    SetSse2Kernels(kernels);
+    kernels.decode[Index(PixelFormat::RGBA8)] = SwapRGBA8Ssse3;
+    kernels.decode[Index(PixelFormat::RGB8)] = DecodeRGB8Ssse3;
+    kernels.encode[Index(PixelFormat::RGBA8)] = SwapRGBA8Ssse3;
+    kernels.encode[Index(PixelFormat::RGB8)] = EncodeRGB8Ssse3;
+    return kernels;
+}
+
+constexpr CodecKernels MakeAvx2Kernels() {
+    CodecKernels kernels = MakeSsse3Kernels();
+    kernels.isa = CodecIsa::AVX2;
+    kernels.unswizzle_tile[4] = Unswizzle4Avx2;
+    kernels.swizzle_tile[4] = Swizzle4Avx2;
+    kernels.decode[Index(PixelFormat::RGBA8)] = SwapRGBA8Avx2;
+    kernels.decode[Index(PixelFormat::RGB565)] = DecodeRGB565Avx2;
+    kernels.decode[Index(PixelFormat::RGBA4)] = DecodeRGBA4Avx2;
+    kernels.encode[Index(PixelFormat::RGBA8)] = SwapRGBA8Avx2;
+    return kernels;
+}
+
+constexpr CodecKernels ssse3_kernels = MakeSsse3Kernels();
+constexpr CodecKernels avx2_kernels = MakeAvx2Kernels();
+
+#elif CYTRUS_ARCH(arm64)
+
+void Unswizzle1Neon(const u8* tile, u8* linear, std::ptrdiff_t stride) {
+    // Each 16 byte quadrant holds a 4x4 block, whose rows are words 0/2, 1/3, 4/6 and 5/7.
+    for (u32 quadrant = 0; quadrant < 4; quadrant++) {
+        const uint16x8_t words = vreinterpretq_u16_u8(vld1q_u8(tile + quadrant * 16));
+        const uint16x8x2_t rows = vuzpq_u16(words, words);
+        const uint32x4_t even = vreinterpretq_u32_u16(rows.val[0]);
+        const uint32x4_t odd = vreinterpretq_u32_u16(rows.val[1]);
+        u8* dest = linear + (quadrant >> 1) * 4 * stride + (quadrant & 1) * 4;
+        vst1q_lane_u32(reinterpret_cast<u32*>(dest), even, 0);
+        vst1q_lane_u32(reinterpret_cast<u32*>(dest + stride), odd, 0);
+        vst1q_lane_u32(reinterpret_cast<u32*>(dest + 2 * stride), even, 1);
+        vst1q_lane_u32(reinterpret_cast<u32*>(dest + 3 * stride), odd, 1);
+    }
+}
+
+void Swizzle1Neon(const u8* linear, std::ptrdiff_t stride, u8* tile) {
+    for (u32 quadrant = 0; quadrant < 4; quadrant++) {
+        const u8* source = linear + (quadrant >> 1) * 4 * stride + (quadrant & 1) * 4;
+        uint32x2_t even = vdup_n_u32(0);
+        uint32x2_t odd = vdup_n_u32(0);
+        even = vld1_lane_u32(reinterpret_cast<const u32*>(source), even, 0);
+        odd = vld1_lane_u32(reinterpret_cast<const u32*>(source + stride), odd, 0);
+        even = vld1_lane_u32(reinterpret_cast<const u32*>(source + 2 * stride), even, 1);
+        odd = vld1_lane_u32(reinterpret_cast<const u32*>(source + 3 * stride), odd, 1);
+        const uint16x4x2_t words =
+            vzip_u16(vreinterpret_u16_u32(even), vreinterpret_u16_u32(odd));
+        vst1q_u16(reinterpret_cast<u16*>(tile + quadrant * 16),
+                  vcombine_u16(words.val[0], words.val[1]));
+    }
+}
+
+void Unswizzle2Neon(const u8* tile, u8* linear, std::ptrdiff_t stride) {
+    for (u32 block = 0; block < 8; block++) {
+        const uint32x4_t pairs = vld1q_u32(reinterpret_cast<const u32*>(tile + block * 16));
+        const uint32x4x2_t rows = vuzpq_u32(pairs, pairs);
+        u8* dest = linear + BlockY(block) * stride + BlockX(block) * 2;
+        vst1_u32(reinterpret_cast<u32*>(dest), vget_low_u32(rows.val[0]));
+        vst1_u32(reinterpret_cast<u32*>(dest + stride), vget_low_u32(rows.val[1]));
+    }
+}
+
+void Swizzle2Neon(const u8* linear, std::ptrdiff_t stride, u8* tile) {
+    for (u32 block = 0; block < 8; block++) {
+        const u8* source = linear + BlockY(block) * stride + BlockX(block) * 2;
+        const uint32x2_t row0 = vld1_u32(reinterpret_cast<const u32*>(source));
+        const uint32x2_t row1 = vld1_u32(reinterpret_cast<const u32*>(source + stride));
+        const uint32x2x2_t pairs = vzip_u32(row0, row1);
+        vst1q_u32(reinterpret_cast<u32*>(tile + block * 16),
+                  vcombine_u32(pairs.val[0], pairs.val[1]));
+    }
+}
+
+void Unswizzle4Neon(const u8* tile, u8* linear, std::ptrdiff_t stride) {
+    for (u32 block = 0; block < 8; block++) {
+        const uint64x2_t left = vld1q_u64(reinterpret_cast<const u64*>(tile + block * 32));
+        const uint64x2_t right = vld1q_u64(reinterpret_cast<const u64*>(tile + block * 32 + 16));
+        u8* dest = linear + BlockY(block) * stride + BlockX(block) * 4;
+        vst1q_u64(reinterpret_cast<u64*>(dest),
+                  vcombine_u64(vget_low_u64(left), vget_low_u64(right)));
+        vst1q_u64(reinterpret_cast<u64*>(dest + stride),
+                  vcombine_u64(vget_high_u64(left), vget_high_u64(right)));
+    }
+}
+
+void Swizzle4Neon(const u8* linear, std::ptrdiff_t stride, u8* tile) {
+    for (u32 block = 0; block < 8; block++) {
+        const u8* source = linear + BlockY(block) * stride + BlockX(block) * 4;
+        const uint64x2_t row0 = vld1q_u64(reinterpret_cast<const u64*>(source));
+        const uint64x2_t row1 = vld1q_u64(reinterpret_cast<const u64*>(source + stride));
+        vst1q_u64(reinterpret_cast<u64*>(tile + block * 32),
+                  vcombine_u64(vget_low_u64(row0), vget_low_u64(row1)));
+        vst1q_u64(reinterpret_cast<u64*>(tile + block * 32 + 16),
+                  vcombine_u64(vget_high_u64(row0), vget_high_u64(row1)));
+    }
+}
+
+void StoreRGBA16(u8* dest, uint16x8_t r, uint16x8_t g, uint16x8_t b, uint16x8_t a) {
+    vst4_u8(dest, uint8x8x4_t{{vmovn_u16(r), vmovn_u16(g), vmovn_u16(b), vmovn_u16(a)}});
+}
+
+uint16x8_t Expand5To8(uint16x8_t value) {
+    return vorrq_u16(vshlq_n_u16(value, 3), vshrq_n_u16(value, 2));
+}
+
+uint16x8_t Expand4To8(uint16x8_t value) {
+    return vorrq_u16(vshlq_n_u16(value, 4), value);
+}
+
+void SwapRGBA8Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_u8(dest + i * 4, vrev32q_u8(vld1q_u8(source + i * 4)));
+    }
+    for (; i < count; i++) {
+        u32 value;
+        std::memcpy(&value, source + i * 4, sizeof(u32));
+        value = Common::swap32(value);
+        std::memcpy(dest + i * 4, &value, sizeof(u32));
+    }
+}
+
+void DecodeRGB8Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16x3_t bgr = vld3q_u8(source + i * 3);
+        vst4q_u8(dest + i * 4, uint8x16x4_t{{bgr.val[2], bgr.val[1], bgr.val[0], vdupq_n_u8(255)}});
+    }
+    DecodeTail<Common::Color::DecodeRGB8, 3>(source + i * 3, dest + i * 4, count - i);
+}
+
+void DecodeRGB565Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8_t pixels = vld1q_u16(reinterpret_cast<const u16*>(source + i * 2));
+        const uint16x8_t r = vshrq_n_u16(pixels, 11);
+        const uint16x8_t g = vandq_u16(vshrq_n_u16(pixels, 5), vdupq_n_u16(0x3F));
+        const uint16x8_t b = vandq_u16(pixels, vdupq_n_u16(0x1F));
+        StoreRGBA16(dest + i * 4, Expand5To8(r), vorrq_u16(vshlq_n_u16(g, 2), vshrq_n_u16(g, 4)),
+                    Expand5To8(b), vdupq_n_u16(0xFF));
+    }
+    DecodeTail<Common::Color::DecodeRGB565, 2>(source + i * 2, dest + i * 4, count - i);
+}
+
+void DecodeRGB5A1Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8_t pixels = vld1q_u16(reinterpret_cast<const u16*>(source + i * 2));
+        const uint16x8_t r = vshrq_n_u16(pixels, 11);
+        const uint16x8_t g = vandq_u16(vshrq_n_u16(pixels, 6), vdupq_n_u16(0x1F));
+        const uint16x8_t b = vandq_u16(vshrq_n_u16(pixels, 1), vdupq_n_u16(0x1F));
+        const uint16x8_t a = vmulq_n_u16(vandq_u16(pixels, vdupq_n_u16(0x1)), 0xFF);
+        StoreRGBA16(dest + i * 4, Expand5To8(r), Expand5To8(g), Expand5To8(b), a);
+    }
+    DecodeTail<Common::Color::DecodeRGB5A1, 2>(source + i * 2, dest + i * 4, count - i);
+}
+
+void DecodeRGBA4Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8_t pixels = vld1q_u16(reinterpret_cast<const u16*>(source + i * 2));
+        const uint16x8_t mask4 = vdupq_n_u16(0xF);
+        const uint16x8_t r = vshrq_n_u16(pixels, 12);
+        const uint16x8_t g = vandq_u16(vshrq_n_u16(pixels, 8), mask4);
+        const uint16x8_t b = vandq_u16(vshrq_n_u16(pixels, 4), mask4);
+        const uint16x8_t a = vandq_u16(pixels, mask4);
+        StoreRGBA16(dest + i * 4, Expand4To8(r), Expand4To8(g), Expand4To8(b), Expand4To8(a));
+    }
+    DecodeTail<Common::Color::DecodeRGBA4, 2>(source + i * 2, dest + i * 4, count - i);
+}
+
+void DecodeIA8Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint8x8x2_t pixels = vld2_u8(source + i * 2);
+        const uint8x8_t intensity = pixels.val[1];
+        vst4_u8(dest + i * 4, uint8x8x4_t{{intensity, intensity, intensity, pixels.val[0]}});
+    }
+    DecodeTail<Common::Color::DecodeIA8, 2>(source + i * 2, dest + i * 4, count - i);
+}
+
+void DecodeI8Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t intensity = vld1q_u8(source + i);
+        vst4q_u8(dest + i * 4, uint8x16x4_t{{intensity, intensity, intensity, vdupq_n_u8(255)}});
+    }
+    DecodeTail<Common::Color::DecodeI8, 1>(source + i, dest + i * 4, count - i);
+}
+
+void DecodeA8Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t zero = vdupq_n_u8(0);
+        vst4q_u8(dest + i * 4, uint8x16x4_t{{zero, zero, zero, vld1q_u8(source + i)}});
+    }
+    DecodeTail<Common::Color::DecodeA8, 1>(source + i, dest + i * 4, count - i);
+}
+
+template <bool decode>
+void RotateD24S8Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const uint32x4_t pixels = vld1q_u32(reinterpret_cast<const u32*>(source + i * 4));
+        if constexpr (decode) {
+            vst1q_u32(reinterpret_cast<u32*>(dest + i * 4),
+                      vorrq_u32(vshlq_n_u32(pixels, 8), vshrq_n_u32(pixels, 24)));
+        } else {
+            vst1q_u32(reinterpret_cast<u32*>(dest + i * 4),
+                      vorrq_u32(vshrq_n_u32(pixels, 8), vshlq_n_u32(pixels, 24)));
+        }
+    }
+    RotateD24S8Tail<decode>(source + i * 4, dest + i * 4, count - i);
+}
+
+void EncodeRGB8Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16x4_t rgba = vld4q_u8(source + i * 4);
+        vst3q_u8(dest + i * 3, uint8x16x3_t{{rgba.val[2], rgba.val[1], rgba.val[0]}});
+    }
+    EncodeTail<Common::Color::EncodeRGB8, 3>(source + i * 4, dest + i * 3, count - i);
+}
+
+/// Splits eight RGBA8 pixels into 16-bit channels.
+uint16x8x4_t LoadRGBA16(const u8* source) {
+    const uint8x8x4_t rgba = vld4_u8(source);
+    return uint16x8x4_t{{vmovl_u8(rgba.val[0]), vmovl_u8(rgba.val[1]), vmovl_u8(rgba.val[2]),
+                         vmovl_u8(rgba.val[3])}};
+}
+
+void EncodeRGB565Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8x4_t rgba = LoadRGBA16(source + i * 4);
+        const uint16x8_t pixels = vorrq_u16(
+            vorrq_u16(vshlq_n_u16(vshrq_n_u16(rgba.val[0], 3), 11),
+                      vshlq_n_u16(vshrq_n_u16(rgba.val[1], 2), 5)),
+            vshrq_n_u16(rgba.val[2], 3));
+        vst1q_u16(reinterpret_cast<u16*>(dest + i * 2), pixels);
+    }
+    EncodeTail<Common::Color::EncodeRGB565, 2>(source + i * 4, dest + i * 2, count - i);
+}
+
+void EncodeRGB5A1Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8x4_t rgba = LoadRGBA16(source + i * 4);
+        const uint16x8_t rg = vorrq_u16(vshlq_n_u16(vshrq_n_u16(rgba.val[0], 3), 11),
+                                        vshlq_n_u16(vshrq_n_u16(rgba.val[1], 3), 6));
+        const uint16x8_t ba = vorrq_u16(vshlq_n_u16(vshrq_n_u16(rgba.val[2], 3), 1),
+                                        vshrq_n_u16(rgba.val[3], 7));
+        vst1q_u16(reinterpret_cast<u16*>(dest + i * 2), vorrq_u16(rg, ba));
+    }
+    EncodeTail<Common::Color::EncodeRGB5A1, 2>(source + i * 4, dest + i * 2, count - i);
+}
+
+void EncodeRGBA4Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8x4_t rgba = LoadRGBA16(source + i * 4);
+        const uint16x8_t rg = vorrq_u16(vshlq_n_u16(vshrq_n_u16(rgba.val[0], 4), 12),
+                                        vshlq_n_u16(vshrq_n_u16(rgba.val[1], 4), 8));
+        const uint16x8_t ba = vorrq_u16(vshlq_n_u16(vshrq_n_u16(rgba.val[2], 4), 4),
+                                        vshrq_n_u16(rgba.val[3], 4));
+        vst1q_u16(reinterpret_cast<u16*>(dest + i * 2), vorrq_u16(rg, ba));
+    }
+    EncodeTail<Common::Color::EncodeRGBA4, 2>(source + i * 4, dest + i * 2, count - i);
+}
+
+/// Computes (r + g + b) / 3 exactly, the sum never exceeds 765.
+uint8x8_t AverageRgb(const uint8x8x4_t& rgba) {
+    const uint16x8_t sum =
+        vaddw_u8(vaddl_u8(rgba.val[0], rgba.val[1]), rgba.val[2]);
+    const uint16x8_t scale = vdupq_n_u16(0xAAAB);
+    const uint32x4_t low = vshrq_n_u32(vmull_u16(vget_low_u16(sum), vget_low_u16(scale)), 17);
+    const uint32x4_t high = vshrq_n_u32(vmull_u16(vget_high_u16(sum), vget_high_u16(scale)), 17);
+    return vmovn_u16(vcombine_u16(vmovn_u32(low), vmovn_u32(high)));
+}
+
+void EncodeIA8Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint8x8x4_t rgba = vld4_u8(source + i * 4);
+        vst2_u8(dest + i * 2, uint8x8x2_t{{rgba.val[3], AverageRgb(rgba)}});
+    }
+    EncodeTail<Common::Color::EncodeIA8, 2>(source + i * 4, dest + i * 2, count - i);
+}
+
+void EncodeI8Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vst1_u8(dest + i, AverageRgb(vld4_u8(source + i * 4)));
+    }
+    EncodeTail<Common::Color::EncodeI8, 1>(source + i * 4, dest + i, count - i);
+}
+
+void EncodeA8Neon(const u8* source, u8* dest, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        vst1q_u8(dest + i, vld4q_u8(source + i * 4).val[3]);
+    }
+    EncodeTail<Common::Color::EncodeA8, 1>(source + i * 4, dest + i, count - i);
+}
+
+constexpr CodecKernels MakeNeonKernels() {
+    CodecKernels kernels = MakeScalarKernels();
+    kernels.isa = CodecIsa::NEON;
+    kernels.unswizzle_tile[1] = Unswizzle1Neon;
+    kernels.unswizzle_tile[2] = Unswizzle2Neon;
+    kernels.unswizzle_tile[4] = Unswizzle4Neon;
+    kernels.swizzle_tile[1] = Swizzle1Neon;
+    kernels.swizzle_tile[2] = Swizzle2Neon;
+    kernels.swizzle_tile[4] = Swizzle4Neon;
+
+    kernels.decode[Index(PixelFormat::RGBA8)] = SwapRGBA8Neon;
+    kernels.decode[Index(PixelFormat::RGB8)] = DecodeRGB8Neon;
+    kernels.decode[Index(PixelFormat::RGB5A1)] = DecodeRGB5A1Neon;
+    kernels.decode[Index(PixelFormat::RGB565)] = DecodeRGB565Neon;
+    kernels.decode[Index(PixelFormat::RGBA4)] = DecodeRGBA4Neon;
+    kernels.decode[Index(PixelFormat::IA8)] = DecodeIA8Neon;
+    kernels.decode[Index(PixelFormat::I8)] = DecodeI8Neon;
+    kernels.decode[Index(PixelFormat::A8)] = DecodeA8Neon;
+    kernels.decode[Index(PixelFormat::D24S8)] = RotateD24S8Neon<true>;
+
+    kernels.encode[Index(PixelFormat::RGBA8)] = SwapRGBA8Neon;
+    kernels.encode[Index(PixelFormat::RGB8)] = EncodeRGB8Neon;
+    kernels.encode[Index(PixelFormat::RGB5A1)] = EncodeRGB5A1Neon;
+    kernels.encode[Index(PixelFormat::RGB565)] = EncodeRGB565Neon;
+    kernels.encode[Index(PixelFormat::RGBA4)] = EncodeRGBA4Neon;
+    kernels.encode[Index(PixelFormat::IA8)] = EncodeIA8Neon;
+    kernels.encode[Index(PixelFormat::I8)] = EncodeI8Neon;
+    kernels.encode[Index(PixelFormat::A8)] = EncodeA8Neon;
+    kernels.encode[Index(PixelFormat::D24S8)] = RotateD24S8Neon<false>;
+    return kernels;
+}
+
+constexpr CodecKernels neon_kernels = MakeNeonKernels();
+
+#endif
+
+} // Anonymous namespace
+
+const CodecKernels* GetCodecKernels(CodecIsa isa) {
+    switch (isa) {
+    case CodecIsa::Scalar:
+        return &scalar_kernels;
+#if CYTRUS_ARCH(x86_64)
+    case CodecIsa::SSSE3:
+        return Common::GetCPUCaps().ssse3 ? &ssse3_kernels : nullptr;
+    case CodecIsa::AVX2:
+        return Common::GetCPUCaps().avx2 ? &avx2_kernels : nullptr;
+#elif CYTRUS_ARCH(arm64)
+    case CodecIsa::NEON:
+        return &neon_kernels;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+const CodecKernels& GetCodecKernels() {
+    static const CodecKernels& kernels = []() -> const CodecKernels& {
+        for (const CodecIsa isa : {CodecIsa::AVX2, CodecIsa::SSSE3, CodecIsa::NEON}) {
+            if (const CodecKernels* best = GetCodecKernels(isa)) {
+                return *best;
+            }
+        }
+        return scalar_kernels;
+    }();
+    return kernels;
+}
+
+} // namespace VideoCore
@@ -0,0 +1,51 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+#include "video_core/rasterizer_cache/pixel_format.h"
+
+namespace VideoCore {
+
+/// Reorders the 64 pixels of a morton tile into 8 rows of 8 pixels.
+/// Row y of the tile is written to linear + y * stride.
+using UnswizzleTileFunc = void (*)(const u8* tile, u8* linear, std::ptrdiff_t stride);
+
+/// Reorders 8 rows of 8 pixels, row y being read from linear + y * stride, into a morton tile.
+using SwizzleTileFunc = void (*)(const u8* linear, std::ptrdiff_t stride, u8* tile);
+
+/// Converts count pixels between a PICA pixel format and RGBA8.
+using ConvertPixelsFunc = void (*)(const u8* source, u8* dest, std::size_t count);
+
+enum class CodecIsa : u32 {
+    Scalar,
+    SSSE3,
+    AVX2,
+    NEON,
+};
+
+/**
+ * Tile (un)swizzling and pixel conversion kernels used by the texture codec. The conversion
+ * kernels produce exactly the same output as DecodePixel/EncodePixel with conversion enabled,
+ * a null entry means the format is handled by the per-pixel path.
+ */
+struct CodecKernels {
+    CodecIsa isa;
+    /// Indexed by the number of bytes per pixel, from 1 to 4.
+    std::array<UnswizzleTileFunc, 5> unswizzle_tile;
+    std::array<SwizzleTileFunc, 5> swizzle_tile;
+    std::array<ConvertPixelsFunc, PIXEL_FORMAT_COUNT> decode;
+    std::array<ConvertPixelsFunc, PIXEL_FORMAT_COUNT> encode;
+};
+
+/// Returns the kernels for the provided instruction set, or nullptr if the host lacks it.
+const CodecKernels* GetCodecKernels(CodecIsa isa);
+
+/// Returns the fastest kernels supported by the host CPU.
+const CodecKernels& GetCodecKernels();
+
+} // namespace VideoCore
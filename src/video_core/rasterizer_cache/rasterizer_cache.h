@@ -6,7 +6,6 @@
 
 #include <type_traits>
 #include <boost/container/small_vector.hpp>
-#include <boost/range/iterator_range.hpp>
 #include "common/alignment.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
@@ -28,19 +27,17 @@ MICROPROFILE_DECLARE(RasterizerCache_UploadSurface);
 MICROPROFILE_DECLARE(RasterizerCache_DownloadSurface);
 MICROPROFILE_DECLARE(RasterizerCache_Invalidation);
 
-constexpr auto RangeFromInterval(const auto& map, const auto& interval) {
-    return boost::make_iterator_range(map.equal_range(interval));
-}
-
 template <class T>
 RasterizerCache<T>::RasterizerCache(Memory::MemorySystem& memory_,
                                     CustomTexManager& custom_tex_manager_, Runtime& runtime_,
                                     Pica::RegsInternal& regs_, RendererBase& renderer_)
     : memory{memory_}, custom_tex_manager{custom_tex_manager_}, runtime{runtime_}, regs{regs_},
-      renderer{renderer_}, resolution_scale_factor{renderer.GetResolutionScaleFactor()},
+      renderer{renderer_}, page_table(NUM_PAGES),
+      resolution_scale_factor{renderer.GetResolutionScaleFactor()},
       filter{Settings::values.texture_filter.GetValue()},
       dump_textures{Settings::values.dump_textures.GetValue()},
-      use_custom_textures{Settings::values.custom_textures.GetValue()} {
+      use_custom_textures{Settings::values.custom_textures.GetValue()},
+      staging_workers{std::max(std::thread::hardware_concurrency(), 2U) - 1, "TextureStaging"} {
     using TextureConfig = Pica::TexturingRegs::TextureConfig;
 
     // Create null handles for all cached resources
@@ -428,6 +425,7 @@ void RasterizerCache<T>::CopySurface(Surface& src_surface, Surface& dst_surface,
     const u32 dst_scale = dst_surface.res_scale;
     if (src_scale > dst_scale) {
         dst_surface.ScaleUp(src_scale);
+        InvalidateLastMatch(dst_surface.addr, dst_surface.end);
     }
 
     const auto src_rect = src_surface.GetScaledSubRect(subrect_params);
@@ -791,16 +789,8 @@ void RasterizerCache<T>::ForEachSurfaceInRegion(PAddr addr, std::size_t size, Fu
     using FuncReturn = typename std::invoke_result<Func, SurfaceId, Surface&>::type;
     static constexpr bool BOOL_BREAK = std::is_same_v<FuncReturn, bool>;
     boost::container::small_vector<SurfaceId, 8> surfaces;
-    ForEachPage(addr, size, [this, &surfaces, addr, size, func](u64 page) {
-        const auto it = page_table.find(page);
-        if (it == page_table.end()) {
-            if constexpr (BOOL_BREAK) {
-                return false;
-            } else {
-                return;
-            }
-        }
-        for (const SurfaceId surface_id : it->second) {
+    ForEachPage(addr, size, [this, &surfaces, addr, size, &func](u64 page) {
+        for (const SurfaceId surface_id : page_table[page].surfaces) {
             Surface& surface = slot_surfaces[surface_id];
             if (True(surface.flags & SurfaceFlagBits::Picked)) {
                 continue;
@@ -832,6 +822,14 @@ template <class T>
 template <MatchFlags find_flags>
 SurfaceId RasterizerCache<T>::FindMatch(const SurfaceParams& params, ScaleMatch match_scale_type,
                                         std::optional<SurfaceInterval> validate_interval) {
+    // The same lookup is often repeated across draws without the surfaces it depends on changing
+    if (last_match && last_match->find_flags == find_flags &&
+        last_match->match_scale_type == match_scale_type &&
+        last_match->validate_interval == validate_interval && last_match->params == params &&
+        last_match->params.res_scale == params.res_scale) {
+        return last_match->match_id;
+    }
+
     SurfaceId match_id{};
     bool match_valid = false;
     u32 match_scale = 0;
@@ -912,9 +910,25 @@ SurfaceId RasterizerCache<T>::FindMatch(const SurfaceParams& params, ScaleMatch
             return std::make_pair(surface.CanTexCopy(params), surface.GetInterval());
         });
     });
+
+    last_match = MatchCacheEntry{
+        .params = params,
+        .find_flags = find_flags,
+        .match_scale_type = match_scale_type,
+        .validate_interval = validate_interval,
+        .match_id = match_id,
+    };
     return match_id;
 }
 
+template <class T>
+void RasterizerCache<T>::InvalidateLastMatch(PAddr addr, PAddr end) {
+    // Only surfaces overlapping the params take part in a lookup
+    if (last_match && addr < last_match->params.end && last_match->params.addr < end) {
+        last_match.reset();
+    }
+}
+
 template <class T>
 void RasterizerCache<T>::ValidateSurface(SurfaceId surface_id, PAddr addr, u32 size) {
     if (size == 0) [[unlikely]] {
@@ -938,7 +952,10 @@ void RasterizerCache<T>::ValidateSurface(SurfaceId surface_id, PAddr addr, u32 s
 
     auto notify_validated = [&](SurfaceInterval interval) {
         surface.MarkValid(interval);
+        InvalidateLastMatch(surface.addr, surface.end);
         validate_regions.erase(interval);
+        memory.RasterizerNotifyGpuAccess(boost::icl::first(interval),
+                                         static_cast<u32>(boost::icl::length(interval)), false);
     };
 
     const DebugScope scope{runtime, Common::Vec4f{0.f, 1.f, 0.f, 1.f},
@@ -976,7 +993,12 @@ void RasterizerCache<T>::ValidateSurface(SurfaceId surface_id, PAddr addr, u32 s
             continue;
         }
 
-        FlushRegion(params.addr, params.size);
+        // Texture hashes may cover the whole level, so it has to be up to date in guest memory
+        if (dump_textures || use_custom_textures) {
+            FlushRegion(level_interval.lower(), boost::icl::length(level_interval));
+        } else {
+            FlushRegion(params.addr, params.size);
+        }
         if (!use_custom_textures || !UploadCustomSurface(surface_id, interval)) {
             UploadSurface(surface, interval);
         }
@@ -1006,15 +1028,29 @@ void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interva
     }
 
     const auto upload_data = source_ptr.GetWriteBytes(load_info.end - load_info.addr);
-    DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, staging.mapped,
-                  runtime.NeedsConversion(surface.pixel_format));
+    const bool convert = runtime.NeedsConversion(surface.pixel_format);
+    DispatchStagingChunks(load_info.end - load_info.addr, [&](u32 chunk, u32 num_chunks) {
+        DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, staging.mapped,
+                      convert, chunk, num_chunks);
+    });
 
     const bool should_dump = False(surface.flags & SurfaceFlagBits::Custom) &&
                              False(surface.flags & SurfaceFlagBits::RenderTarget);
     if (dump_textures && should_dump) {
-        const u64 hash = ComputeHash(load_info, upload_data);
+        const HashMethod method = custom_tex_manager.GetHashMethods().front();
         const u32 level = surface.LevelOf(load_info.addr);
-        custom_tex_manager.DumpTexture(load_info, level, upload_data, hash);
+        const u64 hash = ComputeHash(surface, load_info, upload_data, method);
+        if (method == HashMethod::XXH3) {
+            // The hash covers the whole level, so dump all of it
+            const SurfaceParams level_info = surface.FromInterval(surface.LevelInterval(level));
+            MemoryRef level_ptr = memory.GetPhysicalRef(level_info.addr);
+            if (level_ptr) [[likely]] {
+                const auto level_data = level_ptr.GetWriteBytes(level_info.end - level_info.addr);
+                custom_tex_manager.DumpTexture(level_info, level, level_data, hash);
+            }
+        } else {
+            custom_tex_manager.DumpTexture(load_info, level, upload_data, hash);
+        }
     }
 
     const BufferTextureCopy upload = {
@@ -1023,21 +1059,44 @@ void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interva
         .texture_rect = surface.GetSubRect(load_info),
         .texture_level = surface.LevelOf(load_info.addr),
     };
+    staging_workers.WaitForRequests();
     surface.Upload(upload, staging);
 }
 
 template <class T>
-u64 RasterizerCache<T>::ComputeHash(const SurfaceParams& load_info, std::span<u8> upload_data) {
-    if (!custom_tex_manager.UseNewHash()) {
+u64 RasterizerCache<T>::ComputeHash(Surface& surface, const SurfaceParams& load_info,
+                                    std::span<u8> upload_data, HashMethod method) {
+    switch (method) {
+    case HashMethod::Legacy: {
         const u32 width = load_info.width;
         const u32 height = load_info.height;
         const u32 bpp = GetFormatBytesPerPixel(load_info.pixel_format);
         auto decoded = std::vector<u8>(width * height * bpp);
         DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, decoded, false);
         return Common::ComputeHash64(decoded.data(), decoded.size());
-    } else {
+    }
+    case HashMethod::CityHash:
         return Common::ComputeHash64(upload_data.data(), upload_data.size());
+    case HashMethod::XXH3: {
+        // Hash the whole level, reusing the hashes of the chunks that were not written since
+        const u32 level = surface.LevelOf(load_info.addr);
+        const SurfaceInterval level_interval = surface.LevelInterval(level);
+        const u32 level_size = static_cast<u32>(boost::icl::length(level_interval));
+        MemoryRef level_ptr = memory.GetPhysicalRef(level_interval.lower());
+        if (!level_ptr) [[unlikely]] {
+            return 0;
+        }
+        std::vector<u64>& chunk_hashes = surface.chunk_hashes[level];
+        chunk_hashes.resize((level_size + TEXTURE_HASH_CHUNK_SIZE - 1) / TEXTURE_HASH_CHUNK_SIZE);
+        const u64 hash = HashTextureChunks(level_ptr.GetWriteBytes(level_size), chunk_hashes);
+
+        // The chunk hashes cover the whole level, not only the interval being loaded. Make the
+        // next CPU write anywhere in it reach InvalidateRegion, which drops the stale hashes.
+        memory.RasterizerNotifyGpuAccess(level_interval.lower(), level_size, false);
+        return hash;
     }
+    }
+    UNREACHABLE();
 }
 
 template <class T>
@@ -1053,11 +1112,18 @@ bool RasterizerCache<T>::UploadCustomSurface(SurfaceId surface_id, SurfaceInterv
         return false;
     }
 
+    // Packs may list several hash methods, e.g. to keep textures dumped with an older one working
     const auto upload_data = source_ptr.GetWriteBytes(load_info.end - load_info.addr);
-    const u64 hash = ComputeHash(load_info, upload_data);
+    Material* material = nullptr;
+    for (const HashMethod method : custom_tex_manager.GetHashMethods()) {
+        const u64 hash = ComputeHash(surface, load_info, upload_data, method);
+        material = custom_tex_manager.GetMaterial(hash);
+        if (material) {
+            break;
+        }
+    }
 
     const u32 level = surface.LevelOf(load_info.addr);
-    Material* material = custom_tex_manager.GetMaterial(hash);
 
     if (!material) {
         return surface.IsCustom();
@@ -1077,6 +1143,7 @@ bool RasterizerCache<T>::UploadCustomSurface(SurfaceId surface_id, SurfaceInterv
                 slot_surfaces.swap_and_insert(surface_id, runtime, old_surface, material);
             slot_surfaces[old_id].flags &= ~SurfaceFlagBits::Registered;
             sentenced.emplace_back(old_id, frame_tick);
+            InvalidateLastMatch(old_surface.addr, old_surface.end);
         }
         Surface& surface = slot_surfaces[surface_id];
         surface.UploadCustom(material, level);
@@ -1114,8 +1181,25 @@ void RasterizerCache<T>::DownloadSurface(Surface& surface, SurfaceInterval inter
     }
 
     const auto download_dest = dest_ptr.GetWriteBytes(flush_end - flush_start);
-    EncodeTexture(flush_info, flush_start, flush_end, staging.mapped, download_dest,
-                  runtime.NeedsConversion(surface.pixel_format));
+    const bool convert = runtime.NeedsConversion(surface.pixel_format);
+    DispatchStagingChunks(flush_end - flush_start, [&](u32 chunk, u32 num_chunks) {
+        EncodeTexture(flush_info, flush_start, flush_end, staging.mapped, download_dest, convert,
+                      chunk, num_chunks);
+    });
+
+    // The guest may read the memory as soon as the flush returns.
+    staging_workers.WaitForRequests();
+}
+
+template <class T>
+template <typename Func>
+void RasterizerCache<T>::DispatchStagingChunks(u32 size, const Func& func) {
+    const u32 num_chunks = std::clamp(size / STAGING_CHUNK_SIZE, 1U,
+                                      static_cast<u32>(staging_workers.NumWorkers()) + 1);
+    for (u32 chunk = 1; chunk < num_chunks; chunk++) {
+        staging_workers.QueueWork([func, chunk, num_chunks] { func(chunk, num_chunks); });
+    }
+    func(0, num_chunks);
 }
 
 template <class T>
@@ -1164,6 +1248,7 @@ bool RasterizerCache<T>::ValidateByReinterpretation(Surface& surface, SurfacePar
         const u32 res_scale = src_surface.res_scale;
         if (res_scale > surface.res_scale) {
             surface.ScaleUp(res_scale);
+            InvalidateLastMatch(surface.addr, surface.end);
         }
         const PAddr addr = boost::icl::lower(interval);
         const SurfaceParams copy_params = surface.FromInterval(copy_interval);
@@ -1183,7 +1268,7 @@ bool RasterizerCache<T>::ValidateByReinterpretation(Surface& surface, SurfacePar
     // If there's a surface with invalid format it means the region was cleared
     // so we don't want to skip validation in that case.
     const bool has_invalid = IntervalHasInvalidPixelFormat(params, interval);
-    const bool is_gpu_modified = boost::icl::contains(dirty_regions, interval);
+    const bool is_gpu_modified = dirty_regions.Contains(interval);
     return !has_invalid && is_gpu_modified;
 }
 
@@ -1205,26 +1290,50 @@ bool RasterizerCache<T>::IntervalHasInvalidPixelFormat(const SurfaceParams& para
 
 template <class T>
 void RasterizerCache<T>::ClearAll(bool flush) {
-    const auto flush_interval = PageMap::interval_type::right_open(0x0, 0xFFFFFFFF);
     // Force flush all surfaces from the cache
     if (flush) {
         FlushRegion(0x0, 0xFFFFFFFF);
     }
     // Unmark all of the marked pages
-    for (auto& pair : RangeFromInterval(cached_pages, flush_interval)) {
-        const auto interval = pair.first & flush_interval;
-
-        const PAddr interval_start_addr = boost::icl::first(interval) << Memory::CYTRUS_PAGE_BITS;
-        const PAddr interval_end_addr = boost::icl::last_next(interval) << Memory::CYTRUS_PAGE_BITS;
-        const u32 interval_size = interval_end_addr - interval_start_addr;
-
-        memory.RasterizerMarkRegionCached(interval_start_addr, interval_size, false);
+    u64 run_start = 0;
+    u64 run_end = 0;
+    const auto unmark_run = [&] {
+        if (run_end > run_start) {
+            memory.RasterizerMarkRegionCached(
+                static_cast<PAddr>(run_start << Memory::CYTRUS_PAGE_BITS),
+                static_cast<u32>((run_end - run_start) << Memory::CYTRUS_PAGE_BITS), false);
+        }
+    };
+    for (u64 page = 0; page < NUM_PAGES; page++) {
+        const auto& cached_counts = page_table[page].cached_counts;
+        if (!cached_counts) {
+            continue;
+        }
+        for (u32 i = 0; i < CPU_PAGES_PER_PAGE; i++) {
+            if ((*cached_counts)[i] == 0) {
+                continue;
+            }
+            const u64 cpu_page = page * CPU_PAGES_PER_PAGE + i;
+            if (cpu_page != run_end) {
+                unmark_run();
+                run_start = cpu_page;
+            }
+            run_end = cpu_page + 1;
+        }
     }
+    unmark_run();
 
     // Remove the whole cache without really looking at it.
-    cached_pages -= flush_interval;
-    dirty_regions.clear();
-    page_table.clear();
+    dirty_regions.Clear();
+    for (PageEntry& entry : page_table) {
+        for (const SurfaceId surface_id : entry.surfaces) {
+            Surface& surface = slot_surfaces[surface_id];
+            surface.InvalidateChunkHashes(surface.GetInterval());
+        }
+        entry.surfaces.clear();
+        entry.cached_counts.reset();
+    }
+    last_match.reset();
 }
 
 template <class T>
@@ -1236,9 +1345,9 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, SurfaceId flush_surfa
     const SurfaceInterval flush_interval(addr, addr + size);
     SurfaceRegions flushed_intervals;
 
-    for (const auto& [region, surface_id] : RangeFromInterval(dirty_regions, flush_interval)) {
+    dirty_regions.ForEachInRange(flush_interval, [&](SurfaceInterval region, SurfaceId surface_id) {
         if (flush_surface_id && surface_id != flush_surface_id) {
-            continue;
+            return;
         }
 
         // Small sizes imply that this most likely comes from the cpu, flush the entire region
@@ -1255,7 +1364,7 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, SurfaceId flush_surfa
         SCOPE_EXIT({ flushed_intervals += interval; });
         if (surface.type == SurfaceType::Fill) {
             DownloadFillSurface(surface, interval);
-            continue;
+            return;
         }
 
         // Download each requested level of the surface.
@@ -1268,10 +1377,10 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, SurfaceId flush_surfa
             }
             DownloadSurface(surface, download_interval);
         }
-    }
+    });
 
     // Reset dirty regions
-    dirty_regions -= flushed_intervals;
+    dirty_regions.Erase(flushed_intervals);
 }
 
 template <class T>
@@ -1293,6 +1402,9 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, SurfaceId region
         ASSERT(addr >= region_owner.addr && addr + size <= region_owner.end);
         ASSERT(region_owner.width == region_owner.stride);
         region_owner.MarkValid(invalid_interval);
+        region_owner.InvalidateChunkHashes(invalid_interval);
+        InvalidateLastMatch(region_owner.addr, region_owner.end);
+        memory.RasterizerNotifyGpuAccess(addr, size, true);
     }
 
     boost::container::small_vector<SurfaceId, 4> remove_surfaces;
@@ -1309,6 +1421,7 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, SurfaceId region
         }
         const auto interval = surface.GetInterval() & invalid_interval;
         surface.MarkInvalid(interval);
+        InvalidateLastMatch(surface.addr, surface.end);
         if (!surface.IsFullyInvalid()) {
             return;
         }
@@ -1316,9 +1429,9 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, SurfaceId region
     });
 
     if (region_owner_id) {
-        dirty_regions.set({invalid_interval, region_owner_id});
+        dirty_regions.Set(invalid_interval, region_owner_id);
     } else {
-        dirty_regions.erase(invalid_interval);
+        dirty_regions.Erase(invalid_interval);
     }
 
     for (const SurfaceId surface_id : remove_surfaces) {
@@ -1356,7 +1469,8 @@ void RasterizerCache<T>::RegisterSurface(SurfaceId surface_id) {
     surface.flags |= SurfaceFlagBits::Registered;
     UpdatePagesCachedCount(surface.addr, surface.size, 1);
     ForEachPage(surface.addr, surface.size,
-                [this, surface_id](u64 page) { page_table[page].push_back(surface_id); });
+                [this, surface_id](u64 page) { page_table[page].surfaces.push_back(surface_id); });
+    InvalidateLastMatch(surface.addr, surface.end);
 }
 
 template <class T>
@@ -1367,13 +1481,10 @@ void RasterizerCache<T>::UnregisterSurface(SurfaceId surface_id) {
 
     surface.flags &= ~SurfaceFlagBits::Registered;
     UpdatePagesCachedCount(surface.addr, surface.size, -1);
+    // Writes to the surface memory are no longer reported once its pages are uncached
+    surface.InvalidateChunkHashes(surface.GetInterval());
     ForEachPage(surface.addr, surface.size, [this, surface_id](u64 page) {
-        const auto page_it = page_table.find(page);
-        if (page_it == page_table.end()) {
-            ASSERT_MSG(false, "Unregistering unregistered page=0x{:x}", page << CYTRUS_PAGEBITS);
-            return;
-        }
-        std::vector<SurfaceId>& surfaces = page_it.value();
+        auto& surfaces = page_table[page].surfaces;
         const auto vector_it = std::find(surfaces.begin(), surfaces.end(), surface_id);
         if (vector_it == surfaces.end()) {
             ASSERT_MSG(false, "Unregistering unregistered surface in page=0x{:x}",
@@ -1382,6 +1493,7 @@ void RasterizerCache<T>::UnregisterSurface(SurfaceId surface_id) {
         }
         surfaces.erase(vector_it);
     });
+    InvalidateLastMatch(surface.addr, surface.end);
 
     if (surface.type != SurfaceType::Fill) {
         RemoveTextureCubeFace(surface_id);
@@ -1395,9 +1507,9 @@ void RasterizerCache<T>::UnregisterSurface(SurfaceId surface_id) {
 template <class T>
 void RasterizerCache<T>::UnregisterAll() {
     FlushAll();
-    for (auto& [page, surfaces] : page_table) {
-        while (!surfaces.empty()) {
-            UnregisterSurface(surfaces.back());
+    for (PageEntry& entry : page_table) {
+        while (!entry.surfaces.empty()) {
+            UnregisterSurface(entry.surfaces.back());
         }
     }
     runtime.Finish();
@@ -1407,38 +1519,43 @@ void RasterizerCache<T>::UnregisterAll() {
 
 template <class T>
 void RasterizerCache<T>::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
-    const u32 num_pages =
-        ((addr + size - 1) >> Memory::CYTRUS_PAGE_BITS) - (addr >> Memory::CYTRUS_PAGE_BITS) + 1;
-    const u32 page_start = addr >> Memory::CYTRUS_PAGE_BITS;
-    const u32 page_end = page_start + num_pages;
-
-    // Interval maps will erase segments if count reaches 0, so if delta is negative we have to
-    // subtract after iterating
-    const auto pages_interval = PageMap::interval_type::right_open(page_start, page_end);
-    if (delta > 0) {
-        cached_pages.add({pages_interval, delta});
-    }
-
-    for (const auto& pair : RangeFromInterval(cached_pages, pages_interval)) {
-        const auto interval = pair.first & pages_interval;
-        const int count = pair.second;
-
-        const PAddr interval_start_addr = boost::icl::first(interval) << Memory::CYTRUS_PAGE_BITS;
-        const PAddr interval_end_addr = boost::icl::last_next(interval) << Memory::CYTRUS_PAGE_BITS;
-        const u32 interval_size = interval_end_addr - interval_start_addr;
-
-        if (delta > 0 && count == delta) {
-            memory.RasterizerMarkRegionCached(interval_start_addr, interval_size, true);
-        } else if (delta < 0 && count == -delta) {
-            memory.RasterizerMarkRegionCached(interval_start_addr, interval_size, false);
-        } else {
-            ASSERT(count >= 0);
+    const u64 page_start = addr >> Memory::CYTRUS_PAGE_BITS;
+    const u64 page_end = ((u64{addr} + size - 1) >> Memory::CYTRUS_PAGE_BITS) + 1;
+
+    // Pages that became cached or uncached are reported to the memory system in contiguous runs
+    u64 run_start = page_start;
+    u64 run_end = page_start;
+    const auto mark_run = [&] {
+        if (run_end > run_start) {
+            memory.RasterizerMarkRegionCached(
+                static_cast<PAddr>(run_start << Memory::CYTRUS_PAGE_BITS),
+                static_cast<u32>((run_end - run_start) << Memory::CYTRUS_PAGE_BITS), delta > 0);
+        }
+    };
+    for (u64 page = page_start; page < page_end; page++) {
+        u32& count = CachedPageCount(static_cast<u32>(page));
+        ASSERT(delta > 0 || count >= static_cast<u32>(-delta));
+        count += delta;
+        if (count != (delta > 0 ? static_cast<u32>(delta) : 0U)) {
+            continue;
+        }
+        if (page != run_end) {
+            mark_run();
+            run_start = page;
         }
+        run_end = page + 1;
     }
+    mark_run();
+}
 
-    if (delta < 0) {
-        cached_pages.add({pages_interval, delta});
+template <class T>
+u32& RasterizerCache<T>::CachedPageCount(u32 cpu_page) {
+    static_assert(CPU_PAGES_PER_PAGE == 1U << (CYTRUS_PAGEBITS - Memory::CYTRUS_PAGE_BITS));
+    auto& cached_counts = page_table[cpu_page / CPU_PAGES_PER_PAGE].cached_counts;
+    if (!cached_counts) {
+        cached_counts = std::make_unique<std::array<u32, CPU_PAGES_PER_PAGE>>();
     }
+    return (*cached_counts)[cpu_page % CPU_PAGES_PER_PAGE];
 }
 
 } // namespace VideoCore
@@ -4,18 +4,21 @@
 
 #pragma once
 
+#include <array>
 #include <functional>
 #include <list>
+#include <memory>
 #include <optional>
 #include <span>
 #include <unordered_map>
 #include <vector>
-#include <boost/icl/interval_map.hpp>
-#include <tsl/robin_map.h>
+#include <boost/container/small_vector.hpp>
 
+#include "common/thread_worker.h"
 #include "video_core/rasterizer_cache/framebuffer_base.h"
 #include "video_core/rasterizer_cache/sampler_params.h"
 #include "video_core/rasterizer_cache/surface_params.h"
+#include "video_core/rasterizer_cache/surface_region_map.h"
 #include "video_core/rasterizer_cache/texture_cube.h"
 
 namespace Memory {
@@ -56,11 +59,18 @@ DECLARE_ENUM_FLAG_OPERATORS(MatchFlags);
 
 class CustomTexManager;
 class RendererBase;
+enum class HashMethod : u32;
 
 template <class T>
 class RasterizerCache {
     /// Address shift for caching surfaces into a hash table
     static constexpr u64 CYTRUS_PAGEBITS = 18;
+    /// Number of entries needed to cover the 32-bit physical address space
+    static constexpr u64 NUM_PAGES = u64{1} << (32 - CYTRUS_PAGEBITS);
+    /// Number of CPU pages whose cached state is tracked by each entry
+    static constexpr u32 CPU_PAGES_PER_PAGE = 64;
+    /// Minimum amount of guest texture data worth handing to a staging worker
+    static constexpr u32 STAGING_CHUNK_SIZE = 64 * 1024;
 
     using Runtime = typename T::Runtime;
     using Sampler = typename T::Sampler;
@@ -68,12 +78,23 @@ class RasterizerCache {
     using Framebuffer = typename T::Framebuffer;
     using DebugScope = typename T::DebugScope;
 
-    using SurfaceMap = boost::icl::interval_map<PAddr, SurfaceId, boost::icl::partial_absorber,
-                                                std::less, boost::icl::inplace_plus,
-                                                boost::icl::inter_section, SurfaceInterval>;
-
     using SurfaceRect_Tuple = std::pair<SurfaceId, Common::Rectangle<u32>>;
-    using PageMap = boost::icl::interval_map<u32, int>;
+
+    struct PageEntry {
+        /// Surfaces overlapping this page
+        boost::container::small_vector<SurfaceId, 4> surfaces;
+        /// Number of surfaces overlapping each CPU page, allocated when first needed
+        std::unique_ptr<std::array<u32, CPU_PAGES_PER_PAGE>> cached_counts;
+    };
+
+    /// Arguments and result of the last FindMatch call
+    struct MatchCacheEntry {
+        SurfaceParams params;
+        MatchFlags find_flags;
+        ScaleMatch match_scale_type;
+        std::optional<SurfaceInterval> validate_interval;
+        SurfaceId match_id;
+    };
 
 public:
     explicit RasterizerCache(Memory::MemorySystem& memory, CustomTexManager& custom_tex_manager,
@@ -140,8 +161,8 @@ private:
     /// Iterate over all page indices in a range
     template <typename Func>
     void ForEachPage(PAddr addr, std::size_t size, Func&& func) {
-        static constexpr bool RETURNS_BOOL = std::is_same_v<std::invoke_result<Func, u64>, bool>;
-        const u64 page_end = (addr + size - 1) >> CYTRUS_PAGEBITS;
+        static constexpr bool RETURNS_BOOL = std::is_same_v<std::invoke_result_t<Func, u64>, bool>;
+        const u64 page_end = std::min((addr + size - 1) >> CYTRUS_PAGEBITS, NUM_PAGES - 1);
         for (u64 page = addr >> CYTRUS_PAGEBITS; page <= page_end; ++page) {
             if constexpr (RETURNS_BOOL) {
                 if (func(page)) {
@@ -162,6 +183,9 @@ private:
     SurfaceId FindMatch(const SurfaceParams& params, ScaleMatch match_scale_type,
                         std::optional<SurfaceInterval> validate_interval = std::nullopt);
 
+    /// Forgets the last FindMatch result if a change to the surface at [addr, end) can affect it
+    void InvalidateLastMatch(PAddr addr, PAddr end);
+
     /// Unregisters sentenced surfaces that have surpassed the destruction threshold.
     void RunGarbageCollector();
 
@@ -171,8 +195,9 @@ private:
     /// Removes any references of the provided surface id from cached texture cubes.
     void RemoveTextureCubeFace(SurfaceId surface_id);
 
-    /// Computes the hash of the provided texture data.
-    u64 ComputeHash(const SurfaceParams& load_info, std::span<u8> upload_data);
+    /// Computes the hash of the provided texture data of surface with the given method.
+    u64 ComputeHash(Surface& surface, const SurfaceParams& load_info, std::span<u8> upload_data,
+                    HashMethod method);
 
     /// Update surface's texture for given region when necessary
     void ValidateSurface(SurfaceId surface, PAddr addr, u32 size);
@@ -186,6 +211,11 @@ private:
     /// Copies pixel data in interval from the host GPU surface to the guest VRAM
     void DownloadSurface(Surface& surface, SurfaceInterval interval);
 
+    /// Calls func(chunk, num_chunks) for every chunk of a texture encode or decode of size bytes.
+    /// All chunks but the first run on the staging workers, wait for them before using the data.
+    template <typename Func>
+    void DispatchStagingChunks(u32 size, const Func& func);
+
     /// Downloads a fill surface to guest VRAM
     void DownloadFillSurface(Surface& surface, SurfaceInterval interval);
 
@@ -211,6 +241,9 @@ private:
     /// Increase/decrease the number of surface in pages touching the specified region
     void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
 
+    /// Returns the number of surfaces overlapping the provided CPU page
+    u32& CachedPageCount(u32 cpu_page);
+
 private:
     Memory::MemorySystem& memory;
     CustomTexManager& custom_tex_manager;
@@ -218,21 +251,22 @@ private:
     Pica::RegsInternal& regs;
     RendererBase& renderer;
     std::unordered_map<TextureCubeConfig, TextureCube> texture_cube_cache;
-    tsl::robin_pg_map<u64, std::vector<SurfaceId>, Common::IdentityHash<u64>> page_table;
+    std::vector<PageEntry> page_table;
     std::unordered_map<FramebufferParams, FramebufferId> framebuffers;
     std::unordered_map<SamplerParams, SamplerId> samplers;
     std::list<std::pair<SurfaceId, u64>> sentenced;
     Common::SlotVector<Surface> slot_surfaces;
     Common::SlotVector<Sampler> slot_samplers;
     Common::SlotVector<Framebuffer> slot_framebuffers;
-    SurfaceMap dirty_regions;
-    PageMap cached_pages;
+    SurfaceRegionMap dirty_regions;
+    std::optional<MatchCacheEntry> last_match;
     u32 resolution_scale_factor;
     u64 frame_tick{};
     FramebufferParams fb_params;
     Settings::TextureFilter filter;
     bool dump_textures;
     bool use_custom_textures;
+    Common::ThreadWorker staging_workers;
 };
 
 } // namespace VideoCore
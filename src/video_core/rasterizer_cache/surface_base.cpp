@@ -126,6 +126,23 @@ bool SurfaceBase::HasNormalMap() const noexcept {
     return material && material->Map(MapType::Normal) != nullptr;
 }
 
+void SurfaceBase::InvalidateChunkHashes(SurfaceInterval interval) {
+    for (u32 level = 0; level < levels; level++) {
+        std::vector<u64>& hashes = chunk_hashes[level];
+        if (hashes.empty()) {
+            continue;
+        }
+        const SurfaceInterval level_interval = LevelInterval(level);
+        const SurfaceInterval overlap = interval & level_interval;
+        if (boost::icl::is_empty(overlap)) {
+            continue;
+        }
+        const u32 first = (overlap.lower() - level_interval.lower()) / TEXTURE_HASH_CHUNK_SIZE;
+        const u32 last = (overlap.upper() - level_interval.lower() - 1) / TEXTURE_HASH_CHUNK_SIZE;
+        std::fill(hashes.begin() + first, hashes.begin() + last + 1, 0);
+    }
+}
+
 ClearValue SurfaceBase::MakeClearValue(PAddr copy_addr, PixelFormat dst_format) {
     const SurfaceType dst_type = GetFormatType(dst_format);
     const std::array fill_buffer = MakeFillBuffer(copy_addr);
@@ -71,9 +71,13 @@ public:
 
     void MarkInvalid(SurfaceInterval interval) {
         invalid_regions.insert(interval);
+        InvalidateChunkHashes(interval);
         modification_tick++;
     }
 
+    /// Forgets the chunk hashes of the guest memory in interval, which is about to change
+    void InvalidateChunkHashes(SurfaceInterval interval);
+
     bool IsFullyInvalid() const {
         auto interval = GetInterval();
         return *invalid_regions.equal_range(interval).first == interval;
@@ -90,6 +94,8 @@ public:
     u32 fill_size = 0;
     std::array<u8, 4> fill_data;
     u64 modification_tick = 1;
+    /// Hashes of the guest memory of each level, see HashTextureChunks
+    std::array<std::vector<u64>, MAX_PICA_LEVELS> chunk_hashes;
 };
 
 } // namespace VideoCore
@@ -0,0 +1,137 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include "video_core/rasterizer_cache/slot_id.h"
+#include "video_core/rasterizer_cache/surface_params.h"
+
+namespace VideoCore {
+
+/**
+ * Maps disjoint guest address intervals to the surface that owns them. Entries are kept sorted
+ * in a flat vector and adjacent intervals with the same owner are joined, which keeps lookups
+ * to a binary search followed by a linear walk over the overlapping entries.
+ */
+class SurfaceRegionMap {
+    struct Entry {
+        PAddr start;
+        PAddr end;
+        SurfaceId surface_id;
+    };
+
+public:
+    /// Assigns interval to surface_id, replacing any previous owner
+    void Set(SurfaceInterval interval, SurfaceId surface_id) {
+        const PAddr start = interval.lower();
+        const PAddr end = interval.upper();
+        if (start >= end) {
+            return;
+        }
+        Erase(interval);
+
+        const auto next = std::lower_bound(
+            entries.begin(), entries.end(), start,
+            [](const Entry& entry, PAddr value) { return entry.start < value; });
+        const bool join_prev = next != entries.begin() && std::prev(next)->end == start &&
+                               std::prev(next)->surface_id == surface_id;
+        const bool join_next =
+            next != entries.end() && next->start == end && next->surface_id == surface_id;
+        if (join_prev && join_next) {
+            std::prev(next)->end = next->end;
+            entries.erase(next);
+        } else if (join_prev) {
+            std::prev(next)->end = end;
+        } else if (join_next) {
+            next->start = start;
+        } else {
+            entries.insert(next, Entry{start, end, surface_id});
+        }
+    }
+
+    /// Removes interval from the map, splitting any entries that partially overlap it
+    void Erase(SurfaceInterval interval) {
+        const PAddr start = interval.lower();
+        const PAddr end = interval.upper();
+        if (start >= end) {
+            return;
+        }
+
+        auto first = FirstOverlap(start);
+        if (first != entries.end() && first->start < start) {
+            if (first->end > end) {
+                const Entry tail{end, first->end, first->surface_id};
+                first->end = start;
+                entries.insert(std::next(first), tail);
+                return;
+            }
+            first->end = start;
+            ++first;
+        }
+        auto last = first;
+        while (last != entries.end() && last->end <= end) {
+            ++last;
+        }
+        if (last != entries.end() && last->start < end) {
+            last->start = end;
+        }
+        entries.erase(first, last);
+    }
+
+    /// Removes all intervals in regions from the map
+    template <typename Regions>
+    void Erase(const Regions& regions) {
+        for (const auto& interval : regions) {
+            Erase(interval);
+        }
+    }
+
+    /// Returns true when every address in interval is owned by a surface
+    [[nodiscard]] bool Contains(SurfaceInterval interval) const {
+        PAddr cursor = interval.lower();
+        const PAddr end = interval.upper();
+        for (auto it = FirstOverlap(cursor); it != entries.end() && cursor < end; ++it) {
+            if (it->start > cursor) {
+                return false;
+            }
+            cursor = it->end;
+        }
+        return cursor >= end;
+    }
+
+    /// Calls func(region, surface_id) for every entry overlapping interval. The regions are not
+    /// clipped to interval and the map must not be modified by func.
+    template <typename Func>
+    void ForEachInRange(SurfaceInterval interval, Func&& func) const {
+        const PAddr end = interval.upper();
+        for (auto it = FirstOverlap(interval.lower()); it != entries.end() && it->start < end;
+             ++it) {
+            func(SurfaceInterval{it->start, it->end}, it->surface_id);
+        }
+    }
+
+    void Clear() {
+        entries.clear();
+    }
+
+private:
+    /// Returns the first entry that ends after addr
+    std::vector<Entry>::iterator FirstOverlap(PAddr addr) {
+        return std::upper_bound(entries.begin(), entries.end(), addr,
+                                [](PAddr value, const Entry& entry) { return value < entry.end; });
+    }
+
+    std::vector<Entry>::const_iterator FirstOverlap(PAddr addr) const {
+        return std::upper_bound(entries.begin(), entries.end(), addr,
+                                [](PAddr value, const Entry& entry) { return value < entry.end; });
+    }
+
+private:
+    std::vector<Entry> entries;
+};
+
+} // namespace VideoCore
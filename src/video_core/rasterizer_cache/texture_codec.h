@@ -9,6 +9,7 @@
 #include <span>
 #include "common/alignment.h"
 #include "common/color.h"
+#include "video_core/rasterizer_cache/codec_kernels.h"
 #include "video_core/rasterizer_cache/pixel_format.h"
 #include "video_core/texture/etc1.h"
 #include "video_core/utils.h"
@@ -84,34 +85,45 @@ constexpr void DecodePixel4(u32 x, u32 y, const u8* source_tile, u8* dest_pixel)
     }
 }
 
+/**
+ * Decodes an ETC1 tile a subtile at a time, so the base colors of each subtile half are only
+ * computed once. Row y of the tile is written to linear_top - y * row_pitch.
+ */
 template <PixelFormat format>
-constexpr void DecodePixelETC1(u32 x, u32 y, const u8* source_tile, u8* dest_pixel) {
+void DecodeTileETC1(const u8* source_tile, u8* linear_top, std::ptrdiff_t row_pitch) {
     constexpr u32 subtile_width = 4;
     constexpr u32 subtile_height = 4;
     constexpr bool has_alpha = format == PixelFormat::ETC1A4;
     constexpr std::size_t subtile_size = has_alpha ? 16 : 8;
 
-    const u32 subtile_index = (x / subtile_width) + 2 * (y / subtile_height);
-    x %= subtile_width;
-    y %= subtile_height;
+    for (u32 subtile_index = 0; subtile_index < 4; subtile_index++) {
+        const u8* subtile_ptr = source_tile + subtile_index * subtile_size;
 
-    const u8* subtile_ptr = source_tile + subtile_index * subtile_size;
+        u64_le packed_alpha{};
+        if constexpr (has_alpha) {
+            std::memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
+            subtile_ptr += sizeof(u64);
+        }
 
-    u8 alpha = 255;
-    if constexpr (has_alpha) {
-        u64_le packed_alpha;
-        std::memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
-        subtile_ptr += sizeof(u64);
+        const auto texels = Pica::Texture::DecodeETC1Subtile(MakeInt<u64_le>(subtile_ptr));
+        const u32 base_x = (subtile_index % 2) * subtile_width;
+        const u32 base_y = (subtile_index / 2) * subtile_height;
+
+        for (u32 y = 0; y < subtile_height; y++) {
+            u8* dest_row = linear_top - (base_y + y) * row_pitch + base_x * 4;
+            for (u32 x = 0; x < subtile_width; x++) {
+                u8 alpha = 255;
+                if constexpr (has_alpha) {
+                    alpha = Common::Color::Convert4To8(
+                        (packed_alpha >> (4 * (x * subtile_width + y))) & 0xF);
+                }
 
-        alpha = Common::Color::Convert4To8((packed_alpha >> (4 * (x * subtile_width + y))) & 0xF);
+                // Copy the uncompressed pixel to the destination
+                std::memcpy(dest_row + x * 4, texels[y * subtile_width + x].AsArray(), 3);
+                dest_row[x * 4 + 3] = alpha;
+            }
+        }
     }
-
-    const u64_le subtile_data = MakeInt<u64_le>(subtile_ptr);
-    const auto rgb = Pica::Texture::SampleETC1Subtile(subtile_data, x, y);
-
-    // Copy the uncompressed pixel to the destination
-    std::memcpy(dest_pixel, rgb.AsArray(), 3);
-    dest_pixel[3] = alpha;
 }
 
 template <PixelFormat format, bool converted>
@@ -196,35 +208,97 @@ constexpr void EncodePixel4(u32 x, u32 y, const u8* source_pixel, u8* dest_tile_
     }
 }
 
+/// Returns true if DecodePixel and EncodePixel copy the pixel data unchanged.
+template <PixelFormat format, bool converted>
+constexpr bool IsPassthrough() {
+    switch (format) {
+    case PixelFormat::RGBA8:
+    case PixelFormat::RGB8:
+    case PixelFormat::RGB5A1:
+    case PixelFormat::RGB565:
+    case PixelFormat::RGBA4:
+    case PixelFormat::D24:
+        return !converted;
+    case PixelFormat::D16:
+        return true;
+    default:
+        return false;
+    }
+}
+
 template <bool morton_to_linear, PixelFormat format, bool converted>
-constexpr void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u8> linear_buffer) {
+void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u8> linear_buffer,
+                    const CodecKernels& kernels) {
     constexpr u32 bytes_per_pixel = GetFormatBpp(format) / 8;
     constexpr u32 linear_bytes_per_pixel = converted ? 4 : GetFormatBytesPerPixel(format);
     constexpr bool is_compressed = format == PixelFormat::ETC1 || format == PixelFormat::ETC1A4;
     constexpr bool is_4bit = format == PixelFormat::I4 || format == PixelFormat::A4;
+    constexpr bool is_passthrough = IsPassthrough<format, converted>();
+
+    // The linear buffer is addressed bottom up, so tile row y is linear row 7 - y.
+    const std::ptrdiff_t row_pitch = static_cast<std::ptrdiff_t>(stride) * linear_bytes_per_pixel;
+    u8* linear_top = linear_buffer.data() + 7 * row_pitch;
+
+    if constexpr (is_compressed) {
+        static_assert(morton_to_linear, "Encoding compressed formats is not supported");
+        DecodeTileETC1<format>(tile_buffer.data(), linear_top, row_pitch);
+    } else if constexpr (is_4bit) {
+        for (u32 y = 0; y < 8; y++) {
+            for (u32 x = 0; x < 8; x++) {
+                u8* linear_pixel = linear_top - y * row_pitch + x * linear_bytes_per_pixel;
+                if constexpr (morton_to_linear) {
+                    DecodePixel4<format>(x, y, tile_buffer.data(), linear_pixel);
+                } else {
+                    EncodePixel4<format>(x, y, linear_pixel, tile_buffer.data());
+                }
+            }
+        }
+    } else if constexpr (is_passthrough && bytes_per_pixel == linear_bytes_per_pixel) {
+        // No conversion needed, (un)swizzle directly between the tile and the linear rows.
+        if constexpr (morton_to_linear) {
+            kernels.unswizzle_tile[bytes_per_pixel](tile_buffer.data(), linear_top, -row_pitch);
+        } else {
+            kernels.swizzle_tile[bytes_per_pixel](linear_top, -row_pitch, tile_buffer.data());
+        }
+    } else {
+        // (Un)swizzle through a linear copy of the tile and convert it a row at a time.
+        constexpr std::size_t tile_pitch = 8 * bytes_per_pixel;
+        std::array<u8, 8 * tile_pitch> linear_tile;
+        ConvertPixelsFunc convert = nullptr;
+        if constexpr (!is_passthrough) {
+            constexpr auto index = static_cast<std::size_t>(format);
+            convert = morton_to_linear ? kernels.decode[index] : kernels.encode[index];
+        }
 
-    for (u32 y = 0; y < 8; y++) {
-        for (u32 x = 0; x < 8; x++) {
-            const auto tiled_pixel = tile_buffer.subspan(
-                VideoCore::MortonInterleave(x, y) * bytes_per_pixel, bytes_per_pixel);
-            const auto linear_pixel = linear_buffer.subspan(
-                ((7 - y) * stride + x) * linear_bytes_per_pixel, linear_bytes_per_pixel);
-            if constexpr (morton_to_linear) {
-                if constexpr (is_compressed) {
-                    DecodePixelETC1<format>(x, y, tile_buffer.data(), linear_pixel.data());
-                } else if constexpr (is_4bit) {
-                    DecodePixel4<format>(x, y, tile_buffer.data(), linear_pixel.data());
+        if constexpr (morton_to_linear) {
+            kernels.unswizzle_tile[bytes_per_pixel](tile_buffer.data(), linear_tile.data(),
+                                                    tile_pitch);
+        }
+        for (u32 y = 0; y < 8; y++) {
+            u8* tile_row = linear_tile.data() + y * tile_pitch;
+            u8* linear_row = linear_top - y * row_pitch;
+            if (convert) {
+                if constexpr (morton_to_linear) {
+                    convert(tile_row, linear_row, 8);
                 } else {
-                    DecodePixel<format, converted>(tiled_pixel.data(), linear_pixel.data());
+                    convert(linear_row, tile_row, 8);
                 }
-            } else {
-                if constexpr (is_4bit) {
-                    EncodePixel4<format>(x, y, linear_pixel.data(), tile_buffer.data());
+                continue;
+            }
+            for (u32 x = 0; x < 8; x++) {
+                u8* tiled_pixel = tile_row + x * bytes_per_pixel;
+                u8* linear_pixel = linear_row + x * linear_bytes_per_pixel;
+                if constexpr (morton_to_linear) {
+                    DecodePixel<format, converted>(tiled_pixel, linear_pixel);
                 } else {
-                    EncodePixel<format, converted>(linear_pixel.data(), tiled_pixel.data());
+                    EncodePixel<format, converted>(linear_pixel, tiled_pixel);
                 }
             }
         }
+        if constexpr (!morton_to_linear) {
+            kernels.swizzle_tile[bytes_per_pixel](linear_tile.data(), tile_pitch,
+                                                  tile_buffer.data());
+        }
     }
 }
 
@@ -254,8 +328,8 @@ constexpr void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u
  * in the linear_buffer.
  */
 template <bool morton_to_linear, PixelFormat format, bool converted = false>
-static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 end_offset,
-                                 std::span<u8> linear_buffer, std::span<u8> tiled_buffer) {
+static void MortonCopy(u32 width, u32 height, u32 start_offset, u32 end_offset,
+                       std::span<u8> linear_buffer, std::span<u8> tiled_buffer) {
     constexpr u32 bytes_per_pixel = GetFormatBpp(format) / 8;
     constexpr u32 aligned_bytes_per_pixel = converted ? 4 : GetFormatBytesPerPixel(format);
     constexpr u32 tile_size = GetFormatBpp(format) * 64 / 8;
@@ -270,6 +344,8 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
     ASSERT(!morton_to_linear ||
            (aligned_start_offset == start_offset && aligned_end_offset == end_offset));
 
+    const CodecKernels& kernels = GetCodecKernels();
+
     // In OpenGL the texture origin is in the bottom left corner as opposed to other
     // APIs that have it at the top left. To avoid flipping texture coordinates in
     // the shader we read/write the linear buffer from the bottom up
@@ -296,7 +372,7 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
     if (start_offset < aligned_start_offset && !morton_to_linear) {
         std::array<u8, tile_size> tmp_buf;
         auto linear_data = linear_buffer.subspan(linear_offset, linear_tile_stride);
-        MortonCopyTile<morton_to_linear, format, converted>(width, tmp_buf, linear_data);
+        MortonCopyTile<morton_to_linear, format, converted>(width, tmp_buf, linear_data, kernels);
 
         std::memcpy(tiled_buffer.data(), tmp_buf.data() + start_offset - aligned_down_start_offset,
                     std::min(aligned_start_offset, end_offset) - start_offset);
@@ -313,7 +389,8 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
         while (tiled_offset < buffer_end) {
             auto linear_data = linear_buffer.subspan(linear_offset, linear_tile_stride);
             auto tiled_data = tiled_buffer.subspan(tiled_offset, tile_size);
-            MortonCopyTile<morton_to_linear, format, converted>(width, tiled_data, linear_data);
+            MortonCopyTile<morton_to_linear, format, converted>(width, tiled_data, linear_data,
+                                                                kernels);
             tiled_offset += tile_size;
             linear_next_tile();
         }
@@ -324,7 +401,7 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
     if (end_offset > std::max(aligned_start_offset, aligned_end_offset) && !morton_to_linear) {
         std::array<u8, tile_size> tmp_buf;
         auto linear_data = linear_buffer.subspan(linear_offset, linear_tile_stride);
-        MortonCopyTile<morton_to_linear, format, converted>(width, tmp_buf, linear_data);
+        MortonCopyTile<morton_to_linear, format, converted>(width, tmp_buf, linear_data, kernels);
         std::memcpy(tiled_buffer.data() + tiled_offset, tmp_buf.data(),
                     end_offset - aligned_end_offset);
     }
@@ -340,7 +417,7 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
  * @return
  */
 template <bool decode, PixelFormat format, bool converted = false>
-static constexpr void LinearCopy(std::span<u8> src_buffer, std::span<u8> dst_buffer) {
+static void LinearCopy(std::span<u8> src_buffer, std::span<u8> dst_buffer) {
     std::size_t src_size = src_buffer.size();
     std::size_t dst_size = dst_buffer.size();
 
@@ -355,6 +432,15 @@ static constexpr void LinearCopy(std::span<u8> src_buffer, std::span<u8> dst_buf
         src_size = Common::AlignDown(src_size, src_bytes_per_pixel);
         dst_size = Common::AlignDown(dst_size, dst_bytes_per_pixel);
 
+        const CodecKernels& kernels = GetCodecKernels();
+        constexpr auto index = static_cast<std::size_t>(format);
+        if (const auto convert = decode ? kernels.decode[index] : kernels.encode[index]) {
+            const std::size_t count =
+                std::min(src_size / src_bytes_per_pixel, dst_size / dst_bytes_per_pixel);
+            convert(src_buffer.data(), dst_buffer.data(), count);
+            return;
+        }
+
         for (std::size_t src_index = 0, dst_index = 0; src_index < src_size && dst_index < dst_size;
              src_index += src_bytes_per_pixel, dst_index += dst_bytes_per_pixel) {
             const auto src_pixel = src_buffer.subspan(src_index, src_bytes_per_pixel);
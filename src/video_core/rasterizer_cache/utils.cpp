@@ -2,12 +2,80 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "common/assert.h"
+#include "common/xxh3.h"
 #include "video_core/rasterizer_cache/surface_params.h"
 #include "video_core/rasterizer_cache/texture_codec.h"
 #include "video_core/rasterizer_cache/utils.h"
 
 namespace VideoCore {
 
+namespace {
+
+/// The part of a texture encode or decode assigned to a single chunk.
+struct TextureChunk {
+    SurfaceParams info;
+    PAddr start_addr;
+    PAddr end_addr;
+    std::span<u8> linear;
+    std::span<u8> encoded;
+};
+
+/**
+ * Splits an encode or decode into num_chunks parts. Tiled textures are split on tile row
+ * boundaries, keeping the linear data bottom up like MortonCopy expects. Linear textures are
+ * split on pixel boundaries. The encoded data starts at start_addr. The linear pixel size is the
+ * one used by MortonCopy and LinearCopy for the same conversion, so that the chunks line up with
+ * the unchunked copy whatever the size of the linear buffer.
+ */
+TextureChunk GetTextureChunk(const SurfaceParams& info, PAddr start_addr, PAddr end_addr,
+                             std::span<u8> linear, std::span<u8> encoded, bool convert, u32 chunk,
+                             u32 num_chunks) {
+    if (num_chunks == 1) {
+        return {info, start_addr, end_addr, linear, encoded};
+    }
+
+    TextureChunk result{.info = info};
+    std::size_t linear_start{};
+    std::size_t linear_end{};
+    if (info.is_tiled) {
+        const u32 tile_rows = info.height / 8;
+        const u32 first_row = tile_rows * chunk / num_chunks;
+        const u32 last_row = tile_rows * (chunk + 1) / num_chunks;
+        const u32 tiled_row_size = info.BytesInPixels(info.width * 8);
+        const u32 linear_bpp = convert ? 4 : GetFormatBytesPerPixel(info.pixel_format);
+        const std::size_t linear_row_size = info.width * 8 * linear_bpp;
+        const PAddr chunk_end = info.addr + last_row * tiled_row_size;
+
+        result.info.addr = info.addr + first_row * tiled_row_size;
+        result.info.height = (last_row - first_row) * 8;
+        result.start_addr = std::clamp(start_addr, result.info.addr, chunk_end);
+        result.end_addr = std::clamp(end_addr, result.start_addr, chunk_end);
+        linear_start = (tile_rows - last_row) * linear_row_size;
+        linear_end = (tile_rows - first_row) * linear_row_size;
+    } else {
+        const u64 num_pixels = info.width * info.height;
+        const u64 first_pixel = num_pixels * chunk / num_chunks;
+        const u64 last_pixel = num_pixels * (chunk + 1) / num_chunks;
+        const u32 encoded_bpp = info.GetFormatBpp() / 8;
+        // Unconverted linear textures are copied as they are, without padding the pixels.
+        const u32 linear_bpp = convert ? 4 : encoded_bpp;
+
+        result.start_addr = std::min<PAddr>(start_addr + first_pixel * encoded_bpp, end_addr);
+        result.end_addr = std::min<PAddr>(start_addr + last_pixel * encoded_bpp, end_addr);
+        linear_start = first_pixel * linear_bpp;
+        linear_end = last_pixel * linear_bpp;
+    }
+    linear_start = std::min(linear_start, linear.size());
+    linear_end = std::min(linear_end, linear.size());
+    result.linear = linear.subspan(linear_start, linear_end - linear_start);
+    result.encoded = encoded.subspan(result.start_addr - start_addr,
+                                     result.end_addr - result.start_addr);
+    return result;
+}
+
+} // Anonymous namespace
+
 u32 MipLevels(u32 width, u32 height, u32 max_level) {
     u32 levels = 1;
     while (width > 8 && height > 8) {
@@ -20,7 +88,15 @@ u32 MipLevels(u32 width, u32 height, u32 max_level) {
 }
 
 void EncodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr end_addr,
-                   std::span<u8> source, std::span<u8> dest, bool convert) {
+                   std::span<u8> source, std::span<u8> dest, bool convert, u32 chunk,
+                   u32 num_chunks) {
+    const auto [info, chunk_start, chunk_end, linear, encoded] =
+        GetTextureChunk(surface_info, start_addr, end_addr, source, dest, convert, chunk,
+                        num_chunks);
+    if (chunk_start == chunk_end) {
+        return;
+    }
+
     const PixelFormat format = surface_info.pixel_format;
     const u32 func_index = static_cast<u32>(format);
 
@@ -28,15 +104,15 @@ void EncodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
         const MortonFunc SwizzleImpl =
             (convert ? SWIZZLE_TABLE_CONVERTED : SWIZZLE_TABLE)[func_index];
         if (SwizzleImpl) {
-            SwizzleImpl(surface_info.width, surface_info.height, start_addr - surface_info.addr,
-                        end_addr - surface_info.addr, source, dest);
+            SwizzleImpl(info.width, info.height, chunk_start - info.addr, chunk_end - info.addr,
+                        linear, encoded);
             return;
         }
     } else {
         const LinearFunc LinearEncodeImpl =
             (convert ? LINEAR_ENCODE_TABLE_CONVERTED : LINEAR_ENCODE_TABLE)[func_index];
         if (LinearEncodeImpl) {
-            LinearEncodeImpl(source, dest);
+            LinearEncodeImpl(linear, encoded);
             return;
         }
     }
@@ -47,7 +123,15 @@ void EncodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
 }
 
 void DecodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr end_addr,
-                   std::span<u8> source, std::span<u8> dest, bool convert) {
+                   std::span<u8> source, std::span<u8> dest, bool convert, u32 chunk,
+                   u32 num_chunks) {
+    const auto [info, chunk_start, chunk_end, linear, encoded] =
+        GetTextureChunk(surface_info, start_addr, end_addr, dest, source, convert, chunk,
+                        num_chunks);
+    if (chunk_start == chunk_end) {
+        return;
+    }
+
     const PixelFormat format = surface_info.pixel_format;
     const u32 func_index = static_cast<u32>(format);
 
@@ -55,15 +139,15 @@ void DecodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
         const MortonFunc UnswizzleImpl =
             (convert ? UNSWIZZLE_TABLE_CONVERTED : UNSWIZZLE_TABLE)[func_index];
         if (UnswizzleImpl) {
-            UnswizzleImpl(surface_info.width, surface_info.height, start_addr - surface_info.addr,
-                          end_addr - surface_info.addr, dest, source);
+            UnswizzleImpl(info.width, info.height, chunk_start - info.addr, chunk_end - info.addr,
+                          linear, encoded);
             return;
         }
     } else {
         const LinearFunc LinearDecodeImpl =
             (convert ? LINEAR_DECODE_TABLE_CONVERTED : LINEAR_DECODE_TABLE)[func_index];
         if (LinearDecodeImpl) {
-            LinearDecodeImpl(source, dest);
+            LinearDecodeImpl(encoded, linear);
             return;
         }
     }
@@ -73,4 +157,19 @@ void DecodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
     UNIMPLEMENTED();
 }
 
+u64 HashTextureChunks(std::span<const u8> data, std::span<u64> chunk_hashes) {
+    ASSERT(chunk_hashes.size() ==
+           (data.size() + TEXTURE_HASH_CHUNK_SIZE - 1) / TEXTURE_HASH_CHUNK_SIZE);
+    for (std::size_t i = 0; i < chunk_hashes.size(); i++) {
+        if (chunk_hashes[i] != 0) {
+            continue;
+        }
+        const std::size_t offset = i * TEXTURE_HASH_CHUNK_SIZE;
+        const auto chunk = data.subspan(
+            offset, std::min<std::size_t>(data.size() - offset, TEXTURE_HASH_CHUNK_SIZE));
+        chunk_hashes[i] = Common::XXH3Hash64(chunk.data(), chunk.size());
+    }
+    return Common::XXH3Hash64(chunk_hashes.data(), chunk_hashes.size_bytes());
+}
+
 } // namespace VideoCore
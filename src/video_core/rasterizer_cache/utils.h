@@ -60,6 +60,9 @@ struct BufferTextureCopy {
     u32 texture_level;
 };
 
+/// Size of the guest memory chunks hashed independently by HashTextureChunks
+constexpr u32 TEXTURE_HASH_CHUNK_SIZE = 4096;
+
 struct StagingData {
     u32 size;
     u32 offset;
@@ -80,9 +83,12 @@ u32 MipLevels(u32 width, u32 height, u32 max_level);
  * @param source_tiled The source linear texture data.
  * @param dest_linear The output buffer where the encoded linear or tiled data will be written to.
  * @param convert Whether the pixel format needs to be converted.
+ * @param chunk, num_chunks Only encode the part assigned to chunk out of num_chunks. Chunks cover
+ * whole tile rows and write disjoint memory, so they can be processed concurrently.
  */
 void EncodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr end_addr,
-                   std::span<u8> source, std::span<u8> dest, bool convert = false);
+                   std::span<u8> source, std::span<u8> dest, bool convert = false, u32 chunk = 0,
+                   u32 num_chunks = 1);
 
 /**
  * Decodes a linear or tiled texture to the expected linear format.
@@ -93,8 +99,20 @@ void EncodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
  * @param source_tiled The source linear or tiled texture data.
  * @param dest_linear The output buffer where the decoded linear data will be written to.
  * @param convert Whether the pixel format needs to be converted.
+ * @param chunk, num_chunks Only decode the part assigned to chunk out of num_chunks. Chunks cover
+ * whole tile rows and write disjoint memory, so they can be processed concurrently.
  */
 void DecodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr end_addr,
-                   std::span<u8> source, std::span<u8> dest, bool convert = false);
+                   std::span<u8> source, std::span<u8> dest, bool convert = false, u32 chunk = 0,
+                   u32 num_chunks = 1);
+
+/**
+ * Computes the XXH3 hash of the XXH3 hashes of every TEXTURE_HASH_CHUNK_SIZE chunk of data.
+ *
+ * @param data The guest texture data to hash.
+ * @param chunk_hashes Hashes of the chunks of data, one entry per chunk. Non-zero entries are
+ * reused as they are, the rest are computed and stored back.
+ */
+u64 HashTextureChunks(std::span<const u8> data, std::span<u64> chunk_hashes);
 
 } // namespace VideoCore
@@ -44,7 +44,8 @@ public:
     /// Returns the rasterizer owned by the renderer
     virtual VideoCore::RasterizerInterface* Rasterizer() = 0;
 
-    /// Finalize rendering the guest frame and draw into the presentation texture
+    /// Finalize rendering the guest frame and draw into the presentation texture. The frame is
+    /// ended separately with EndFrame, on the emulation thread.
     virtual void SwapBuffers() = 0;
 
     /// Draws the latest frame to the window waiting timeout_ms for a frame to arrive (Renderer
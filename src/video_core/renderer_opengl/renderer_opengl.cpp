@@ -116,7 +116,6 @@ void RendererOpenGL::SwapBuffers() {
         }
     }
 
-    EndFrame();
     prev_state.Apply();
     rasterizer.TickFrame();
 }
@@ -19,7 +19,6 @@ RendererSoftware::~RendererSoftware() = default;
 
 void RendererSoftware::SwapBuffers() {
     PrepareRenderTarget();
-    EndFrame();
 }
 
 void RendererSoftware::PrepareRenderTarget() {
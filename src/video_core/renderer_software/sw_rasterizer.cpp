@@ -14,6 +14,7 @@
 #include "video_core/renderer_software/sw_lighting.h"
 #include "video_core/renderer_software/sw_proctex.h"
 #include "video_core/renderer_software/sw_rasterizer.h"
+#include "video_core/renderer_software/sw_span.h"
 #include "video_core/renderer_software/sw_texturing.h"
 #include "video_core/texture/texture_decode.h"
 
@@ -66,10 +67,63 @@ struct Vertex : Pica::OutputVertex {
     }
 };
 
+/// Triangle setup data shared by all the tiles a triangle was binned to.
+struct BinnedTriangle {
+    Vertex v0;
+    Vertex v1;
+    Vertex v2;
+    std::array<Common::Vec3<Fix12P4>, 3> vtxpos;
+    std::array<int, 3> bias;
+    u16 min_x;
+    u16 min_y;
+    u16 max_x;
+    u16 max_y;
+};
+
+/// Fragments of a scanline that passed the coverage test, along with their inputs to the
+/// texture combiners.
+struct FragmentSpan {
+    std::array<u16, SPAN_SIZE> x{};
+    std::array<float, SPAN_SIZE> depth{};
+    ColorSpan primary_color;
+    ColorSpan primary_fragment_color;
+    ColorSpan secondary_fragment_color;
+    std::array<ColorSpan, 4> texture_color;
+    std::size_t count{};
+    u16 y{};
+};
+
+/// Screen region owned by a tile in 12.4 fixed point. Tiles on the right and bottom edges of the
+/// grid extend to infinity so that triangles outside the framebuffer are handled as before.
+struct TileRect {
+    u32 x1;
+    u32 y1;
+    u32 x2;
+    u32 y2;
+};
+
 namespace {
 
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
 
+/// Width and height of a screen tile in pixels.
+constexpr u32 TILE_SIZE = 32;
+
+/// Returns true if the TEV stage forwards the output of the previous stage unchanged.
+bool IsPassThroughTevStage(const TexturingRegs::TevStageConfig& stage, u32 index) {
+    using TevStageConfig = TexturingRegs::TevStageConfig;
+    // The first stage reads color_source3 in place of a Previous color_source1.
+    const bool reads_previous_color =
+        stage.color_source1 == TevStageConfig::Source::Previous &&
+        (index != 0 || stage.color_source3 == TevStageConfig::Source::Previous);
+    return stage.color_op == TevStageConfig::Operation::Replace &&
+           stage.alpha_op == TevStageConfig::Operation::Replace && reads_previous_color &&
+           stage.alpha_source1 == TevStageConfig::Source::Previous &&
+           stage.color_modifier1 == TevStageConfig::ColorModifier::SourceColor &&
+           stage.alpha_modifier1 == TevStageConfig::AlphaModifier::SourceAlpha &&
+           stage.GetColorMultiplier() == 1 && stage.GetAlphaMultiplier() == 1;
+}
+
 struct ClippingEdge {
 public:
     constexpr ClippingEdge(Common::Vec4<f24> coeffs,
@@ -105,6 +159,40 @@ RasterizerSoftware::RasterizerSoftware(Memory::MemorySystem& memory_, Pica::Pica
       num_sw_threads{std::max(std::thread::hardware_concurrency(), 2U)},
       sw_workers{num_sw_threads, "SwRenderer workers"}, fb{memory, regs.framebuffer} {}
 
+RasterizerSoftware::~RasterizerSoftware() = default;
+
+void RasterizerSoftware::DrawTriangles() {
+    FlushBins();
+}
+
+void RasterizerSoftware::NotifyPicaRegisterChanged(u32 id) {
+    // Binned triangles are rasterized with the current register state, so they must be
+    // processed before it changes.
+    if (!triangles.empty()) [[unlikely]] {
+        FlushBins();
+    }
+}
+
+void RasterizerSoftware::FlushAll() {
+    FlushBins();
+}
+
+void RasterizerSoftware::FlushRegion(PAddr addr, u32 size) {
+    FlushBins();
+}
+
+void RasterizerSoftware::InvalidateRegion(PAddr addr, u32 size) {
+    FlushBins();
+}
+
+void RasterizerSoftware::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    FlushBins();
+}
+
+void RasterizerSoftware::ClearAll(bool flush) {
+    FlushBins();
+}
+
 void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                                      const Pica::OutputVertex& v2) {
     /**
@@ -201,7 +289,7 @@ void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::O
             vtx2.screenpos.x.ToFloat32(), vtx2.screenpos.y.ToFloat32(),
             vtx2.screenpos.z.ToFloat32());
 
-        ProcessTriangle(vtx0, vtx1, vtx2);
+        BinTriangle(vtx0, vtx1, vtx2);
     }
 }
 
@@ -227,10 +315,8 @@ void RasterizerSoftware::MakeScreenCoords(Vertex& vtx) {
     vtx.screenpos[2] = vtx.pos.z * inv_w;
 }
 
-void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
-                                         bool reversed) {
-    MICROPROFILE_SCOPE(GPU_Rasterization);
-
+void RasterizerSoftware::BinTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                                     bool reversed) {
     // Vertex positions in rasterizer coordinates
     static auto screen_to_rasterizer_coords = [](const Common::Vec3<f24>& vec) {
         return Common::Vec3{Fix12P4::FromFloat24(vec.x), Fix12P4::FromFloat24(vec.y),
@@ -246,13 +332,13 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     if (regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepAll) {
         // Make sure we always end up with a triangle wound counter-clockwise
         if (!reversed && SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) <= 0) {
-            ProcessTriangle(v0, v2, v1, true);
+            BinTriangle(v0, v2, v1, true);
             return;
         }
     } else {
         if (!reversed && regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepClockWise) {
             // Reverse vertex order and use the CCW code path.
-            ProcessTriangle(v0, v2, v1, true);
+            BinTriangle(v0, v2, v1, true);
             return;
         }
         // Cull away triangles which are wound clockwise.
@@ -286,189 +372,367 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
     max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
 
-    const int bias0 =
-        IsRightSideOrFlatBottomEdge(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) ? -1 : 0;
-    const int bias1 =
-        IsRightSideOrFlatBottomEdge(vtxpos[1].xy(), vtxpos[2].xy(), vtxpos[0].xy()) ? -1 : 0;
-    const int bias2 =
-        IsRightSideOrFlatBottomEdge(vtxpos[2].xy(), vtxpos[0].xy(), vtxpos[1].xy()) ? -1 : 0;
+    if (min_x >= max_x || min_y >= max_y) {
+        return;
+    }
+
+    const std::array<int, 3> bias = {
+        IsRightSideOrFlatBottomEdge(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) ? -1 : 0,
+        IsRightSideOrFlatBottomEdge(vtxpos[1].xy(), vtxpos[2].xy(), vtxpos[0].xy()) ? -1 : 0,
+        IsRightSideOrFlatBottomEdge(vtxpos[2].xy(), vtxpos[0].xy(), vtxpos[1].xy()) ? -1 : 0,
+    };
+
+    // Size the tile grid from the render target when starting a new batch.
+    if (triangles.empty()) {
+        const auto& framebuffer = regs.framebuffer.framebuffer;
+        tiles_x = std::max((framebuffer.GetWidth() + TILE_SIZE - 1) / TILE_SIZE, 1U);
+        tiles_y = std::max((framebuffer.GetHeight() + TILE_SIZE - 1) / TILE_SIZE, 1U);
+        bins.resize(tiles_x * tiles_y);
+    }
+
+    const u32 triangle_index = static_cast<u32>(triangles.size());
+    triangles.push_back({v0, v1, v2, vtxpos, bias, min_x, min_y, max_x, max_y});
+
+    // Append the triangle to every tile its bounding box touches.
+    const u32 tile_x1 = std::min<u32>((min_x >> 4) / TILE_SIZE, tiles_x - 1);
+    const u32 tile_y1 = std::min<u32>((min_y >> 4) / TILE_SIZE, tiles_y - 1);
+    const u32 tile_x2 = std::min<u32>(((max_x >> 4) - 1) / TILE_SIZE, tiles_x - 1);
+    const u32 tile_y2 = std::min<u32>(((max_y >> 4) - 1) / TILE_SIZE, tiles_y - 1);
+    for (u32 tile_y = tile_y1; tile_y <= tile_y2; tile_y++) {
+        for (u32 tile_x = tile_x1; tile_x <= tile_x2; tile_x++) {
+            bins[tile_y * tiles_x + tile_x].push_back(triangle_index);
+        }
+    }
+}
+
+void RasterizerSoftware::FlushBins() {
+    if (triangles.empty()) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_Rasterization);
+
+    fb.Bind();
+    BindPipeline();
+
+    // Each worker owns an interleaved subset of the tiles. Triangles are processed in
+    // submission order within a tile and tiles never share pixels, so ordering is preserved.
+    const std::size_t num_workers = sw_workers.NumWorkers();
+    for (std::size_t worker = 0; worker < num_workers; worker++) {
+        sw_workers.QueueWork([this, worker, num_workers] {
+            for (std::size_t index = worker; index < bins.size(); index += num_workers) {
+                const auto& bin = bins[index];
+                if (bin.empty()) {
+                    continue;
+                }
+                const u32 tile_x = static_cast<u32>(index % tiles_x);
+                const u32 tile_y = static_cast<u32>(index / tiles_x);
+                const TileRect tile = {
+                    .x1 = (tile_x * TILE_SIZE) << 4,
+                    .y1 = (tile_y * TILE_SIZE) << 4,
+                    .x2 = tile_x == tiles_x - 1 ? UINT32_MAX : ((tile_x + 1) * TILE_SIZE) << 4,
+                    .y2 = tile_y == tiles_y - 1 ? UINT32_MAX : ((tile_y + 1) * TILE_SIZE) << 4,
+                };
+                for (const u32 triangle_index : bin) {
+                    ProcessTriangle(triangles[triangle_index], tile);
+                }
+            }
+        });
+    }
+    sw_workers.WaitForRequests();
+
+    triangles.clear();
+    for (auto& bin : bins) {
+        bin.clear();
+    }
+}
+
+void RasterizerSoftware::ProcessTriangle(const BinnedTriangle& triangle, const TileRect& tile) {
+    const Vertex& v0 = triangle.v0;
+    const Vertex& v1 = triangle.v1;
+    const Vertex& v2 = triangle.v2;
+    const auto& vtxpos = triangle.vtxpos;
+    const int bias0 = triangle.bias[0];
+    const int bias1 = triangle.bias[1];
+    const int bias2 = triangle.bias[2];
+
+    // Restrict the bounding box to the tile. Both are aligned to pixel boundaries.
+    const u32 min_x = std::max<u32>(triangle.min_x, tile.x1);
+    const u32 min_y = std::max<u32>(triangle.min_y, tile.y1);
+    const u32 max_x = std::min<u32>(triangle.max_x, tile.x2);
+    const u32 max_y = std::min<u32>(triangle.max_y, tile.y2);
+
+    // Convert the scissor box coordinates to 12.4 fixed point
+    const u16 scissor_x1 = static_cast<u16>(regs.rasterizer.scissor_test.x1 << 4);
+    const u16 scissor_y1 = static_cast<u16>(regs.rasterizer.scissor_test.y1 << 4);
+    // x2,y2 have +1 added to cover the entire sub-pixel area
+    const u16 scissor_x2 = static_cast<u16>((regs.rasterizer.scissor_test.x2 + 1) << 4);
+    const u16 scissor_y2 = static_cast<u16>((regs.rasterizer.scissor_test.y2 + 1) << 4);
 
     const auto w_inverse = Common::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
 
     const auto textures = regs.texturing.GetTextures();
     const auto tev_stages = regs.texturing.GetTevStages();
 
-    fb.Bind();
-
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
     // TODO: Not sure if looping through x first might be faster
-    for (u16 y = min_y + 8; y < max_y; y += 0x10) {
-        const auto process_scanline = [&, y] {
-            for (u16 x = min_x + 8; x < max_x; x += 0x10) {
-                // Do not process the pixel if it's inside the scissor box and the scissor mode is
-                // set to Exclude.
-                if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
-                    if (x >= scissor_x1 && x < scissor_x2 && y >= scissor_y1 && y < scissor_y2) {
-                        continue;
-                    }
+    FragmentSpan span;
+    for (u16 y = static_cast<u16>(min_y + 8); y < max_y; y += 0x10) {
+        span.y = y;
+        for (u16 x = static_cast<u16>(min_x + 8); x < max_x; x += 0x10) {
+            // Do not process the pixel if it's inside the scissor box and the scissor mode is
+            // set to Exclude.
+            if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
+                if (x >= scissor_x1 && x < scissor_x2 && y >= scissor_y1 && y < scissor_y2) {
+                    continue;
                 }
+            }
 
-                // Calculate the barycentric coordinates w0, w1 and w2
-                const s32 w0 = bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
-                const s32 w1 = bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
-                const s32 w2 = bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
-                const s32 wsum = w0 + w1 + w2;
+            // Calculate the barycentric coordinates w0, w1 and w2
+            const s32 w0 = bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
+            const s32 w1 = bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
+            const s32 w2 = bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
+            const s32 wsum = w0 + w1 + w2;
 
-                // If current pixel is not covered by the current primitive
-                if (w0 < 0 || w1 < 0 || w2 < 0) {
-                    continue;
-                }
+            // If current pixel is not covered by the current primitive
+            if (w0 < 0 || w1 < 0 || w2 < 0) {
+                continue;
+            }
 
-                const auto baricentric_coordinates = Common::MakeVec(
-                    f24::FromFloat32(static_cast<f32>(w0)), f24::FromFloat32(static_cast<f32>(w1)),
-                    f24::FromFloat32(static_cast<f32>(w2)));
-                const f24 interpolated_w_inverse =
-                    f24::One() / Common::Dot(w_inverse, baricentric_coordinates);
-
-                // interpolated_z = z / w
-                const float interpolated_z_over_w =
-                    (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
-                     v2.screenpos[2].ToFloat32() * w2) /
-                    wsum;
-
-                // Not fully accurate. About 3 bits in precision are missing.
-                // Z-Buffer (z / w * scale + offset)
-                const float depth_scale =
-                    f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
-                const float depth_offset =
-                    f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
-                float depth = interpolated_z_over_w * depth_scale + depth_offset;
-
-                // Potentially switch to W-Buffer
-                if (regs.rasterizer.depthmap_enable ==
-                    Pica::RasterizerRegs::DepthBuffering::WBuffering) {
-                    // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
-                    depth *= interpolated_w_inverse.ToFloat32() * wsum;
-                }
+            const auto baricentric_coordinates = Common::MakeVec(
+                f24::FromFloat32(static_cast<f32>(w0)), f24::FromFloat32(static_cast<f32>(w1)),
+                f24::FromFloat32(static_cast<f32>(w2)));
+            const f24 interpolated_w_inverse =
+                f24::One() / Common::Dot(w_inverse, baricentric_coordinates);
+
+            // interpolated_z = z / w
+            const float interpolated_z_over_w =
+                (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
+                 v2.screenpos[2].ToFloat32() * w2) /
+                wsum;
+
+            // Not fully accurate. About 3 bits in precision are missing.
+            // Z-Buffer (z / w * scale + offset)
+            const float depth_scale =
+                f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
+            const float depth_offset =
+                f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
+            float depth = interpolated_z_over_w * depth_scale + depth_offset;
+
+            // Potentially switch to W-Buffer
+            if (regs.rasterizer.depthmap_enable ==
+                Pica::RasterizerRegs::DepthBuffering::WBuffering) {
+                // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
+                depth *= interpolated_w_inverse.ToFloat32() * wsum;
+            }
 
-                // Clamp the result
-                depth = std::clamp(depth, 0.0f, 1.0f);
-
-                /**
-                 * Perspective correct attribute interpolation:
-                 * Attribute values cannot be calculated by simple linear interpolation since
-                 * they are not linear in screen space. For example, when interpolating a
-                 * texture coordinate across two vertices, something simple like
-                 *     u = (u0*w0 + u1*w1)/(w0+w1)
-                 * will not work. However, the attribute value divided by the
-                 * clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
-                 * in screenspace. Hence, we can linearly interpolate these two independently and
-                 * calculate the interpolated attribute by dividing the results.
-                 * I.e.
-                 *     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
-                 *     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
-                 *     u = u_over_w / one_over_w
-                 *
-                 * The generalization to three vertices is straightforward in baricentric
-                 *coordinates.
-                 **/
-                const auto get_interpolated_attribute = [&](f24 attr0, f24 attr1, f24 attr2) {
-                    auto attr_over_w = Common::MakeVec(attr0, attr1, attr2);
-                    f24 interpolated_attr_over_w =
-                        Common::Dot(attr_over_w, baricentric_coordinates);
-                    return interpolated_attr_over_w * interpolated_w_inverse;
-                };
+            // Clamp the result
+            depth = std::clamp(depth, 0.0f, 1.0f);
+
+            /**
+             * Perspective correct attribute interpolation:
+             * Attribute values cannot be calculated by simple linear interpolation since
+             * they are not linear in screen space. For example, when interpolating a
+             * texture coordinate across two vertices, something simple like
+             *     u = (u0*w0 + u1*w1)/(w0+w1)
+             * will not work. However, the attribute value divided by the
+             * clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
+             * in screenspace. Hence, we can linearly interpolate these two independently and
+             * calculate the interpolated attribute by dividing the results.
+             * I.e.
+             *     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
+             *     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
+             *     u = u_over_w / one_over_w
+             *
+             * The generalization to three vertices is straightforward in baricentric
+             *coordinates.
+             **/
+            const auto get_interpolated_attribute = [&](f24 attr0, f24 attr1, f24 attr2) {
+                auto attr_over_w = Common::MakeVec(attr0, attr1, attr2);
+                f24 interpolated_attr_over_w =
+                    Common::Dot(attr_over_w, baricentric_coordinates);
+                return interpolated_attr_over_w * interpolated_w_inverse;
+            };
+
+            const Common::Vec4<u8> primary_color{
+                static_cast<u8>(
+                    round(get_interpolated_attribute(v0.color.r(), v1.color.r(), v2.color.r())
+                              .ToFloat32() *
+                          255)),
+                static_cast<u8>(
+                    round(get_interpolated_attribute(v0.color.g(), v1.color.g(), v2.color.g())
+                              .ToFloat32() *
+                          255)),
+                static_cast<u8>(
+                    round(get_interpolated_attribute(v0.color.b(), v1.color.b(), v2.color.b())
+                              .ToFloat32() *
+                          255)),
+                static_cast<u8>(
+                    round(get_interpolated_attribute(v0.color.a(), v1.color.a(), v2.color.a())
+                              .ToFloat32() *
+                          255)),
+            };
+
+            std::array<Common::Vec2<f24>, 3> uv;
+            uv[0].u() = get_interpolated_attribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
+            uv[0].v() = get_interpolated_attribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
+            uv[1].u() = get_interpolated_attribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
+            uv[1].v() = get_interpolated_attribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
+            uv[2].u() = get_interpolated_attribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
+            uv[2].v() = get_interpolated_attribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
+
+            // Sample bound texture units.
+            const f24 tc0_w = get_interpolated_attribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+            const auto texture_color = TextureColor(uv, textures, tc0_w);
+
+            Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
+            Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
+
+            if (!regs.lighting.disable) {
+                const auto normquat =
+                    Common::Quaternion<f32>{
+                        {get_interpolated_attribute(v0.quat.x, v1.quat.x, v2.quat.x)
+                             .ToFloat32(),
+                         get_interpolated_attribute(v0.quat.y, v1.quat.y, v2.quat.y)
+                             .ToFloat32(),
+                         get_interpolated_attribute(v0.quat.z, v1.quat.z, v2.quat.z)
+                             .ToFloat32()},
+                        get_interpolated_attribute(v0.quat.w, v1.quat.w, v2.quat.w).ToFloat32(),
+                    }
+                        .Normalized();
 
-                const Common::Vec4<u8> primary_color{
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.r(), v1.color.r(), v2.color.r())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.g(), v1.color.g(), v2.color.g())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.b(), v1.color.b(), v2.color.b())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.a(), v1.color.a(), v2.color.a())
-                                  .ToFloat32() *
-                              255)),
+                const Common::Vec3f view{
+                    get_interpolated_attribute(v0.view.x, v1.view.x, v2.view.x).ToFloat32(),
+                    get_interpolated_attribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
+                    get_interpolated_attribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
                 };
+                std::tie(primary_fragment_color, secondary_fragment_color) =
+                    ComputeFragmentsColors(regs.lighting, pica.lighting, normquat, view,
+                                           texture_color);
+            }
 
-                std::array<Common::Vec2<f24>, 3> uv;
-                uv[0].u() = get_interpolated_attribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
-                uv[0].v() = get_interpolated_attribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
-                uv[1].u() = get_interpolated_attribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
-                uv[1].v() = get_interpolated_attribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
-                uv[2].u() = get_interpolated_attribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
-                uv[2].v() = get_interpolated_attribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
-
-                // Sample bound texture units.
-                const f24 tc0_w = get_interpolated_attribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
-                const auto texture_color = TextureColor(uv, textures, tc0_w);
-
-                Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
-                Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
-
-                if (!regs.lighting.disable) {
-                    const auto normquat =
-                        Common::Quaternion<f32>{
-                            {get_interpolated_attribute(v0.quat.x, v1.quat.x, v2.quat.x)
-                                 .ToFloat32(),
-                             get_interpolated_attribute(v0.quat.y, v1.quat.y, v2.quat.y)
-                                 .ToFloat32(),
-                             get_interpolated_attribute(v0.quat.z, v1.quat.z, v2.quat.z)
-                                 .ToFloat32()},
-                            get_interpolated_attribute(v0.quat.w, v1.quat.w, v2.quat.w).ToFloat32(),
-                        }
-                            .Normalized();
-
-                    const Common::Vec3f view{
-                        get_interpolated_attribute(v0.view.x, v1.view.x, v2.view.x).ToFloat32(),
-                        get_interpolated_attribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
-                        get_interpolated_attribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
-                    };
-                    std::tie(primary_fragment_color, secondary_fragment_color) =
-                        ComputeFragmentsColors(regs.lighting, pica.lighting, normquat, view,
-                                               texture_color);
-                }
+            // Queue the fragment, the rest of the pipeline runs on whole spans.
+            const std::size_t lane = span.count;
+            span.x[lane] = x;
+            span.depth[lane] = depth;
+            span.primary_color.Set(lane, primary_color);
+            span.primary_fragment_color.Set(lane, primary_fragment_color);
+            span.secondary_fragment_color.Set(lane, secondary_fragment_color);
+            for (std::size_t i = 0; i < texture_color.size(); i++) {
+                span.texture_color[i].Set(lane, texture_color[i]);
+            }
+            if (++span.count == SPAN_SIZE) {
+                (this->*process_span)(span, tev_stages);
+                span.count = 0;
+            }
+        }
 
-                // Write the TEV stages.
-                auto combiner_output =
-                    WriteTevConfig(texture_color, tev_stages, primary_color, primary_fragment_color,
-                                   secondary_fragment_color);
-
-                const auto& output_merger = regs.framebuffer.output_merger;
-                if (output_merger.fragment_operation_mode ==
-                    FramebufferRegs::FragmentOperationMode::Shadow) {
-                    const u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
-                    // Use green color as the shadow intensity
-                    const u8 stencil = combiner_output.y;
-                    fb.DrawShadowMapPixel(x >> 4, y >> 4, depth_int, stencil);
-                    // Skip the normal output merger pipeline if it is in shadow mode
-                    continue;
-                }
+        if (span.count != 0) {
+            (this->*process_span)(span, tev_stages);
+            span.count = 0;
+        }
+    }
+}
 
-                // Does alpha testing happen before or after stencil?
-                if (!DoAlphaTest(combiner_output.a())) {
-                    continue;
-                }
-                WriteFog(depth, combiner_output);
-                if (!DoDepthStencilTest(x, y, depth)) {
-                    continue;
-                }
-                const auto result = PixelColor(x, y, combiner_output);
-                if (regs.framebuffer.framebuffer.allow_color_write != 0) {
-                    fb.DrawPixel(x >> 4, y >> 4, result);
-                }
+void RasterizerSoftware::BindPipeline() {
+    const auto& output_merger = regs.framebuffer.output_merger;
+    const auto& framebuffer = regs.framebuffer.framebuffer;
+
+    // Stages that forward the previous output unchanged only need to update the combiner buffer.
+    passthrough_tev_stages = 0;
+    const auto tev_stages = regs.texturing.GetTevStages();
+    for (u32 index = 0; index < tev_stages.size(); index++) {
+        if (IsPassThroughTevStage(tev_stages[index], index)) {
+            passthrough_tev_stages |= 1U << index;
+        }
+    }
+
+    if (output_merger.fragment_operation_mode == FramebufferRegs::FragmentOperationMode::Shadow) {
+        process_span = &RasterizerSoftware::ProcessShadowSpan;
+        return;
+    }
+
+    const bool fog = regs.texturing.fog_mode == TexturingRegs::FogMode::Fog;
+    const bool alpha_test = output_merger.alpha_test.enable != 0;
+    const bool stencil_test = output_merger.stencil_test.enable &&
+                              framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
+    const bool depth_stencil =
+        stencil_test || output_merger.depth_test_enable ||
+        (framebuffer.allow_depth_stencil_write != 0 && output_merger.depth_write_enable);
+    const bool read_dest = output_merger.alphablend_enable ||
+                           output_merger.logic_op != FramebufferRegs::LogicOp::Copy ||
+                           !output_merger.red_enable || !output_merger.green_enable ||
+                           !output_merger.blue_enable || !output_merger.alpha_enable;
+
+    // Every combination of the pipeline stages is instantiated at compile time, so the
+    // specialized variant is selected by indexing with the state key.
+    static constexpr auto variants = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<ProcessSpanFunc, sizeof...(I)>{
+            &RasterizerSoftware::ProcessSpan<(I & 1) != 0, (I & 2) != 0, (I & 4) != 0,
+                                             (I & 8) != 0>...};
+    }(std::make_index_sequence<16>{});
+
+    const u32 key = (fog ? 1 : 0) | (alpha_test ? 2 : 0) | (depth_stencil ? 4 : 0) |
+                    (read_dest ? 8 : 0);
+    process_span = variants[key];
+}
+
+void RasterizerSoftware::ProcessShadowSpan(
+    const FragmentSpan& span, std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages) {
+    const auto combiner_output = WriteTevConfig(span, tev_stages);
+    for (std::size_t lane = 0; lane < span.count; lane++) {
+        const u32 depth_int = static_cast<u32>(span.depth[lane] * 0xFFFFFF);
+        // Use green color as the shadow intensity
+        const u8 stencil = combiner_output[1][lane];
+        fb.DrawShadowMapPixel(span.x[lane] >> 4, span.y >> 4, depth_int, stencil);
+    }
+}
+
+template <bool fog, bool alpha_test, bool depth_stencil, bool read_dest>
+void RasterizerSoftware::ProcessSpan(
+    const FragmentSpan& span, std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages) {
+    // Write the TEV stages.
+    auto combiner_output = WriteTevConfig(span, tev_stages);
+
+    // Fog only modifies the color channels, so it can be applied before the alpha test.
+    if constexpr (fog) {
+        WriteFog(span.depth, combiner_output);
+    }
+
+    const bool allow_color_write = regs.framebuffer.framebuffer.allow_color_write != 0;
+    std::array<bool, SPAN_SIZE> passed{};
+    ColorSpan dest{};
+    for (std::size_t lane = 0; lane < span.count; lane++) {
+        // Does alpha testing happen before or after stencil?
+        if constexpr (alpha_test) {
+            if (!DoAlphaTest(combiner_output[3][lane])) {
+                continue;
             }
-        };
-        sw_workers.QueueWork(std::move(process_scanline));
+        }
+        if constexpr (depth_stencil) {
+            if (!DoDepthStencilTest(span.x[lane], span.y, span.depth[lane])) {
+                continue;
+            }
+        }
+        if (allow_color_write) {
+            passed[lane] = true;
+            if constexpr (read_dest) {
+                dest.Set(lane, fb.GetPixel(span.x[lane] >> 4, span.y >> 4));
+            }
+        }
+    }
+
+    if (!allow_color_write) {
+        return;
+    }
+
+    // Without blending, logic ops or write masks the combiner output is written as is.
+    const auto result = read_dest ? PixelColor(dest, combiner_output) : combiner_output;
+    for (std::size_t lane = 0; lane < span.count; lane++) {
+        if (passed[lane]) {
+            fb.DrawPixel(span.x[lane] >> 4, span.y >> 4, result.Get(lane));
+        }
     }
-    sw_workers.WaitForRequests();
 }
 
 std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
@@ -591,58 +855,76 @@ std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
     return texture_color;
 }
 
-Common::Vec4<u8> RasterizerSoftware::PixelColor(u16 x, u16 y,
-                                                Common::Vec4<u8> combiner_output) const {
-    const auto dest = fb.GetPixel(x >> 4, y >> 4);
-    Common::Vec4<u8> blend_output = combiner_output;
+ColorSpan RasterizerSoftware::PixelColor(const ColorSpan& dest,
+                                         const ColorSpan& combiner_output) const {
+    ColorSpan blend_output = combiner_output;
 
     const auto& output_merger = regs.framebuffer.output_merger;
     if (output_merger.alphablend_enable) {
         const auto params = output_merger.alpha_blending;
-        const auto lookup_factor = [&](u32 channel, FramebufferRegs::BlendFactor factor) -> u8 {
+        const Common::Vec4<u8> blend_const =
+            Common::MakeVec(
+                output_merger.blend_const.r.Value(), output_merger.blend_const.g.Value(),
+                output_merger.blend_const.b.Value(), output_merger.blend_const.a.Value())
+                .Cast<u8>();
+
+        const auto lookup_factor = [&](u32 channel,
+                                       FramebufferRegs::BlendFactor factor) -> ChannelSpan {
             DEBUG_ASSERT(channel < 4);
 
-            const Common::Vec4<u8> blend_const =
-                Common::MakeVec(
-                    output_merger.blend_const.r.Value(), output_merger.blend_const.g.Value(),
-                    output_merger.blend_const.b.Value(), output_merger.blend_const.a.Value())
-                    .Cast<u8>();
+            ChannelSpan result;
+            const auto invert = [&result](const ChannelSpan& values) {
+                for (std::size_t i = 0; i < SPAN_SIZE; i++) {
+                    result[i] = 255 - values[i];
+                }
+                return result;
+            };
 
             switch (factor) {
             case FramebufferRegs::BlendFactor::Zero:
-                return 0;
+                result.fill(0);
+                return result;
             case FramebufferRegs::BlendFactor::One:
-                return 255;
+                result.fill(255);
+                return result;
             case FramebufferRegs::BlendFactor::SourceColor:
                 return combiner_output[channel];
             case FramebufferRegs::BlendFactor::OneMinusSourceColor:
-                return 255 - combiner_output[channel];
+                return invert(combiner_output[channel]);
             case FramebufferRegs::BlendFactor::DestColor:
                 return dest[channel];
             case FramebufferRegs::BlendFactor::OneMinusDestColor:
-                return 255 - dest[channel];
+                return invert(dest[channel]);
             case FramebufferRegs::BlendFactor::SourceAlpha:
-                return combiner_output.a();
+                return combiner_output[3];
             case FramebufferRegs::BlendFactor::OneMinusSourceAlpha:
-                return 255 - combiner_output.a();
+                return invert(combiner_output[3]);
             case FramebufferRegs::BlendFactor::DestAlpha:
-                return dest.a();
+                return dest[3];
             case FramebufferRegs::BlendFactor::OneMinusDestAlpha:
-                return 255 - dest.a();
+                return invert(dest[3]);
             case FramebufferRegs::BlendFactor::ConstantColor:
-                return blend_const[channel];
+                result.fill(blend_const[channel]);
+                return result;
             case FramebufferRegs::BlendFactor::OneMinusConstantColor:
-                return 255 - blend_const[channel];
+                result.fill(255 - blend_const[channel]);
+                return result;
             case FramebufferRegs::BlendFactor::ConstantAlpha:
-                return blend_const.a();
+                result.fill(blend_const.a());
+                return result;
             case FramebufferRegs::BlendFactor::OneMinusConstantAlpha:
-                return 255 - blend_const.a();
+                result.fill(255 - blend_const.a());
+                return result;
             case FramebufferRegs::BlendFactor::SourceAlphaSaturate:
                 // Returns 1.0 for the alpha channel
                 if (channel == 3) {
-                    return 255;
+                    result.fill(255);
+                    return result;
                 }
-                return std::min(combiner_output.a(), static_cast<u8>(255 - dest.a()));
+                for (std::size_t i = 0; i < SPAN_SIZE; i++) {
+                    result[i] = std::min(combiner_output[3][i], static_cast<u8>(255 - dest[3][i]));
+                }
+                return result;
             default:
                 LOG_CRITICAL(HW_GPU, "Unknown blend factor {:x}", factor);
                 UNIMPLEMENTED();
@@ -651,91 +933,104 @@ Common::Vec4<u8> RasterizerSoftware::PixelColor(u16 x, u16 y,
             return combiner_output[channel];
         };
 
-        const auto srcfactor = Common::MakeVec(
-            lookup_factor(0, params.factor_source_rgb), lookup_factor(1, params.factor_source_rgb),
-            lookup_factor(2, params.factor_source_rgb), lookup_factor(3, params.factor_source_a));
-
-        const auto dstfactor = Common::MakeVec(
-            lookup_factor(0, params.factor_dest_rgb), lookup_factor(1, params.factor_dest_rgb),
-            lookup_factor(2, params.factor_dest_rgb), lookup_factor(3, params.factor_dest_a));
-
-        blend_output = EvaluateBlendEquation(combiner_output, srcfactor, dest, dstfactor,
-                                             params.blend_equation_rgb);
-        blend_output.a() = EvaluateBlendEquation(combiner_output, srcfactor, dest, dstfactor,
-                                                 params.blend_equation_a)
-                               .a();
+        for (u32 channel = 0; channel < 4; channel++) {
+            const bool is_alpha = channel == 3;
+            const auto src_factor =
+                is_alpha ? params.factor_source_a.Value() : params.factor_source_rgb.Value();
+            const auto dst_factor =
+                is_alpha ? params.factor_dest_a.Value() : params.factor_dest_rgb.Value();
+            const auto equation =
+                is_alpha ? params.blend_equation_a.Value() : params.blend_equation_rgb.Value();
+            const auto srcfactor = lookup_factor(channel, src_factor);
+            const auto dstfactor = lookup_factor(channel, dst_factor);
+            blend_output[channel] = EvaluateBlendEquationSpan(
+                combiner_output[channel], srcfactor, dest[channel], dstfactor, equation);
+        }
     } else {
-        blend_output =
-            Common::MakeVec(LogicOp(combiner_output.r(), dest.r(), output_merger.logic_op),
-                            LogicOp(combiner_output.g(), dest.g(), output_merger.logic_op),
-                            LogicOp(combiner_output.b(), dest.b(), output_merger.logic_op),
-                            LogicOp(combiner_output.a(), dest.a(), output_merger.logic_op));
-    }
-
-    const Common::Vec4<u8> result = {
-        output_merger.red_enable ? blend_output.r() : dest.r(),
-        output_merger.green_enable ? blend_output.g() : dest.g(),
-        output_merger.blue_enable ? blend_output.b() : dest.b(),
-        output_merger.alpha_enable ? blend_output.a() : dest.a(),
+        for (u32 channel = 0; channel < 4; channel++) {
+            for (std::size_t i = 0; i < SPAN_SIZE; i++) {
+                blend_output[channel][i] =
+                    LogicOp(combiner_output[channel][i], dest[channel][i], output_merger.logic_op);
+            }
+        }
+    }
+
+    const std::array<bool, 4> write_enable = {
+        output_merger.red_enable != 0,
+        output_merger.green_enable != 0,
+        output_merger.blue_enable != 0,
+        output_merger.alpha_enable != 0,
     };
+    for (u32 channel = 0; channel < 4; channel++) {
+        if (!write_enable[channel]) {
+            blend_output[channel] = dest[channel];
+        }
+    }
 
-    return result;
+    return blend_output;
 }
 
-Common::Vec4<u8> RasterizerSoftware::WriteTevConfig(
-    std::span<const Common::Vec4<u8>, 4> texture_color,
-    std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages,
-    Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
-    Common::Vec4<u8> secondary_fragment_color) {
+ColorSpan RasterizerSoftware::WriteTevConfig(
+    const FragmentSpan& span, std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages) {
     /**
      * Texture environment - consists of 6 stages of color and alpha combining.
      * Color combiners take three input color values from some source (e.g. interpolated
      * vertex color, texture color, previous stage, etc), perform some very simple
      * operations on each of them (e.g. inversion) and then calculate the output color
      * with some basic arithmetic. Alpha combiners can be configured separately but work
-     * analogously.
+     * analogously. Every stage is evaluated for all the fragments of the span at once.
      **/
-    Common::Vec4<u8> combiner_output = {0, 0, 0, 0};
-    Common::Vec4<u8> combiner_buffer = {0, 0, 0, 0};
-    Common::Vec4<u8> next_combiner_buffer =
+    ColorSpan combiner_output{};
+    ColorSpan combiner_buffer{};
+    ColorSpan next_combiner_buffer = ColorSpan::Splat(
         Common::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
                         regs.texturing.tev_combiner_buffer_color.g.Value(),
                         regs.texturing.tev_combiner_buffer_color.b.Value(),
                         regs.texturing.tev_combiner_buffer_color.a.Value())
-            .Cast<u8>();
+            .Cast<u8>());
 
     for (u32 tev_stage_index = 0; tev_stage_index < tev_stages.size(); ++tev_stage_index) {
+        if (passthrough_tev_stages & (1U << tev_stage_index)) {
+            UpdateCombinerBuffer(tev_stage_index, combiner_output, combiner_buffer,
+                                 next_combiner_buffer);
+            continue;
+        }
+
         const auto& tev_stage = tev_stages[tev_stage_index];
         using Source = TexturingRegs::TevStageConfig::Source;
 
-        auto get_source = [&](Source source) -> Common::Vec4<u8> {
+        const ColorSpan constant =
+            ColorSpan::Splat(Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                                             tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                                 .Cast<u8>());
+
+        auto get_source = [&](Source source) -> const ColorSpan& {
             switch (source) {
             case Source::PrimaryColor:
-                return primary_color;
+                return span.primary_color;
             case Source::PrimaryFragmentColor:
-                return primary_fragment_color;
+                return span.primary_fragment_color;
             case Source::SecondaryFragmentColor:
-                return secondary_fragment_color;
+                return span.secondary_fragment_color;
             case Source::Texture0:
-                return texture_color[0];
+                return span.texture_color[0];
             case Source::Texture1:
-                return texture_color[1];
+                return span.texture_color[1];
             case Source::Texture2:
-                return texture_color[2];
+                return span.texture_color[2];
             case Source::Texture3:
-                return texture_color[3];
+                return span.texture_color[3];
             case Source::PreviousBuffer:
                 return combiner_buffer;
             case Source::Constant:
-                return Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
-                                       tev_stage.const_b.Value(), tev_stage.const_a.Value())
-                    .Cast<u8>();
+                return constant;
             case Source::Previous:
                 return combiner_output;
             default:
                 LOG_ERROR(HW_GPU, "Unknown color combiner source {}", (int)source);
                 UNIMPLEMENTED();
-                return {0, 0, 0, 0};
+                static const ColorSpan zero{};
+                return zero;
             }
         };
 
@@ -752,51 +1047,65 @@ Common::Vec4<u8> RasterizerSoftware::WriteTevConfig(
         const auto source2 = tev_stage_index == 0 && tev_stage.color_source2 == Source::Previous
                                  ? tev_stage.color_source3.Value()
                                  : tev_stage.color_source2.Value();
-        const std::array<Common::Vec3<u8>, 3> color_result = {
-            GetColorModifier(tev_stage.color_modifier1, get_source(source1)),
-            GetColorModifier(tev_stage.color_modifier2, get_source(source2)),
-            GetColorModifier(tev_stage.color_modifier3, get_source(tev_stage.color_source3)),
+        const std::array<RgbSpan, 3> color_result = {
+            GetColorModifierSpan(tev_stage.color_modifier1, get_source(source1)),
+            GetColorModifierSpan(tev_stage.color_modifier2, get_source(source2)),
+            GetColorModifierSpan(tev_stage.color_modifier3, get_source(tev_stage.color_source3)),
         };
-        const Common::Vec3<u8> color_output = ColorCombine(tev_stage.color_op, color_result);
+        RgbSpan color_output = ColorCombineSpan(tev_stage.color_op, color_result);
 
-        u8 alpha_output;
+        ChannelSpan alpha_output;
         if (tev_stage.color_op == TexturingRegs::TevStageConfig::Operation::Dot3_RGBA) {
             // result of Dot3_RGBA operation is also placed to the alpha component
-            alpha_output = color_output.x;
+            alpha_output = color_output[0];
         } else {
             // alpha combiner
-            const std::array<u8, 3> alpha_result = {{
-                GetAlphaModifier(tev_stage.alpha_modifier1, get_source(tev_stage.alpha_source1)),
-                GetAlphaModifier(tev_stage.alpha_modifier2, get_source(tev_stage.alpha_source2)),
-                GetAlphaModifier(tev_stage.alpha_modifier3, get_source(tev_stage.alpha_source3)),
-            }};
-            alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
+            const std::array<ChannelSpan, 3> alpha_result = {
+                GetAlphaModifierSpan(tev_stage.alpha_modifier1,
+                                     get_source(tev_stage.alpha_source1)),
+                GetAlphaModifierSpan(tev_stage.alpha_modifier2,
+                                     get_source(tev_stage.alpha_source2)),
+                GetAlphaModifierSpan(tev_stage.alpha_modifier3,
+                                     get_source(tev_stage.alpha_source3)),
+            };
+            alpha_output = AlphaCombineSpan(tev_stage.alpha_op, alpha_result);
         }
 
-        combiner_output[0] = std::min(255U, color_output.r() * tev_stage.GetColorMultiplier());
-        combiner_output[1] = std::min(255U, color_output.g() * tev_stage.GetColorMultiplier());
-        combiner_output[2] = std::min(255U, color_output.b() * tev_stage.GetColorMultiplier());
-        combiner_output[3] = std::min(255U, alpha_output * tev_stage.GetAlphaMultiplier());
-
-        combiner_buffer = next_combiner_buffer;
-
-        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
-                tev_stage_index)) {
-            next_combiner_buffer.r() = combiner_output.r();
-            next_combiner_buffer.g() = combiner_output.g();
-            next_combiner_buffer.b() = combiner_output.b();
+        for (std::size_t channel = 0; channel < 3; channel++) {
+            ApplyMultiplierSpan(color_output[channel], tev_stage.GetColorMultiplier());
+            combiner_output[channel] = color_output[channel];
         }
+        ApplyMultiplierSpan(alpha_output, tev_stage.GetAlphaMultiplier());
+        combiner_output[3] = alpha_output;
 
-        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
-                tev_stage_index)) {
-            next_combiner_buffer.a() = combiner_output.a();
-        }
+        UpdateCombinerBuffer(tev_stage_index, combiner_output, combiner_buffer,
+                             next_combiner_buffer);
     }
 
     return combiner_output;
 }
 
-void RasterizerSoftware::WriteFog(float depth, Common::Vec4<u8>& combiner_output) const {
+void RasterizerSoftware::UpdateCombinerBuffer(u32 tev_stage_index,
+                                              const ColorSpan& combiner_output,
+                                              ColorSpan& combiner_buffer,
+                                              ColorSpan& next_combiner_buffer) const {
+    combiner_buffer = next_combiner_buffer;
+
+    if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
+            tev_stage_index)) {
+        next_combiner_buffer[0] = combiner_output[0];
+        next_combiner_buffer[1] = combiner_output[1];
+        next_combiner_buffer[2] = combiner_output[2];
+    }
+
+    if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
+            tev_stage_index)) {
+        next_combiner_buffer[3] = combiner_output[3];
+    }
+}
+
+void RasterizerSoftware::WriteFog(std::span<const float, SPAN_SIZE> depth,
+                                  ColorSpan& combiner_output) const {
     /**
      * Apply fog combiner. Not fully accurate. We'd have to know what data type is used to
      * store the depth etc. Using float for now until we know more about Pica datatypes.
@@ -807,22 +1116,30 @@ void RasterizerSoftware::WriteFog(float depth, Common::Vec4<u8>& combiner_output
                             regs.texturing.fog_color.b.Value())
                 .Cast<u8>();
 
-        float fog_index;
-        if (regs.texturing.fog_flip) {
-            fog_index = (1.0f - depth) * 128.0f;
-        } else {
-            fog_index = depth * 128.0f;
+        std::array<f32, SPAN_SIZE> fog_factor;
+        for (std::size_t lane = 0; lane < SPAN_SIZE; lane++) {
+            float fog_index;
+            if (regs.texturing.fog_flip) {
+                fog_index = (1.0f - depth[lane]) * 128.0f;
+            } else {
+                fog_index = depth[lane] * 128.0f;
+            }
+
+            // Generate clamped fog factor from LUT for given fog index
+            const f32 fog_i = std::clamp(floorf(fog_index), 0.0f, 127.0f);
+            const f32 fog_f = fog_index - fog_i;
+            const auto& fog_lut_entry = pica.fog.lut[static_cast<u32>(fog_i)];
+            fog_factor[lane] = std::clamp(
+                fog_lut_entry.ToFloat() + fog_lut_entry.DiffToFloat() * fog_f, 0.0f, 1.0f);
         }
 
-        // Generate clamped fog factor from LUT for given fog index
-        const f32 fog_i = std::clamp(floorf(fog_index), 0.0f, 127.0f);
-        const f32 fog_f = fog_index - fog_i;
-        const auto& fog_lut_entry = pica.fog.lut[static_cast<u32>(fog_i)];
-        f32 fog_factor = fog_lut_entry.ToFloat() + fog_lut_entry.DiffToFloat() * fog_f;
-        fog_factor = std::clamp(fog_factor, 0.0f, 1.0f);
+        // Blend the channels separately so the loops can be vectorized.
         for (u32 i = 0; i < 3; i++) {
-            combiner_output[i] = static_cast<u8>(fog_factor * combiner_output[i] +
-                                                 (1.0f - fog_factor) * fog_color[i]);
+            for (std::size_t lane = 0; lane < SPAN_SIZE; lane++) {
+                combiner_output[i][lane] =
+                    static_cast<u8>(fog_factor[lane] * combiner_output[i][lane] +
+                                    (1.0f - fog_factor[lane]) * fog_color[i]);
+            }
         }
     }
 }
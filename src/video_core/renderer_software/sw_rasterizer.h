@@ -5,11 +5,13 @@
 #pragma once
 
 #include <span>
+#include <vector>
 #include "common/thread_worker.h"
 #include "video_core/pica/regs_texturing.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_software/sw_clipper.h"
 #include "video_core/renderer_software/sw_framebuffer.h"
+#include "video_core/renderer_software/sw_span.h"
 
 namespace Pica {
 struct RegsInternal;
@@ -19,46 +21,68 @@ class PicaCore;
 namespace SwRenderer {
 
 struct Vertex;
+struct BinnedTriangle;
+struct FragmentSpan;
+struct TileRect;
 
 class RasterizerSoftware : public VideoCore::RasterizerInterface {
 public:
     explicit RasterizerSoftware(Memory::MemorySystem& memory, Pica::PicaCore& pica);
+    ~RasterizerSoftware() override;
 
     void AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                      const Pica::OutputVertex& v2) override;
-    void DrawTriangles() override {}
-    void NotifyPicaRegisterChanged(u32 id) override {}
-    void FlushAll() override {}
-    void FlushRegion(PAddr addr, u32 size) override {}
-    void InvalidateRegion(PAddr addr, u32 size) override {}
-    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
-    void ClearAll(bool flush) override {}
+    void DrawTriangles() override;
+    void NotifyPicaRegisterChanged(u32 id) override;
+    void FlushAll() override;
+    void FlushRegion(PAddr addr, u32 size) override;
+    void InvalidateRegion(PAddr addr, u32 size) override;
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
+    void ClearAll(bool flush) override;
 
 private:
     /// Computes the screen coordinates of the provided vertex.
     void MakeScreenCoords(Vertex& vtx);
 
-    /// Processes the triangle defined by the provided vertices.
-    void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
-                         bool reversed = false);
+    /// Performs triangle setup and appends the triangle to the bins of the tiles it covers.
+    void BinTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2, bool reversed = false);
+
+    /// Rasterizes all binned triangles, with each worker processing its own set of tiles.
+    void FlushBins();
+
+    /// Rasterizes the part of the provided triangle that falls inside the tile.
+    void ProcessTriangle(const BinnedTriangle& triangle, const TileRect& tile);
 
     /// Returns the texture color of the currently processed pixel.
     std::array<Common::Vec4<u8>, 4> TextureColor(
         std::span<const Common::Vec2<f24>, 3> uv,
         std::span<const Pica::TexturingRegs::FullTextureConfig, 3> textures, f24 tc0_w) const;
 
-    /// Returns the final pixel color with blending or logic ops applied.
-    Common::Vec4<u8> PixelColor(u16 x, u16 y, Common::Vec4<u8> combiner_output) const;
+    /// Selects the fragment pipeline variant specialized for the current register state.
+    void BindPipeline();
+
+    /// Runs the texture combiners and output merger on a span of covered fragments.
+    template <bool fog, bool alpha_test, bool depth_stencil, bool read_dest>
+    void ProcessSpan(const FragmentSpan& span,
+                     std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages);
+
+    /// Runs the texture combiners on a span of fragments and writes them to the shadow map.
+    void ProcessShadowSpan(const FragmentSpan& span,
+                           std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages);
+
+    /// Returns the final span colors with blending or logic ops applied.
+    ColorSpan PixelColor(const ColorSpan& dest, const ColorSpan& combiner_output) const;
+
+    /// Emulates the TEV configuration and returns the combiner output of the span.
+    ColorSpan WriteTevConfig(const FragmentSpan& span,
+                             std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages);
 
-    /// Emulates the TEV configuration and returns the combiner output.
-    Common::Vec4<u8> WriteTevConfig(
-        std::span<const Common::Vec4<u8>, 4> texture_color,
-        std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages,
-        Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
-        Common::Vec4<u8> secondary_fragment_color);
+    /// Latches the combiner buffer at the end of the provided TEV stage.
+    void UpdateCombinerBuffer(u32 tev_stage_index, const ColorSpan& combiner_output,
+                              ColorSpan& combiner_buffer, ColorSpan& next_combiner_buffer) const;
 
     /// Blends fog to the combiner output if enabled.
-    void WriteFog(float depth, Common::Vec4<u8>& combiner_output) const;
+    void WriteFog(std::span<const float, SPAN_SIZE> depth, ColorSpan& combiner_output) const;
 
     /// Performs the alpha test. Returns false if the test failed.
     bool DoAlphaTest(u8 alpha) const;
@@ -73,6 +97,14 @@ private:
     std::size_t num_sw_threads;
     Common::ThreadWorker sw_workers;
     Framebuffer fb;
+    using ProcessSpanFunc = void (RasterizerSoftware::*)(
+        const FragmentSpan&, std::span<const Pica::TexturingRegs::TevStageConfig, 6>);
+    ProcessSpanFunc process_span{};
+    u32 passthrough_tev_stages{};
+    std::vector<BinnedTriangle> triangles;
+    std::vector<std::vector<u32>> bins;
+    u32 tiles_x{};
+    u32 tiles_y{};
 };
 
 } // namespace SwRenderer
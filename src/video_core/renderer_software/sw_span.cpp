@@ -0,0 +1,422 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/arch.h"
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "video_core/renderer_software/sw_span.h"
+#include "video_core/renderer_software/sw_texturing.h"
+
+#if CYTRUS_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CYTRUS_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
+namespace SwRenderer {
+
+using Pica::FramebufferRegs;
+using TevStageConfig = Pica::TexturingRegs::TevStageConfig;
+
+namespace {
+
+/**
+ * Eight fragments widened to 16-bit lanes. Every TEV and blending operation keeps its
+ * intermediate values below 65536, so SSE2 on x86_64 and NEON on arm64 are sufficient to
+ * reproduce the scalar results exactly. Other hosts use a plain array the compiler may
+ * vectorize on its own.
+ */
+#if CYTRUS_ARCH(x86_64)
+
+using Lanes = __m128i;
+
+Lanes Load(const ChannelSpan& values) {
+    const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values.data()));
+    return _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+}
+
+void Store(ChannelSpan& values, Lanes lanes) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(values.data()),
+                     _mm_packus_epi16(lanes, _mm_setzero_si128()));
+}
+
+Lanes Splat(u16 value) {
+    return _mm_set1_epi16(static_cast<s16>(value));
+}
+
+Lanes Add(Lanes a, Lanes b) {
+    return _mm_add_epi16(a, b);
+}
+
+Lanes Sub(Lanes a, Lanes b) {
+    return _mm_sub_epi16(a, b);
+}
+
+Lanes SubSaturate(Lanes a, Lanes b) {
+    return _mm_subs_epu16(a, b);
+}
+
+Lanes Mul(Lanes a, Lanes b) {
+    return _mm_mullo_epi16(a, b);
+}
+
+/// Minimum of two vectors whose lanes are below 0x8000.
+Lanes Min(Lanes a, Lanes b) {
+    return _mm_min_epi16(a, b);
+}
+
+/// Maximum of two vectors whose lanes are below 0x8000.
+Lanes Max(Lanes a, Lanes b) {
+    return _mm_max_epi16(a, b);
+}
+
+template <int shift>
+Lanes ShiftRight(Lanes a) {
+    return _mm_srli_epi16(a, shift);
+}
+
+/// Returns all ones in the lanes where a >= b, for lanes below 0x8000.
+Lanes GreaterEqual(Lanes a, Lanes b) {
+    return _mm_cmpeq_epi16(_mm_max_epi16(a, b), a);
+}
+
+Lanes And(Lanes a, Lanes b) {
+    return _mm_and_si128(a, b);
+}
+
+#elif CYTRUS_ARCH(arm64)
+
+using Lanes = uint16x8_t;
+
+Lanes Load(const ChannelSpan& values) {
+    return vmovl_u8(vld1_u8(values.data()));
+}
+
+void Store(ChannelSpan& values, Lanes lanes) {
+    vst1_u8(values.data(), vqmovn_u16(lanes));
+}
+
+Lanes Splat(u16 value) {
+    return vdupq_n_u16(value);
+}
+
+Lanes Add(Lanes a, Lanes b) {
+    return vaddq_u16(a, b);
+}
+
+Lanes Sub(Lanes a, Lanes b) {
+    return vsubq_u16(a, b);
+}
+
+Lanes SubSaturate(Lanes a, Lanes b) {
+    return vqsubq_u16(a, b);
+}
+
+Lanes Mul(Lanes a, Lanes b) {
+    return vmulq_u16(a, b);
+}
+
+Lanes Min(Lanes a, Lanes b) {
+    return vminq_u16(a, b);
+}
+
+Lanes Max(Lanes a, Lanes b) {
+    return vmaxq_u16(a, b);
+}
+
+template <int shift>
+Lanes ShiftRight(Lanes a) {
+    return vshrq_n_u16(a, shift);
+}
+
+Lanes GreaterEqual(Lanes a, Lanes b) {
+    return vcgeq_u16(a, b);
+}
+
+Lanes And(Lanes a, Lanes b) {
+    return vandq_u16(a, b);
+}
+
+#else
+
+struct Lanes {
+    std::array<u16, SPAN_SIZE> v;
+};
+
+template <typename Op>
+Lanes Map(Lanes a, Lanes b, Op op) {
+    Lanes result;
+    for (std::size_t i = 0; i < SPAN_SIZE; i++) {
+        result.v[i] = static_cast<u16>(op(a.v[i], b.v[i]));
+    }
+    return result;
+}
+
+Lanes Load(const ChannelSpan& values) {
+    Lanes result;
+    std::copy(values.begin(), values.end(), result.v.begin());
+    return result;
+}
+
+void Store(ChannelSpan& values, Lanes lanes) {
+    for (std::size_t i = 0; i < SPAN_SIZE; i++) {
+        values[i] = static_cast<u8>(std::min<u16>(lanes.v[i], 255));
+    }
+}
+
+Lanes Splat(u16 value) {
+    Lanes result;
+    result.v.fill(value);
+    return result;
+}
+
+Lanes Add(Lanes a, Lanes b) {
+    return Map(a, b, [](u16 x, u16 y) { return x + y; });
+}
+
+Lanes Sub(Lanes a, Lanes b) {
+    return Map(a, b, [](u16 x, u16 y) { return x - y; });
+}
+
+Lanes SubSaturate(Lanes a, Lanes b) {
+    return Map(a, b, [](u16 x, u16 y) { return x > y ? x - y : 0; });
+}
+
+Lanes Mul(Lanes a, Lanes b) {
+    return Map(a, b, [](u16 x, u16 y) { return x * y; });
+}
+
+Lanes Min(Lanes a, Lanes b) {
+    return Map(a, b, [](u16 x, u16 y) { return std::min(x, y); });
+}
+
+Lanes Max(Lanes a, Lanes b) {
+    return Map(a, b, [](u16 x, u16 y) { return std::max(x, y); });
+}
+
+template <int shift>
+Lanes ShiftRight(Lanes a) {
+    return Map(a, a, [](u16 x, u16) { return x >> shift; });
+}
+
+Lanes GreaterEqual(Lanes a, Lanes b) {
+    return Map(a, b, [](u16 x, u16 y) { return x >= y ? 0xFFFF : 0; });
+}
+
+Lanes And(Lanes a, Lanes b) {
+    return Map(a, b, [](u16 x, u16 y) { return x & y; });
+}
+
+#endif
+
+/// Computes x / 255 rounded down, exact for x <= 65025.
+Lanes Div255(Lanes x) {
+    return ShiftRight<8>(Add(Add(x, Splat(1)), ShiftRight<8>(x)));
+}
+
+/// Combines a single channel of the three TEV stage inputs. Dot3 is handled by the caller.
+ChannelSpan CombineChannel(TevStageConfig::Operation op, const ChannelSpan& in0,
+                           const ChannelSpan& in1, const ChannelSpan& in2) {
+    using Operation = TevStageConfig::Operation;
+
+    if (op == Operation::Replace) {
+        return in0;
+    }
+
+    const Lanes a = Load(in0);
+    const Lanes b = Load(in1);
+    const Lanes c = Load(in2);
+    const Lanes max = Splat(255);
+
+    Lanes result;
+    switch (op) {
+    case Operation::Modulate:
+        result = Div255(Mul(a, b));
+        break;
+    case Operation::Add:
+        result = Min(Add(a, b), max);
+        break;
+    case Operation::AddSigned:
+        // TODO(bunnei): Verify that the color conversion from (float) 0.5f to
+        // (byte) 128 is correct
+        result = Min(SubSaturate(Add(a, b), Splat(128)), max);
+        break;
+    case Operation::Lerp:
+        result = Div255(Add(Mul(a, c), Mul(b, Sub(max, c))));
+        break;
+    case Operation::Subtract:
+        result = SubSaturate(a, b);
+        break;
+    case Operation::MultiplyThenAdd:
+        // (a * b + 255 * c) / 255 == a * b / 255 + c
+        result = Min(Add(Div255(Mul(a, b)), c), max);
+        break;
+    case Operation::AddThenMultiply:
+        result = Div255(Mul(Min(Add(a, b), max), c));
+        break;
+    default:
+        LOG_ERROR(HW_GPU, "Unknown combiner operation {}", (int)op);
+        UNIMPLEMENTED();
+        return {};
+    }
+
+    ChannelSpan out;
+    Store(out, result);
+    return out;
+}
+
+ChannelSpan Invert(const ChannelSpan& values) {
+    ChannelSpan out;
+    for (std::size_t i = 0; i < SPAN_SIZE; i++) {
+        out[i] = 255 - values[i];
+    }
+    return out;
+}
+
+} // Anonymous namespace
+
+RgbSpan GetColorModifierSpan(TevStageConfig::ColorModifier factor, const ColorSpan& values) {
+    using ColorModifier = TevStageConfig::ColorModifier;
+
+    switch (factor) {
+    case ColorModifier::SourceColor:
+        return {values[0], values[1], values[2]};
+    case ColorModifier::OneMinusSourceColor:
+        return {Invert(values[0]), Invert(values[1]), Invert(values[2])};
+    case ColorModifier::SourceAlpha:
+        return {values[3], values[3], values[3]};
+    case ColorModifier::OneMinusSourceAlpha: {
+        const ChannelSpan inverted = Invert(values[3]);
+        return {inverted, inverted, inverted};
+    }
+    case ColorModifier::SourceRed:
+        return {values[0], values[0], values[0]};
+    case ColorModifier::OneMinusSourceRed: {
+        const ChannelSpan inverted = Invert(values[0]);
+        return {inverted, inverted, inverted};
+    }
+    case ColorModifier::SourceGreen:
+        return {values[1], values[1], values[1]};
+    case ColorModifier::OneMinusSourceGreen: {
+        const ChannelSpan inverted = Invert(values[1]);
+        return {inverted, inverted, inverted};
+    }
+    case ColorModifier::SourceBlue:
+        return {values[2], values[2], values[2]};
+    case ColorModifier::OneMinusSourceBlue: {
+        const ChannelSpan inverted = Invert(values[2]);
+        return {inverted, inverted, inverted};
+    }
+    }
+    UNREACHABLE();
+}
+
+ChannelSpan GetAlphaModifierSpan(TevStageConfig::AlphaModifier factor, const ColorSpan& values) {
+    using AlphaModifier = TevStageConfig::AlphaModifier;
+
+    switch (factor) {
+    case AlphaModifier::SourceAlpha:
+        return values[3];
+    case AlphaModifier::OneMinusSourceAlpha:
+        return Invert(values[3]);
+    case AlphaModifier::SourceRed:
+        return values[0];
+    case AlphaModifier::OneMinusSourceRed:
+        return Invert(values[0]);
+    case AlphaModifier::SourceGreen:
+        return values[1];
+    case AlphaModifier::OneMinusSourceGreen:
+        return Invert(values[1]);
+    case AlphaModifier::SourceBlue:
+        return values[2];
+    case AlphaModifier::OneMinusSourceBlue:
+        return Invert(values[2]);
+    }
+    UNREACHABLE();
+}
+
+RgbSpan ColorCombineSpan(TevStageConfig::Operation op, std::span<const RgbSpan, 3> input) {
+    using Operation = TevStageConfig::Operation;
+
+    if (op == Operation::Dot3_RGB || op == Operation::Dot3_RGBA) {
+        // Dot3 mixes channels and needs 32-bit intermediates, use the scalar path.
+        RgbSpan out;
+        for (std::size_t lane = 0; lane < SPAN_SIZE; lane++) {
+            std::array<Common::Vec3<u8>, 3> lane_input;
+            for (std::size_t i = 0; i < 3; i++) {
+                lane_input[i] = {input[i][0][lane], input[i][1][lane], input[i][2][lane]};
+            }
+            const auto result = ColorCombine(op, lane_input);
+            for (std::size_t channel = 0; channel < 3; channel++) {
+                out[channel][lane] = result[channel];
+            }
+        }
+        return out;
+    }
+
+    return {
+        CombineChannel(op, input[0][0], input[1][0], input[2][0]),
+        CombineChannel(op, input[0][1], input[1][1], input[2][1]),
+        CombineChannel(op, input[0][2], input[1][2], input[2][2]),
+    };
+}
+
+ChannelSpan AlphaCombineSpan(TevStageConfig::Operation op, std::span<const ChannelSpan, 3> input) {
+    return CombineChannel(op, input[0], input[1], input[2]);
+}
+
+void ApplyMultiplierSpan(ChannelSpan& values, u32 multiplier) {
+    if (multiplier == 1) {
+        return;
+    }
+    const Lanes result = Min(Mul(Load(values), Splat(static_cast<u16>(multiplier))), Splat(255));
+    Store(values, result);
+}
+
+ChannelSpan EvaluateBlendEquationSpan(const ChannelSpan& src, const ChannelSpan& srcfactor,
+                                      const ChannelSpan& dest, const ChannelSpan& destfactor,
+                                      FramebufferRegs::BlendEquation equation) {
+    // The products are at most 255 * 255 and fit in 16 bits. Sums are divided piecewise
+    // to avoid overflowing the lanes.
+    const Lanes src_result = Mul(Load(src), Load(srcfactor));
+    const Lanes dst_result = Mul(Load(dest), Load(destfactor));
+    const Lanes max = Splat(255);
+
+    Lanes result;
+    switch (equation) {
+    case FramebufferRegs::BlendEquation::Add: {
+        const Lanes src_quot = Div255(src_result);
+        const Lanes dst_quot = Div255(dst_result);
+        const Lanes rem_sum = Add(Sub(src_result, Mul(src_quot, max)),
+                                  Sub(dst_result, Mul(dst_quot, max)));
+        const Lanes carry = And(GreaterEqual(rem_sum, max), Splat(1));
+        result = Min(Add(Add(src_quot, dst_quot), carry), max);
+        break;
+    }
+    case FramebufferRegs::BlendEquation::Subtract:
+        result = Div255(SubSaturate(src_result, dst_result));
+        break;
+    case FramebufferRegs::BlendEquation::ReverseSubtract:
+        result = Div255(SubSaturate(dst_result, src_result));
+        break;
+    case FramebufferRegs::BlendEquation::Min:
+        // Division by a positive constant preserves ordering.
+        result = Min(Div255(src_result), Div255(dst_result));
+        break;
+    case FramebufferRegs::BlendEquation::Max:
+        result = Max(Div255(src_result), Div255(dst_result));
+        break;
+    default:
+        LOG_CRITICAL(HW_GPU, "Unknown RGB blend equation 0x{:x}", equation);
+        UNIMPLEMENTED();
+        return {};
+    }
+
+    ChannelSpan out;
+    Store(out, result);
+    return out;
+}
+
+} // namespace SwRenderer
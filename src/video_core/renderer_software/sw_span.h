@@ -0,0 +1,77 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <span>
+
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/pica/regs_framebuffer.h"
+#include "video_core/pica/regs_texturing.h"
+
+namespace SwRenderer {
+
+/// Number of horizontally adjacent fragments processed by a single span kernel call.
+constexpr std::size_t SPAN_SIZE = 8;
+
+/// A single color channel of every fragment in a span.
+using ChannelSpan = std::array<u8, SPAN_SIZE>;
+
+/// The rgb channels of every fragment in a span.
+using RgbSpan = std::array<ChannelSpan, 3>;
+
+/// Colors of the fragments in a span, stored as one array per RGBA channel.
+struct ColorSpan {
+    std::array<ChannelSpan, 4> channels{};
+
+    ChannelSpan& operator[](std::size_t channel) {
+        return channels[channel];
+    }
+
+    const ChannelSpan& operator[](std::size_t channel) const {
+        return channels[channel];
+    }
+
+    [[nodiscard]] Common::Vec4<u8> Get(std::size_t lane) const {
+        return {channels[0][lane], channels[1][lane], channels[2][lane], channels[3][lane]};
+    }
+
+    void Set(std::size_t lane, const Common::Vec4<u8>& color) {
+        for (std::size_t i = 0; i < 4; i++) {
+            channels[i][lane] = color[i];
+        }
+    }
+
+    /// Returns a span with every fragment set to the provided color.
+    [[nodiscard]] static ColorSpan Splat(const Common::Vec4<u8>& color) {
+        ColorSpan span;
+        for (std::size_t i = 0; i < 4; i++) {
+            span.channels[i].fill(color[i]);
+        }
+        return span;
+    }
+};
+
+RgbSpan GetColorModifierSpan(Pica::TexturingRegs::TevStageConfig::ColorModifier factor,
+                             const ColorSpan& values);
+
+ChannelSpan GetAlphaModifierSpan(Pica::TexturingRegs::TevStageConfig::AlphaModifier factor,
+                                 const ColorSpan& values);
+
+RgbSpan ColorCombineSpan(Pica::TexturingRegs::TevStageConfig::Operation op,
+                         std::span<const RgbSpan, 3> input);
+
+ChannelSpan AlphaCombineSpan(Pica::TexturingRegs::TevStageConfig::Operation op,
+                             std::span<const ChannelSpan, 3> input);
+
+/// Computes min(255, value * multiplier) for every fragment of the span.
+void ApplyMultiplierSpan(ChannelSpan& values, u32 multiplier);
+
+ChannelSpan EvaluateBlendEquationSpan(const ChannelSpan& src, const ChannelSpan& srcfactor,
+                                      const ChannelSpan& dest, const ChannelSpan& destfactor,
+                                      Pica::FramebufferRegs::BlendEquation equation);
+
+} // namespace SwRenderer
@@ -849,7 +849,6 @@ void RendererVulkan::SwapBuffers() {
     }
 #endif
     rasterizer.TickFrame();
-    EndFrame();
 }
 
 void RendererVulkan::RenderScreenshot() {
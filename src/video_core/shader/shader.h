@@ -29,6 +29,9 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, ShaderUnit& state) const = 0;
+
+    /// Starts loading the shaders of the title that were cached on disk, ahead of their first use.
+    virtual void LoadDiskCache([[maybe_unused]] u64 program_id) {}
 };
 
 std::unique_ptr<ShaderEngine> CreateEngine(bool use_jit);
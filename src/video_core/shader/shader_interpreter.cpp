@@ -46,7 +46,8 @@ struct LoopStackElement {
 
 template <bool Debug>
 static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
-                           DebugData<Debug>& debug_data, unsigned entry_point) {
+                           DebugData<Debug>& debug_data, unsigned entry_point,
+                           const ArithmeticDelegate* delegate) {
     boost::circular_buffer<IfStackElement> if_stack(8);
     boost::circular_buffer<CallStackElement> call_stack(4);
     boost::circular_buffer<LoopStackElement> loop_stack(4);
@@ -209,7 +210,18 @@ static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
             debug_data.max_opdesc_id =
                 std::max<u32>(debug_data.max_opdesc_id, 1 + instr.common.operand_desc_id);
 
-            switch (instr.opcode.Value().EffectiveOpCode()) {
+            const OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+            if (delegate && ArithmeticDelegate::IsDelegated(opcode)) {
+                const Common::Vec4<f24> result = delegate->Evaluate(opcode, src1, src2);
+                for (int i = 0; i < 4; ++i) {
+                    if (swizzle.DestComponentEnabled(i)) {
+                        dest[i] = result[i];
+                    }
+                }
+                break;
+            }
+
+            switch (opcode) {
             case OpCode::Id::ADD: {
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
@@ -290,7 +302,6 @@ static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
 
-                OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
                 if (opcode == OpCode::Id::DPH || opcode == OpCode::Id::DPHI)
                     src1[3] = f24::One();
 
@@ -735,7 +746,7 @@ void InterpreterEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
     MICROPROFILE_SCOPE(GPU_Shader);
 
     DebugData<false> dummy_debug_data;
-    RunInterpreter(setup, state, dummy_debug_data, setup.entry_point);
+    RunInterpreter(setup, state, dummy_debug_data, setup.entry_point, delegate);
 }
 
 DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
@@ -747,7 +758,7 @@ DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
     // Setup input register table
     state.input.fill(Common::Vec4<f24>::AssignToAll(f24::Zero()));
     state.LoadInput(config, input);
-    RunInterpreter(setup, state, debug_data, setup.entry_point);
+    RunInterpreter(setup, state, debug_data, setup.entry_point, nullptr);
     return debug_data;
 }
 
@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <nihstro/shader_bytecode.h>
+#include "common/vector_math.h"
 #include "video_core/pica/output_vertex.h"
+#include "video_core/pica_types.h"
 #include "video_core/shader/debug_data.h"
 #include "video_core/shader/shader.h"
 
@@ -14,8 +17,48 @@ struct ShaderRegs;
 
 namespace Pica::Shader {
 
+/**
+ * Computes the arithmetic instructions whose results differ between shader engines, such as the
+ * approximations used for RCP and EX2. The interpreter defers them to a delegate when it stands
+ * in for another engine, so that both produce bit-identical vertices.
+ */
+class ArithmeticDelegate {
+public:
+    virtual ~ArithmeticDelegate() = default;
+
+    /// Returns true for the instructions that are deferred to the delegate
+    static bool IsDelegated(nihstro::OpCode::Id opcode) {
+        switch (opcode) {
+        case nihstro::OpCode::Id::DP3:
+        case nihstro::OpCode::Id::DP4:
+        case nihstro::OpCode::Id::DPH:
+        case nihstro::OpCode::Id::DPHI:
+        case nihstro::OpCode::Id::EX2:
+        case nihstro::OpCode::Id::LG2:
+        case nihstro::OpCode::Id::RCP:
+        case nihstro::OpCode::Id::RSQ:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * Evaluates a delegated instruction
+     * @param opcode Effective opcode of the instruction
+     * @param src1 First source operand, already swizzled and negated
+     * @param src2 Second source operand, already swizzled and negated
+     * @return All four components of the result, before the destination mask is applied
+     */
+    virtual Common::Vec4<f24> Evaluate(nihstro::OpCode::Id opcode, const f24* src1,
+                                       const f24* src2) const = 0;
+};
+
 class InterpreterEngine final : public ShaderEngine {
 public:
+    explicit InterpreterEngine(const ArithmeticDelegate* delegate = nullptr)
+        : delegate{delegate} {}
+
     void SetupBatch(ShaderSetup& setup, u32 entry_point) override;
     void Run(const ShaderSetup& setup, ShaderUnit& state) const override;
 
@@ -28,6 +71,9 @@ public:
      */
     DebugData<true> ProduceDebugInfo(const ShaderSetup& setup, const AttributeBuffer& input,
                                      const ShaderRegs& config) const;
+
+private:
+    const ArithmeticDelegate* delegate;
 };
 
 } // namespace Pica::Shader
@@ -5,11 +5,19 @@
 #include "common/arch.h"
 #if CYTRUS_ARCH(x86_64) || CYTRUS_ARCH(arm64)
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
 #include "common/assert.h"
 #include "common/hash.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
+#include "video_core/pica/shader_setup.h"
+#include "video_core/pica/shader_unit.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
 #if CYTRUS_ARCH(arm64)
 #include "video_core/shader/shader_jit_a64_compiler.h"
 #endif
@@ -19,8 +27,79 @@
 
 namespace Pica::Shader {
 
-JitEngine::JitEngine() = default;
-JitEngine::~JitEngine() = default;
+using nihstro::OpCode;
+
+struct JitEngine::CacheEntry {
+    std::unique_ptr<JitShader> shader;
+
+    /// Published once the shader is ready to run, possibly by a compile worker
+    std::atomic<const JitShader*> compiled{};
+};
+
+/// Copy of the program being compiled by a worker, as the setup may change in the meantime
+struct JitEngine::ProgramCopy {
+    ProgramCode program_code;
+    SwizzleData swizzle_data;
+};
+
+/**
+ * Evaluates the instructions delegated by the interpreter with a program holding each of them at
+ * its own entry point, which reads its operands from v0 and v1 and writes all components of o0.
+ */
+class JitEngine::JitArithmetic final : public ArithmeticDelegate {
+public:
+    JitArithmetic() {
+        // Selects xyzw for every source and enables all destination components
+        constexpr u32 IdentitySwizzle = 0x0D86C36F;
+        constexpr u32 Operands = (1 << 7); // dest o0, src1 v0, src2 v1
+        setup.swizzle_data[0] = IdentitySwizzle;
+        for (u32 i = 0; i < Opcodes.size(); ++i) {
+            setup.program_code[2 * i] = (static_cast<u32>(Opcodes[i]) << 26) | Operands;
+            setup.program_code[2 * i + 1] = static_cast<u32>(OpCode::Id::END) << 26;
+        }
+        shader.Compile(&setup.program_code, &setup.swizzle_data);
+    }
+
+    Common::Vec4<f24> Evaluate(OpCode::Id opcode, const f24* src1,
+                               const f24* src2) const override {
+        // DPHI only differs from DPH in how its operands are fetched
+        if (opcode == OpCode::Id::DPHI) {
+            opcode = OpCode::Id::DPH;
+        }
+        const auto it = std::find(Opcodes.begin(), Opcodes.end(), opcode);
+        ASSERT(it != Opcodes.end());
+
+        ShaderUnit state;
+        std::copy_n(src1, 4, &state.input[0].x);
+        std::copy_n(src2, 4, &state.input[1].x);
+        shader.Run(setup, state, 2 * static_cast<u32>(it - Opcodes.begin()));
+        return state.output[0];
+    }
+
+private:
+    static constexpr std::array Opcodes{
+        OpCode::Id::DP3, OpCode::Id::DP4, OpCode::Id::DPH, OpCode::Id::EX2,
+        OpCode::Id::LG2, OpCode::Id::RCP, OpCode::Id::RSQ,
+    };
+
+    ShaderSetup setup;
+    JitShader shader;
+};
+
+JitEngine::JitEngine()
+    : arithmetic{Settings::values.async_shader_jit.GetValue() ? std::make_unique<JitArithmetic>()
+                                                              : nullptr},
+      interpreter{arithmetic.get()} {
+    if (arithmetic) {
+        const u32 num_workers = std::clamp(std::thread::hardware_concurrency() / 4, 1U, 4U);
+        compile_workers = std::make_unique<Common::ThreadWorker>(num_workers, "ShaderJit");
+    }
+}
+
+JitEngine::~JitEngine() {
+    // Stop the workers before the entries they publish to are destroyed
+    compile_workers.reset();
+}
 
 void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
@@ -30,21 +109,99 @@ void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
     const u64 swizzle_hash = setup.GetSwizzleDataHash();
 
     const u64 cache_key = Common::HashCombine(code_hash, swizzle_hash);
-    auto iter = cache.find(cache_key);
-    if (iter != cache.end()) {
-        setup.cached_shader = iter->second.get();
-    } else {
+    auto [iter, inserted] = cache.try_emplace(cache_key);
+    if (inserted) {
+        iter->second = std::make_unique<CacheEntry>();
+        CompileShader(*iter->second, cache_key, setup);
+    }
+
+    // Stays null while the shader is compiled in the background, Run falls back to the
+    // interpreter for those batches. It defers the instructions whose results are specific to
+    // the JIT back to it, so the vertices are the same either way.
+    setup.cached_shader = iter->second->compiled.load(std::memory_order_acquire);
+}
+
+void JitEngine::CompileShader(CacheEntry& entry, u64 cache_key, const ShaderSetup& setup) {
+    if (LoadFromDiskCache(entry, cache_key)) {
+        return;
+    }
+
+    const auto compile = [this, &entry, cache_key](const auto& program_code,
+                                                   const auto& swizzle_data) {
         auto shader = std::make_unique<JitShader>();
-        shader->Compile(&setup.program_code, &setup.swizzle_data);
-        setup.cached_shader = shader.get();
-        cache.emplace_hint(iter, cache_key, std::move(shader));
+        shader->Compile(&program_code, &swizzle_data);
+        SaveToDiskCache(*shader, cache_key);
+
+        entry.shader = std::move(shader);
+        entry.compiled.store(entry.shader.get(), std::memory_order_release);
+    };
+
+    if (!compile_workers) {
+        compile(setup.program_code, setup.swizzle_data);
+        return;
     }
+
+    auto program = std::make_unique<ProgramCopy>();
+    program->program_code = setup.program_code;
+    program->swizzle_data = setup.swizzle_data;
+    compile_workers->QueueWork([compile, program = std::move(program)] {
+        compile(program->program_code, program->swizzle_data);
+    });
+}
+
+bool JitEngine::LoadFromDiskCache(CacheEntry& entry, u64 cache_key) {
+#if CYTRUS_ARCH(x86_64)
+    if (!disk_cache) {
+        return false;
+    }
+    const auto cached_code = disk_cache->Take(cache_key);
+    if (!cached_code) {
+        return false;
+    }
+
+    auto shader = std::make_unique<JitShader>();
+    if (!shader->Deserialize(*cached_code)) {
+        return false;
+    }
+    entry.shader = std::move(shader);
+    entry.compiled.store(entry.shader.get(), std::memory_order_release);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void JitEngine::SaveToDiskCache(const JitShader& shader, u64 cache_key) {
+#if CYTRUS_ARCH(x86_64)
+    if (disk_cache) {
+        disk_cache->Append(cache_key, shader.Serialize());
+    }
+#endif
+}
+
+void JitEngine::LoadDiskCache(u64 program_id) {
+    // Only the x64 backend emits relocatable code
+#if CYTRUS_ARCH(x86_64)
+    if (!Settings::values.use_disk_shader_cache.GetValue() || program_id == 0) {
+        return;
+    }
+
+    // Wait for the shaders being compiled to be appended to the previous cache
+    if (compile_workers) {
+        compile_workers->WaitForRequests();
+    }
+    disk_cache = std::make_unique<JitDiskCache>(program_id, JitShader::GetHostSignature());
+    disk_cache->LoadAsync();
+#endif
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
 
 void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
-    ASSERT(setup.cached_shader != nullptr);
+    if (setup.cached_shader == nullptr) {
+        interpreter.Run(setup, state);
+        return;
+    }
 
     MICROPROFILE_SCOPE(GPU_Shader);
 
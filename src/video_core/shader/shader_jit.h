@@ -10,10 +10,13 @@
 #include <memory>
 #include <unordered_map>
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "video_core/shader/shader.h"
+#include "video_core/shader/shader_interpreter.h"
 
 namespace Pica::Shader {
 
+class JitDiskCache;
 class JitShader;
 
 class JitEngine final : public ShaderEngine {
@@ -23,9 +26,31 @@ public:
 
     void SetupBatch(ShaderSetup& setup, u32 entry_point) override;
     void Run(const ShaderSetup& setup, ShaderUnit& state) const override;
+    void LoadDiskCache(u64 program_id) override;
 
 private:
-    std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    class JitArithmetic;
+    struct CacheEntry;
+    struct ProgramCopy;
+
+    /**
+     * Compiles the shader of the entry, either immediately or on a compile worker when
+     * asynchronous compilation is enabled.
+     */
+    void CompileShader(CacheEntry& entry, u64 cache_key, const ShaderSetup& setup);
+
+    bool LoadFromDiskCache(CacheEntry& entry, u64 cache_key);
+    void SaveToDiskCache(const JitShader& shader, u64 cache_key);
+
+    std::unordered_map<u64, std::unique_ptr<CacheEntry>> cache;
+    std::unique_ptr<JitDiskCache> disk_cache;
+
+    /// Runs the instructions the interpreter would compute differently through the JIT
+    std::unique_ptr<JitArithmetic> arithmetic;
+    /// Runs batches whose shader is still being compiled
+    InterpreterEngine interpreter;
+
+    std::unique_ptr<Common::ThreadWorker> compile_workers;
 };
 
 } // namespace Pica::Shader
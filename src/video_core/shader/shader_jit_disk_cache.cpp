@@ -0,0 +1,191 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <fmt/format.h>
+#include "common/common_paths.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
+
+namespace Pica::Shader {
+
+namespace {
+
+constexpr u32 CacheMagic = 0x54494A50; // "PJIT"
+
+/// Bump whenever the layout of the cache file changes
+constexpr u32 CacheVersion = 1;
+
+struct CacheHeader {
+    u32 magic;
+    u32 version;
+    u64 build_hash;
+    u64 host_signature;
+};
+static_assert(sizeof(CacheHeader) == 24);
+
+struct EntryHeader {
+    u64 key;
+    u64 size;
+    u64 code_hash; ///< Hash of the code, as the code of a damaged entry must never be run
+};
+static_assert(sizeof(EntryHeader) == 24);
+
+CacheHeader MakeHeader(u64 host_signature) {
+    // Emitted code bakes in structure offsets of the emulator, never reuse it across builds
+    return {
+        .magic = CacheMagic,
+        .version = CacheVersion,
+        .build_hash = Common::ComputeHash64(Common::g_scm_rev, std::strlen(Common::g_scm_rev)),
+        .host_signature = host_signature,
+    };
+}
+
+} // Anonymous namespace
+
+JitDiskCache::JitDiskCache(u64 title_id_, u64 host_signature_)
+    : title_id{title_id_}, host_signature{host_signature_}, worker{1, "ShaderJitCache"} {}
+
+JitDiskCache::~JitDiskCache() {
+    worker.WaitForRequests();
+}
+
+void JitDiskCache::LoadAsync() {
+    worker.QueueWork([this] { Load(); });
+}
+
+std::optional<std::vector<u8>> JitDiskCache::Take(u64 key) {
+    std::scoped_lock lock{mutex};
+    const auto it = loaded_shaders.find(key);
+    if (it == loaded_shaders.end()) {
+        return std::nullopt;
+    }
+    auto code = std::move(it->second);
+    loaded_shaders.erase(it);
+    return code;
+}
+
+void JitDiskCache::Append(u64 key, std::vector<u8> code) {
+    worker.QueueWork([this, key, code = std::move(code)] { Save(key, code); });
+}
+
+void JitDiskCache::Load() {
+    const std::string path = GetCachePath();
+    if (!FileUtil::Exists(path)) {
+        return;
+    }
+
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Failed to open shader JIT cache {}", path);
+        return;
+    }
+
+    const CacheHeader expected = MakeHeader(host_signature);
+    CacheHeader header{};
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        std::memcmp(&header, &expected, sizeof(header)) != 0) {
+        LOG_INFO(HW_GPU, "Shader JIT cache was created by another build or host, removing");
+        file.Close();
+        FileUtil::Delete(path);
+        return;
+    }
+
+    const u64 file_size = file.GetSize();
+    u64 valid_size = file.Tell();
+    std::size_t num_loaded = 0;
+    EntryHeader entry{};
+    while (file.ReadBytes(&entry, sizeof(entry)) == sizeof(entry)) {
+        if (entry.size > file_size - file.Tell()) {
+            break;
+        }
+        std::vector<u8> code(entry.size);
+        if (file.ReadBytes(code.data(), code.size()) != code.size()) {
+            break;
+        }
+        valid_size = file.Tell();
+        if (Common::ComputeHash64(code.data(), code.size()) != entry.code_hash) {
+            LOG_WARNING(HW_GPU, "Shader JIT cache entry {:016X} is corrupted, skipping",
+                        entry.key);
+            continue;
+        }
+        if (!stored_keys.insert(entry.key).second) {
+            continue;
+        }
+
+        std::scoped_lock lock{mutex};
+        loaded_shaders.insert_or_assign(entry.key, std::move(code));
+        num_loaded++;
+    }
+
+    file.Close();
+
+    // Drop a partially written last entry, so that the entries appended after it can be read
+    if (valid_size != file_size) {
+        LOG_WARNING(HW_GPU, "Shader JIT cache is truncated, dropping its last entry");
+        FileUtil::IOFile truncate_file(path, "r+b");
+        if (!truncate_file.IsOpen() || !truncate_file.Resize(valid_size)) {
+            LOG_ERROR(HW_GPU, "Failed to truncate shader JIT cache {}, removing", path);
+            truncate_file.Close();
+            FileUtil::Delete(path);
+        }
+    }
+
+    LOG_INFO(HW_GPU, "Loaded {} shaders from the shader JIT cache", num_loaded);
+}
+
+void JitDiskCache::Save(u64 key, const std::vector<u8>& code) {
+    // Shaders compiled before loading finished might already be stored
+    if (!stored_keys.insert(key).second || !OpenForAppend()) {
+        return;
+    }
+
+    const EntryHeader entry{
+        .key = key,
+        .size = code.size(),
+        .code_hash = Common::ComputeHash64(code.data(), code.size()),
+    };
+    if (append_file.WriteObject(entry) != 1 ||
+        append_file.WriteBytes(code.data(), code.size()) != code.size()) {
+        LOG_ERROR(HW_GPU, "Failed to write to the shader JIT cache");
+        append_file.Close();
+        return;
+    }
+    append_file.Flush();
+}
+
+bool JitDiskCache::OpenForAppend() {
+    if (append_file.IsOpen()) {
+        return true;
+    }
+
+    const std::string path = GetCachePath();
+    if (!FileUtil::CreateFullPath(path)) {
+        LOG_ERROR(HW_GPU, "Failed to create the shader JIT cache directory for {}", path);
+        return false;
+    }
+
+    append_file = FileUtil::IOFile(path, "ab");
+    if (!append_file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Failed to open shader JIT cache {}", path);
+        return false;
+    }
+
+    // New files begin with a header describing the build and host
+    if (append_file.GetSize() == 0 && append_file.WriteObject(MakeHeader(host_signature)) != 1) {
+        LOG_ERROR(HW_GPU, "Failed to write the shader JIT cache header to {}", path);
+        append_file.Close();
+        return false;
+    }
+    return true;
+}
+
+std::string JitDiskCache::GetCachePath() const {
+    return fmt::format("{}jit" DIR_SEP "{:016X}.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir), title_id);
+}
+
+} // namespace Pica::Shader
@@ -0,0 +1,62 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/thread_worker.h"
+
+namespace Pica::Shader {
+
+/**
+ * Stores the code emitted by the shader JIT on disk, keyed by the hash of the program and
+ * swizzle data, so that the shaders of a title don't have to be recompiled on every boot.
+ * All file accesses happen on a dedicated thread in submission order.
+ */
+class JitDiskCache {
+public:
+    /**
+     * @param title_id       Title the cache file belongs to.
+     * @param host_signature Value identifying the host the code was emitted for. Cache files
+     *                       written with a different signature are discarded.
+     */
+    explicit JitDiskCache(u64 title_id, u64 host_signature);
+    ~JitDiskCache();
+
+    /// Starts loading the cache file of the title in the background.
+    void LoadAsync();
+
+    /// Returns the stored code for the given key if it has been loaded, removing it from memory.
+    std::optional<std::vector<u8>> Take(u64 key);
+
+    /// Queues the code of a newly compiled shader to be appended to the cache file.
+    void Append(u64 key, std::vector<u8> code);
+
+private:
+    void Load();
+    void Save(u64 key, const std::vector<u8>& code);
+    bool OpenForAppend();
+    std::string GetCachePath() const;
+
+    u64 title_id;
+    u64 host_signature;
+
+    std::mutex mutex;
+    std::unordered_map<u64, std::vector<u8>> loaded_shaders;
+
+    /// Members below are only accessed from the cache thread
+    std::unordered_set<u64> stored_keys;
+    FileUtil::IOFile append_file;
+
+    Common::ThreadWorker worker;
+};
+
+} // namespace Pica::Shader
@@ -5,6 +5,8 @@
 #include "common/arch.h"
 #if CYTRUS_ARCH(x86_64)
 
+#include <algorithm>
+#include <cstring>
 #include <nihstro/shader_bytecode.h>
 #include <smmintrin.h>
 #include <xbyak/xbyak_util.h>
@@ -14,7 +16,6 @@
 #include "common/vector_math.h"
 #include "common/x64/cpu_detect.h"
 #include "common/x64/xbyak_abi.h"
-#include "common/x64/xbyak_util.h"
 #include "video_core/pica/shader_unit.h"
 #include "video_core/pica_types.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
@@ -170,12 +171,18 @@ static void LogCritical(const char* msg) {
 void JitShader::Compile_Assert(bool condition, const char* msg) {
     if (!condition) {
         ABI_PushRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
-        mov(ABI_PARAM1, reinterpret_cast<std::size_t>(msg));
-        CallFarFunction(*this, LogCritical);
+        Compile_LogCritical(msg);
         ABI_PopRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
     }
 }
 
+void JitShader::Compile_LogCritical(const char* msg) {
+    // Both the message and the function address are addressed relative to the code, so that the
+    // shader can be serialized and loaded at a different address.
+    lea(ABI_PARAM1, ptr[rip + log_messages.emplace_back(Label{}, msg).first]);
+    call(qword[rip + log_critical_function]);
+}
+
 /**
  * Loads and swizzles a source register into the specified XMM register.
  * @param instr VS instruction, used for determining how to load the source register
@@ -564,8 +571,23 @@ void JitShader::Compile_FLR(Instruction instr) {
     if (host_caps.has(Cpu::tSSE41)) {
         roundps(SRC1, SRC1, _MM_FROUND_FLOOR);
     } else {
-        cvttps2dq(SRC1, SRC1);
-        cvtdq2ps(SRC1, SRC1);
+        // Truncate, then subtract one where that rounded a negative value up. Values that do not
+        // fit an int32 are already integral and are kept, as are infinities and NaN. The sign of
+        // the source is kept so that floor(-0.0) is -0.0, matching roundps and std::floor.
+        cvttps2dq(SCRATCH, SRC1);
+        movdqa(SCRATCH2, SCRATCH);
+        pcmpeqd(SCRATCH2, NEGBIT); // Out of range conversions return 0x80000000
+        cvtdq2ps(SCRATCH, SCRATCH);
+        movaps(SRC2, SRC1);
+        cmpltps(SRC2, SCRATCH);
+        andps(SRC2, ONE);
+        subps(SCRATCH, SRC2);
+        movaps(SRC3, SRC1);
+        andps(SRC3, NEGBIT);
+        andps(SRC1, SCRATCH2);
+        andnps(SCRATCH2, SCRATCH);
+        orps(SRC1, SCRATCH2);
+        orps(SRC1, SRC3);
     }
 
     Compile_DestEnable(instr, SRC1);
@@ -877,8 +899,7 @@ void JitShader::Compile_EMIT(Instruction instr) {
     jnz(have_emitter);
 
     ABI_PushRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
-    mov(ABI_PARAM1, reinterpret_cast<std::size_t>("Execute EMIT on VS"));
-    CallFarFunction(*this, LogCritical);
+    Compile_LogCritical("Execute EMIT on VS");
     ABI_PopRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
     jmp(end);
 
@@ -887,7 +908,7 @@ void JitShader::Compile_EMIT(Instruction instr) {
     mov(ABI_PARAM1, rax);
     mov(ABI_PARAM2, STATE);
     add(ABI_PARAM2, static_cast<Xbyak::uint32>(offsetof(ShaderUnit, output)));
-    CallFarFunction(*this, Emit);
+    call(qword[rip + emit_function]);
     ABI_PopRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
     L(end);
 }
@@ -899,8 +920,7 @@ void JitShader::Compile_SETE(Instruction instr) {
     jnz(have_emitter);
 
     ABI_PushRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
-    mov(ABI_PARAM1, reinterpret_cast<std::size_t>("Execute SETEMIT on VS"));
-    CallFarFunction(*this, LogCritical);
+    Compile_LogCritical("Execute SETEMIT on VS");
     ABI_PopRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
     jmp(end);
 
@@ -1006,14 +1026,10 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     mov(COND1, byte[STATE + offsetof(ShaderUnit, conditional_code[1])]);
 
     // Used to set a register to one
-    static const __m128 one = {1.f, 1.f, 1.f, 1.f};
-    mov(rax, reinterpret_cast<std::size_t>(&one));
-    movaps(ONE, xword[rax]);
+    movaps(ONE, xword[rip + one_vector]);
 
     // Used to negate registers
-    static const __m128 neg = {-0.f, -0.f, -0.f, -0.f};
-    mov(rax, reinterpret_cast<std::size_t>(&neg));
-    movaps(NEGBIT, xword[rax]);
+    movaps(NEGBIT, xword[rip + neg_vector]);
 
     // Jump to start of the shader program
     jmp(ABI_PARAM3);
@@ -1021,13 +1037,26 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     // Compile entire program
     Compile_Block(static_cast<u32>(program_code->size()));
 
+    // Emit the messages logged by the program
+    for (auto& [label, msg] : log_messages) {
+        L(label);
+        db(reinterpret_cast<const u8*>(msg), std::strlen(msg) + 1);
+    }
+
+    ready();
+
+    // Resolve the entry points now that all labels have been bound
+    for (std::size_t i = 0; i < instruction_labels.size(); ++i) {
+        entry_offsets[i] = static_cast<u32>(instruction_labels[i].getAddress() - getCode());
+    }
+
     // Free memory that's no longer needed
     program_code = nullptr;
     swizzle_data = nullptr;
     return_offsets.clear();
     return_offsets.shrink_to_fit();
-
-    ready();
+    log_messages.clear();
+    log_messages.shrink_to_fit();
 
     ASSERT_MSG(getSize() <= MAX_SHADER_SIZE, "Compiled a shader that exceeds the allocated size!");
     LOG_DEBUG(HW_GPU, "Compiled shader size={}", getSize());
@@ -1037,7 +1066,112 @@ JitShader::JitShader() : Xbyak::CodeGenerator(MAX_SHADER_SIZE) {
     CompilePrelude();
 }
 
+namespace {
+
+/// Header of a serialized shader, followed by the entry offsets and the code itself.
+struct SerializedShaderHeader {
+    u32 code_size;
+    u32 program_offset;
+    u32 host_function_table;
+};
+
+/// Host functions referenced by the function table in the prelude, in table order
+std::array<u64, 2> GetHostFunctions() {
+    return {reinterpret_cast<u64>(&LogCritical), reinterpret_cast<u64>(&Emit)};
+}
+
+} // Anonymous namespace
+
+std::vector<u8> JitShader::Serialize() const {
+    const SerializedShaderHeader header{
+        .code_size = static_cast<u32>(getSize()),
+        .program_offset = static_cast<u32>(reinterpret_cast<const u8*>(program) - getCode()),
+        .host_function_table = static_cast<u32>(host_function_table),
+    };
+
+    std::vector<u8> blob(sizeof(header) + sizeof(entry_offsets) + getSize());
+    u8* out = blob.data();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, entry_offsets.data(), sizeof(entry_offsets));
+    out += sizeof(entry_offsets);
+    std::memcpy(out, getCode(), getSize());
+    return blob;
+}
+
+bool JitShader::Deserialize(std::span<const u8> blob) {
+    SerializedShaderHeader header;
+    if (blob.size() < sizeof(header) + sizeof(entry_offsets)) {
+        return false;
+    }
+    std::memcpy(&header, blob.data(), sizeof(header));
+
+    const auto code = blob.subspan(sizeof(header) + sizeof(entry_offsets));
+    const std::size_t host_functions_size = GetHostFunctions().size() * sizeof(u64);
+    if (code.size() != header.code_size || code.size() > MAX_SHADER_SIZE ||
+        header.program_offset >= code.size() ||
+        header.host_function_table + host_functions_size > code.size()) {
+        return false;
+    }
+
+    std::array<u32, MAX_PROGRAM_CODE_LENGTH> offsets;
+    std::memcpy(offsets.data(), blob.data() + sizeof(header), sizeof(offsets));
+    if (std::any_of(offsets.begin(), offsets.end(),
+                    [&](u32 offset) { return offset >= code.size(); })) {
+        return false;
+    }
+
+    // Discard the prelude emitted on construction, the blob carries its own copy
+    reset();
+    std::memcpy(top_, code.data(), code.size());
+    setSize(code.size());
+
+    // The code only references host functions through the table, point it at this process
+    const auto host_functions = GetHostFunctions();
+    std::memcpy(top_ + header.host_function_table, host_functions.data(), host_functions_size);
+
+    entry_offsets = offsets;
+    host_function_table = header.host_function_table;
+    program = reinterpret_cast<CompiledShader*>(top_ + header.program_offset);
+    ready();
+    return true;
+}
+
+u64 JitShader::GetHostSignature() {
+    // Bump whenever the layout of serialized shaders or of the prelude changes
+    constexpr u64 SerializedVersion = 2;
+
+    u64 features = 0;
+    features |= static_cast<u64>(host_caps.has(Cpu::tSSE41)) << 0;
+    features |= static_cast<u64>(host_caps.has(Cpu::tAVX)) << 1;
+    features |= static_cast<u64>(host_caps.has(Cpu::tFMA)) << 2;
+    features |= static_cast<u64>(host_caps.has(Cpu::tAVX512F)) << 3;
+    features |= static_cast<u64>(host_caps.has(Cpu::tAVX512VL)) << 4;
+    features |= static_cast<u64>(host_caps.has(Cpu::tAVX512DQ)) << 5;
+    return (SerializedVersion << 32) | features;
+}
+
 void JitShader::CompilePrelude() {
+    // Vector constants loaded at the start of the shader program
+    align(16);
+    L(one_vector);
+    for (std::size_t i = 0; i < 4; ++i) {
+        dd(0x3f800000); // 1.0f
+    }
+    L(neg_vector);
+    for (std::size_t i = 0; i < 4; ++i) {
+        dd(0x80000000); // -0.0f
+    }
+
+    // Host functions are only called through this table, which allows relocating the code
+    align(8);
+    const auto host_functions = GetHostFunctions();
+    host_function_table = getSize();
+    L(log_critical_function);
+    dq(host_functions[0]);
+    L(emit_function);
+    dq(host_functions[1]);
+
     log2_subroutine = CompilePrelude_Log2();
     exp2_subroutine = CompilePrelude_Exp2();
 }
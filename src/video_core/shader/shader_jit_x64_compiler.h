@@ -10,6 +10,8 @@
 #include <array>
 #include <bitset>
 #include <cstddef>
+#include <span>
+#include <utility>
 #include <vector>
 #include <nihstro/shader_bytecode.h>
 #include <xbyak/xbyak.h>
@@ -39,12 +41,31 @@ public:
     JitShader();
 
     void Run(const ShaderSetup& setup, ShaderUnit& state, u32 offset) const {
-        program(&setup.uniforms, &state, instruction_labels[offset].getAddress());
+        program(&setup.uniforms, &state, getCode() + entry_offsets[offset]);
     }
 
     void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
                  const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data);
 
+    /**
+     * Serializes the compiled shader into a blob that can be loaded back with Deserialize. The
+     * emitted code is position independent, host function addresses are only referenced through
+     * a table that is patched on load.
+     */
+    std::vector<u8> Serialize() const;
+
+    /**
+     * Replaces the contents of the shader with a blob created by Serialize.
+     * @returns false if the blob is malformed, in which case the shader must be compiled instead.
+     */
+    bool Deserialize(std::span<const u8> blob);
+
+    /**
+     * Returns a value identifying the code layout and the host CPU features the emitted code
+     * depends on. Serialized shaders may only be loaded on hosts with the same signature.
+     */
+    static u64 GetHostSignature();
+
     void Compile_ADD(Instruction instr);
     void Compile_DP3(Instruction instr);
     void Compile_DP4(Instruction instr);
@@ -106,6 +127,9 @@ private:
      */
     void Compile_Assert(bool condition, const char* msg);
 
+    /// Emits a call to LogCritical with the provided message, stored alongside the shader code.
+    void Compile_LogCritical(const char* msg);
+
     /**
      * Analyzes the entire shader program for `CALL` instructions before emitting any code,
      * identifying the locations where a return needs to be inserted.
@@ -125,6 +149,12 @@ private:
     /// Mapping of Pica VS instructions to pointers in the emitted code
     std::array<Xbyak::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
 
+    /// Offsets of each Pica VS instruction from the start of the code, resolved after compilation
+    std::array<u32, MAX_PROGRAM_CODE_LENGTH> entry_offsets{};
+
+    /// Messages referenced by the emitted code, written after the shader program
+    std::vector<std::pair<Xbyak::Label, const char*>> log_messages;
+
     /// Labels pointing to the end of each nested LOOP block. Used by the BREAKC instruction to
     /// break out of a loop.
     std::vector<Xbyak::Label> loop_break_labels;
@@ -140,6 +170,15 @@ private:
 
     Xbyak::Label log2_subroutine;
     Xbyak::Label exp2_subroutine;
+
+    /// Vector constants used by the shader program
+    Xbyak::Label one_vector;
+    Xbyak::Label neg_vector;
+
+    /// Table of host function addresses called by the emitted code
+    Xbyak::Label log_critical_function;
+    Xbyak::Label emit_function;
+    std::size_t host_function_table = 0;
 };
 
 } // namespace Pica::Shader
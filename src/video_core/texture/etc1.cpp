@@ -69,13 +69,8 @@ union ETC1Tile {
         BitField<60, 4, u64> r1;
     } separate;
 
-    const Common::Vec3<u8> GetRGB(unsigned int x, unsigned int y) const {
-        int texel = 4 * x + y;
-
-        if (flip)
-            std::swap(x, y);
-
-        // Lookup base value
+    /// Returns the base color of the half of the subtile containing the flipped coordinate x.
+    Common::Vec3<int> GetBaseColor(unsigned int x) const {
         Common::Vec3<int> ret;
         if (differential_mode) {
             ret.r() = static_cast<int>(differential.r);
@@ -100,8 +95,10 @@ union ETC1Tile {
                 ret.b() = Common::Color::Convert4To8(static_cast<u8>(separate.b2));
             }
         }
+        return ret;
+    }
 
-        // Add modifier
+    Common::Vec3<u8> ApplyModifier(Common::Vec3<int> ret, unsigned int x, int texel) const {
         unsigned table_index =
             static_cast<int>((x < 2) ? table_index_1.Value() : table_index_2.Value());
 
@@ -115,6 +112,29 @@ union ETC1Tile {
 
         return ret.Cast<u8>();
     }
+
+    const Common::Vec3<u8> GetRGB(unsigned int x, unsigned int y) const {
+        int texel = 4 * x + y;
+
+        if (flip)
+            std::swap(x, y);
+
+        return ApplyModifier(GetBaseColor(x), x, texel);
+    }
+
+    std::array<Common::Vec3<u8>, 16> GetAllRGB() const {
+        // Both halves share their base color, so only compute it once per half
+        const std::array<Common::Vec3<int>, 2> base_colors = {GetBaseColor(0), GetBaseColor(2)};
+
+        std::array<Common::Vec3<u8>, 16> texels;
+        for (unsigned int y = 0; y < 4; y++) {
+            for (unsigned int x = 0; x < 4; x++) {
+                const unsigned int half_x = flip ? y : x;
+                texels[y * 4 + x] = ApplyModifier(base_colors[half_x / 2], half_x, 4 * x + y);
+            }
+        }
+        return texels;
+    }
 };
 
 } // anonymous namespace
@@ -124,4 +144,9 @@ Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+std::array<Common::Vec3<u8>, 16> DecodeETC1Subtile(u64 value) {
+    ETC1Tile tile{value};
+    return tile.GetAllRGB();
+}
+
 } // namespace Pica::Texture
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 
@@ -11,4 +12,7 @@ namespace Pica::Texture {
 
 Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y);
 
+/// Decodes every texel of a 4x4 ETC1 subtile, indexed by y * 4 + x.
+std::array<Common::Vec3<u8>, 16> DecodeETC1Subtile(u64 value);
+
 } // namespace Pica::Texture